@@ -0,0 +1,457 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Measure how fast findCosmicRays is, and how well it finds and removes CRs, on a synthetic frame whose
+ * truth is known:  a sloping, noisy sky with PSF-shaped stars (the brightest of which saturate and bleed),
+ * bad columns, and CR tracks.
+ *
+ * Usage:
+ *    crBenchmark [--width N] [--height N] [--ncr N] [--nstar N] [--nbadcol N] [--nsat N]
+ *                [--iter N] [--threads N] [--seed N] [--json file]
+ *
+ * The results are written as JSON (to stdout unless --json is given), so that they can be tracked from
+ * release to release.  Two stages are timed (the best of --iter runs):
+ *   - "scan":    findCosmicRays with keep=true, i.e. finding and growing the CRs but not removing them
+ *   - "total":   findCosmicRays with keep=false;  the difference is reported as "removal"
+ * For each we report the pixels processed per second, the number and size of the heap allocations made,
+ * the peak heap usage, and findCosmicRays' own breakdown of the fastest run (CosmicRayStats);  the
+ * process's peak resident set size is also reported.
+ *
+ * The detection is scored against the injected CRs:  completeness is the fraction of the pixels with a CR
+ * deposit of more than 5 sigma that are masked as CR;  strictPurity is the fraction of the CR-masked
+ * pixels that have any CR deposit at all, and purity the fraction that have a deposit in them or one of
+ * their 8 neighbours (findCosmicRays deliberately masks the pixels bordering a CR).  We also count the
+ * masked pixels that are on stars (more than 5 sigma above the sky) but not near a CR.  The removal is
+ * scored by the residuals (in units of sigma) of the interpolated pixels from the noiseless truth,
+ * ignoring pixels that are BAD or SAT.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "lsst/pex/policy/Policy.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+#include "heapCounter.h"
+
+namespace afwDet = lsst::afw::detection;
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+typedef afwImage::MaskedImage<float> MaskedImageF;
+
+/************************************************************************************************************/
+/*
+ * Count the heap allocations (see heapCounter.h)
+ */
+using heapCounter::HeapStats;
+using heapCounter::getHeapStats;
+using heapCounter::resetHeapStats;
+
+/************************************************************************************************************/
+
+namespace {
+/*
+ * What to put in the synthetic frame, and how to run findCosmicRays
+ */
+struct Options {
+    Options() : width(2048), height(4096), nCr(5000), nStar(200), nBadColumn(4), nSaturated(5),
+                nIter(5), nThread(1), seed(1), jsonFile() {}
+
+    int width, height;                  // size of frame
+    int nCr;                            // number of CRs
+    int nStar;                          // number of unsaturated stars
+    int nBadColumn;                     // number of bad columns
+    int nSaturated;                     // number of saturated stars
+    int nIter;                          // number of times to time each stage
+    int nThread;                        // value of the nThreads policy entry
+    int seed;                           // seed for the frame's random numbers
+    std::string jsonFile;               // where to write the results; empty for stdout
+};
+
+Options parseArgs(int argc, char **argv) {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Option " << arg << " needs a value" << std::endl;
+            std::exit(1);
+        }
+        char const *value = argv[++i];
+        if (arg == "--width") {
+            opts.width = std::atoi(value);
+        } else if (arg == "--height") {
+            opts.height = std::atoi(value);
+        } else if (arg == "--ncr") {
+            opts.nCr = std::atoi(value);
+        } else if (arg == "--nstar") {
+            opts.nStar = std::atoi(value);
+        } else if (arg == "--nbadcol") {
+            opts.nBadColumn = std::atoi(value);
+        } else if (arg == "--nsat") {
+            opts.nSaturated = std::atoi(value);
+        } else if (arg == "--iter") {
+            opts.nIter = std::max(1, std::atoi(value));
+        } else if (arg == "--threads") {
+            opts.nThread = std::atoi(value);
+        } else if (arg == "--seed") {
+            opts.seed = std::atoi(value);
+        } else if (arg == "--json") {
+            opts.jsonFile = value;
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            std::exit(1);
+        }
+    }
+    if (opts.width < 16 || opts.height < 16) {
+        std::cerr << "The frame must be at least 16x16" << std::endl;
+        std::exit(1);
+    }
+    return opts;
+}
+
+double const bkgd = 100.0;              // sky level at the origin
+double const sigma = 10.0;              // noise in the sky
+double const fwhm = 5.0;                // FWHM of the PSF, pixels
+double const saturation = 60000.0;      // saturation level
+
+// The noiseless sky at (x, y)
+double sky(Options const& opts, int const x, int const y) {
+    return bkgd + 0.05*x*2048/opts.width + 0.02*y*2048/opts.height;
+}
+
+/*
+ * A synthetic frame, and what we put into it
+ */
+struct Frame {
+    explicit Frame(Options const& opts) :
+        image(afwGeom::Extent2I(opts.width, opts.height)),
+        truth(afwGeom::Extent2I(opts.width, opts.height)),
+        deposit(afwGeom::Extent2I(opts.width, opts.height)) {}
+
+    MaskedImageF image;                 // the frame, as findCosmicRays sees it
+    afwImage::Image<float> truth;       // the noiseless sky and stars
+    afwImage::Image<float> deposit;     // the CRs' contribution to each pixel
+};
+
+void addStar(afwImage::Image<float> &truth, double const xc, double const yc, double const flux) {
+    double const psfSigma = fwhm/(2*std::sqrt(2*std::log(2.0)));
+    int const r = static_cast<int>(6*psfSigma*(1 + std::log10(std::max(1.0, flux/1e4)))); // far enough
+    double const pi = 3.14159265358979323846;
+    double const amp = flux/(2*pi*psfSigma*psfSigma);
+    for (int y = std::max(0, int(yc) - r); y <= std::min(truth.getHeight() - 1, int(yc) + r); ++y) {
+        for (int x = std::max(0, int(xc) - r); x <= std::min(truth.getWidth() - 1, int(xc) + r); ++x) {
+            double const r2 = (x - xc)*(x - xc) + (y - yc)*(y - yc);
+            truth(x, y) += amp*std::exp(-r2/(2*psfSigma*psfSigma));
+        }
+    }
+}
+
+/*
+ * Saturate the pixels in column x above the saturation level, bleeding the excess charge up and down the
+ * column
+ */
+void bleed(MaskedImageF &mi, int const x, afwImage::MaskPixel const satBit) {
+    int const height = mi.getHeight();
+    double excess = 0;
+    int y0 = height, y1 = -1;          // range of saturated rows
+    for (int y = 0; y != height; ++y) {
+        float &pix = (*mi.getImage())(x, y);
+        if (pix > saturation) {
+            excess += pix - saturation;
+            y0 = std::min(y0, y);
+            y1 = std::max(y1, y);
+        }
+    }
+    if (y1 < 0) {
+        return;
+    }
+    int const nbleed = static_cast<int>(excess/saturation/2); // rows to bleed in each direction
+    for (int y = std::max(0, y0 - nbleed); y <= std::min(height - 1, y1 + nbleed); ++y) {
+        (*mi.getImage())(x, y) = saturation;
+        (*mi.getMask())(x, y) |= satBit;
+    }
+}
+
+Frame makeFrame(Options const& opts) {
+    Frame frame(opts);
+    int const width = opts.width, height = opts.height;
+    afwImage::MaskPixel const badBit = MaskedImageF::Mask::getPlaneBitMask("BAD");
+    afwImage::MaskPixel const satBit = MaskedImageF::Mask::getPlaneBitMask("SAT");
+
+    std::mt19937 rng(opts.seed);
+    std::uniform_real_distribution<double> xpos(0, width - 1), ypos(0, height - 1);
+    /*
+     * The noiseless sky and stars
+     */
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            frame.truth(x, y) = sky(opts, x, y);
+        }
+    }
+    std::uniform_real_distribution<double> logFlux(3, 6);
+    for (int i = 0; i != opts.nStar; ++i) {
+        addStar(frame.truth, xpos(rng), ypos(rng), std::pow(10.0, logFlux(rng)));
+    }
+    std::vector<int> saturatedColumns;
+    for (int i = 0; i != opts.nSaturated; ++i) {
+        double const xc = xpos(rng);
+        addStar(frame.truth, xc, ypos(rng), 1e8);
+        saturatedColumns.push_back(static_cast<int>(xc + 0.5));
+    }
+    /*
+     * The observed frame
+     */
+    *frame.image.getMask() = 0;
+    *frame.image.getVariance() = sigma*sigma;
+    std::normal_distribution<double> noise(0.0, sigma);
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            (*frame.image.getImage())(x, y) = frame.truth(x, y) + noise(rng);
+        }
+    }
+    /*
+     * The CRs
+     */
+    frame.deposit = 0;
+    std::uniform_int_distribution<int> xstart(2, width - 3), ystart(2, height - 3);
+    std::uniform_int_distribution<int> length(1, 12), direction(0, 3);
+    std::normal_distribution<double> amplitude(500.0, 200.0);
+    int const dxs[] = {1, 0, 1, 1}, dys[] = {0, 1, 1, -1};
+    for (int i = 0; i != opts.nCr; ++i) {
+        int const x0 = xstart(rng), y0 = ystart(rng), len = length(rng), dir = direction(rng);
+        for (int k = 0; k != len; ++k) {
+            int const x = x0 + k*dxs[dir], y = y0 + k*dys[dir];
+            if (x >= 0 && x < width && y >= 0 && y < height) {
+                double const dn = std::fabs(amplitude(rng));
+                frame.deposit(x, y) += dn;
+                (*frame.image.getImage())(x, y) += dn;
+            }
+        }
+    }
+    /*
+     * Saturation trails and bad columns
+     */
+    for (std::vector<int>::const_iterator x = saturatedColumns.begin(); x != saturatedColumns.end(); ++x) {
+        for (int dx = -2; dx <= 2; ++dx) {
+            if (*x + dx >= 0 && *x + dx < width) {
+                bleed(frame.image, *x + dx, satBit);
+            }
+        }
+    }
+    std::uniform_int_distribution<int> column(0, width - 1);
+    for (int i = 0; i != opts.nBadColumn; ++i) {
+        int const x = column(rng);
+        for (int y = 0; y != height; ++y) {
+            (*frame.image.getImage())(x, y) = 0;
+            (*frame.image.getMask())(x, y) |= badBit;
+        }
+    }
+
+    return frame;
+}
+
+/*
+ * Timing and memory use of a stage
+ */
+struct StageResult {
+    double best;                        // fastest time, seconds
+    HeapStats heap;                     // heap usage of the last run
+    algorithms::CosmicRayStats stats;   // findCosmicRays' statistics for the fastest run
+};
+
+StageResult timeStage(MaskedImageF const& in, MaskedImageF &out, std::vector<PTR(afwDet::Footprint)> &crs,
+                      lsst::pex::policy::Policy const& policy, bool keep, int nIter) {
+    double const psfSigma = fwhm/(2*std::sqrt(2*std::log(2.0)));
+    algorithms::DoubleGaussianPsf const psf(29, 29, psfSigma);
+
+    StageResult result;
+    result.best = 0;
+    for (int i = 0; i != nIter; ++i) {
+        out = MaskedImageF(in, true);
+        crs.clear();
+
+        algorithms::CosmicRayStats stats;
+        resetHeapStats();
+        auto const start = std::chrono::steady_clock::now();
+        crs = algorithms::findCosmicRays(out, psf, bkgd, policy, keep, stats);
+        double const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.heap = getHeapStats();
+
+        if (i == 0 || elapsed < result.best) {
+            result.best = elapsed;
+            result.stats = stats;
+        }
+    }
+    return result;
+}
+
+void writeStage(std::ostream &os, std::string const& name, StageResult const& stage, double npix) {
+    os << "    \"" << name << "\": {\"seconds\": " << stage.best
+       << ", \"pixelsPerSecond\": " << npix/stage.best
+       << ", \"nAlloc\": " << stage.heap.nAlloc
+       << ", \"allocBytes\": " << stage.heap.nAllocBytes
+       << ", \"peakHeapBytes\": " << stage.heap.peak << ",\n"
+       << "      \"stages\": {\"scan\": " << stage.stats.scanTime << ", \"merge\": " << stage.stats.mergeTime
+       << ", \"condition1\": " << stage.stats.condition1Time << ", \"grow\": " << stage.stats.growTime
+       << ", \"remove\": " << stage.stats.removeTime << "},\n"
+       << "      \"counts\": {\"nCandidatePixel\": " << stage.stats.nCandidatePixel
+       << ", \"nSpan\": " << stage.stats.nSpan
+       << ", \"nCrBeforeCondition1\": " << stage.stats.nCrBeforeCondition1
+       << ", \"nCrAfterCondition1\": " << stage.stats.nCrAfterCondition1 << ", \"nGrownPerIteration\": [";
+    for (std::size_t i = 0; i != stage.stats.nGrownPerIteration.size(); ++i) {
+        os << (i == 0 ? "" : ", ") << stage.stats.nGrownPerIteration[i];
+    }
+    os << "], \"nFallbackInterpolation\": " << stage.stats.nFallbackInterpolation << "}}";
+}
+}
+
+int main(int argc, char **argv) {
+    Options const opts = parseArgs(argc, argv);
+    Frame const frame = makeFrame(opts);
+
+    lsst::pex::policy::Policy policy;
+    policy.set("nCrPixelMax", 10000000);
+    policy.set("minSigma", 6.0);
+    policy.set("min_DN", 150.0);
+    policy.set("cond3_fac", 2.5);
+    policy.set("cond3_fac2", 0.6);
+    policy.set("niteration", 3);
+    policy.set("nThreads", opts.nThread);
+    /*
+     * Time the stages
+     */
+    MaskedImageF scanned(frame.image, true), cleaned(frame.image, true);
+    std::vector<PTR(afwDet::Footprint)> scannedCrs, cleanedCrs;
+    StageResult const scan = timeStage(frame.image, scanned, scannedCrs, policy, true, opts.nIter);
+    StageResult const total = timeStage(frame.image, cleaned, cleanedCrs, policy, false, opts.nIter);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    long const maxRssBytes = 1024L*usage.ru_maxrss; // ru_maxrss is in kB on linux
+    /*
+     * Score the detection
+     */
+    afwImage::MaskPixel const crBit = MaskedImageF::Mask::getPlaneBitMask("CR");
+    afwImage::MaskPixel const ignoreMask = MaskedImageF::Mask::getPlaneBitMask("BAD") |
+        MaskedImageF::Mask::getPlaneBitMask("SAT");
+    long nTrue = 0, nTrueFound = 0;     // number of detectable CR pixels, and the number masked as CR
+    long nMasked = 0;                   // number of pixels masked as CR
+    long nMaskedTrue = 0;               // number of masked pixels with a CR deposit
+    long nMaskedNear = 0;               // number of masked pixels with a CR deposit in them or a neighbour
+    long nMaskedStar = 0;               // number of masked pixels on stars, with no CR deposit nearby
+    std::vector<double> resids;         // residuals of the interpolated pixels, in units of sigma
+    double sum = 0, sum2 = 0;           // sum and sum of squares of resids
+    for (int y = 0; y != opts.height; ++y) {
+        for (int x = 0; x != opts.width; ++x) {
+            bool const masked = (*scanned.getMask())(x, y) & crBit;
+            if (frame.deposit(x, y) > 5*sigma) {
+                ++nTrue;
+                nTrueFound += masked;
+            }
+            if (masked) {
+                bool near = false;
+                for (int y2 = std::max(0, y - 1); y2 <= std::min(opts.height - 1, y + 1); ++y2) {
+                    for (int x2 = std::max(0, x - 1); x2 <= std::min(opts.width - 1, x + 1); ++x2) {
+                        near = near || (frame.deposit(x2, y2) > 0);
+                    }
+                }
+                ++nMasked;
+                nMaskedTrue += (frame.deposit(x, y) > 0);
+                nMaskedNear += near;
+                nMaskedStar += (!near && frame.truth(x, y) - sky(opts, x, y) > 5*sigma);
+            }
+
+            if (((*cleaned.getMask())(x, y) & crBit) && !((*cleaned.getMask())(x, y) & ignoreMask)) {
+                double const resid = ((*cleaned.getImage())(x, y) - frame.truth(x, y))/sigma;
+                resids.push_back(resid);
+                sum += resid;
+                sum2 += resid*resid;
+            }
+        }
+    }
+    long const nResid = resids.size();
+    long nResid3 = 0;                   // number of resids within 3 sigma of the truth
+    for (std::vector<double>::const_iterator ptr = resids.begin(); ptr != resids.end(); ++ptr) {
+        nResid3 += (std::fabs(*ptr) < 3);
+    }
+    std::nth_element(resids.begin(), resids.begin() + nResid/2, resids.end());
+    double const medianResid = (nResid == 0) ? 0.0 : resids[nResid/2];
+    double const npix = static_cast<double>(opts.width)*opts.height;
+    /*
+     * And write the results
+     */
+    std::ostringstream os;
+    os << "{\n"
+       << "  \"frame\": {\"width\": " << opts.width << ", \"height\": " << opts.height
+       << ", \"nCr\": " << opts.nCr << ", \"nStar\": " << opts.nStar << ", \"nBadColumn\": " << opts.nBadColumn
+       << ", \"nSaturated\": " << opts.nSaturated << ", \"seed\": " << opts.seed << "},\n"
+       << "  \"nThreads\": " << opts.nThread << ",\n"
+       << "  \"nIter\": " << opts.nIter << ",\n"
+       << "  \"timing\": {\n";
+    writeStage(os, "scan", scan, npix);
+    os << ",\n";
+    writeStage(os, "total", total, npix);
+    os << ",\n"
+       << "    \"removal\": {\"seconds\": " << std::max(0.0, total.best - scan.best) << "}\n"
+       << "  },\n"
+       << "  \"maxRssBytes\": " << maxRssBytes << ",\n"
+       << "  \"detection\": {\"nCr\": " << scannedCrs.size() << ", \"nMasked\": " << nMasked
+       << ", \"nTrue\": " << nTrue
+       << ", \"completeness\": " << (nTrue == 0 ? 1.0 : double(nTrueFound)/nTrue)
+       << ", \"strictPurity\": " << (nMasked == 0 ? 1.0 : double(nMaskedTrue)/nMasked)
+       << ", \"purity\": " << (nMasked == 0 ? 1.0 : double(nMaskedNear)/nMasked)
+       << ", \"nStarPixelsMasked\": " << nMaskedStar << "},\n"
+       << "  \"removal\": {\"nPixel\": " << nResid
+       << ", \"medianResid\": " << medianResid
+       << ", \"meanResid\": " << (nResid == 0 ? 0.0 : sum/nResid)
+       << ", \"rmsResid\": " << (nResid == 0 ? 0.0 : std::sqrt(sum2/nResid))
+       << ", \"fractionWithin3Sigma\": " << (nResid == 0 ? 1.0 : double(nResid3)/nResid) << "}\n"
+       << "}\n";
+
+    if (opts.jsonFile.empty()) {
+        std::cout << os.str();
+    } else {
+        std::ofstream out(opts.jsonFile.c_str());
+        out << os.str();
+    }
+
+    return 0;
+}
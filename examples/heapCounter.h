@@ -0,0 +1,166 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Count the heap allocations made by the benchmarks, by replacing the global operator new and delete.
+ * Each block carries its size in a header, so that we can track the number of bytes in use.
+ *
+ * Every form of new and delete is replaced, not just the plain ones:  the library's own nothrow and
+ * aligned forms are free to call malloc directly, and a block that they allocate mustn't be passed to
+ * a delete that expects a header (or vice versa).
+ *
+ * This file defines the replacements, so include it in exactly one file of each program
+ */
+#ifndef LSST_MEAS_ALGORITHMS_EXAMPLES_heapCounter_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_EXAMPLES_heapCounter_h_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace heapCounter {
+namespace {
+std::atomic<long> nAlloc(0);            // number of allocations
+std::atomic<long> nAllocBytes(0);       // number of bytes allocated
+std::atomic<long> heapBytes(0);         // number of bytes currently allocated
+std::atomic<long> heapPeak(0);          // the largest value of heapBytes since resetHeapStats
+
+std::size_t const headerSize = 16;      // keeps the blocks suitably aligned
+
+/*
+ * Return a block of size bytes aligned to alignment (a power of 2), or NULL if there's no memory.  The
+ * block's size is stored in the word before it, and the memory that malloc gave us starts
+ * max(alignment, headerSize) bytes before that
+ */
+void *countedAlloc(std::size_t size, std::size_t alignment=headerSize) {
+    std::size_t const offset = std::max(alignment, headerSize);
+    void *block = NULL;
+    if (alignment <= headerSize) {
+        block = std::malloc(size + offset);
+    } else if (posix_memalign(&block, alignment, size + offset) != 0) {
+        block = NULL;
+    }
+    if (!block) {
+        return NULL;
+    }
+    void *ptr = static_cast<char *>(block) + offset;
+    static_cast<std::size_t *>(ptr)[-1] = size;
+
+    ++nAlloc;
+    nAllocBytes += size;
+    long const inUse = (heapBytes += size);
+    for (long peak = heapPeak; inUse > peak && !heapPeak.compare_exchange_weak(peak, inUse); ) {
+        ;
+    }
+    return ptr;
+}
+
+void *countedAllocOrThrow(std::size_t size, std::size_t alignment=headerSize) {
+    void *ptr = countedAlloc(size, alignment);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+/// Free a block returned by countedAlloc(size, alignment)
+void countedFree(void *ptr, std::size_t alignment=headerSize) {
+    if (ptr) {
+        heapBytes -= static_cast<std::size_t *>(ptr)[-1];
+        std::free(static_cast<char *>(ptr) - std::max(alignment, headerSize));
+    }
+}
+
+struct HeapStats {
+    long nAlloc, nAllocBytes, peak;     // allocations, bytes allocated, and peak usage above the start
+};
+
+long heapStart = 0;                     // heapBytes when resetHeapStats was called
+
+void resetHeapStats() {
+    nAlloc = 0;
+    nAllocBytes = 0;
+    heapStart = heapBytes;
+    heapPeak = heapStart;
+}
+
+HeapStats getHeapStats() {
+    HeapStats const stats = {nAlloc, nAllocBytes, heapPeak - heapStart};
+    return stats;
+}
+}} // namespace heapCounter::<anonymous>
+
+void *operator new(std::size_t size) { return heapCounter::countedAllocOrThrow(size); }
+void *operator new[](std::size_t size) { return heapCounter::countedAllocOrThrow(size); }
+void *operator new(std::size_t size, std::nothrow_t const&) noexcept {
+    return heapCounter::countedAlloc(size);
+}
+void *operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+    return heapCounter::countedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept { heapCounter::countedFree(ptr); }
+void operator delete[](void *ptr) noexcept { heapCounter::countedFree(ptr); }
+void operator delete(void *ptr, std::nothrow_t const&) noexcept { heapCounter::countedFree(ptr); }
+void operator delete[](void *ptr, std::nothrow_t const&) noexcept { heapCounter::countedFree(ptr); }
+#if defined(__cpp_sized_deallocation)
+void operator delete(void *ptr, std::size_t) noexcept { heapCounter::countedFree(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { heapCounter::countedFree(ptr); }
+#endif
+
+#if defined(__cpp_aligned_new)
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return heapCounter::countedAllocOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return heapCounter::countedAllocOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void *operator new(std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept {
+    return heapCounter::countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept {
+    return heapCounter::countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr, std::align_val_t alignment) noexcept {
+    heapCounter::countedFree(ptr, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void *ptr, std::align_val_t alignment) noexcept {
+    heapCounter::countedFree(ptr, static_cast<std::size_t>(alignment));
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t alignment) noexcept {
+    heapCounter::countedFree(ptr, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void *ptr, std::size_t, std::align_val_t alignment) noexcept {
+    heapCounter::countedFree(ptr, static_cast<std::size_t>(alignment));
+}
+void operator delete(void *ptr, std::align_val_t alignment, std::nothrow_t const&) noexcept {
+    heapCounter::countedFree(ptr, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void *ptr, std::align_val_t alignment, std::nothrow_t const&) noexcept {
+    heapCounter::countedFree(ptr, static_cast<std::size_t>(alignment));
+}
+#endif
+
+#endif
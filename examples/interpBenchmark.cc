@@ -0,0 +1,396 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Measure how fast interpolateOverDefects is on synthetic defect maps, on both float and double
+ * MaskedImages.
+ *
+ * Usage:
+ *    interpBenchmark [--width N] [--height N] [--iter N] [--threads N] [--seed N] [--config name]
+ *                    [--json file]
+ *
+ * The defect maps ("configurations") are:
+ *   - "isolated":  isolated bad pixels
+ *   - "columns":   bad columns, 1-3 pixels wide and running the full height of the frame
+ *   - "blocks":    wide blocks, 15-60 pixels across
+ *   - "edges":     bands of defects at and near the left and right edges of the frame, and in the middle,
+ *                  both narrow and wide, so that every DefectPosition is used
+ *   - "mixed":     all of the above
+ * (--config selects just one of them).
+ *
+ * For each configuration and pixel type we time (the best of --iter runs):
+ *   - "defects":    interpolateOverDefects given the list of Defects, i.e. classification and interpolation
+ *   - "plan":       building a DefectPlan from the Defects, i.e. just the classification
+ *   - "apply":      interpolateOverDefects given the DefectPlan, i.e. just the interpolation
+ *   - "psf":        as "apply", but interpolating over wide defects using the PSF
+ *   - "columns":    as "apply", but for the transposed frame and defects, interpolated along columns; this
+ *                   does the same arithmetic as "apply", so should take about as long
+ *   - "maskPlane":  interpolateOverMaskPlane, with the defects' pixels set in the mask
+ * and report the frame's rows processed per second, the rows (and columns) that contain defects per
+ * second, and the number and size of the heap allocations made.  The results are written as JSON (to
+ * stdout unless --json is given).
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/DefectPlan.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+#include "lsst/meas/algorithms/Interp.h"
+
+#include "heapCounter.h"
+
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+typedef std::vector<algorithms::Defect::Ptr> DefectList;
+
+/************************************************************************************************************/
+/*
+ * Count the heap allocations (see heapCounter.h)
+ */
+using heapCounter::HeapStats;
+using heapCounter::getHeapStats;
+using heapCounter::resetHeapStats;
+
+/************************************************************************************************************/
+
+namespace {
+struct Options {
+    Options() : width(4096), height(4096), nIter(5), nThread(1), seed(1), config(), jsonFile() {}
+
+    int width, height;                  // size of frame
+    int nIter;                          // number of times to time each stage
+    int nThread;                        // number of threads to use
+    int seed;                           // seed for the defects' positions and the pixels' noise
+    std::string config;                 // the only configuration to run; empty for all
+    std::string jsonFile;               // where to write the results; empty for stdout
+};
+
+char const *const configNames[] = {"isolated", "columns", "blocks", "edges", "mixed"};
+int const nConfig = sizeof(configNames)/sizeof(configNames[0]);
+
+Options parseArgs(int argc, char **argv) {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Option " << arg << " needs a value" << std::endl;
+            std::exit(1);
+        }
+        char const *value = argv[++i];
+        if (arg == "--width") {
+            opts.width = std::atoi(value);
+        } else if (arg == "--height") {
+            opts.height = std::atoi(value);
+        } else if (arg == "--iter") {
+            opts.nIter = std::max(1, std::atoi(value));
+        } else if (arg == "--threads") {
+            opts.nThread = std::atoi(value);
+        } else if (arg == "--seed") {
+            opts.seed = std::atoi(value);
+        } else if (arg == "--config") {
+            opts.config = value;
+            if (std::find(configNames, configNames + nConfig, opts.config) == configNames + nConfig) {
+                std::cerr << "Unknown configuration " << opts.config << std::endl;
+                std::exit(1);
+            }
+        } else if (arg == "--json") {
+            opts.jsonFile = value;
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            std::exit(1);
+        }
+    }
+    if (opts.width < 256 || opts.height < 256) {
+        std::cerr << "The frame must be at least 256x256" << std::endl;
+        std::exit(1);
+    }
+    return opts;
+}
+
+double const bkgd = 1000.0;             // sky level
+double const sigma = 30.0;              // noise in the sky
+
+void addDefect(DefectList &defects, int const x0, int const y0, int const width, int const height) {
+    defects.push_back(algorithms::Defect::Ptr(new algorithms::Defect(
+        afwGeom::Box2I(afwGeom::Point2I(x0, y0), afwGeom::Extent2I(width, height)))));
+}
+
+/*
+ * Generate the defects for a configuration
+ */
+DefectList makeDefects(Options const& opts, std::string const& config) {
+    int const width = opts.width, height = opts.height;
+    std::mt19937 rng(opts.seed);
+    std::uniform_int_distribution<int> xpos(0, width - 1), ypos(0, height - 1);
+
+    DefectList defects;
+    if (config == "isolated" || config == "mixed") {
+        int const nPixel = width*height/2000;
+        for (int i = 0; i != nPixel; ++i) {
+            addDefect(defects, xpos(rng), ypos(rng), 1, 1);
+        }
+    }
+    if (config == "columns" || config == "mixed") {
+        std::uniform_int_distribution<int> columnWidth(1, 3);
+        for (int i = 0; i != 50; ++i) {
+            addDefect(defects, xpos(rng), 0, columnWidth(rng), height);
+        }
+    }
+    if (config == "blocks" || config == "mixed") {
+        std::uniform_int_distribution<int> blockWidth(15, 60), blockHeight(20, 200);
+        for (int i = 0; i != 100; ++i) {
+            int const w = blockWidth(rng), h = blockHeight(rng);
+            addDefect(defects, std::min(xpos(rng), width - w), std::min(ypos(rng), height - h), w, h);
+        }
+    }
+    if (config == "edges" || config == "mixed") {
+        /*
+         * Bands of rows, each containing a narrow and a wide defect at each of LEFT, NEAR_LEFT, NEAR_RIGHT,
+         * and RIGHT, and a narrow and a wide one in the middle
+         */
+        int const bandHeight = 40;
+        for (int y0 = 0; y0 + 2*bandHeight <= height; y0 += 2*bandHeight) {
+            int const narrow = 1 + (y0/(2*bandHeight))%4;         // cycle through the narrow widths
+            int const wide = algorithms::Defect::WIDE_DEFECT + (y0/(2*bandHeight))%20;
+
+            addDefect(defects, 0, y0, narrow, bandHeight/2);                   // LEFT
+            addDefect(defects, 0, y0 + bandHeight/2, wide, bandHeight/2);      // WIDE_LEFT
+            addDefect(defects, width - narrow, y0, narrow, bandHeight/2);      // RIGHT
+            addDefect(defects, width - wide, y0 + bandHeight/2, wide, bandHeight/2); // WIDE_RIGHT
+            addDefect(defects, width/3, y0, narrow, bandHeight);               // MIDDLE
+            addDefect(defects, 2*width/3, y0, wide, bandHeight);               // WIDE
+
+            int const y1 = y0 + bandHeight;
+            addDefect(defects, 1, y1, narrow, bandHeight/2);                   // NEAR_LEFT
+            addDefect(defects, 1, y1 + bandHeight/2, wide, bandHeight/2);      // WIDE_NEAR_LEFT
+            addDefect(defects, width - narrow - 1, y1, narrow, bandHeight/2);  // NEAR_RIGHT
+            addDefect(defects, width - wide - 1, y1 + bandHeight/2, wide, bandHeight/2); // WIDE_NEAR_RIGHT
+        }
+    }
+
+    return defects;
+}
+
+/*
+ * Swap the defects' x and y axes
+ */
+DefectList transposeDefects(DefectList const& defects) {
+    DefectList transposed;
+    for (DefectList::const_iterator ptr = defects.begin(); ptr != defects.end(); ++ptr) {
+        addDefect(transposed, (*ptr)->getY0(), (*ptr)->getX0(),
+                  (*ptr)->getBBox().getHeight(), (*ptr)->getBBox().getWidth());
+    }
+    return transposed;
+}
+
+/*
+ * A noisy flat frame, with the defects' pixels set in its mask's BAD plane
+ */
+template <typename PixelT>
+afwImage::MaskedImage<PixelT> makeFrame(Options const& opts, DefectList const& defects) {
+    afwImage::MaskedImage<PixelT> mi(afwGeom::Extent2I(opts.width, opts.height));
+    afwImage::MaskPixel const badBit = afwImage::MaskedImage<PixelT>::Mask::getPlaneBitMask("BAD");
+
+    std::mt19937 rng(opts.seed);
+    std::normal_distribution<double> noise(bkgd, sigma);
+    for (int y = 0; y != opts.height; ++y) {
+        for (int x = 0; x != opts.width; ++x) {
+            (*mi.getImage())(x, y) = noise(rng);
+        }
+    }
+    *mi.getMask() = 0;
+    *mi.getVariance() = sigma*sigma;
+
+    afwGeom::Box2I const bbox = mi.getBBox(afwImage::PARENT);
+    for (DefectList::const_iterator ptr = defects.begin(); ptr != defects.end(); ++ptr) {
+        afwGeom::Box2I box = (*ptr)->getBBox();
+        box.clip(bbox);
+        for (int y = box.getMinY(); y <= box.getMaxY(); ++y) {
+            for (int x = box.getMinX(); x <= box.getMaxX(); ++x) {
+                (*mi.getMask())(x, y) |= badBit;
+            }
+        }
+    }
+
+    return mi;
+}
+
+/*
+ * Timing and memory use of a stage
+ */
+struct StageResult {
+    double best;                        // fastest time, seconds
+    HeapStats heap;                     // heap usage of the last run
+};
+
+/*
+ * Time run, which works on out, nIter times;  out is reset from in before each (untimed)
+ */
+template <typename MaskedImageT>
+StageResult timeStage(MaskedImageT const& in, MaskedImageT &out, std::function<void()> const& run,
+                      int nIter) {
+    StageResult result;
+    result.best = 0;
+    for (int i = 0; i != nIter; ++i) {
+        out <<= in;
+
+        resetHeapStats();
+        auto const start = std::chrono::steady_clock::now();
+        run();
+        double const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.heap = getHeapStats();
+
+        if (i == 0 || elapsed < result.best) {
+            result.best = elapsed;
+        }
+    }
+    return result;
+}
+
+void writeStage(std::ostream &os, std::string const& name, StageResult const& stage,
+                int nRow, long nDefectRow, bool last=false) {
+    os << "        \"" << name << "\": {\"seconds\": " << stage.best
+       << ", \"rowsPerSecond\": " << nRow/stage.best
+       << ", \"defectRowsPerSecond\": " << nDefectRow/stage.best
+       << ", \"nAlloc\": " << stage.heap.nAlloc
+       << ", \"allocBytes\": " << stage.heap.nAllocBytes << "}" << (last ? "\n" : ",\n");
+}
+
+/*
+ * Time all the stages for one configuration and pixel type
+ */
+template <typename PixelT>
+void runConfig(std::ostream &os, Options const& opts, DefectList &defects, algorithms::DefectPlan const& plan,
+               algorithms::DoubleGaussianPsf const& psf) {
+    typedef afwImage::MaskedImage<PixelT> MaskedImageT;
+    MaskedImageT const in = makeFrame<PixelT>(opts, defects);
+    MaskedImageT out(in, true);
+    afwImage::MaskPixel const badBit = MaskedImageT::Mask::getPlaneBitMask("BAD");
+    int const nThread = opts.nThread;
+
+    long nDefectRow = 0;                // number of rows and columns that contain defects
+    for (int pass = 0; pass != 2; ++pass) {
+        std::vector<algorithms::DefectPlan::Run> const& runs = (pass == 0) ? plan.getRowRuns() :
+                                                                              plan.getColumnRuns();
+        for (std::vector<algorithms::DefectPlan::Run>::const_iterator run = runs.begin();
+             run != runs.end(); ++run) {
+            nDefectRow += run->y1 - run->y0;
+        }
+    }
+
+    StageResult const full = timeStage(in, out, [&]() {
+            algorithms::interpolateOverDefects(out, psf, defects, 0.0, false, nThread);
+        }, opts.nIter);
+    StageResult const planning = timeStage(in, out, [&]() {
+            algorithms::DefectPlan const planned(out.getBBox(afwImage::PARENT), defects);
+        }, opts.nIter);
+    StageResult const apply = timeStage(in, out, [&]() {
+            algorithms::interpolateOverDefects(out, plan, 0.0, nThread);
+        }, opts.nIter);
+    StageResult const withPsf = timeStage(in, out, [&]() {
+            algorithms::interpolateOverDefects(out, plan, 0.0, nThread, &psf);
+        }, opts.nIter);
+    StageResult const maskPlane = timeStage(in, out, [&]() {
+            algorithms::interpolateOverMaskPlane(out, badBit, 0.0, false, nThread);
+        }, opts.nIter);
+
+    Options transposedOpts = opts;
+    std::swap(transposedOpts.width, transposedOpts.height);
+    DefectList const transposedDefects = transposeDefects(defects);
+    MaskedImageT const transposedIn = makeFrame<PixelT>(transposedOpts, transposedDefects);
+    MaskedImageT transposedOut(transposedIn, true);
+    algorithms::DefectPlan const columnPlan(transposedIn.getBBox(afwImage::PARENT), transposedDefects, false,
+                                            algorithms::INTERP_COLUMNS);
+    StageResult const alongColumns = timeStage(transposedIn, transposedOut, [&]() {
+            algorithms::interpolateOverDefects(transposedOut, columnPlan, 0.0, nThread);
+        }, opts.nIter);
+
+    writeStage(os, "defects", full, opts.height, nDefectRow);
+    writeStage(os, "plan", planning, opts.height, nDefectRow);
+    writeStage(os, "apply", apply, opts.height, nDefectRow);
+    writeStage(os, "psf", withPsf, opts.height, nDefectRow);
+    writeStage(os, "columns", alongColumns, opts.height, nDefectRow);
+    writeStage(os, "maskPlane", maskPlane, opts.height, nDefectRow, true);
+}
+}
+
+int main(int argc, char **argv) {
+    Options const opts = parseArgs(argc, argv);
+    algorithms::DoubleGaussianPsf const psf(21, 21, 2.0);
+
+    std::ostringstream os;
+    os << "{\n"
+       << "  \"frame\": {\"width\": " << opts.width << ", \"height\": " << opts.height
+       << ", \"seed\": " << opts.seed << "},\n"
+       << "  \"nThreads\": " << opts.nThread << ",\n"
+       << "  \"nIter\": " << opts.nIter << ",\n"
+       << "  \"configs\": {\n";
+    bool first = true;
+    for (int i = 0; i != nConfig; ++i) {
+        std::string const config = configNames[i];
+        if (!opts.config.empty() && config != opts.config) {
+            continue;
+        }
+        DefectList defects = makeDefects(opts, config);
+        afwGeom::Box2I const bbox(afwGeom::Point2I(0, 0), afwGeom::Extent2I(opts.width, opts.height));
+        algorithms::DefectPlan const plan(bbox, defects);
+
+        os << (first ? "" : ",\n")
+           << "    \"" << config << "\": {\n"
+           << "      \"nDefect\": " << defects.size() << ", \"nSegment\": " << plan.getSegments().size()
+           << ",\n"
+           << "      \"float\": {\n";
+        runConfig<float>(os, opts, defects, plan, psf);
+        os << "      },\n"
+           << "      \"double\": {\n";
+        runConfig<double>(os, opts, defects, plan, psf);
+        os << "      }\n"
+           << "    }";
+        first = false;
+    }
+    os << "\n  }\n"
+       << "}\n";
+
+    if (opts.jsonFile.empty()) {
+        std::cout << os.str();
+    } else {
+        std::ofstream out(opts.jsonFile.c_str());
+        out << os.str();
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Time findCosmicRays, and see how well it restores the pixels under the CRs
+ *
+ * Usage:
+ *    removeCrBenchmark [nIter]                      Use a synthetic frame whose true sky is known
+ *    removeCrBenchmark nIter file.fits [bkgd]       Use a real (CR-hit) frame
+ *
+ * For a real frame the background defaults to the median pixel value, and we report how far the
+ * interpolated pixels lie from that background (in units of the noise) rather than from the truth.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lsst/pex/policy/Policy.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+namespace afwDet = lsst::afw::detection;
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+typedef afwImage::MaskedImage<float> MaskedImageF;
+
+namespace {
+/*
+ * A sloping sky with noise and straight CR tracks; the noiseless sky is returned in truth
+ */
+MaskedImageF makeFrame(afwImage::Image<float> &truth, double bkgd, double sigma, int nCr) {
+    int const width = truth.getWidth(), height = truth.getHeight();
+    MaskedImageF mi(afwGeom::Extent2I(width, height));
+    *mi.getMask() = 0;
+    *mi.getVariance() = sigma*sigma;
+
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, sigma);
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            truth(x, y) = bkgd + 0.05*x + 0.02*y;
+            (*mi.getImage())(x, y) = truth(x, y) + noise(rng);
+        }
+    }
+
+    std::uniform_int_distribution<int> xpos(2, width - 3), ypos(2, height - 3);
+    std::uniform_int_distribution<int> length(1, 12), direction(0, 3);
+    std::normal_distribution<double> amplitude(500.0, 200.0);
+    int const dxs[] = {1, 0, 1, 1}, dys[] = {0, 1, 1, -1};
+    for (int i = 0; i != nCr; ++i) {
+        int const x0 = xpos(rng), y0 = ypos(rng), len = length(rng), dir = direction(rng);
+        for (int k = 0; k != len; ++k) {
+            int const x = x0 + k*dxs[dir], y = y0 + k*dys[dir];
+            if (x >= 0 && x < width && y >= 0 && y < height) {
+                (*mi.getImage())(x, y) += std::fabs(amplitude(rng));
+            }
+        }
+    }
+
+    return mi;
+}
+
+double median(MaskedImageF const& mi) {
+    std::vector<float> values;
+    values.reserve(mi.getWidth()*mi.getHeight());
+    for (int y = 0; y != mi.getHeight(); ++y) {
+        for (int x = 0; x != mi.getWidth(); ++x) {
+            values.push_back((*mi.getImage())(x, y));
+        }
+    }
+    std::nth_element(values.begin(), values.begin() + values.size()/2, values.end());
+    return values[values.size()/2];
+}
+}
+
+int main(int argc, char **argv) {
+    int const nIter = (argc > 1) ? std::atoi(argv[1]) : 5;
+    std::string const fileName = (argc > 2) ? argv[2] : "";
+    double const sigma = 10.0;          // noise in the synthetic frame
+
+    afwImage::Image<float> truth(afwGeom::Extent2I(2048, 2048));
+    MaskedImageF const frame = fileName.empty() ? makeFrame(truth, 100.0, sigma, 5000) : MaskedImageF(fileName);
+    double const bkgd = (argc > 3) ? std::atof(argv[3]) : (fileName.empty() ? 100.0 : median(frame));
+
+    double const fwhm = 5;              // pixels
+    algorithms::DoubleGaussianPsf const psf(29, 29, fwhm/(2*std::sqrt(2*std::log(2.0))));
+
+    lsst::pex::policy::Policy policy;
+    policy.set("nCrPixelMax", 1000000);
+    policy.set("minSigma", 6.0);
+    policy.set("min_DN", 150.0);
+    policy.set("cond3_fac", 2.5);
+    policy.set("cond3_fac2", 0.6);
+    policy.set("niteration", 3);
+
+    double best = 0;                    // fastest time, in seconds
+    MaskedImageF mi(frame, true);
+    std::vector<PTR(afwDet::Footprint)> crs;
+    for (int i = 0; i != nIter; ++i) {
+        mi = MaskedImageF(frame, true);
+
+        auto const start = std::chrono::steady_clock::now();
+        crs = algorithms::findCosmicRays(mi, psf, bkgd, policy);
+        double const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (i == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    /*
+     * How good are the interpolated values?
+     */
+    afwImage::MaskPixel const crBit = MaskedImageF::Mask::getPlaneBitMask("CR");
+    int nPix = 0;                       // number of CR pixels
+    double sum = 0, sum2 = 0;           // sum and sum of squares of the residuals, in units of sigma
+    for (int y = 0; y != mi.getHeight(); ++y) {
+        for (int x = 0; x != mi.getWidth(); ++x) {
+            if (!((*mi.getMask())(x, y) & crBit)) {
+                continue;
+            }
+            double const expected = fileName.empty() ? truth(x, y) : bkgd;
+            double const resid = ((*mi.getImage())(x, y) - expected)/std::sqrt((*mi.getVariance())(x, y));
+            ++nPix;
+            sum += resid;
+            sum2 += resid*resid;
+        }
+    }
+    double const mean = (nPix == 0) ? 0 : sum/nPix;
+    double const rms = (nPix == 0) ? 0 : std::sqrt(sum2/nPix);
+
+    std::cout << (fileName.empty() ? "synthetic" : fileName) << ": "
+              << mi.getWidth() << "x" << mi.getHeight() << " pixels, "
+              << crs.size() << " CRs covering " << nPix << " pixels" << std::endl;
+    std::cout << "Best of " << nIter << ": " << 1e3*best << " ms;  residuals under CRs (sigma): mean "
+              << mean << " rms " << rms << (fileName.empty() ? " (relative to truth)" : " (relative to bkgd)")
+              << std::endl;
+
+    return 0;
+}
@@ -22,6 +22,7 @@
  
 #include "lsst/meas/algorithms/CR.h"
 #include "lsst/meas/algorithms/Interp.h"
+#include "lsst/meas/algorithms/DefectPlan.h"
 #include "lsst/meas/algorithms/PSF.h"
 #include "lsst/meas/algorithms/PsfCandidate.h"
 #include "lsst/meas/algorithms/SpatialModelPsf.h"
@@ -27,20 +27,68 @@
 //!
 // Handle cosmic rays in a MaskedImage
 //
+#include <functional>
+#include <string>
 #include <vector>
 #include "lsst/base.h"
+#include "lsst/pex/exceptions.h"
 #include "lsst/afw/image/MaskedImage.h"
 
-namespace lsst { namespace afw {
+namespace lsst {
+namespace afw {
 namespace detection {
     class Footprint;
     class Psf;
+}}
+namespace afw { namespace math {
+    class BoundedField;
+}}
+namespace daf { namespace base {
+    class PropertySet;
 }}}
 
 namespace lsst {
 namespace meas {
 namespace algorithms {
 
+/// An exception that indicates that an image has more than the Policy's nCrPixelMax CR pixels
+LSST_EXCEPTION_TYPE(TooManyCrPixelsError, lsst::pex::exceptions::LengthError,
+                    lsst::meas::algorithms::TooManyCrPixelsError);
+
+/**
+ * Where findCosmicRays spent its time, and what it found along the way
+ *
+ * The times are wall-clock seconds.  If the library was built with LSST_MEAS_ALGORITHMS_CR_STATS defined
+ * to 0 the instrumentation is compiled out, and everything is left at zero.
+ */
+struct CosmicRayStats {
+    CosmicRayStats() : scanTime(0), mergeTime(0), condition1Time(0), growTime(0), removeTime(0), totalTime(0),
+                       nCandidatePixel(0), nSpan(0), nCrBeforeCondition1(0), nCrAfterCondition1(0),
+                       nGrownPerIteration(), nFallbackInterpolation(0) {}
+
+    double scanTime;                    ///< finding the candidate CR pixels
+    double mergeTime;                   ///< merging the candidate pixels into CRs
+    double condition1Time;              ///< rejecting CRs with too little flux (condition #1)
+    double growTime;                    ///< looking for contaminated pixels around the CRs
+    double removeTime;                  ///< interpolating over the CRs (both passes)
+    double totalTime;                   ///< the whole search (all of the above, and a little more)
+
+    int nCandidatePixel;                ///< number of candidate CR pixels found by the scan
+    int nSpan;                          ///< number of spans that they make up
+    int nCrBeforeCondition1;            ///< number of CRs before condition #1
+    int nCrAfterCondition1;             ///< number of CRs after condition #1
+    std::vector<int> nGrownPerIteration; ///< number of pixels added in each iteration of growing the CRs
+    int nFallbackInterpolation;         ///< number of pixels with no usable estimate from their neighbours,
+                                        ///< which were interpolated with interp::singlePixel or guessed
+
+    /// Set this object's values in metadata, each with the given prefix (e.g. "cr.scanTime")
+    void setMetadata(lsst::daf::base::PropertySet &metadata, std::string const& prefix = "cr.") const;
+};
+
+/*
+ * N.b. it's safe to call findCosmicRays (and findCosmicRaysStreaming) on different images from different
+ * threads at the same time
+ */
 template <typename MaskedImageT>
 std::vector<std::shared_ptr<lsst::afw::detection::Footprint> >
 findCosmicRays(MaskedImageT& image,
@@ -50,6 +98,101 @@ findCosmicRays(MaskedImageT& image,
                bool const keep = false
               );
 
+/*
+ * As above, but also reporting where the time went in stats
+ */
+template <typename MaskedImageT>
+std::vector<std::shared_ptr<lsst::afw::detection::Footprint> >
+findCosmicRays(MaskedImageT& image,
+               lsst::afw::detection::Psf const &psf,
+               double const bkgd,
+               lsst::pex::policy::Policy const& policy,
+               bool const keep,
+               CosmicRayStats &stats
+              );
+
+/*
+ * As the first findCosmicRays, but with a background that varies over the image (evaluated in the
+ * image's parent frame)
+ */
+template <typename MaskedImageT>
+std::vector<std::shared_ptr<lsst::afw::detection::Footprint> >
+findCosmicRays(MaskedImageT& image,
+               lsst::afw::detection::Psf const &psf,
+               lsst::afw::math::BoundedField const& bkgd,
+               lsst::pex::policy::Policy const& policy,
+               bool const keep = false
+              );
+
+/*
+ * As above, but using the caller's standard deviation (the sqrt of the variance) of each pixel
+ */
+template <typename MaskedImageT>
+std::vector<std::shared_ptr<lsst::afw::detection::Footprint> >
+findCosmicRays(MaskedImageT& image,
+               lsst::afw::image::Image<float> const& sigma,
+               lsst::afw::detection::Psf const &psf,
+               double const bkgd,
+               lsst::pex::policy::Policy const& policy,
+               bool const keep = false
+              );
+
+/**
+ * A source of rows for findCosmicRaysStreaming, e.g. an image that's being read from disk a band at a time
+ *
+ * The rows are read in order, from the bottom of the image to the top, and each is handed back to writeRows
+ * (with its CRs removed and masked) exactly once when findCosmicRaysStreaming has finished with it; the
+ * rows are also written in order.
+ */
+template <typename MaskedImageT>
+class CosmicRayRowSource {
+public:
+    virtual ~CosmicRayRowSource() {}
+    /// Return the bounding box (in the parent frame) of the whole image
+    virtual lsst::afw::geom::Box2I getBBox() const = 0;
+    /// Return rows [y0, y0 + nrow) of the image; y0 is in the parent frame
+    virtual std::shared_ptr<MaskedImageT> readRows(int y0, int nrow) = 0;
+    /// Accept some processed rows; their bounding box says which rows they are
+    virtual void writeRows(MaskedImageT const& rows) = 0;
+};
+
+template <typename MaskedImageT>
+void
+findCosmicRaysStreaming(CosmicRayRowSource<MaskedImageT> &source,
+                        lsst::afw::detection::Psf const &psf,
+                        double const bkgd,
+                        lsst::pex::policy::Policy const& policy,
+                        std::function<void (std::shared_ptr<lsst::afw::detection::Footprint>)> const& callback,
+                        bool const keep = false
+                       );
+
+/**
+ * The outcome of processing one of the images passed to findCosmicRaysBatch
+ */
+struct CosmicRayBatchResult {
+    enum Status {
+        OK,                             ///< the image was processed successfully
+        TOO_MANY_CRS,                   ///< the image had more than nCrPixelMax CR pixels
+        FAILED                          ///< something else went wrong; see message
+    };
+
+    CosmicRayBatchResult() : status(OK), message(), crs(), stats() {}
+
+    Status status;                      ///< how did we get on?
+    std::string message;                ///< what went wrong, if status != OK
+    std::vector<std::shared_ptr<lsst::afw::detection::Footprint> > crs; ///< the CRs we found
+    CosmicRayStats stats;               ///< where the time went
+};
+
+template <typename MaskedImageT>
+std::vector<CosmicRayBatchResult>
+findCosmicRaysBatch(std::vector<std::shared_ptr<MaskedImageT> > const& images,
+                    std::vector<std::shared_ptr<lsst::afw::detection::Psf const> > const& psfs,
+                    std::vector<double> const& bkgds,
+                    lsst::pex::policy::Policy const& policy,
+                    bool const keep = false
+                   );
+
 }}}
 
 #endif
@@ -150,6 +150,16 @@ public:
      */
     virtual bool isPersistable() const { return true; }
 
+    /**
+     *  @brief Return the components that contain a point within their validPolygons
+     *
+     *  The result is the same as the input catalog's subsetContaining(ccdXY, coaddWcs, true), but the
+     *  components are looked up in an index rather than each being tested in turn.
+     *
+     *  @param[in]   ccdXY       Position in the coadd's pixel coordinates.
+     */
+    afw::table::ExposureCatalog subsetContaining(afw::geom::Point2D const & ccdXY) const;
+
     // Factory used to read CoaddPsf from an InputArchive; defined only in the source file.
     class Factory;
 
@@ -185,8 +195,12 @@ protected:
 
 private:
 
+    // Spatial index of the inputs in coadd pixel coordinates; defined only in the source file.
+    class Index;
+
     afw::table::ExposureCatalog _catalog;
     CONST_PTR(afw::image::Wcs) _coaddWcs;
+    CONST_PTR(Index) _index;
     afw::table::Key<double> _weightKey;
     afw::geom::Point2D _averagePosition;
     std::string _warpingKernelName;   // could be removed if we could get this from _warpingControl (#2949)
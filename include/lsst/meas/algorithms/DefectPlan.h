@@ -0,0 +1,128 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_DefectPlan_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_DefectPlan_h_INCLUDED
+
+#include <vector>
+
+#include "lsst/afw/geom/Box.h"
+#include "lsst/afw/table/io/Persistable.h"
+#include "lsst/meas/algorithms/Interp.h"
+
+namespace lsst { namespace meas { namespace algorithms {
+
+/**
+ * @brief A detector's defects, classified ready for interpolateOverDefects
+ *
+ * A detector's defects rarely change, so a plan may be built once (and persisted along with the other
+ * calibration products) and then used to interpolate over any number of images with the same bounding box,
+ * without clipping, sorting, or classifying the defects again.
+ *
+ * The plan is a flat array of segments (1-D defects in a row, or in a column for those interpolated along
+ * columns), and runs of rows (or columns) that share the same segments.  It can't be changed once built.
+ */
+class DefectPlan :
+    public afw::table::io::PersistableFacade<DefectPlan>,
+    public afw::table::io::Persistable
+{
+public:
+
+    /**
+     * @brief A 1-D defect, decoded ready to be interpolated over
+     *
+     * In a run of columns x and y are swapped, so "x" is the row.
+     */
+    struct Segment {
+        int x0, x1;                     ///< the defect's pixels, to be marked as interpolated
+        int badX0, badX1;               ///< the pixels to interpolate
+        Defect::DefectPosition pos;     ///< position of the defect on the chip
+        unsigned int type;              ///< type of the defect; see Interp.cc
+        int pattern;                    ///< how to interpolate over it; see detail::findInterpPattern
+        int fallbackX0, fallbackX1;     ///< pixels to set to the fallback value, if fallbackX0 <= fallbackX1
+        bool interpolate;               ///< are there any pixels to interpolate?
+    };
+
+    /// The rows (or columns) [y0, y1), all of which contain the segments [begin, end)
+    struct Run {
+        int y0, y1;                     ///< the rows (or columns), relative to the bounding box's origin
+        int begin, end;                 ///< indices into getSegments()
+    };
+
+    /**
+     * @brief Classify the defects in an image with the given bounding box
+     *
+     * The arguments are as for interpolateOverDefects; the defects are in the parent frame.
+     */
+    DefectPlan(afw::geom::Box2I const & bbox,
+               std::vector<Defect::Ptr> const & badList,
+               bool useFallbackValueAtEdge=false,
+               InterpDirection direction=INTERP_ROWS
+              );
+
+    /// The bounding box of the images that the plan can be used for
+    afw::geom::Box2I getBBox() const { return _bbox; }
+
+    /// The segments, in the order that they're to be interpolated over
+    std::vector<Segment> const & getSegments() const { return _segments; }
+
+    /// The runs of rows, to be interpolated along rows
+    std::vector<Run> const & getRowRuns() const { return _rowRuns; }
+
+    /// The runs of columns, to be interpolated along columns after the rows
+    std::vector<Run> const & getColumnRuns() const { return _columnRuns; }
+
+    /// Return true if the DefectPlan is persistable (always true)
+    virtual bool isPersistable() const { return true; }
+
+    // Factory used to read DefectPlan from an InputArchive; defined only in the source file.
+    class Factory;
+
+protected:
+
+    // See afw::table::io::Persistable::getPersistenceName
+    virtual std::string getPersistenceName() const;
+
+    // See afw::table::io::Persistable::getPythonModule
+    virtual std::string getPythonModule() const;
+
+    // See afw::table::io::Persistable::write
+    virtual void write(OutputArchiveHandle & handle) const;
+
+private:
+
+    DefectPlan(afw::geom::Box2I const & bbox,
+               std::vector<Segment> const & segments,
+               std::vector<Run> const & rowRuns,
+               std::vector<Run> const & columnRuns
+              );
+
+    afw::geom::Box2I _bbox;             // bounding box of the images that the plan is for
+    std::vector<Segment> _segments;     // the segments in all the runs
+    std::vector<Run> _rowRuns;          // the runs of rows
+    std::vector<Run> _columnRuns;       // the runs of columns
+};
+
+}}} // namespace lsst::meas::algorithms
+
+#endif // !LSST_MEAS_ALGORITHMS_DefectPlan_h_INCLUDED
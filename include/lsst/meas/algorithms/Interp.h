@@ -28,6 +28,7 @@
 // Interpolate over defects in a MaskedImage
 //
 #include <limits>
+#include <utility>
 #include <vector>
 #include "lsst/afw/image/Defect.h"
 #include "lsst/afw/image/MaskedImage.h"
@@ -58,9 +59,51 @@ namespace interp {
      * Used to debias min(x, y)
      */
     double const min2GaussianBias = -0.5641895835; ///< Mean value of the minimum of two N(0,1) variates
+    /**
+     * The most pixels (the defect and the good pixels on either side) that singlePixel interpolates over;
+     * as it also needs 2 more pixels to exist beyond them, it never looks more than singlePixelMaxData + 2
+     * pixels away from the pixel that it's interpolating
+     */
+    int const singlePixelMaxData = 40;
+    /**
+     * The variance of the white noise that the PSF-based interpolation over wide defects assumes, relative
+     * to that of the PSF-smoothed signal.  It's added to the diagonal of the kriging system, which keeps the
+     * system well conditioned and stops the weights chasing the noise in the nearest good pixels
+     */
+    double const wideNugget = 1e-2;
+
+    /**
+     * @brief The runs of bad pixels in each row and each column of an image
+     *
+     * This lets singlePixel find the extent of the defect around a pixel with a binary search rather than
+     * a scan, so build one for an image and reuse it for all the pixels that you need to interpolate.
+     *
+     * All coordinates are in the parent frame.
+     */
+    class BadPixelRuns {
+    public:
+        typedef std::pair<int, int> Run;     ///< first and last bad pixel in a run
+
+        BadPixelRuns(lsst::afw::image::Mask<lsst::afw::image::MaskPixel> const& mask,
+                     lsst::afw::image::MaskPixel const badMask);
+
+        void add(int y, int x0, int x1);
+
+        Run getDefect(int x, int y, bool horizontal) const;
+        std::vector<Run> getRuns(int x, int y, bool horizontal, int i0, int i1) const;
+    private:
+        int _x0, _y0;                          // origin of the mask
+        std::vector<std::vector<Run> > _rows;  // the runs in each row, in order and relative to _x0
+        std::vector<std::vector<Run> > _cols;  // the runs in each column, in order and relative to _y0
+    };
+
+    template <typename MaskedImageT>
+    std::pair<bool, typename MaskedImageT::Image::Pixel> singlePixel(int x, int y, MaskedImageT const &image,
+                                                                     bool horizontal, double minval);
 
     template <typename MaskedImageT>
     std::pair<bool, typename MaskedImageT::Image::Pixel> singlePixel(int x, int y, MaskedImageT const &image,
+                                                                     BadPixelRuns const &badPixels,
                                                                      bool horizontal, double minval);
 }
 
@@ -106,14 +149,74 @@ private:
     unsigned int _type;                 //!< Type of defect
 };
 
+/**
+ * The direction in which interpolateOverDefects interpolates over a defect
+ */
+enum InterpDirection {
+    INTERP_ROWS,                        //!< along rows
+    INTERP_COLUMNS,                     //!< along columns
+    INTERP_AUTO                         //!< across the narrower dimension of the defect (rows if square)
+};
+
+/**
+ * Interpolate over the pixels in badList, setting their INTRP bit
+ *
+ * The defects are interpolated along rows, along columns, or (INTERP_AUTO) along rows for those that are
+ * at least as tall as they are wide (e.g. bad columns) and along columns for the rest (e.g. bleed trails).
+ * Interpolating along columns treats the bottom and top of the image as the left and right edges.  If the
+ * defects are interpolated in both directions those interpolated along rows are patched first, so they
+ * count as good pixels when interpolating along columns;  the pixels of those interpolated along columns
+ * count as bad when interpolating along rows, so a bad column that crosses a bleed trail never uses the
+ * trail's unpatched pixels.
+ *
+ * The rows (and columns) are shared between up to nThread threads;  the results don't depend on how many
+ * are used.
+ *
+ * If usePsf is true, wide defects (at least Defect::WIDE_DEFECT pixels across) are interpolated using the
+ * PSF's autocorrelation as the covariance between pixels, rather than with fixed coefficients.
+ */
 template <typename MaskedImageT>
 void interpolateOverDefects(MaskedImageT &image,
                             lsst::afw::detection::Psf const &psf,
                             std::vector<Defect::Ptr> &badList,
                             double fallbackValue = 0.0,
-                            bool useFallbackValueAtEdge=false
+                            bool useFallbackValueAtEdge=false,
+                            int nThread=1,
+                            InterpDirection direction=INTERP_ROWS,
+                            bool usePsf=false
                            );
 
+class DefectPlan;
+
+/**
+ * Interpolate over the pixels in a DefectPlan, setting their INTRP bit
+ *
+ * The image's bounding box must be the plan's.  If psf isn't NULL it's used to interpolate over wide
+ * defects, as for the other overload's usePsf.
+ */
+template <typename MaskedImageT>
+void interpolateOverDefects(MaskedImageT &image,
+                            DefectPlan const &plan,
+                            double fallbackValue = 0.0,
+                            int nThread=1,
+                            lsst::afw::detection::Psf const *psf=NULL
+                           );
+
+/**
+ * Interpolate along rows over the pixels with any of planeBits set in the image's mask, setting their
+ * INTRP bit
+ *
+ * The result is the same as passing interpolateOverDefects a Defect for each run of those pixels in a row,
+ * but no Defects (or Footprints) are made.
+ */
+template <typename MaskedImageT>
+void interpolateOverMaskPlane(MaskedImageT &image,
+                              typename MaskedImageT::Mask::Pixel const planeBits,
+                              double fallbackValue = 0.0,
+                              bool useFallbackValueAtEdge=false,
+                              int nThread=1
+                             );
+
 }}} // lsst::meas::algorithms::interp
 
 #endif
@@ -0,0 +1,494 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#if !defined(LSST_MEAS_ALGORITHMS_DETAIL_CRROWKERNEL_H)
+#define LSST_MEAS_ALGORITHMS_DETAIL_CRROWKERNEL_H
+//!
+// Test a whole row of pixels at a time against the CR conditions used by findCosmicRays
+//
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#   include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#   include <immintrin.h>
+#endif
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace detail {
+
+/**
+ * @brief Parameters for conditions #2 and #3 of the per-pixel CR test (see CR.cc)
+ */
+struct CrTestParams {
+    double minSigma;                    ///< minSigma, or -threshold if negative
+    double thresH;                      ///< horizontal threshold for condition #3
+    double thresV;                      ///< vertical threshold for condition #3
+    double thresD;                      ///< diagonal threshold for condition #3
+    double bkgd;                        ///< unsubtracted background level
+    double cond3Fac;                    ///< fiddle factor for condition #3
+    bool skipCondition3;                ///< only apply conditions #2 and #4 (e.g. if bkgd isn't known yet)
+};
+
+/**
+ * @brief Three adjacent rows of an image, variance, and mask, centred on the row being tested
+ *
+ * Index 0 is row y - 1, 1 is row y, and 2 is row y + 1; all three point at column 0.
+ *
+ * If sigma isn't NULL it points at column 0 of the standard deviation of row y (the square root of
+ * its variance), which is widened to double and used instead of taking the square root ourselves.
+ * Similarly, if bkgd isn't NULL it points at column 0 of the background under row y, which is used
+ * instead of CrTestParams::bkgd.
+ */
+template <typename ImagePixelT, typename VariancePixelT, typename MaskPixelT>
+struct CrRows {
+    ImagePixelT const *image[3];
+    VariancePixelT const *variance[3];
+    MaskPixelT const *mask[3];
+    float const *sigma;
+    double const *bkgd;
+};
+
+/**
+ * @brief Is pixel x a CR candidate according to conditions #2, #3 (unless p.skipCondition3), and #4?
+ *
+ * This is the reference version of the test in CR.cc's is_cr_pixel (and the condition #4 mask tests
+ * that follow it), spelling out the precision of each operation:  the directional means are formed in
+ * the image's pixel type, and everything else in double.  The vectorised code in findCrCandidates
+ * must reproduce it exactly.
+ */
+template <typename ImagePixelT, typename VariancePixelT, typename MaskPixelT>
+inline bool isCrCandidate(CrRows<ImagePixelT, VariancePixelT, MaskPixelT> const &rows,
+                          int const x,
+                          CrTestParams const &p,
+                          MaskPixelT const badMask,
+                          MaskPixelT const interpBit
+                         )
+{
+    ImagePixelT const *im_s = rows.image[0] + x, *im_0 = rows.image[1] + x, *im_n = rows.image[2] + x;
+    VariancePixelT const *var_s = rows.variance[0] + x, *var_0 = rows.variance[1] + x,
+        *var_n = rows.variance[2] + x;
+
+    ImagePixelT const v_00 = im_0[0];
+    if (v_00 < 0) {
+        return false;
+    }
+    double const dv_00 = rows.sigma ? static_cast<double>(rows.sigma[x]) : std::sqrt(static_cast<double>(var_0[0]));
+    //
+    // condition #2
+    //
+    ImagePixelT const mean_we =   (im_0[-1] + im_0[1])/2;
+    ImagePixelT const mean_ns =   (im_n[0]  + im_s[0])/2;
+    ImagePixelT const mean_swne = (im_s[-1] + im_n[1])/2;
+    ImagePixelT const mean_nwse = (im_n[-1] + im_s[1])/2;
+
+    if (p.minSigma < 0) {
+        if (v_00 < -p.minSigma) {
+            return false;
+        }
+    } else {
+        double const thres_sky_sigma = p.minSigma*dv_00;
+
+        if (v_00 < mean_ns   + thres_sky_sigma &&
+            v_00 < mean_we   + thres_sky_sigma &&
+            v_00 < mean_swne + thres_sky_sigma &&
+            v_00 < mean_nwse + thres_sky_sigma) {
+            return false;
+        }
+    }
+    //
+    // condition #3
+    //
+    if (!p.skipCondition3) {
+        double const dmean_we =   std::sqrt(static_cast<double>(var_0[-1] + var_0[1]))/2;
+        double const dmean_ns =   std::sqrt(static_cast<double>(var_n[0]  + var_s[0]))/2;
+        double const dmean_swne = std::sqrt(static_cast<double>(var_s[-1] + var_n[1]))/2;
+        double const dmean_nwse = std::sqrt(static_cast<double>(var_n[-1] + var_s[1]))/2;
+
+        double const bkgd = rows.bkgd ? rows.bkgd[x] : p.bkgd;
+        double const peak = (v_00 - bkgd) - p.cond3Fac*dv_00;
+        if (!(p.thresV*peak > (mean_ns   - bkgd) + p.cond3Fac*dmean_ns ||
+              p.thresH*peak > (mean_we   - bkgd) + p.cond3Fac*dmean_we ||
+              p.thresD*peak > (mean_swne - bkgd) + p.cond3Fac*dmean_swne ||
+              p.thresD*peak > (mean_nwse - bkgd) + p.cond3Fac*dmean_nwse)) {
+            return false;
+        }
+    }
+    //
+    // condition #4
+    //
+    MaskPixelT const *m_s = rows.mask[0] + x, *m_0 = rows.mask[1] + x, *m_n = rows.mask[2] + x;
+    if (m_0[0] & badMask) {
+        return false;
+    }
+    if ((m_n[-1] | m_n[0] | m_n[1] | m_0[-1] | m_0[1] | m_s[-1] | m_s[0] | m_s[1]) & interpBit) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Apply isCrCandidate to pixels [x0, x1) of a row one at a time
+ *
+ * Bit k of candidates[n] is set iff pixel x0 + 8*n + k is a candidate;  candidates must have room for
+ * (x1 - x0 + 7)/8 bytes.  The caller must ensure that columns x0 - 1 and x1 exist.
+ */
+template <typename ImagePixelT, typename VariancePixelT, typename MaskPixelT>
+void findCrCandidatesScalar(CrRows<ImagePixelT, VariancePixelT, MaskPixelT> const &rows,
+                            int const x0, int const x1,
+                            CrTestParams const &p,
+                            MaskPixelT const badMask,
+                            MaskPixelT const interpBit,
+                            std::uint8_t *candidates
+                           )
+{
+    for (int x = x0; x < x1; x += 8) {
+        std::uint8_t bits = 0;
+        for (int k = 0; k < 8 && x + k < x1; ++k) {
+            if (isCrCandidate(rows, x + k, p, badMask, interpBit)) {
+                bits |= (1 << k);
+            }
+        }
+        *candidates++ = bits;
+    }
+}
+
+/**
+ * @brief Apply isCrCandidate to pixels [x0, x1) of a row, producing a candidate bitmask
+ *
+ * Arguments are as for findCrCandidatesScalar, and so is the result, bit for bit.  Float images with
+ * 16-bit masks are processed eight pixels at a time with SSE2 or AVX; other pixel types, and the
+ * ragged end of the row, use the scalar code.
+ */
+template <typename ImagePixelT, typename VariancePixelT, typename MaskPixelT>
+void findCrCandidates(CrRows<ImagePixelT, VariancePixelT, MaskPixelT> const &rows,
+                      int const x0, int const x1,
+                      CrTestParams const &p,
+                      MaskPixelT const badMask,
+                      MaskPixelT const interpBit,
+                      std::uint8_t *candidates
+                     )
+{
+    findCrCandidatesScalar(rows, x0, x1, p, badMask, interpBit, candidates);
+}
+
+#if defined(__SSE2__)
+/*
+ * Return an 8-bit mask of those of the 8 16-bit mask pixels starting at x that pass condition #4
+ */
+inline int crMaskTest8(CrRows<float, float, std::uint16_t> const &rows, int const x,
+                       __m128i const badMask, __m128i const interpBit) {
+    __m128i const zero = _mm_setzero_si128();
+    std::uint16_t const *m_s = rows.mask[0] + x, *m_0 = rows.mask[1] + x, *m_n = rows.mask[2] + x;
+    __m128i const neighbours = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(m_n - 1)),
+                                  _mm_loadu_si128(reinterpret_cast<__m128i const *>(m_n))),
+                     _mm_or_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(m_n + 1)),
+                                  _mm_loadu_si128(reinterpret_cast<__m128i const *>(m_0 - 1)))),
+        _mm_or_si128(_mm_or_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(m_0 + 1)),
+                                  _mm_loadu_si128(reinterpret_cast<__m128i const *>(m_s - 1))),
+                     _mm_or_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(m_s)),
+                                  _mm_loadu_si128(reinterpret_cast<__m128i const *>(m_s + 1)))));
+    __m128i const center = _mm_loadu_si128(reinterpret_cast<__m128i const *>(m_0));
+
+    __m128i const ok = _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(center, badMask), zero),
+                                     _mm_cmpeq_epi16(_mm_and_si128(neighbours, interpBit), zero));
+    int const bytes = _mm_movemask_epi8(ok); // two bits per pixel
+    int bits = 0;
+    for (int k = 0; k < 8; ++k) {
+        bits |= ((bytes >> (2*k)) & 1) << k;
+    }
+    return bits;
+}
+
+#if defined(__AVX__)
+/*
+ * Return a mask of those of the 4 pixels described that are non-negative and pass condition #2, working
+ * in double precision; the float means are passed in already widened, and so is dv_00, the standard
+ * deviation of the central pixels.
+ *
+ * This is the cheap part of the test, and on a sky-dominated frame it rejects almost every pixel
+ * (condition #2 is equivalent to v_00 >= min(mean_ns, mean_we, mean_swne, mean_nwse) + minSigma*dv_00),
+ * so the caller only goes on to condition #3 if some pixel survives
+ */
+inline __m256d crCondition2(__m256d const v_00, __m256d const dv_00,
+                            __m256d const mean_ns, __m256d const mean_we, __m256d const mean_swne,
+                            __m256d const mean_nwse, CrTestParams const &p) {
+    __m256d const ok = _mm256_cmp_pd(v_00, _mm256_setzero_pd(), _CMP_NLT_UQ); // !(v_00 < 0)
+    if (p.minSigma < 0) {
+        return _mm256_and_pd(ok, _mm256_cmp_pd(v_00, _mm256_set1_pd(-p.minSigma), _CMP_NLT_UQ));
+    }
+
+    __m256d const thres = _mm256_mul_pd(_mm256_set1_pd(p.minSigma), dv_00);
+    __m256d const fail = _mm256_and_pd(
+        _mm256_and_pd(_mm256_cmp_pd(v_00, _mm256_add_pd(mean_ns, thres), _CMP_LT_OQ),
+                      _mm256_cmp_pd(v_00, _mm256_add_pd(mean_we, thres), _CMP_LT_OQ)),
+        _mm256_and_pd(_mm256_cmp_pd(v_00, _mm256_add_pd(mean_swne, thres), _CMP_LT_OQ),
+                      _mm256_cmp_pd(v_00, _mm256_add_pd(mean_nwse, thres), _CMP_LT_OQ)));
+    return _mm256_andnot_pd(fail, ok);
+}
+
+/*
+ * Return a mask of those of the 4 pixels described that pass condition #3, working in double
+ * precision.  Arguments are as for crCondition2, plus the widened variance sums and the background
+ */
+inline __m256d crCondition3(__m256d const v_00, __m256d const dv_00,
+                            __m256d const mean_ns, __m256d const mean_we, __m256d const mean_swne,
+                            __m256d const mean_nwse,
+                            __m256d const var_ns, __m256d const var_we, __m256d const var_swne,
+                            __m256d const var_nwse, __m256d const bkgd,
+                            CrTestParams const &p) {
+    __m256d const half = _mm256_set1_pd(0.5);
+    __m256d const cond3Fac = _mm256_set1_pd(p.cond3Fac);
+
+    __m256d const peak = _mm256_sub_pd(_mm256_sub_pd(v_00, bkgd), _mm256_mul_pd(cond3Fac, dv_00));
+#define CR_TEST3(THRES, MEAN, VAR)                                                                   \
+    _mm256_cmp_pd(_mm256_mul_pd(_mm256_set1_pd(THRES), peak),                                        \
+                  _mm256_add_pd(_mm256_sub_pd(MEAN, bkgd),                                           \
+                                _mm256_mul_pd(cond3Fac, _mm256_mul_pd(_mm256_sqrt_pd(VAR), half))),  \
+                  _CMP_GT_OQ)
+    __m256d const pass3 = _mm256_or_pd(_mm256_or_pd(CR_TEST3(p.thresV, mean_ns, var_ns),
+                                                    CR_TEST3(p.thresH, mean_we, var_we)),
+                                       _mm256_or_pd(CR_TEST3(p.thresD, mean_swne, var_swne),
+                                                    CR_TEST3(p.thresD, mean_nwse, var_nwse)));
+#undef CR_TEST3
+
+    return pass3;
+}
+
+/*
+ * Widen the low or high four floats of a __m256 to doubles
+ */
+inline __m256d widenLo(__m256 const x) { return _mm256_cvtps_pd(_mm256_castps256_ps128(x)); }
+inline __m256d widenHi(__m256 const x) { return _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)); }
+
+/*
+ * Return an 8-bit mask of those of the 8 pixels starting at x that pass conditions #2 and #3
+ */
+inline int crTest8(CrRows<float, float, std::uint16_t> const &rows, int const x, CrTestParams const &p) {
+    float const *im_s = rows.image[0] + x, *im_0 = rows.image[1] + x, *im_n = rows.image[2] + x;
+    float const *var_s = rows.variance[0] + x, *var_0 = rows.variance[1] + x, *var_n = rows.variance[2] + x;
+    __m256 const half = _mm256_set1_ps(0.5f);
+
+    __m256 const v_00 = _mm256_loadu_ps(im_0);
+    __m256 const mean_we =   _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(im_0 - 1), _mm256_loadu_ps(im_0 + 1)),
+                                           half);
+    __m256 const mean_ns =   _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(im_n),     _mm256_loadu_ps(im_s)),
+                                           half);
+    __m256 const mean_swne = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(im_s - 1), _mm256_loadu_ps(im_n + 1)),
+                                           half);
+    __m256 const mean_nwse = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(im_n - 1), _mm256_loadu_ps(im_s + 1)),
+                                           half);
+
+    __m256d dv_lo, dv_hi;               // standard deviations of the central pixels
+    if (rows.sigma) {
+        __m256 const sigma_00 = _mm256_loadu_ps(rows.sigma + x);
+        dv_lo = widenLo(sigma_00);
+        dv_hi = widenHi(sigma_00);
+    } else {
+        __m256 const var_00 = _mm256_loadu_ps(var_0);
+        dv_lo = _mm256_sqrt_pd(widenLo(var_00));
+        dv_hi = _mm256_sqrt_pd(widenHi(var_00));
+    }
+
+    __m256d const v_lo = widenLo(v_00), v_hi = widenHi(v_00);
+    __m256d const ns_lo = widenLo(mean_ns), we_lo = widenLo(mean_we),
+        swne_lo = widenLo(mean_swne), nwse_lo = widenLo(mean_nwse);
+    __m256d const ns_hi = widenHi(mean_ns), we_hi = widenHi(mean_we),
+        swne_hi = widenHi(mean_swne), nwse_hi = widenHi(mean_nwse);
+
+    __m256d const ok_lo = crCondition2(v_lo, dv_lo, ns_lo, we_lo, swne_lo, nwse_lo, p);
+    __m256d const ok_hi = crCondition2(v_hi, dv_hi, ns_hi, we_hi, swne_hi, nwse_hi, p);
+    int const pass2 = _mm256_movemask_pd(ok_lo) | (_mm256_movemask_pd(ok_hi) << 4);
+    if (pass2 == 0 || p.skipCondition3) {
+        return pass2;                   // usually 0; don't bother with the variances
+    }
+
+    __m256 const var_we =   _mm256_add_ps(_mm256_loadu_ps(var_0 - 1), _mm256_loadu_ps(var_0 + 1));
+    __m256 const var_ns =   _mm256_add_ps(_mm256_loadu_ps(var_n),     _mm256_loadu_ps(var_s));
+    __m256 const var_swne = _mm256_add_ps(_mm256_loadu_ps(var_s - 1), _mm256_loadu_ps(var_n + 1));
+    __m256 const var_nwse = _mm256_add_ps(_mm256_loadu_ps(var_n - 1), _mm256_loadu_ps(var_s + 1));
+
+    __m256d const bkgd_lo = rows.bkgd ? _mm256_loadu_pd(rows.bkgd + x) : _mm256_set1_pd(p.bkgd);
+    __m256d const bkgd_hi = rows.bkgd ? _mm256_loadu_pd(rows.bkgd + x + 4) : bkgd_lo;
+
+    __m256d const pass_lo = _mm256_and_pd(ok_lo,
+                                          crCondition3(v_lo, dv_lo, ns_lo, we_lo, swne_lo, nwse_lo,
+                                                       widenLo(var_ns), widenLo(var_we),
+                                                       widenLo(var_swne), widenLo(var_nwse), bkgd_lo, p));
+    __m256d const pass_hi = _mm256_and_pd(ok_hi,
+                                          crCondition3(v_hi, dv_hi, ns_hi, we_hi, swne_hi, nwse_hi,
+                                                       widenHi(var_ns), widenHi(var_we),
+                                                       widenHi(var_swne), widenHi(var_nwse), bkgd_hi, p));
+    return _mm256_movemask_pd(pass_lo) | (_mm256_movemask_pd(pass_hi) << 4);
+}
+#else
+/*
+ * Return a mask of those of the 2 pixels described that are non-negative and pass condition #2, working
+ * in double precision; the float means are passed in already widened, and so is dv_00, the standard
+ * deviation of the central pixels.  See the AVX version for why this is split from condition #3
+ */
+inline __m128d crCondition2(__m128d const v_00, __m128d const dv_00,
+                            __m128d const mean_ns, __m128d const mean_we, __m128d const mean_swne,
+                            __m128d const mean_nwse, CrTestParams const &p) {
+    __m128d const ok = _mm_cmpnlt_pd(v_00, _mm_setzero_pd()); // !(v_00 < 0)
+    if (p.minSigma < 0) {
+        return _mm_and_pd(ok, _mm_cmpnlt_pd(v_00, _mm_set1_pd(-p.minSigma)));
+    }
+
+    __m128d const thres = _mm_mul_pd(_mm_set1_pd(p.minSigma), dv_00);
+    __m128d const fail = _mm_and_pd(_mm_and_pd(_mm_cmplt_pd(v_00, _mm_add_pd(mean_ns, thres)),
+                                               _mm_cmplt_pd(v_00, _mm_add_pd(mean_we, thres))),
+                                    _mm_and_pd(_mm_cmplt_pd(v_00, _mm_add_pd(mean_swne, thres)),
+                                               _mm_cmplt_pd(v_00, _mm_add_pd(mean_nwse, thres))));
+    return _mm_andnot_pd(fail, ok);
+}
+
+/*
+ * Return a mask of those of the 2 pixels described that pass condition #3, working in double
+ * precision.  Arguments are as for crCondition2, plus the widened variance sums and the background
+ */
+inline __m128d crCondition3(__m128d const v_00, __m128d const dv_00,
+                            __m128d const mean_ns, __m128d const mean_we, __m128d const mean_swne,
+                            __m128d const mean_nwse,
+                            __m128d const var_ns, __m128d const var_we, __m128d const var_swne,
+                            __m128d const var_nwse, __m128d const bkgd,
+                            CrTestParams const &p) {
+    __m128d const half = _mm_set1_pd(0.5);
+    __m128d const cond3Fac = _mm_set1_pd(p.cond3Fac);
+
+    __m128d const peak = _mm_sub_pd(_mm_sub_pd(v_00, bkgd), _mm_mul_pd(cond3Fac, dv_00));
+#define CR_TEST3(THRES, MEAN, VAR)                                                                   \
+    _mm_cmpgt_pd(_mm_mul_pd(_mm_set1_pd(THRES), peak),                                               \
+                 _mm_add_pd(_mm_sub_pd(MEAN, bkgd), _mm_mul_pd(cond3Fac, _mm_mul_pd(_mm_sqrt_pd(VAR), half))))
+    __m128d const pass3 = _mm_or_pd(_mm_or_pd(CR_TEST3(p.thresV, mean_ns, var_ns),
+                                              CR_TEST3(p.thresH, mean_we, var_we)),
+                                    _mm_or_pd(CR_TEST3(p.thresD, mean_swne, var_swne),
+                                              CR_TEST3(p.thresD, mean_nwse, var_nwse)));
+#undef CR_TEST3
+
+    return pass3;
+}
+
+/*
+ * Widen the low or high two floats of a __m128 to doubles
+ */
+inline __m128d widenLo(__m128 const x) { return _mm_cvtps_pd(x); }
+inline __m128d widenHi(__m128 const x) { return _mm_cvtps_pd(_mm_movehl_ps(x, x)); }
+
+/*
+ * Return a 4-bit mask of those of the 4 pixels starting at x that pass conditions #2 and #3
+ */
+inline int crTest4(CrRows<float, float, std::uint16_t> const &rows, int const x, CrTestParams const &p) {
+    float const *im_s = rows.image[0] + x, *im_0 = rows.image[1] + x, *im_n = rows.image[2] + x;
+    float const *var_s = rows.variance[0] + x, *var_0 = rows.variance[1] + x, *var_n = rows.variance[2] + x;
+    __m128 const half = _mm_set1_ps(0.5f);
+
+    __m128 const v_00 = _mm_loadu_ps(im_0);
+    __m128 const mean_we =   _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(im_0 - 1), _mm_loadu_ps(im_0 + 1)), half);
+    __m128 const mean_ns =   _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(im_n),     _mm_loadu_ps(im_s)),     half);
+    __m128 const mean_swne = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(im_s - 1), _mm_loadu_ps(im_n + 1)), half);
+    __m128 const mean_nwse = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(im_n - 1), _mm_loadu_ps(im_s + 1)), half);
+
+    __m128d dv_lo, dv_hi;               // standard deviations of the central pixels
+    if (rows.sigma) {
+        __m128 const sigma_00 = _mm_loadu_ps(rows.sigma + x);
+        dv_lo = widenLo(sigma_00);
+        dv_hi = widenHi(sigma_00);
+    } else {
+        __m128 const var_00 = _mm_loadu_ps(var_0);
+        dv_lo = _mm_sqrt_pd(widenLo(var_00));
+        dv_hi = _mm_sqrt_pd(widenHi(var_00));
+    }
+
+    __m128d const v_lo = widenLo(v_00), v_hi = widenHi(v_00);
+    __m128d const ns_lo = widenLo(mean_ns), we_lo = widenLo(mean_we),
+        swne_lo = widenLo(mean_swne), nwse_lo = widenLo(mean_nwse);
+    __m128d const ns_hi = widenHi(mean_ns), we_hi = widenHi(mean_we),
+        swne_hi = widenHi(mean_swne), nwse_hi = widenHi(mean_nwse);
+
+    __m128d const ok_lo = crCondition2(v_lo, dv_lo, ns_lo, we_lo, swne_lo, nwse_lo, p);
+    __m128d const ok_hi = crCondition2(v_hi, dv_hi, ns_hi, we_hi, swne_hi, nwse_hi, p);
+    int const pass2 = _mm_movemask_pd(ok_lo) | (_mm_movemask_pd(ok_hi) << 2);
+    if (pass2 == 0 || p.skipCondition3) {
+        return pass2;                   // usually 0; don't bother with the variances
+    }
+
+    __m128 const var_we =   _mm_add_ps(_mm_loadu_ps(var_0 - 1), _mm_loadu_ps(var_0 + 1));
+    __m128 const var_ns =   _mm_add_ps(_mm_loadu_ps(var_n),     _mm_loadu_ps(var_s));
+    __m128 const var_swne = _mm_add_ps(_mm_loadu_ps(var_s - 1), _mm_loadu_ps(var_n + 1));
+    __m128 const var_nwse = _mm_add_ps(_mm_loadu_ps(var_n - 1), _mm_loadu_ps(var_s + 1));
+
+    __m128d const bkgd_lo = rows.bkgd ? _mm_loadu_pd(rows.bkgd + x) : _mm_set1_pd(p.bkgd);
+    __m128d const bkgd_hi = rows.bkgd ? _mm_loadu_pd(rows.bkgd + x + 2) : bkgd_lo;
+
+    __m128d const pass_lo = _mm_and_pd(ok_lo, crCondition3(v_lo, dv_lo, ns_lo, we_lo, swne_lo, nwse_lo,
+                                                           widenLo(var_ns), widenLo(var_we),
+                                                           widenLo(var_swne), widenLo(var_nwse), bkgd_lo, p));
+    __m128d const pass_hi = _mm_and_pd(ok_hi, crCondition3(v_hi, dv_hi, ns_hi, we_hi, swne_hi, nwse_hi,
+                                                           widenHi(var_ns), widenHi(var_we),
+                                                           widenHi(var_swne), widenHi(var_nwse), bkgd_hi, p));
+    return _mm_movemask_pd(pass_lo) | (_mm_movemask_pd(pass_hi) << 2);
+}
+
+/*
+ * Return an 8-bit mask of those of the 8 pixels starting at x that pass conditions #2 and #3
+ */
+inline int crTest8(CrRows<float, float, std::uint16_t> const &rows, int const x, CrTestParams const &p) {
+    return crTest4(rows, x, p) | (crTest4(rows, x + 4, p) << 4);
+}
+#endif
+
+template <>
+inline void findCrCandidates(CrRows<float, float, std::uint16_t> const &rows,
+                             int const x0, int const x1,
+                             CrTestParams const &p,
+                             std::uint16_t const badMask,
+                             std::uint16_t const interpBit,
+                             std::uint8_t *candidates
+                            )
+{
+    __m128i const badMask8 = _mm_set1_epi16(static_cast<short>(badMask));
+    __m128i const interpBit8 = _mm_set1_epi16(static_cast<short>(interpBit));
+
+    int x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        // The mask test is cheap, and fails every pixel in BAD or NO_DATA regions
+        int const maskOk = crMaskTest8(rows, x, badMask8, interpBit8);
+        *candidates++ = static_cast<std::uint8_t>((maskOk == 0) ? 0 : (crTest8(rows, x, p) & maskOk));
+    }
+    if (x < x1) {
+        findCrCandidatesScalar(rows, x, x1, p, badMask, interpBit, candidates);
+    }
+}
+#endif
+
+}}}} // namespace lsst::meas::algorithms::detail
+
+#endif
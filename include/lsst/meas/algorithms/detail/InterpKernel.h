@@ -0,0 +1,79 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#if !defined(LSST_MEAS_ALGORITHMS_DETAIL_INTERPKERNEL_H)
+#define LSST_MEAS_ALGORITHMS_DETAIL_INTERPKERNEL_H
+//!
+// Interpolate over a 1-D defect in a row, using a table of the LPC coefficients for each type of defect
+//
+#include "lsst/meas/algorithms/Interp.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace detail {
+
+/**
+ * @brief Return the index of the interpolant for a defect of a given position and type, or -1 if we
+ * don't have one
+ *
+ * The type encodes both the defect's width and which of its neighbours are good (see Interp.cc).
+ * NEAR_LEFT and NEAR_RIGHT defects share MIDDLE's interpolants, and WIDE_NEAR_LEFT and WIDE_NEAR_RIGHT
+ * share WIDE's.
+ */
+int findInterpPattern(Defect::DefectPosition pos, unsigned int type);
+
+/**
+ * @brief Can interpolateDefect safely be used on the pixels [badX0, badX1] of a row of length ncol?
+ *
+ * The position must be one of Defect's, the neighbours that it implies (out[badX0 - 2] to out[badX1 + 2])
+ * must lie in the row, and unless the defect is wide enough to reach the far side of the row (and so is
+ * filled rather than interpolated over) pattern must be one of findInterpPattern's interpolants.
+ */
+bool isValidDefect(int ncol, int badX0, int badX1, Defect::DefectPosition pos, int pattern);
+
+/**
+ * @brief Interpolate over the pixels [badX0, badX1] of a row of length ncol
+ *
+ * The interpolant is the one that findInterpPattern returns for the defect's position and type (if it's
+ * -1, only wide defects that reach the far side of the row are touched).  Values below min are replaced
+ * by the neighbouring good pixels.  Wide defects that reach the far side of the row (and so have no good
+ * pixels on one side) are set to the one good pixel beyond them, if there is one, or fallbackValue.
+ *
+ * Instantiated for the x_iterators of float and double images.
+ */
+template <typename PixelT, typename IterT>
+void interpolateDefect(IterT out,                               ///< the start of the row
+                       int const ncol,                          ///< the row's length
+                       int const badX0,                         ///< the defect's first pixel
+                       int const badX1,                         ///< the defect's last pixel
+                       Defect::DefectPosition const pos,        ///< the defect's position
+                       int const pattern,                       ///< the defect's interpolant
+                       PixelT const min,                        ///< minimum acceptable value
+                       double const fallbackValue               ///< value to use if there are no good pixels
+                      );
+
+}}}} // namespace lsst::meas::algorithms::detail
+
+#endif
@@ -0,0 +1,98 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#if !defined(LSST_MEAS_ALGORITHMS_DETAIL_PARALLEL_H)
+#define LSST_MEAS_ALGORITHMS_DETAIL_PARALLEL_H
+//!
+// Minimal support for running independent pieces of work on several threads
+//
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace detail {
+
+/**
+ * @brief Call func(i) for i in [0, n), spreading the calls over up to nThread threads
+ *
+ * Tasks are handed out one at a time, so they needn't all take the same time.  The calling thread
+ * does its share of the work.  If a task throws, no further tasks are started and the first exception
+ * is rethrown in the calling thread once all the threads have finished.
+ */
+template <typename FuncT>
+void parallelFor(int const n,           ///< number of tasks
+                 int nThread,           ///< maximum number of threads to use (<= 1: run serially)
+                 FuncT func             ///< the work; called as func(int i)
+                ) {
+    if (nThread > n) {
+        nThread = n;
+    }
+    if (nThread <= 1) {
+        for (int i = 0; i < n; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<int> next(0);           // next task to be started
+    std::exception_ptr error;           // first exception thrown by a task
+    std::mutex errorMutex;              // protects error
+
+    auto worker = [&]() {
+        for (int i = next++; i < n; i = next++) {
+            try {
+                func(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next = n;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThread - 1);
+    for (int i = 1; i < nThread; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::vector<std::thread>::iterator ptr = threads.begin(); ptr != threads.end(); ++ptr) {
+        ptr->join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+}}}} // namespace lsst::meas::algorithms::detail
+
+#endif
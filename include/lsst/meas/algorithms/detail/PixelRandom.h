@@ -0,0 +1,94 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#if !defined(LSST_MEAS_ALGORITHMS_DETAIL_PIXELRANDOM_H)
+#define LSST_MEAS_ALGORITHMS_DETAIL_PIXELRANDOM_H
+//!
+// Random numbers that are a function of a pixel's position rather than of how many have been drawn before
+//
+#include <cmath>
+#include <cstdint>
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace detail {
+
+/**
+ * @brief A counter-based random number generator, keyed by pixel position
+ *
+ * Each deviate depends only on the seed, the pixel's (x, y), and a stream number (to allow several
+ * independent deviates per pixel), so the values given to a pixel don't depend on the order in which the
+ * pixels are processed, nor on which thread processes them.  The position should be in the parent frame,
+ * so that a sub-image sees the same values as the whole image.
+ *
+ * The bits come from the SplitMix64 finaliser applied to the key in turn;  this isn't
+ * cryptographically strong, but its output passes the usual statistical tests.
+ */
+class PixelRandom {
+public:
+    explicit PixelRandom(std::uint64_t seed = 1) : _seed(mix(seed)) {}
+
+    /// Return a deviate drawn uniformly from (0, 1)
+    double uniform(int const x, int const y, int const stream = 0) const {
+        return toUniform(bits(x, y, stream, 0));
+    }
+
+    /// Return a deviate drawn from N(0, 1)
+    double gaussian(int const x, int const y, int const stream = 0) const {
+        double const u1 = toUniform(bits(x, y, stream, 0));
+        double const u2 = toUniform(bits(x, y, stream, 1));
+
+        double const twoPi = 6.283185307179586476925;
+        return std::sqrt(-2*std::log(u1))*std::cos(twoPi*u2); // Box-Muller
+    }
+private:
+    static std::uint64_t mix(std::uint64_t z) {
+        z += 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Return 64 random bits for the k'th word of (x, y, stream)
+    std::uint64_t bits(int const x, int const y, int const stream, int const k) const {
+        std::uint64_t const xy = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) |
+            static_cast<std::uint32_t>(y);
+        std::uint64_t const sk = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(stream)) << 32) |
+            static_cast<std::uint32_t>(k);
+        return mix(mix(_seed ^ xy) ^ sk);
+    }
+
+    // Convert 64 bits to a double in (0, 1), using the top 53
+    static double toUniform(std::uint64_t const b) {
+        return ((b >> 11) + 0.5)*(1.0/9007199254740992.0); // 2^-53
+    }
+
+    std::uint64_t _seed;                // the seed, mixed
+};
+
+}}}} // namespace lsst::meas::algorithms::detail
+
+#endif
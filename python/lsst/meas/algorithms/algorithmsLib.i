@@ -88,6 +88,9 @@ namespace lsst { namespace meas { namespace algorithms { namespace interp {} nam
 
 %include "lsst/meas/algorithms/Interp.h"
 
+%declareTablePersistable(DefectPlan, lsst::meas::algorithms::DefectPlan);
+%include "lsst/meas/algorithms/DefectPlan.h"
+
 /************************************************************************************************************/
 
 %define %Exposure(PIXTYPE)
@@ -124,6 +127,10 @@ namespace lsst { namespace meas { namespace algorithms { namespace interp {} nam
                                           lsst::afw::image::MaskedImage<PIXTYPE,
                                                                         lsst::afw::image::MaskPixel,
                                                                         lsst::afw::image::VariancePixel> >;
+    %template(interpolateOverMaskPlane) lsst::meas::algorithms::interpolateOverMaskPlane<
+                                            lsst::afw::image::MaskedImage<PIXTYPE,
+                                                                          lsst::afw::image::MaskPixel,
+                                                                          lsst::afw::image::VariancePixel> >;
 %enddef
 
 %instantiate_templates(F, float)
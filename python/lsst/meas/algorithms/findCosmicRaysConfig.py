@@ -56,6 +56,22 @@ class FindCosmicRaysConfig(pexConfig.Config):
         doc="number of times to look for contaminated pixels near known CR pixels",
         default=3,
     )
+    nThreads = pexConfig.Field(
+        dtype=int,
+        doc="number of threads to use when searching for CR pixels; the results don't depend on it",
+        default=1,
+    )
+    streamBandHeight = pexConfig.Field(
+        dtype=int,
+        doc="number of rows to read at a time when finding CRs in an image that's streamed from disk",
+        default=256,
+    )
+    randomSeed = pexConfig.Field(
+        dtype=int,
+        doc="seed for the noise added to interpolated CR pixels; each pixel's noise depends only on "
+            "the seed and its position",
+        default=1,
+    )
     keepCRs = pexConfig.Field(
         dtype=bool,
         doc="Don't interpolate over CR pixels",
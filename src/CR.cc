@@ -32,6 +32,13 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
 #include <typeinfo>
 
@@ -42,15 +49,19 @@
 
 #include "lsst/pex/exceptions.h"
 #include "lsst/log/Log.h"
+#include "lsst/daf/base/PropertySet.h"
 #include "lsst/pex/exceptions.h"
 #include "lsst/afw/detection/Footprint.h"
 #include "lsst/afw/detection/FootprintFunctor.h"
 #include "lsst/afw/geom.h"
 #include "lsst/afw/detection/Psf.h"
 #include "lsst/afw/image/MaskedImage.h"
-#include "lsst/afw/math/Random.h"
+#include "lsst/afw/math/BoundedField.h"
 #include "lsst/meas/algorithms/CR.h"
 #include "lsst/meas/algorithms/Interp.h"
+#include "lsst/meas/algorithms/detail/CrRowKernel.h"
+#include "lsst/meas/algorithms/detail/Parallel.h"
+#include "lsst/meas/algorithms/detail/PixelRandom.h"
 
 /**
  * @todo These should go into afw --- actually, there're already there, but
@@ -64,9 +75,6 @@ namespace detection {
  */
 class IdSpan {
 public:
-    typedef std::shared_ptr<IdSpan> Ptr;
-    typedef std::shared_ptr<const IdSpan> ConstPtr;
-
     explicit IdSpan(int id, int y, int x0, int x1) : id(id), y(y), x0(x0), x1(x1) {}
     int id;                         /* ID for object */
     int y;                          /* Row wherein IdSpan dwells */
@@ -75,36 +83,23 @@ public:
 /**
  * comparison functor; sort by ID, then by row (y), then by column range start (x0)
  */
-struct IdSpanCompar : public std::binary_function<const IdSpan::ConstPtr, const IdSpan::ConstPtr, bool> {
-    bool operator()(const IdSpan::ConstPtr a, const IdSpan::ConstPtr b) {
-        if (a->id < b->id) {
+struct IdSpanCompar {
+    bool operator()(IdSpan const& a, IdSpan const& b) const {
+        if (a.id < b.id) {
             return true;
-        } else if(a->id > b->id) {
+        } else if(a.id > b.id) {
             return false;
         } else {
-            if (a->y < b->y) {
+            if (a.y < b.y) {
                 return true;
-            } else if (a->y > b->y) {
+            } else if (a.y > b.y) {
                 return false;
             } else {
-                return (a->x0 < b->x0) ? true : false;
+                return (a.x0 < b.x0) ? true : false;
             }
         }
     }
 };
-/**
- * Follow a chain of aliases, returning the final resolved value.
- */
-int resolve_alias(const std::vector<int>& aliases, /* list of aliases */
-                  int id) {         /* alias to look up */
-    int resolved = id;              /* resolved alias */
-
-    while (id != aliases[id]) {
-        resolved = id = aliases[id];
-    }
-
-    return(resolved);
-}
 }}} // namespace lsst::afw::detection
 
 namespace lsst {
@@ -116,12 +111,53 @@ namespace math = lsst::afw::math;
 namespace image = lsst::afw::image;
 namespace detection = lsst::afw::detection;
 
+/*
+ * Define LSST_MEAS_ALGORITHMS_CR_STATS to 0 to compile out the timers and counters that fill CosmicRayStats
+ */
+#if !defined(LSST_MEAS_ALGORITHMS_CR_STATS)
+#   define LSST_MEAS_ALGORITHMS_CR_STATS 1
+#endif
+
+#if LSST_MEAS_ALGORITHMS_CR_STATS
+#   define CR_STATS(STATEMENT) STATEMENT
+#else
+#   define CR_STATS(STATEMENT)
+#endif
+
 namespace {
 
+class SigmaPlane;
+class CrBackground;
+
+/*
+ * Add the time from construction to stop() (or destruction, whichever comes first) to a total
+ */
+class StageTimer {
+public:
+    explicit StageTimer(double &seconds) : _seconds(seconds), _start(std::chrono::steady_clock::now()),
+                                           _running(true) {}
+    StageTimer(StageTimer const&) = delete;
+    StageTimer& operator=(StageTimer const&) = delete;
+    ~StageTimer() { stop(); }
+
+    void stop() {
+        if (_running) {
+            _seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+            _running = false;
+        }
+    }
+private:
+    double &_seconds;
+    std::chrono::steady_clock::time_point _start;
+    bool _running;
+};
+
 template<typename ImageT, typename MaskT>
-void removeCR(image::MaskedImage<ImageT, MaskT> & mi, std::vector<detection::Footprint::Ptr> & CRs,
-              double const bkgd, MaskT const , MaskT const saturBit, MaskT const badMask,
-              bool const debias, bool const grow);
+void removeCR(image::MaskedImage<ImageT, MaskT> & mi, geom::Box2I const & frame,
+              std::vector<detection::Footprint::Ptr> & CRs,
+              CrBackground const &bkgd, MaskT const , MaskT const saturBit, MaskT const badMask,
+              bool const debias, bool const grow, SigmaPlane const &sigma,
+              detail::PixelRandom const &rand, CosmicRayStats &stats);
 
 template<typename ImageT>
 bool condition_3(ImageT *estimate, double const peak,
@@ -135,36 +171,28 @@ bool condition_3(ImageT *estimate, double const peak,
 /************************************************************************************************************/
 //
 // A class to hold a detected pixel
+//
+// Each pixel carries a sequence number, allocated in the order that the pixels are found by each call to
+// findCosmicRays (there's no global counter, so concurrent calls don't interfere with each other)
 template<typename ImageT>
 struct CRPixel {
     typedef typename std::shared_ptr<CRPixel> Ptr;
 
-    CRPixel(int _col, int _row, ImageT _val, int _id = -1) :
-        id(_id), col(_col), row(_row), val(_val) {
-        _i = ++i;
-    }
+    CRPixel(int _col, int _row, ImageT _val, int _seq, int _id = -1) :
+        id(_id), col(_col), row(_row), val(_val), seq(_seq) {}
     ~CRPixel() {}
 
     bool operator< (const CRPixel& a) const {
-        return _i < a._i;
-    }
-
-    int get_i() const {
-        return _i;
+        return seq < a.seq;
     }
 
     int id;                             // Unique ID for cosmic ray (not cosmic ray pixel)
     int col;                            // position
     int row;                            //    of pixel
     ImageT val;                         // initial value of pixel
-private:
-    static int i;                       // current value of running index
-    int mutable _i;                     // running index
+    int seq;                            // sequence number; the order in which the pixel was found
 };
 
-template<typename ImageT>
-int CRPixel<ImageT>::i = 0;
-
 template<typename ImageT>
 struct Sort_CRPixel_by_id {
     bool operator() (CRPixel<ImageT> const & a, CRPixel<ImageT> const & b) const {
@@ -172,6 +200,123 @@ struct Sort_CRPixel_by_id {
     }
 };
 
+/************************************************************************************************************/
+/*
+ * A disjoint-set forest (union-find) over the integers [0, n), used to merge the spans that make up CRs
+ *
+ * find uses path compression and merge uses union by rank, so each operation costs essentially constant
+ * time.  Each set also carries a label;  when two sets are merged the result takes the label of the second.
+ * With this rule the labels are exactly the roots that simple alias chains (aliases[root(i)] = root(j))
+ * would produce, which fixes the order in which the CRs are reported.
+ */
+class DisjointSet {
+public:
+    explicit DisjointSet(int n) : _parent(n), _rank(n, 0), _label(n) {
+        for (int i = 0; i != n; ++i) {
+            _parent[i] = _label[i] = i;
+        }
+    }
+
+    // Return the root of i's set
+    int find(int i) {
+        int root = i;
+        while (_parent[root] != root) {
+            root = _parent[root];
+        }
+        while (_parent[i] != root) {    // point everything on the path straight at the root
+            int const next = _parent[i];
+            _parent[i] = root;
+            i = next;
+        }
+        return root;
+    }
+
+    // Merge the sets containing i and j; the result inherits j's label
+    void merge(int i, int j) {
+        int ri = find(i);
+        int rj = find(j);
+        if (ri == rj) {
+            return;
+        }
+        int const label = _label[rj];
+        if (_rank[ri] < _rank[rj]) {
+            std::swap(ri, rj);
+        }
+        _parent[rj] = ri;
+        if (_rank[ri] == _rank[rj]) {
+            ++_rank[ri];
+        }
+        _label[ri] = label;
+    }
+
+    // Return the label of i's set
+    int getLabel(int i) {
+        return _label[find(i)];
+    }
+private:
+    std::vector<int> _parent;           // parent of each element; roots are their own parents
+    std::vector<int> _rank;             // upper bound on the height of each root's tree
+    std::vector<int> _label;            // label of each root's set
+};
+
+/************************************************************************************************************/
+/*
+ * The caller's standard deviation (sqrt of the variance) of each pixel of an image, which every stage of
+ * the CR search would otherwise recompute each time that it visits a pixel
+ *
+ * We don't compute the plane ourselves:  only one of the square roots in each test is of a single pixel's
+ * variance, and after the first pass the plane is only read near CRs, so writing it costs more than it
+ * saves (a 2048x2048 frame with 5000 CRs was 5% slower with it).
+ *
+ * The plane is a view of the caller's image, which must outlive it.  Its values are widened to double as
+ * they're read, as that's the precision in which the tests are made.  Coordinates are relative to the
+ * image's origin.  An empty plane is also valid:  get then computes the value from the variance
+ */
+class SigmaPlane {
+public:
+    SigmaPlane() : _image(NULL) {}
+
+    // Use an image of the standard deviation as the plane
+    void set(image::Image<float> const &sigma) {
+        _image = &sigma;
+    }
+
+    // Return row y of the plane, or NULL if it's empty
+    float const *row(int const y) const {
+        return _image ? _image->row_begin(y) : NULL;
+    }
+
+    // Return the standard deviation of pixel (x, y), whose variance is variance
+    double get(int const x, int const y, double const variance) const {
+        return _image ? static_cast<double>(_image->row_begin(y)[x]) : std::sqrt(variance);
+    }
+private:
+    image::Image<float> const *_image;  // the caller's standard deviation; NULL if the plane's empty
+};
+
+/*
+ * The unsubtracted background under an image:  either a constant, or a BoundedField in the parent frame
+ *
+ * Evaluating a BoundedField at every pixel would cost more than the CR search itself, but we only need the
+ * background at pixels that satisfy condition #2 and at the CRs and their neighbours, so it's evaluated
+ * there as we go.  The field is used from several threads at once if the search is multithreaded
+ */
+class CrBackground {
+public:
+    explicit CrBackground(double const value) : _value(value), _field(NULL) {}
+    explicit CrBackground(math::BoundedField const& field) : _value(0), _field(&field) {}
+
+    bool isConstant() const { return !_field; }
+
+    // Return the background at (x, y)
+    double get(int const x, int const y) const {
+        return _field ? _field->evaluate(geom::Point2D(x, y)) : _value;
+    }
+private:
+    double _value;                      // the background, if it's constant
+    math::BoundedField const *_field;   // the background, if it isn't
+};
+
 /*****************************************************************************/
 /*
  * This is the code to see if a given pixel is bad
@@ -184,7 +329,8 @@ bool is_cr_pixel(typename MaskedImageT::Image::Pixel *corr,      // corrected va
                  double const minSigma, // minSigma, or -threshold if negative
                  double const thresH, double const thresV, double const thresD, // for condition #3
                  double const bkgd,     // unsubtracted background level
-                 double const cond3Fac // fiddle factor for condition #3
+                 double const cond3Fac, // fiddle factor for condition #3
+                 double const dv_00     // standard deviation of this pixel
                 )
 {
     typedef typename MaskedImageT::Image::Pixel ImagePixel;
@@ -213,7 +359,7 @@ bool is_cr_pixel(typename MaskedImageT::Image::Pixel *corr,      // corrected va
             return false;
         }
     } else {
-        double const thres_sky_sigma = minSigma*sqrt(loc.variance(0, 0));
+        double const thres_sky_sigma = minSigma*dv_00;
 
         if (v_00 < mean_ns   + thres_sky_sigma &&
             v_00 < mean_we   + thres_sky_sigma &&
@@ -227,12 +373,16 @@ bool is_cr_pixel(typename MaskedImageT::Image::Pixel *corr,      // corrected va
  *
  * Note that this uses mean_ns etc. even if minSigma is negative
  */
-    double const dv_00 =      sqrt(loc.variance( 0,  0));
+    //
+    // The square roots are taken in double precision (of the float sums of the variances); the
+    // vectorised version of this test in detail/CrRowKernel.h relies on this.  dv_00 is passed in,
+    // as it may come from a SigmaPlane
+    //
     // standard deviation of means of surrounding pixels
-    double const dmean_we =   sqrt(loc.variance(-1,  0) + loc.variance( 1,  0))/2;
-    double const dmean_ns =   sqrt(loc.variance( 0,  1) + loc.variance( 0, -1))/2;
-    double const dmean_swne = sqrt(loc.variance(-1, -1) + loc.variance( 1,  1))/2;
-    double const dmean_nwse = sqrt(loc.variance(-1,  1) + loc.variance( 1, -1))/2;
+    double const dmean_we =   std::sqrt(static_cast<double>(loc.variance(-1,  0) + loc.variance( 1,  0)))/2;
+    double const dmean_ns =   std::sqrt(static_cast<double>(loc.variance( 0,  1) + loc.variance( 0, -1)))/2;
+    double const dmean_swne = std::sqrt(static_cast<double>(loc.variance(-1, -1) + loc.variance( 1,  1)))/2;
+    double const dmean_nwse = std::sqrt(static_cast<double>(loc.variance(-1,  1) + loc.variance( 1, -1)))/2;
 
     if (!condition_3(corr,
                      v_00 - bkgd, mean_ns - bkgd, mean_we - bkgd, mean_swne - bkgd, mean_nwse - bkgd,
@@ -250,42 +400,245 @@ bool is_cr_pixel(typename MaskedImageT::Image::Pixel *corr,      // corrected va
 
 /************************************************************************************************************/
 //
-// Worker routine to process the pixels adjacent to a span (including the points just
-// to the left and just to the right)
+// Apply conditions #2, #3, and #4 to all the pixels in row j (except the edge ones which we ignore),
+// replacing the CR-contaminated pixels with a preliminary estimate as we go.  The tests are made
+// by the vectorised row kernel in detail/CrRowKernel.h, which gives identical results to is_cr_pixel.
+//
+// Each contaminated pixel is passed to found(i, j, val) (with val the pixel's initial value) before it's
+// replaced; if found returns false, the scan stops and we return false
 //
+template <typename MaskedImageT, typename FoundT>
+bool scanRowForCRs(MaskedImageT &mimage, ///< Image to search
+                   int const j,          ///< the row to process
+                   double const minSigma, // minSigma
+                   double const thresH, double const thresV, double const thresD, // for cond. #3
+                   CrBackground const &bkgd, // unsubtracted background level
+                   double const cond3Fac, // fiddle factor for condition #3
+                   typename MaskedImageT::Mask::Pixel const badMask,   // naughty pixels
+                   typename MaskedImageT::Mask::Pixel const interpBit, // interpolated pixels
+                   float const *sigma,    // row j of the image's SigmaPlane, or NULL
+                   FoundT &found          // called for each contaminated pixel
+                  )
+{
+    typedef typename MaskedImageT::Image::Pixel ImagePixel;
+    typedef typename MaskedImageT::Variance::Pixel VariancePixel;
+    typedef typename MaskedImageT::Mask::Pixel MaskPixel;
+
+    int const ncol = mimage.getWidth();
+    if (ncol < 3) {
+        return true;
+    }
+    /*
+     * Apply conditions #2, #3, and #4 to the whole row at once, given the values at the start of the row
+     */
+    detail::CrRows<ImagePixel, VariancePixel, MaskPixel> rows;
+    for (int k = 0; k != 3; ++k) {
+        rows.image[k] = mimage.getImage()->row_begin(j + k - 1);
+        rows.variance[k] = mimage.getVariance()->row_begin(j + k - 1);
+        rows.mask[k] = mimage.getMask()->row_begin(j + k - 1);
+    }
+    rows.sigma = sigma;
+    rows.bkgd = NULL;
+    /*
+     * If the background isn't constant we only evaluate it for the pixels that satisfy the other
+     * conditions, so the whole row is only tested against conditions #2 and #4
+     */
+    std::vector<double> bkgdRow;        // the background under row j where we've needed it
+    if (!bkgd.isConstant()) {
+        bkgdRow.resize(ncol);
+        rows.bkgd = &bkgdRow[0];
+    }
+    detail::CrTestParams const params = {minSigma, thresH, thresV, thresD,
+                                         bkgd.isConstant() ? bkgd.get(0, 0) : 0.0, cond3Fac, false};
+    detail::CrTestParams rowParams = params;
+    rowParams.skipCondition3 = !bkgd.isConstant();
+
+    std::vector<std::uint8_t> candidates((ncol - 2 + 7)/8); // bitmask of candidates in columns [1, ncol - 1)
+    detail::findCrCandidates(rows, 1, ncol - 1, rowParams, badMask, interpBit, &candidates[0]);
+
+    auto const isCrCandidate = [&](int const i) { // apply the full test to pixel i
+        if (rows.bkgd) {
+            bkgdRow[i] = bkgd.get(i + mimage.getX0(), j + mimage.getY0());
+        }
+        return detail::isCrCandidate(rows, i, params, badMask, interpBit);
+    };
+    /*
+     * Replacing a CR pixel changes the test for its right-hand neighbour, so we retest that pixel;
+     * everything else is as the kernel said
+     */
+    bool retest = false;                // is the previous pixel a CR?
+    for (int i = 1; i < ncol - 1; ++i) {
+        int const k = i - 1;            // index into candidates
+        bool isCandidate;
+        if (retest) {
+            isCandidate = isCrCandidate(i);
+            retest = false;
+        } else {
+            if ((k & 07) == 0 && candidates[k >> 3] == 0) { // no candidates in the next 8 pixels
+                i += 7;
+                continue;
+            }
+            isCandidate = (candidates[k >> 3] >> (k & 07)) & 01;
+            if (isCandidate && rowParams.skipCondition3) {
+                isCandidate = isCrCandidate(i);
+            }
+        }
+        if (!isCandidate) {
+            continue;
+        }
+/*
+ * OK, it's a CR
+ *
+ * replace CR-contaminated pixels with reasonable values as we go through
+ * image, which increases the detection rate
+ */
+        typename MaskedImageT::xy_locator loc = mimage.xy_at(i, j); // locator for data
+        ImagePixel corr = 0;
+        double const dv_00 = sigma ? sigma[i] : std::sqrt(static_cast<double>(loc.variance()));
+        bool const isCR = is_cr_pixel<MaskedImageT>(&corr, loc, minSigma, thresH, thresV, thresD,
+                                                   rows.bkgd ? rows.bkgd[i] : params.bkgd, cond3Fac, dv_00);
+        assert(isCR);
+        (void)isCR;
+
+        bool const ok = found(i, j, loc.image());
+        loc.image() = corr;         /* just a preliminary estimate */
+        retest = true;
+
+        if (!ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/************************************************************************************************************/
+/*
+ * Grow a CR for up to niteration iterations.  Each iteration tests the untested neighbours of the pixels
+ * added by the previous one (to start with, of the CR's own pixels); a pixel that's been tested and
+ * rejected is never tested again, so the work scales with the number of pixels that we add rather than
+ * with the size of the CR.  The pixels that we add are corrected in place as we go (in raster order
+ * within each iteration), and are added to the CR at the end.
+ *
+ * Pixels in the first or last row or column of frame are never added, and we don't grow from pixels
+ * within two rows of its bottom or top (so the second and second-to-last rows may still be added).
+ *
+ * Return false (having stopped early) if adding the pixels would exceed nCrPixelMax
+ */
 template <typename MaskedImageT>
-void checkSpanForCRs(detection::Footprint *extras, // Extra spans get added to this Footprint
-                     std::vector<CRPixel<typename MaskedImageT::Image::Pixel> >& crpixels,
-                                        // a list of pixels containing CRs
-                     int const y,   // the row to process
-                     int const x0, int const x1, // range of pixels in the span (inclusive)
-                     MaskedImageT& image, ///< Image to search
-                     double const minSigma, // minSigma
-                     double const thresH, double const thresV, double const thresD, // for cond. #3
-                     double const bkgd, // unsubtracted background level
-                     double const cond3Fac, // fiddle factor for condition #3
-                     bool const keep // if true, don't remove the CRs
-                    )
+bool growCR(detection::Footprint &cr,   // the CR to grow
+            MaskedImageT &mimage,       // Image to search
+            geom::Box2I const &frame,   // bounding box of the whole frame
+            std::vector<CRPixel<typename MaskedImageT::Image::Pixel> > &crpixels, // the CRs' pixels
+            int &seq,                   // sequence number of the next CR pixel
+            int &nextra,                // number of pixels added to all the CRs so far
+            CrBackground const &bkgd,   // unsubtracted background of frame, DN
+            double const minSigma,      // minSigma
+            double const thresH, double const thresV, double const thresD, // for cond. #3
+            int const niteration,       // number of iterations
+            int const nCrPixelMax,      // maximum number of contaminated pixels
+            bool const keep,            // if true, don't remove the CRs
+            SigmaPlane const &sigma,    // the image's standard deviation; may be empty
+            std::vector<std::uint8_t> &visited, // workspace: state of each pixel in the grown CR's bbox
+            std::vector<int> &nGrown    // incremented by the number of pixels added in each iteration
+           )
 {
-    typedef typename MaskedImageT::Image::Pixel MImagePixel;
-    typename MaskedImageT::xy_locator loc = image.xy_at(x0 - 1, y); // locator for data
-
-    int const imageX0 = image.getX0();
-    int const imageY0 = image.getY0();
-
-    for (int x = x0 - 1; x <= x1 + 1; ++x) {
-        MImagePixel corr = 0;                // new value for pixel
-        if (is_cr_pixel<MaskedImageT>(&corr, loc, minSigma, thresH, thresV, thresD,
-                                     bkgd, cond3Fac)) {
-            if (keep) {
-                crpixels.push_back(CRPixel<MImagePixel>(x + imageX0, y + imageY0, loc.image()));
+    typedef typename MaskedImageT::Image::Pixel ImagePixel;
+    enum { UNTESTED = 0, REJECTED, IN_CR, ADDED };
+    typedef std::pair<int, int> Pixel;  // (y, x) in the parent frame, so they sort in raster order
+    /*
+     * The CR can't grow more than niteration pixels from where it started
+     */
+    geom::Box2I bbox = cr.getBBox();
+    bbox.grow(niteration);
+    bbox.clip(frame);
+    int const bx0 = bbox.getMinX(), by0 = bbox.getMinY(), bwidth = bbox.getWidth();
+    visited.assign(bbox.getArea(), UNTESTED);
+
+    std::vector<Pixel> frontier;        // the pixels added in the last iteration
+    for (detection::Footprint::SpanList::const_iterator sp = cr.getSpans().begin();
+         sp != cr.getSpans().end(); ++sp) {
+        int const y = (*sp)->getY();
+        for (int x = (*sp)->getX0(); x <= (*sp)->getX1(); ++x) {
+            visited[(y - by0)*bwidth + x - bx0] = IN_CR;
+            frontier.push_back(Pixel(y, x));
+        }
+    }
+
+    int nadded = 0;                     // number of pixels added to this CR
+    std::vector<Pixel> candidates;      // the pixels to test in this iteration
+    for (int i = 0; i != niteration && !frontier.empty(); ++i) {
+        candidates.clear();
+        for (std::vector<Pixel>::const_iterator ptr = frontier.begin(); ptr != frontier.end(); ++ptr) {
+            /*
+             * We're going to check a 3x3 region around the pixels, so we need a buffer around the edge
+             */
+            if (ptr->first - frame.getMinY() < 2 || ptr->first - frame.getMinY() >= frame.getHeight() - 2) {
+                continue;
             }
-            loc.image() = corr;
+            for (int y = ptr->first - 1; y <= ptr->first + 1; ++y) {
+                for (int x = ptr->second - 1; x <= ptr->second + 1; ++x) {
+                    if (x - frame.getMinX() < 1 || x - frame.getMinX() >= frame.getWidth() - 1) {
+                        continue;
+                    }
+                    std::uint8_t &state = visited[(y - by0)*bwidth + x - bx0];
+                    if (state == UNTESTED) {
+                        state = REJECTED; // unless it turns out to be a CR
+                        candidates.push_back(Pixel(y, x));
+                    }
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        frontier.clear();
+        for (std::vector<Pixel>::const_iterator ptr = candidates.begin(); ptr != candidates.end(); ++ptr) {
+            int const y = ptr->first, x = ptr->second;
+            int const ix = x - mimage.getX0(), iy = y - mimage.getY0();
+            typename MaskedImageT::xy_locator loc = mimage.xy_at(ix, iy);
+            ImagePixel corr = 0;        // new value for pixel
+            double const dv_00 = sigma.get(ix, iy, loc.variance());
+            if (is_cr_pixel<MaskedImageT>(&corr, loc, minSigma, thresH, thresV, thresD, bkgd.get(x, y), 0,
+                                          dv_00)) {
+                if (keep) {
+                    crpixels.push_back(CRPixel<ImagePixel>(x, y, loc.image(), seq++));
+                }
+                loc.image() = corr;
 
-            extras->addSpan(y + imageY0, x + imageX0, x + imageX0);
+                visited[(y - by0)*bwidth + x - bx0] = ADDED;
+                frontier.push_back(*ptr);
+            }
+        }
+
+        if (!frontier.empty()) {        // we added some pixels
+            if (nextra + static_cast<int>(crpixels.size()) > nCrPixelMax) {
+                return false;
+            }
+            nextra += frontier.size();
+            nadded += frontier.size();
+            CR_STATS(nGrown[i] += frontier.size();)
+        }
+    }
+    /*
+     * Add the new pixels to the CR, a run at a time
+     */
+    if (nadded > 0) {
+        for (int y = 0; y != bbox.getHeight(); ++y) {
+            std::uint8_t const *row = &visited[y*bwidth];
+            for (int x = 0; x != bwidth; ++x) {
+                if (row[x] == ADDED) {
+                    int const x0 = x;
+                    while (x + 1 != bwidth && row[x + 1] == ADDED) {
+                        ++x;
+                    }
+                    cr.addSpan(y + by0, x0 + bx0, x + bx0);
+                }
+            }
         }
-        ++loc.x();
+        cr.normalize();
     }
+
+    return true;
 }
 
 /************************************************************************************************************/
@@ -295,16 +648,16 @@ void checkSpanForCRs(detection::Footprint *extras, // Extra spans get added to t
 template <typename ImageT>
 class CountsInCR : public detection::FootprintFunctor<ImageT> {
 public:
-    CountsInCR(ImageT const& mimage, double const bkgd) :
+    CountsInCR(ImageT const& mimage, CrBackground const& bkgd) :
         detection::FootprintFunctor<ImageT>(mimage),
         _bkgd(bkgd),
         _sum(0.0) {}
 
     // method called for each pixel by apply()
     void operator()(typename ImageT::xy_locator loc, // locator pointing at the pixel
-                    int, int
+                    int x, int y                     // the pixel's position in the parent frame
                    ) {
-        _sum += *loc - _bkgd;
+        _sum += *loc - _bkgd.get(x, y);
     }
 
     virtual void reset(detection::Footprint const&) {}
@@ -314,7 +667,7 @@ public:
 
     double getCounts() const { return _sum; }
 private:
-    double const _bkgd;                  // the Image's background level
+    CrBackground const& _bkgd;           // the Image's background level
     typename ImageT::Pixel _sum;         // the sum of all DN in the Footprint, corrected for bkgd
 };
 }
@@ -336,34 +689,68 @@ static void reinstateCrPixels(
     }
 }
 
-/*!
- * @brief Find cosmic rays in an Image, and mask and remove them
- *
- * @return vector of CR's Footprints
+namespace {
+/*
+ * The parameters that control the search for CRs, as read from the Policy and the PSF
  */
-template <typename MaskedImageT>
-std::vector<detection::Footprint::Ptr>
-findCosmicRays(MaskedImageT &mimage,      ///< Image to search
-               detection::Psf const &psf, ///< the Image's PSF
-               double const bkgd,         ///< unsubtracted background of frame, DN
-               lsst::pex::policy::Policy const &policy, ///< Policy directing the behavior
-               bool const keep                          ///< if true, don't remove the CRs
-              ) {
-    typedef typename MaskedImageT::Image ImageT;
-    typedef typename ImageT::Pixel ImagePixel;
-    typedef typename MaskedImageT::Mask::Pixel MaskPixel;
+struct CrParams {
+    double minSigma;                    // min sigma over sky in pixel for CR candidate
+    double minDn;                       // min number of DN in an CRs
+    double cond3Fac;                    // fiddle factor for condition #3
+    double cond3Fac2;                   // 2nd fiddle factor for condition #3
+    double thresH, thresV, thresD;      // thresholds for condition #3, from the PSF
+    int niteration;                     // Number of times to look for contaminated pixels near CRs
+    int nCrPixelMax;                    // maximum number of contaminated pixels
+    int nThread;                        // number of threads to use
+    int randomSeed;                     // seed for the noise added to the interpolated pixels
+    image::MaskPixel crBit;             // CR-contaminated pixels
+    image::MaskPixel interpBit;         // Interpolated pixels
+    image::MaskPixel saturBit;          // Saturated pixels
+    image::MaskPixel badMask;           // naughty pixels
+};
+
+/*
+ * Set the parameters that come from the Policy;  the thresholds for condition #3 are set separately
+ * by setCrThresholds
+ */
+template <typename MaskT>
+CrParams makeCrParams(lsst::pex::policy::Policy const &policy     // Policy directing the behavior
+                     )
+{
+    CrParams p;
 
     // Parse the Policy
-    double const minSigma = policy.getDouble("minSigma");    // min sigma over sky in pixel for CR candidate
-    double const minDn = policy.getDouble("min_DN");         // min number of DN in an CRs
-    double const cond3Fac = policy.getDouble("cond3_fac");   // fiddle factor for condition #3
-    double const cond3Fac2 = policy.getDouble("cond3_fac2"); // 2nd fiddle factor for condition #3
-    int const niteration = policy.getInt("niteration");      // Number of times to look for contaminated
-                                                             // pixels near CRs
-    int const nCrPixelMax = policy.getInt("nCrPixelMax");    // maximum number of contaminated pixels
+    p.minSigma = policy.getDouble("minSigma");
+    p.minDn = policy.getDouble("min_DN");
+    p.cond3Fac = policy.getDouble("cond3_fac");
+    p.cond3Fac2 = policy.getDouble("cond3_fac2");
+    p.niteration = policy.getInt("niteration");
+    p.nCrPixelMax = policy.getInt("nCrPixelMax");
+    p.nThread = policy.exists("nThreads") ? policy.getInt("nThreads") : 1;
+    p.randomSeed = policy.exists("randomSeed") ? policy.getInt("randomSeed") : 1;
+    p.thresH = p.thresV = p.thresD = 0;
+/*
+ * Setup desired mask planes
+ */
+    image::MaskPixel const badBit = MaskT::getPlaneBitMask("BAD"); // Generic bad pixels
+    p.crBit = MaskT::getPlaneBitMask("CR");
+    p.interpBit = MaskT::getPlaneBitMask("INTRP");
+    p.saturBit = MaskT::getPlaneBitMask("SAT");
+    image::MaskPixel const nodataBit = MaskT::getPlaneBitMask("NO_DATA"); // Non data pixels
+
+    p.badMask = (badBit | p.interpBit | p.saturBit | nodataBit);
+
+    return p;
+}
+
+/*
+ * Set the thresholds for condition #3 from the PSF
+ */
+void setCrThresholds(CrParams &p,                    // the parameters to set
+                     detection::Psf const &psf       // the Image's PSF
+                    )
+{
 /*
- * thresholds for 3rd condition
- *
  * Realise PSF at center of image
  */
     lsst::afw::math::Kernel::ConstPtr kernel = psf.getLocalKernel();
@@ -377,221 +764,260 @@ findCosmicRays(MaskedImageT &mimage,      ///< Image to search
     int const yc = kernel->getCtrY();
 
     double const I0 = psfImage(xc, yc);
-    double const thresH = cond3Fac2*(0.5*(psfImage(xc - 1, yc) + psfImage(xc + 1, yc)))/I0; // horizontal
-    double const thresV = cond3Fac2*(0.5*(psfImage(xc, yc - 1) + psfImage(xc, yc + 1)))/I0; // vertical
-    double const thresD = cond3Fac2*(0.25*(psfImage(xc - 1, yc - 1) + psfImage(xc + 1, yc + 1) +
-                                           psfImage(xc - 1, yc + 1) + psfImage(xc + 1, yc - 1)))/I0; // diag
+    p.thresH = p.cond3Fac2*(0.5*(psfImage(xc - 1, yc) + psfImage(xc + 1, yc)))/I0; // horizontal
+    p.thresV = p.cond3Fac2*(0.5*(psfImage(xc, yc - 1) + psfImage(xc, yc + 1)))/I0; // vertical
+    p.thresD = p.cond3Fac2*(0.25*(psfImage(xc - 1, yc - 1) + psfImage(xc + 1, yc + 1) +
+                                  psfImage(xc - 1, yc + 1) + psfImage(xc + 1, yc - 1)))/I0; // diag
+}
+
 /*
- * Setup desired mask planes
+ * Callback for scanRowForCRs that remembers each contaminated pixel in a list, complaining when the list
+ * grows too long
  */
-    MaskPixel const badBit = mimage.getMask()->getPlaneBitMask("BAD"); // Generic bad pixels
-    MaskPixel const crBit = mimage.getMask()->getPlaneBitMask("CR"); // CR-contaminated pixels
-    MaskPixel const interpBit = mimage.getMask()->getPlaneBitMask("INTRP"); // Interpolated pixels
-    MaskPixel const saturBit = mimage.getMask()->getPlaneBitMask("SAT"); // Saturated pixels
-    MaskPixel const nodataBit = mimage.getMask()->getPlaneBitMask("NO_DATA"); // Non data pixels
+template <typename ImagePixel>
+class AppendCRPixel {
+public:
+    AppendCRPixel(std::vector<CRPixel<ImagePixel> > &crpixels, // list of CR-contaminated pixels
+                  int &seq,                                    // sequence number of the next pixel
+                  int const x0, int const y0,                  // origin of the image being scanned
+                  int const nCrPixelMax                        // maximum number of contaminated pixels
+                 ) : _crpixels(crpixels), _seq(seq), _x0(x0), _y0(y0), _nCrPixelMax(nCrPixelMax) {}
+
+    bool operator()(int i, int j, ImagePixel val) {
+        _crpixels.push_back(CRPixel<ImagePixel>(i + _x0, j + _y0, val, _seq++));
+        return static_cast<int>(_crpixels.size()) <= _nCrPixelMax;
+    }
+private:
+    std::vector<CRPixel<ImagePixel> > &_crpixels;
+    int &_seq;
+    int const _x0, _y0;
+    int const _nCrPixelMax;
+};
 
-    MaskPixel const badMask = (badBit | interpBit | saturBit | nodataBit); // naughty pixels
 /*
- * Go through the frame looking at each pixel (except the edge ones which we ignore)
+ * Callback for scanRowForCRs that only records where the contaminated pixels are
  */
-    int const ncol = mimage.getWidth();
-    int const nrow = mimage.getHeight();
-
-    std::vector<CRPixel<ImagePixel> > crpixels; // storage for detected CR-contaminated pixels
-    typedef typename std::vector<CRPixel<ImagePixel> >::iterator crpixel_iter;
-    typedef typename std::vector<CRPixel<ImagePixel> >::reverse_iterator crpixel_riter;
+class AppendCRPosition {
+public:
+    explicit AppendCRPosition(std::vector<geom::Point2I> &positions) : _positions(positions) {}
 
-    for (int j = 1; j < nrow - 1; ++j) {
-        typename MaskedImageT::xy_locator loc = mimage.xy_at(1, j); // locator for data
+    template <typename ImagePixel>
+    bool operator()(int i, int j, ImagePixel) {
+        _positions.push_back(geom::Point2I(i, j));
+        return true;
+    }
+private:
+    std::vector<geom::Point2I> &_positions;
+};
 
-        for (int i = 1; i < ncol - 1; ++i, ++loc.x()) {
-            ImagePixel corr = 0;
-            if (!is_cr_pixel<MaskedImageT>(&corr, loc, minSigma,
-                                           thresH, thresV, thresD, bkgd, cond3Fac)) {
-                continue;
-            }
-/*
- * condition #4
- */
-            if (loc.mask() & badMask) {
-                continue;
-            }
-            if ((loc.mask(-1,  1) | loc.mask(0,  1) | loc.mask(1,  1) |
-                 loc.mask(-1,  0) |                   loc.mask(1,  0) |
-                 loc.mask(-1, -1) | loc.mask(0, -1) | loc.mask(1, -1)) & interpBit) {
-                continue;
-            }
 /*
- * OK, it's a CR
+ * Run-length encode the CR pixels in [begin, end), which are in row-major order, into IdSpans.  Each span
+ * gets a new ID, starting at id0 + 1; the number of the last ID used is returned.
  *
- * replace CR-contaminated pixels with reasonable values as we go through
- * image, which increases the detection rate
+ * *end must be a valid CRPixel that doesn't adjoin the last pixel in the range (e.g. the dummy pixel
+ * at the end of the list of CR pixels, or the first pixel of the next row band)
  */
-            crpixels.push_back(CRPixel<ImagePixel>(i + mimage.getX0(), j + mimage.getY0(), loc.image()));
-            loc.image() = corr;         /* just a preliminary estimate */
+template <typename ImagePixel>
+int makeIdSpans(typename std::vector<CRPixel<ImagePixel> >::iterator const begin,
+                typename std::vector<CRPixel<ImagePixel> >::iterator const end,
+                int const id0,                                  // IDs are allocated after this one
+                std::vector<detection::IdSpan> &spans           // the new spans are appended to this list
+               )
+{
+    typedef typename std::vector<CRPixel<ImagePixel> >::iterator crpixel_iter;
 
-            if (static_cast<int>(crpixels.size()) > nCrPixelMax) {
-                reinstateCrPixels(mimage.getImage().get(), crpixels);
+    int ncr = id0;                      // the last ID allocated
+    int x0 = -1, x1 = -1, y = -1;       // the beginning and end column, and row of this span in a CR
 
-                throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
-                                  (boost::format("Too many CR pixels (max %d)") % nCrPixelMax).str());
-            }
+    for (crpixel_iter crp = begin; crp < end; ++crp) {
+        if (crp->id < 0) {              // not already assigned
+            crp->id = ++ncr;            // a new CR
+            y = crp->row;
+            x0 = x1 = crp->col;
+        }
+        int const id = crp->id;
+
+        if (crp[1].row == crp[0].row && crp[1].col == crp[0].col + 1) {
+            crp[1].id = id;
+            ++x1;
+        } else {
+            assert (y >= 0 && x0 >= 0 && x1 >= 0);
+            spans.push_back(detection::IdSpan(id, y, x0, x1));
         }
     }
-/*
- * We've found them on a pixel-by-pixel basis, now merge those pixels
- * into cosmic rays
- */
-    std::vector<int> aliases;           // aliases for initially disjoint parts of CRs
-    aliases.reserve(1 + crpixels.size()/2); // initial size of aliases
 
-    std::vector<detection::IdSpan::Ptr> spans; // y:x0,x1 for objects
-    spans.reserve(aliases.capacity());  // initial size of spans
+    return ncr;
+}
 
-    aliases.push_back(0);               // 0 --> 0
+/*
+ * Find the CR-contaminated pixels in the image using nBand row bands processed in parallel
+ *
+ * Each band is scanned in a private copy of its image pixels (plus a halo of one row on each side, as
+ * that's all the 3x3 test looks at), so the bands don't see each other's preliminary corrections.  The
+ * serial scan does see them, so as we stitch the bands back together in order we rescan the top rows of
+ * any band whose lower neighbour found CR pixels in its last row, stopping as soon as the rescan agrees
+ * with what the band found. The resulting pixels, and the values left in the image, are thus identical
+ * to those found by scanning the whole image in one pass.
+ *
+ * On return, bandStarts[b] is the index in crpixels of the first pixel in band b; the last element is
+ * crpixels.size()
+ */
+template <typename MaskedImageT>
+void findCRPixelsInBands(
+        std::vector<CRPixel<typename MaskedImageT::Image::Pixel> > &crpixels, // the CR pixels
+        std::vector<std::size_t> &bandStarts, // where each band starts in crpixels
+        int &seq,                             // sequence number of the next CR pixel
+        MaskedImageT &mimage,                 // Image to search
+        int const nBand,                      // number of row bands
+        CrBackground const &bkgd,             // unsubtracted background level
+        CrParams const &p,                    // parameters of the search
+        SigmaPlane const &sigma               // mimage's standard deviation; may be empty
+                        )
+{
+    typedef typename MaskedImageT::Image ImageT;
+    typedef typename ImageT::Pixel ImagePixel;
+    typedef typename MaskedImageT::Mask MaskT;
+    typedef typename MaskedImageT::Variance VarianceT;
 
-    /**
-     In this loop, we look for strings of CRpixels on the same row and adjoining columns;
-     each of these becomes a Span with a unique ID.
-     */
+    int const ncol = mimage.getWidth();
+    int const nrow = mimage.getHeight();
+    int const imageX0 = mimage.getX0();
+    int const imageY0 = mimage.getY0();
+    int const halo = 1;                 // rows of halo needed by the 3x3 test
+    //
+    // Rows [1, nrow - 1) are searched;  split them into bands
+    //
+    std::vector<int> bandRows(nBand + 1);
+    for (int b = 0; b <= nBand; ++b) {
+        bandRows[b] = 1 + static_cast<int>((static_cast<long>(nrow - 2)*b)/nBand);
+    }
 
-    int ncr = 0;                        // number of detected cosmic rays
-    if (!crpixels.empty()) {
-        int id;                         // id number for a CR
-        int x0 = -1, x1 = -1, y = -1;   // the beginning and end column, and row of this span in a CR
+    std::vector<typename ImageT::Ptr> bandImages(nBand); // private copies of each band's pixels
+    std::vector<std::vector<geom::Point2I> > bandPositions(nBand); // CR pixels found in each band
+
+    detail::parallelFor(nBand, p.nThread, [&](int b) {
+        int const r0 = bandRows[b];
+        int const r1 = bandRows[b + 1];
+        geom::BoxI const bbox(geom::PointI(0, r0 - halo), geom::PointI(ncol - 1, r1 - 1 + halo));
+
+        bandImages[b].reset(new ImageT(*mimage.getImage(), bbox, image::LOCAL, true));
+        MaskedImageT band(bandImages[b],
+                          typename MaskT::Ptr(new MaskT(*mimage.getMask(), bbox, image::LOCAL, false)),
+                          typename VarianceT::Ptr(new VarianceT(*mimage.getVariance(), bbox, image::LOCAL,
+                                                                false)));
+        AppendCRPosition found(bandPositions[b]);
+        for (int j = halo; j < halo + r1 - r0; ++j) {
+            scanRowForCRs(band, j, p.minSigma, p.thresH, p.thresV, p.thresD, bkgd, p.cond3Fac,
+                          p.badMask, p.interpBit, sigma.row(j - halo + r0), found);
+        }
+    });
+    //
+    // Stitch the bands together in order, writing their preliminary corrections into the image
+    //
+    AppendCRPixel<ImagePixel> append(crpixels, seq, imageX0, imageY0, p.nCrPixelMax);
+
+    bandStarts.clear();
+    for (int b = 0; b != nBand; ++b) {
+        bandStarts.push_back(crpixels.size());
+
+        int const r0 = bandRows[b];
+        int const r1 = bandRows[b + 1];
+        ImageT const &bandImage = *bandImages[b];
+        std::vector<geom::Point2I> const &positions = bandPositions[b];
+        std::vector<geom::Point2I>::const_iterator pos = positions.begin();
+        //
+        // If the row above the band had contaminated pixels the band saw different values from those
+        // that the serial scan would have seen, so rescan it in place until the results agree
+        //
+        int r = r0;                     // first row whose band results we can use unchanged
+        if (!crpixels.empty() && crpixels.back().row == r0 - 1 + imageY0) {
+            for (; r < r1; ) {
+                std::size_t const nOld = crpixels.size();
+                if (!scanRowForCRs(mimage, r, p.minSigma, p.thresH, p.thresV, p.thresD, bkgd, p.cond3Fac,
+                                   p.badMask, p.interpBit, sigma.row(r), append)) {
+                    reinstateCrPixels(mimage.getImage().get(), crpixels);
+
+                    throw LSST_EXCEPT(TooManyCrPixelsError,
+                                      (boost::format("Too many CR pixels (max %d)") % p.nCrPixelMax).str());
+                }
+                bool same = true;       // did the rescan agree with the band?
+                std::size_t i = nOld;
+                for (; pos != positions.end() && pos->getY() - halo + r0 == r; ++pos, ++i) {
+                    if (i == crpixels.size() || crpixels[i].col != pos->getX() + imageX0 ||
+                        (*mimage.getImage())(pos->getX(), r) != bandImage(pos->getX(), pos->getY())) {
+                        same = false;
+                    }
+                }
+                if (i != crpixels.size()) {
+                    same = false;
+                }
+                ++r;
 
-        // I am dummy
-        CRPixel<ImagePixel> dummy(0, -1, 0, -1);
-        crpixels.push_back(dummy);
-        //printf("Created dummy CR: i %i, id %i, col %i, row %i, val %g\n", dummy.get_i(), dummy.id, dummy.col, dummy.row, (double)dummy.val);
-        for (crpixel_iter crp = crpixels.begin(); crp < crpixels.end() - 1 ; ++crp) {
-            //printf("Looking at CR: i %i, id %i, col %i, row %i, val %g\n", crp->get_i(), crp->id, crp->col, crp->row, (double)crp->val);
-
-            if (crp->id < 0) {           // not already assigned
-                crp->id = ++ncr;        // a new CR
-                aliases.push_back(crp->id);
-                y = crp->row;
-                x0 = x1 = crp->col;
-                //printf("  Assigned ID %i; looking at row %i, start col %i\n", crp->id, crp->row, crp->col);
+                if (same) {
+                    break;
+                }
             }
-            id = crp->id;
-            //printf("  Next CRpix has i=%i, id=%i, row %i, col %i\n", crp[1].get_i(), crp[1].id, crp[1].row, crp[1].col);
+        }
+        //
+        // The rest of the band is correct;  copy it into the list, and the corrections into the image
+        //
+        for (; pos != positions.end(); ++pos) {
+            int const x = pos->getX();
+            int const y = pos->getY() - halo + r0;
+            assert(y >= r);
+
+            typename ImageT::x_iterator ptr = mimage.getImage()->at(x, y);
+            bool const ok = append(x, y, *ptr);
+            *ptr = bandImage(x, pos->getY());
+
+            if (!ok) {
+                reinstateCrPixels(mimage.getImage().get(), crpixels);
 
-            if (crp[1].row == crp[0].row && crp[1].col == crp[0].col + 1) {
-                //printf("  Adjoining!  Set next CRpix id = %i; x1=%i\n", crp[1].id, x1);
-                crp[1].id = id;
-                ++x1;
-            } else {
-                assert (y >= 0 && x0 >= 0 && x1 >= 0);
-                spans.push_back(detection::IdSpan::Ptr(new detection::IdSpan(id, y, x0, x1)));
-                //printf("  Not adjoining; adding span id=%i, y=%i, x = [%i, %i]\n", id, y, x0, x1);
+                throw LSST_EXCEPT(TooManyCrPixelsError,
+                                  (boost::format("Too many CR pixels (max %d)") % p.nCrPixelMax).str());
             }
         }
     }
-
-    // At the end of this loop, all crpixel entries have been assigned an ID,
-    // except for the "dummy" entry at the end of the array.
-    if (crpixels.size() > 0) {
-        for (crpixel_iter cp = crpixels.begin(); cp != crpixels.end() - 1; cp++) {
-            assert(cp->id >= 0);
-            assert(cp->col >= 0);
-            assert(cp->row >= 0);
-        }
-        // dummy:
-        assert(crpixels[crpixels.size()-1].id == -1);
-        assert(crpixels[crpixels.size()-1].col == 0);
-        assert(crpixels[crpixels.size()-1].row == -1);
-    }
-
-    for (std::vector<detection::IdSpan::Ptr>::iterator sp = spans.begin(), end = spans.end(); sp != end; sp++) {
-        assert((*sp)->id >= 0);
-        assert((*sp)->y >= 0);
-        assert((*sp)->x0 >= 0);
-        assert((*sp)->x1 >= (*sp)->x0);
-        for (std::vector<detection::IdSpan::Ptr>::iterator sp2 = sp + 1; sp2 != end; sp2++) {
-            assert((*sp2)->y >= (*sp)->y);
-            if ((*sp2)->y == (*sp)->y) {
-                assert((*sp2)->x0 > (*sp)->x1);
-            }
-        }
-    }
-
-/*
- * See if spans touch each other
- */
-    for (std::vector<detection::IdSpan::Ptr>::iterator sp = spans.begin(), end = spans.end();
-         sp != end; ++sp) {
-        int const y = (*sp)->y;
-        int const x0 = (*sp)->x0;
-        int const x1 = (*sp)->x1;
-
-        // this loop will probably run for only a few steps
-        for (std::vector<detection::IdSpan::Ptr>::iterator sp2 = sp + 1; sp2 != end; ++sp2) {
-            if ((*sp2)->y == y) {
-                // on this row (but not adjoining columns, since it would have been merged into this span);
-                // keep looking.
-                continue;
-            } else if ((*sp2)->y != (y + 1)) {
-                // sp2 is more than one row below; can't be connected.
-                break;
-            } else if ((*sp2)->x0 > (x1 + 1)) {
-                // sp2 is more than one column away to the right; can't be connected
-                break;
-            } else if ((*sp2)->x1 >= (x0 - 1)) {
-                // touches
-                int r1 = detection::resolve_alias(aliases, (*sp)->id);
-                int r2 = detection::resolve_alias(aliases, (*sp2)->id);
-                aliases[r1] = r2;
-            }
-        }
-    }
-
-
-
-
+    bandStarts.push_back(crpixels.size());
+}
 
 /*
- * Resolve aliases; first alias chains, then the IDs in the spans
- */
-    for (unsigned int i = 0; i != spans.size(); ++i) {
-        spans[i]->id = detection::resolve_alias(aliases, spans[i]->id);
-    }
-
-/*
- * Sort spans by ID, so we can sweep through them once
- */
-    if (spans.size() > 0) {
-        std::sort(spans.begin(), spans.end(), detection::IdSpanCompar());
-    }
-
-/*
- * Build Footprints from spans
+ * The second half of findCosmicRays:  given the candidate CRs, apply condition #1, remove the survivors,
+ * look for extra contaminated pixels around them, and set their mask bits
+ *
+ * mimage needn't be the whole frame (whose bounding box is frame), but it must include all the pixels
+ * within niteration + interp::singlePixelMaxData + 3 rows of each CR.  crpixels are the CRs' pixels (with
+ * their initial values already reinstated in mimage), followed by a dummy;  if keep is true, we append the
+ * pixels found while growing the CRs.  nCrPixelMax limits the number of CR pixels (including those in
+ * crpixels).
+ *
+ * Return false if there are too many CR pixels, in which case CRs isn't trustworthy and all the pixels in
+ * crpixels have been restored to their initial values
  */
-    std::vector<detection::Footprint::Ptr> CRs; // our cosmic rays
-
-    if (spans.size() > 0) {
-        int id = spans[0]->id;
-        unsigned int i0 = 0;            // initial value of i
-        for (unsigned int i = i0; i <= spans.size(); ++i) { // <= size to catch the last object
-            if (i == spans.size() || spans[i]->id != id) {
-                detection::Footprint::Ptr cr(new detection::Footprint(i - i0));
-
-                for (; i0 < i; ++i0) {
-                    cr->addSpan(spans[i0]->y, spans[i0]->x0, spans[i0]->x1);
-                }
-                CRs.push_back(cr);
-            }
-
-            if (i < spans.size()) {
-                id = spans[i]->id;
-            }
-        }
-    }
+template <typename MaskedImageT>
+bool cleanCRs(MaskedImageT &mimage,     // Image to search
+              geom::Box2I const &frame, // bounding box of the whole frame
+              std::vector<detection::Footprint::Ptr> &CRs, // the candidate CRs
+              std::vector<CRPixel<typename MaskedImageT::Image::Pixel> > &crpixels, // the CRs' pixels
+              int &seq,                 // sequence number of the next CR pixel
+              CrBackground const &bkgd, // unsubtracted background of frame, DN
+              CrParams const &p,        // parameters of the search
+              int const nCrPixelMax,    // maximum number of contaminated pixels
+              bool const keep,          // if true, don't remove the CRs
+              SigmaPlane const &sigma,  // mimage's standard deviation; may be empty
+              CosmicRayStats &stats     // statistics to update
+             )
+{
+    typedef typename MaskedImageT::Image ImageT;
+    typedef typename ImageT::Pixel ImagePixel;
+    typedef typename MaskedImageT::Mask::Pixel MaskPixel;
+    typedef typename std::vector<CRPixel<ImagePixel> >::reverse_iterator crpixel_riter;
 
-    reinstateCrPixels(mimage.getImage().get(), crpixels);
 /*
  * apply condition #1
  */
+    CR_STATS(StageTimer condition1Timer(stats.condition1Time);)
+    CR_STATS(stats.nCrBeforeCondition1 += CRs.size();)
     CountsInCR<ImageT> CountDN(*mimage.getImage(), bkgd);
     for (std::vector<detection::Footprint::Ptr>::iterator cr = CRs.begin(), end = CRs.end();
          cr != end; ++cr) {
@@ -599,7 +1025,7 @@ findCosmicRays(MaskedImageT &mimage,      ///< Image to search
 
         LOGL_DEBUG("TRACE4.algorithms.CR", "CR at (%d, %d) has %g DN",
                    (*cr)->getBBox().getMinX(), (*cr)->getBBox().getMinY(), CountDN.getCounts());
-        if (CountDN.getCounts() < minDn) { /* not bright enough */
+        if (CountDN.getCounts() < p.minDn) { /* not bright enough */
             LOGL_DEBUG("TRACE5.algorithms.CR", "Erasing CR");
 
             cr = CRs.erase(cr);
@@ -607,14 +1033,17 @@ findCosmicRays(MaskedImageT &mimage,      ///< Image to search
             --end;
         }
     }
-    ncr = CRs.size();           /* some may have been too faint */
+    CR_STATS(stats.nCrAfterCondition1 += CRs.size();)
+    CR_STATS(condition1Timer.stop();)
 /*
  * We've found them all, time to kill them all
  */
     bool const debias_values = true;
     bool grow = false;
+    detail::PixelRandom const rand(p.randomSeed); // the same for each pass, and each part of the frame
     LOGL_DEBUG("TRACE2.algorithms.CR", "Removing initial list of CRs");
-    removeCR(mimage, CRs, bkgd, crBit, saturBit, badMask, debias_values, grow);
+    removeCR(mimage, frame, CRs, bkgd, p.crBit, p.saturBit, p.badMask, debias_values, grow, sigma, rand,
+             stats);
 #if 0                                   // Useful to see phase 2 in ds9; debugging only
     (void)setMaskFromFootprintList(mimage.getMask().get(), CRs,
                                    mimage.getMask()->getPlaneBitMask("DETECTED"));
@@ -628,79 +1057,51 @@ findCosmicRays(MaskedImageT &mimage,      ///< Image to search
  */
     bool too_many_crs = false;          // we've seen too many CR pixels
     int nextra = 0;                     // number of pixels added to list of CRs
-    for (int i = 0; i != niteration && !too_many_crs; ++i) {
-        LOGL_DEBUG("TRACE1.algorithms.CR", "Starting iteration %d", i);
-        for (std::vector<detection::Footprint::Ptr>::iterator fiter = CRs.begin();
-             fiter != CRs.end(); fiter++) {
-            detection::Footprint::Ptr cr = *fiter;
+    std::vector<std::uint8_t> visited;  // workspace for growCR
+    LOGL_DEBUG("TRACE1.algorithms.CR", "Growing %d CRs for up to %d iterations",
+               static_cast<int>(CRs.size()), p.niteration);
+    CR_STATS(StageTimer growTimer(stats.growTime);)
+    CR_STATS(
+        if (static_cast<int>(stats.nGrownPerIteration.size()) < p.niteration) {
+            stats.nGrownPerIteration.resize(p.niteration, 0);
+        }
+    )
+    for (std::vector<detection::Footprint::Ptr>::iterator fiter = CRs.begin(); fiter != CRs.end(); ++fiter) {
+        detection::Footprint::Ptr cr = *fiter;
 /*
  * Are all those `CR' pixels interpolated?  If so, don't grow it
  */
-            {
-                detection::Footprint::Ptr om = footprintAndMask(cr, mimage.getMask(), interpBit);
-                int const npix = (om) ? om->getNpix() : 0;
-
-                if (static_cast<std::size_t>(npix) == cr->getNpix()) {
-                    continue;
+        bool allInterpolated = true;
+        for (detection::Footprint::SpanList::const_iterator siter = cr->getSpans().begin();
+             allInterpolated && siter != cr->getSpans().end(); ++siter) {
+            typename MaskedImageT::Mask::x_iterator mask =
+                mimage.getMask()->row_begin((*siter)->getY() - mimage.getY0());
+            for (int x = (*siter)->getX0() - mimage.getX0(); x <= (*siter)->getX1() - mimage.getX0(); ++x) {
+                if (!(mask[x] & p.interpBit)) {
+                    allInterpolated = false;
+                    break;
                 }
             }
+        }
+        if (allInterpolated) {
+            continue;
+        }
 /*
  * No; some of the suspect pixels aren't interpolated
  */
-            detection::Footprint extra;                     // extra pixels added to cr
-            for (detection::Footprint::SpanList::const_iterator siter = cr->getSpans().begin();
-                 siter != cr->getSpans().end(); siter++) {
-                detection::Span::Ptr const span = *siter;
-
-                /*
-                 * Check the lines above and below the span.  We're going to check a 3x3 region around
-                 * the pixels, so we need a buffer around the edge.  We check the pixels just to the
-                 * left/right of the span, so the buffer needs to be 2 pixels (not just 1) in the
-                 * column direction, but only 1 in the row direction.
-                 */
-                int const y = span->getY() - mimage.getY0();
-                if (y < 2 || y >= nrow - 2) {
-                    continue;
-                }
-                int x0 = span->getX0() - mimage.getX0();
-                int x1 = span->getX1() - mimage.getX0();
-                x0 = (x0 < 2) ? 2 : (x0 > ncol - 3) ? ncol - 3 : x0;
-                x1 = (x1 < 2) ? 2 : (x1 > ncol - 3) ? ncol - 3 : x1;
-
-                checkSpanForCRs(&extra, crpixels, y - 1, x0, x1, mimage,
-                                minSigma/2, thresH, thresV, thresD, bkgd, 0, keep);
-                checkSpanForCRs(&extra, crpixels, y,     x0, x1, mimage,
-                                minSigma/2, thresH, thresV, thresD, bkgd, 0, keep);
-                checkSpanForCRs(&extra, crpixels, y + 1, x0, x1, mimage,
-                                minSigma/2, thresH, thresV, thresD, bkgd, 0, keep);
-            }
-
-            if (extra.getSpans().size() > 0) {      // we added some pixels
-                if (nextra + static_cast<int>(crpixels.size()) > nCrPixelMax) {
-                    too_many_crs = true;
-                    break;
-                }
-
-                nextra += extra.getNpix();
-
-                detection::Footprint::SpanList &espans = extra.getSpans();
-                for (detection::Footprint::SpanList::const_iterator siter = espans.begin();
-                     siter != espans.end(); siter++) {
-                    cr->addSpan(**siter);
-                }
-                cr->normalize();
-            }
-        }
-
-        if (nextra == 0) {
+        if (!growCR(*cr, mimage, frame, crpixels, seq, nextra, bkgd, p.minSigma/2,
+                    p.thresH, p.thresV, p.thresD, p.niteration, nCrPixelMax, keep, sigma, visited,
+                    stats.nGrownPerIteration)) {
+            too_many_crs = true;
             break;
         }
     }
+    CR_STATS(growTimer.stop();)
 /*
  * mark those pixels as CRs
  */
     if (!too_many_crs) {
-        (void)setMaskFromFootprintList(mimage.getMask().get(), CRs, crBit);
+        (void)setMaskFromFootprintList(mimage.getMask().get(), CRs, static_cast<MaskPixel>(p.crBit));
     }
 /*
  * Maybe reinstate initial values; n.b. the same pixel may appear twice, so we want the
@@ -728,22 +1129,724 @@ findCosmicRays(MaskedImageT &mimage,      ///< Image to search
         if (true || nextra > 0) {
             grow = true;
             LOGL_DEBUG("TRACE2.algorithms.CR", "Removing final list of CRs, grow = %d", grow);
-            removeCR(mimage, CRs, bkgd, crBit, saturBit, badMask, debias_values, grow);
+            removeCR(mimage, frame, CRs, bkgd, p.crBit, p.saturBit, p.badMask, debias_values, grow, sigma,
+                     rand, stats);
         }
 /*
  * we interpolated over all CR pixels, so set the interp bits too
  */
         (void)setMaskFromFootprintList(mimage.getMask().get(), CRs,
-                                       static_cast<MaskPixel>(crBit | interpBit));
+                                       static_cast<MaskPixel>(p.crBit | p.interpBit));
+    }
+
+    return !too_many_crs;
+}
+}
+
+namespace {
+/*
+ * The body of findCosmicRays, given the parameters derived from the PSF and Policy
+ */
+template <typename MaskedImageT>
+std::vector<detection::Footprint::Ptr>
+findCosmicRaysWithParams(MaskedImageT &mimage,      // Image to search
+                         CrBackground const &bkgd,  // unsubtracted background of frame, DN
+                         CrParams const &p,         // parameters from the PSF and Policy
+                         bool const keep,           // if true, don't remove the CRs
+                         CosmicRayStats &stats,     // statistics to update
+                         image::Image<float> const *sigmaImage = NULL // mimage's standard deviation, or NULL
+                        ) {
+    CR_STATS(StageTimer totalTimer(stats.totalTime);)
+    typedef typename MaskedImageT::Image ImageT;
+    typedef typename ImageT::Pixel ImagePixel;
+/*
+ * Go through the frame looking at each pixel (except the edge ones which we ignore)
+ */
+    int const nrow = mimage.getHeight();
+    /*
+     * Use the caller's standard deviation if we have it;  otherwise the square roots are taken as needed
+     */
+    SigmaPlane sigma;
+    if (sigmaImage) {
+        if (sigmaImage->getWidth() != mimage.getWidth() || sigmaImage->getHeight() != nrow) {
+            throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
+                              (boost::format("Sigma image is %dx%d, but image is %dx%d") %
+                               sigmaImage->getWidth() % sigmaImage->getHeight() %
+                               mimage.getWidth() % mimage.getHeight()).str());
+        }
+        sigma.set(*sigmaImage);
+    }
+
+    std::vector<CRPixel<ImagePixel> > crpixels; // storage for detected CR-contaminated pixels
+    int seq = 0;                        // sequence number of the next CR pixel
+    typedef typename std::vector<CRPixel<ImagePixel> >::iterator crpixel_iter;
+    /*
+     * If we've been asked to use more than one thread, split the frame into row bands
+     */
+    int nBand = 1;                      // number of row bands
+    if (p.nThread > 1) {
+        int const minBandRows = 64;     // fewest rows worth giving a band of their own
+        nBand = std::min(p.nThread, (nrow - 2)/minBandRows);
+        if (nBand < 1) {
+            nBand = 1;
+        }
+    }
+    std::vector<std::size_t> bandStarts; // index of first CR pixel in each band, then crpixels.size()
+
+    CR_STATS(StageTimer scanTimer(stats.scanTime);)
+    if (nBand == 1) {
+        AppendCRPixel<ImagePixel> append(crpixels, seq, mimage.getX0(), mimage.getY0(), p.nCrPixelMax);
+
+        for (int j = 1; j < nrow - 1; ++j) {
+            if (!scanRowForCRs(mimage, j, p.minSigma, p.thresH, p.thresV, p.thresD, bkgd, p.cond3Fac,
+                               p.badMask, p.interpBit, sigma.row(j), append)) {
+                reinstateCrPixels(mimage.getImage().get(), crpixels);
+
+                throw LSST_EXCEPT(TooManyCrPixelsError,
+                                  (boost::format("Too many CR pixels (max %d)") % p.nCrPixelMax).str());
+            }
+        }
+        bandStarts.push_back(0);
+        bandStarts.push_back(crpixels.size());
+    } else {
+        findCRPixelsInBands(crpixels, bandStarts, seq, mimage, nBand, bkgd, p, sigma);
+    }
+    CR_STATS(scanTimer.stop();)
+    CR_STATS(stats.nCandidatePixel += crpixels.size();)
+/*
+ * We've found them on a pixel-by-pixel basis, now merge those pixels
+ * into cosmic rays
+ */
+    CR_STATS(StageTimer mergeTimer(stats.mergeTime);)
+    std::vector<detection::IdSpan> spans; // y:x0,x1 for objects
+    spans.reserve(1 + crpixels.size()/2); // initial size of spans
+
+    /**
+     In this loop, we look for strings of CRpixels on the same row and adjoining columns;
+     each of these becomes a Span with a unique ID.  The bands are independent (no span
+     crosses from one to the next), so we do them in parallel and renumber the IDs afterwards
+     */
+
+    int ncr = 0;                        // number of detected cosmic rays
+    if (!crpixels.empty()) {
+        // I am dummy
+        CRPixel<ImagePixel> dummy(0, -1, 0, seq++, -1);
+        crpixels.push_back(dummy);
+
+        if (nBand == 1) {
+            ncr = makeIdSpans<ImagePixel>(crpixels.begin(), crpixels.end() - 1, 0, spans);
+        } else {
+            std::vector<std::vector<detection::IdSpan> > bandSpans(nBand);
+            std::vector<int> bandNcr(nBand);
+
+            detail::parallelFor(nBand, p.nThread, [&](int b) {
+                bandNcr[b] = makeIdSpans<ImagePixel>(crpixels.begin() + bandStarts[b],
+                                                     crpixels.begin() + bandStarts[b + 1], 0, bandSpans[b]);
+            });
+            for (int b = 0; b != nBand; ++b) {
+                for (std::vector<detection::IdSpan>::iterator sp = bandSpans[b].begin();
+                     sp != bandSpans[b].end(); ++sp) {
+                    sp->id += ncr;
+                }
+                spans.insert(spans.end(), bandSpans[b].begin(), bandSpans[b].end());
+                for (crpixel_iter crp = crpixels.begin() + bandStarts[b];
+                     crp != crpixels.begin() + bandStarts[b + 1]; ++crp) {
+                    crp->id += ncr;
+                }
+                ncr += bandNcr[b];
+            }
+        }
     }
 
+    CR_STATS(stats.nSpan += spans.size();)
+
+    // At the end of this loop, all crpixel entries have been assigned an ID,
+    // except for the "dummy" entry at the end of the array.
+    if (crpixels.size() > 0) {
+        for (crpixel_iter cp = crpixels.begin(); cp != crpixels.end() - 1; cp++) {
+            assert(cp->id >= 0);
+            assert(cp->col >= 0);
+            assert(cp->row >= 0);
+        }
+        // dummy:
+        assert(crpixels[crpixels.size()-1].id == -1);
+        assert(crpixels[crpixels.size()-1].col == 0);
+        assert(crpixels[crpixels.size()-1].row == -1);
+    }
+
+    // The spans are in row-major order, and don't overlap
+    for (std::size_t i = 0; i != spans.size(); ++i) {
+        assert(spans[i].id == static_cast<int>(i) + 1);
+        assert(spans[i].y >= 0);
+        assert(spans[i].x0 >= 0);
+        assert(spans[i].x1 >= spans[i].x0);
+        if (i > 0) {
+            assert(spans[i].y > spans[i - 1].y ||
+                   (spans[i].y == spans[i - 1].y && spans[i].x0 > spans[i - 1].x1));
+        }
+    }
+
+/*
+ * See if spans touch each other (this also stitches together CRs that cross the boundaries between bands).
+ *
+ * We sweep down pairs of adjacent rows;  within a row the spans are sorted and disjoint, so the first span
+ * in the next row that could touch a span never moves to the left.  The merges are made in the same order
+ * as an exhaustive search would make them, which matters for the sets' labels
+ */
+    DisjointSet cosmicRays(ncr + 1);    // ID 0 isn't used
+    {
+        std::size_t const nspan = spans.size();
+        std::size_t rowStart = 0;       // first span in this row
+        while (rowStart < nspan) {
+            int const y = spans[rowStart].y;
+            std::size_t nextStart = rowStart; // first span in the next row
+            while (nextStart < nspan && spans[nextStart].y == y) {
+                ++nextStart;
+            }
+            if (nextStart < nspan && spans[nextStart].y == y + 1) {
+                std::size_t first = nextStart; // first span in the next row that might touch sp
+                for (std::size_t sp = rowStart; sp != nextStart; ++sp) {
+                    int const x0 = spans[sp].x0;
+                    int const x1 = spans[sp].x1;
+
+                    while (first < nspan && spans[first].y == y + 1 && spans[first].x1 < x0 - 1) {
+                        ++first;
+                    }
+                    for (std::size_t sp2 = first;
+                         sp2 < nspan && spans[sp2].y == y + 1 && spans[sp2].x0 <= x1 + 1; ++sp2) {
+                        cosmicRays.merge(spans[sp].id, spans[sp2].id); // touches
+                    }
+                }
+            }
+            rowStart = nextStart;
+        }
+    }
+
+/*
+ * Label the spans with their CR, and sort them by label so each CR's spans are contiguous
+ */
+    for (std::vector<detection::IdSpan>::iterator sp = spans.begin(); sp != spans.end(); ++sp) {
+        sp->id = cosmicRays.getLabel(sp->id);
+    }
+    std::sort(spans.begin(), spans.end(), detection::IdSpanCompar());
+
+/*
+ * Build Footprints from spans
+ */
+    std::vector<detection::Footprint::Ptr> CRs; // our cosmic rays
+
+    for (std::size_t i0 = 0; i0 != spans.size(); ) {
+        std::size_t i = i0 + 1;         // one past the CR's last span
+        while (i != spans.size() && spans[i].id == spans[i0].id) {
+            ++i;
+        }
+
+        detection::Footprint::Ptr cr(new detection::Footprint(i - i0));
+        for (; i0 != i; ++i0) {
+            cr->addSpan(spans[i0].y, spans[i0].x0, spans[i0].x1);
+        }
+        CRs.push_back(cr);
+    }
+    CR_STATS(mergeTimer.stop();)
+
+    reinstateCrPixels(mimage.getImage().get(), crpixels);
+
+    bool const too_many_crs = !cleanCRs(mimage, mimage.getBBox(image::PARENT), CRs, crpixels, seq, bkgd, p,
+                                        p.nCrPixelMax, keep, sigma, stats);
     if (too_many_crs) {                 // we've cleaned up, so we can throw the exception
-        throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
-                          (boost::format("Too many CR pixels (max %d)") % nCrPixelMax).str());
+        throw LSST_EXCEPT(TooManyCrPixelsError,
+                          (boost::format("Too many CR pixels (max %d)") % p.nCrPixelMax).str());
     }
 
     return CRs;
 }
+}
+
+/*!
+ * @brief Find cosmic rays in an Image, and mask and remove them
+ *
+ * findCosmicRays keeps no global state, so it may be called from several threads at once (e.g. to process
+ * the CCDs of a focal plane in parallel) as long as each call has its own image, and the PSF is either not
+ * shared or safe to use from several threads; the results don't depend on what the other threads are doing.
+ * The same is true of findCosmicRaysStreaming.  See also findCosmicRaysBatch.
+ *
+ * @return vector of CR's Footprints
+ *
+ * @throw TooManyCrPixelsError if there are more than the Policy's nCrPixelMax CR pixels
+ */
+template <typename MaskedImageT>
+std::vector<detection::Footprint::Ptr>
+findCosmicRays(MaskedImageT &mimage,      ///< Image to search
+               detection::Psf const &psf, ///< the Image's PSF
+               double const bkgd,         ///< unsubtracted background of frame, DN
+               lsst::pex::policy::Policy const &policy, ///< Policy directing the behavior
+               bool const keep                          ///< if true, don't remove the CRs
+              ) {
+    CosmicRayStats stats;
+    return findCosmicRays(mimage, psf, bkgd, policy, keep, stats);
+}
+
+/*!
+ * @brief Find cosmic rays in an Image, and mask and remove them, reporting where the time went
+ *
+ * Each stage's time and counts are added to stats, so the same object may be used to accumulate the
+ * statistics from several calls
+ *
+ * @return vector of CR's Footprints
+ */
+template <typename MaskedImageT>
+std::vector<detection::Footprint::Ptr>
+findCosmicRays(MaskedImageT &mimage,      ///< Image to search
+               detection::Psf const &psf, ///< the Image's PSF
+               double const bkgd,         ///< unsubtracted background of frame, DN
+               lsst::pex::policy::Policy const &policy, ///< Policy directing the behavior
+               bool const keep,                         ///< if true, don't remove the CRs
+               CosmicRayStats &stats                    ///< statistics to update
+              ) {
+    CrParams p = makeCrParams<typename MaskedImageT::Mask>(policy);
+    setCrThresholds(p, psf);
+
+    return findCosmicRaysWithParams(mimage, CrBackground(bkgd), p, keep, stats);
+}
+
+/*!
+ * @brief Find cosmic rays in an Image, and mask and remove them, given a background that varies over the
+ * Image (e.g. from amplifier to amplifier)
+ *
+ * This saves the caller from subtracting the background from (a copy of) the Image first.  The background
+ * is evaluated in the Image's parent frame, but only where it's needed (at pixels that might be CRs, and
+ * around the CRs), so this is almost as fast as passing a number; a constant background gives the same
+ * results as passing its value.
+ *
+ * @return vector of CR's Footprints
+ */
+template <typename MaskedImageT>
+std::vector<detection::Footprint::Ptr>
+findCosmicRays(MaskedImageT &mimage,      ///< Image to search
+               detection::Psf const &psf, ///< the Image's PSF
+               math::BoundedField const &bkgd, ///< unsubtracted background of frame, DN
+               lsst::pex::policy::Policy const &policy, ///< Policy directing the behavior
+               bool const keep                          ///< if true, don't remove the CRs
+              ) {
+    CrParams p = makeCrParams<typename MaskedImageT::Mask>(policy);
+    setCrThresholds(p, psf);
+
+    CosmicRayStats stats;
+    return findCosmicRaysWithParams(mimage, CrBackground(bkgd), p, keep, stats);
+}
+
+/*!
+ * @brief Find cosmic rays in an Image, and mask and remove them, given the standard deviation of each pixel
+ *
+ * This saves findCosmicRays from taking the square root of the variance plane, when the caller already
+ * has it (e.g. to make a signal-to-noise image); sigma's values are used instead.
+ *
+ * @return vector of CR's Footprints
+ *
+ * @throw lsst::pex::exceptions::LengthError if sigma and mimage differ in size
+ */
+template <typename MaskedImageT>
+std::vector<detection::Footprint::Ptr>
+findCosmicRays(MaskedImageT &mimage,      ///< Image to search
+               image::Image<float> const &sigma, ///< standard deviation of each of mimage's pixels
+               detection::Psf const &psf, ///< the Image's PSF
+               double const bkgd,         ///< unsubtracted background of frame, DN
+               lsst::pex::policy::Policy const &policy, ///< Policy directing the behavior
+               bool const keep                          ///< if true, don't remove the CRs
+              ) {
+    CrParams p = makeCrParams<typename MaskedImageT::Mask>(policy);
+    setCrThresholds(p, psf);
+
+    CosmicRayStats stats;
+    return findCosmicRaysWithParams(mimage, CrBackground(bkgd), p, keep, stats, &sigma);
+}
+
+/*!
+ * @brief Find cosmic rays in a set of Images (e.g. the CCDs of a focal plane), and mask and remove them
+ *
+ * The Policy is parsed once, and the thresholds are calculated once for each distinct Psf before any
+ * threads are started (so the Psfs needn't be safe to use from several threads).  The images are then
+ * handed out to policy's nThreads threads as they become free, each image being processed by a single
+ * thread; the results are identical to calling findCosmicRays on each image in turn.
+ *
+ * Errors are reported per image rather than thrown:  an image with too many CR pixels (for which
+ * findCosmicRays would throw TooManyCrPixelsError) is left as findCosmicRays would leave it and is flagged
+ * TOO_MANY_CRS;  any other failure, including any other LengthError, is flagged FAILED.
+ *
+ * @return the results for each image, in the same order as images
+ *
+ * @throw lsst::pex::exceptions::LengthError if images, psfs, and bkgds are not all the same length
+ */
+template <typename MaskedImageT>
+std::vector<CosmicRayBatchResult>
+findCosmicRaysBatch(std::vector<std::shared_ptr<MaskedImageT> > const& images, ///< Images to search
+                    std::vector<std::shared_ptr<detection::Psf const> > const& psfs, ///< the Images' PSFs
+                    std::vector<double> const& bkgds, ///< unsubtracted backgrounds of the Images, DN
+                    lsst::pex::policy::Policy const &policy, ///< Policy directing the behavior
+                    bool const keep                          ///< if true, don't remove the CRs
+                   ) {
+    int const nImage = images.size();
+    if (psfs.size() != images.size() || bkgds.size() != images.size()) {
+        throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
+                          (boost::format("Saw %d images but %d psfs and %d backgrounds") %
+                           images.size() % psfs.size() % bkgds.size()).str());
+    }
+
+    std::vector<CosmicRayBatchResult> results(nImage);
+    CrParams const common = makeCrParams<typename MaskedImageT::Mask>(policy);
+    std::vector<CrParams> params(nImage, common);
+    std::map<detection::Psf const *, int> seen; // index of the first image to use each Psf
+    for (int i = 0; i != nImage; ++i) {
+        params[i].nThread = 1;          // we're parallelising over images instead
+
+        if (!images[i] || !psfs[i]) {
+            results[i].status = CosmicRayBatchResult::FAILED;
+            results[i].message = !images[i] ? "No image provided" : "No Psf provided";
+            continue;
+        }
+
+        std::map<detection::Psf const *, int>::const_iterator const first = seen.find(psfs[i].get());
+        if (first != seen.end()) {
+            params[i] = params[first->second];
+            continue;
+        }
+        try {
+            setCrThresholds(params[i], *psfs[i]);
+            seen[psfs[i].get()] = i;
+        } catch (std::exception &e) {
+            results[i].status = CosmicRayBatchResult::FAILED;
+            results[i].message = e.what();
+        }
+    }
+
+    detail::parallelFor(nImage, common.nThread, [&](int i) {
+        CosmicRayBatchResult &result = results[i];
+        if (result.status != CosmicRayBatchResult::OK) {
+            return;
+        }
+        try {
+            result.crs = findCosmicRaysWithParams(*images[i], CrBackground(bkgds[i]), params[i], keep,
+                                                  result.stats);
+        } catch (TooManyCrPixelsError &e) {
+            result.status = CosmicRayBatchResult::TOO_MANY_CRS;
+            result.message = e.what();
+        } catch (std::exception &e) {
+            result.status = CosmicRayBatchResult::FAILED;
+            result.message = e.what();
+        }
+    });
+
+    return results;
+}
+
+namespace {
+/*
+ * A CR that findCosmicRaysStreaming is assembling, one row at a time
+ */
+template <typename ImagePixel>
+struct CRComponent {
+    explicit CRComponent(int minY) : minY(minY), maxY(minY) {}
+
+    std::vector<detection::IdSpan> spans; // the CR's spans (their IDs are meaningless)
+    std::vector<CRPixel<ImagePixel> > pixels; // the CR's pixels, with their initial values
+    int minY, maxY;                     // the rows (in the parent frame) that the CR occupies
+};
+
+/*
+ * Return a new image containing rows [y0, y1) of the frame, copied from the parts of image (which
+ * has the same columns as the new image) and band that are in that range
+ */
+template <typename MaskedImageT>
+std::shared_ptr<MaskedImageT> copyRows(std::shared_ptr<MaskedImageT> const& image, // may be empty
+                                       MaskedImageT const& band, // some rows just after image
+                                       int const y0, int const y1 // desired range of rows
+                                      )
+{
+    geom::Box2I const bbox(geom::Point2I(band.getX0(), y0), geom::Extent2I(band.getWidth(), y1 - y0));
+    std::shared_ptr<MaskedImageT> out(new MaskedImageT(bbox));
+
+    if (image && image->getY0() + image->getHeight() > y0) {
+        geom::Box2I const oldBBox(geom::Point2I(band.getX0(), y0),
+                                  geom::Point2I(band.getX0() + band.getWidth() - 1,
+                                                image->getY0() + image->getHeight() - 1));
+        MaskedImageT dest(*out, oldBBox, image::PARENT, false);
+        dest <<= MaskedImageT(*image, oldBBox, image::PARENT, false);
+    }
+    MaskedImageT dest(*out, band.getBBox(image::PARENT), image::PARENT, false);
+    dest <<= band;
+
+    return out;
+}
+}
+
+/*!
+ * @brief Find cosmic rays in an image that's too large to hold in memory, and mask and remove them
+ *
+ * The image is read from source a band of rows at a time (policy entry streamBandHeight; default 256),
+ * and we only hold the rows that can still be affected by CRs that we haven't finished with; the memory
+ * used thus depends on the width of the image and the height of the tallest CR, but not on the height
+ * of the image.  Rows are written back to source as soon as we've finished with them, and each CR's
+ * Footprint is passed to callback once it's been cleaned.
+ *
+ * The candidate CRs are the same as those that findCosmicRays would find, but they're removed and grown
+ * in batches as the rows that they need become available rather than all at once; as the growth step looks
+ * at the interpolated pixels, a CR's final extent (as well as its interpolated values) may differ slightly.
+ *
+ * If there are too many CR pixels the rows that we're still holding are returned to source with their
+ * initial values and a TooManyCrPixelsError is thrown;  rows that have already been written are not
+ * revisited.
+ */
+template <typename MaskedImageT>
+void
+findCosmicRaysStreaming(CosmicRayRowSource<MaskedImageT> &source, ///< source of the image's rows
+                        detection::Psf const &psf, ///< the Image's PSF
+                        double const bkgd,         ///< unsubtracted background of frame, DN
+                        lsst::pex::policy::Policy const &policy, ///< Policy directing the behavior
+                        std::function<void (detection::Footprint::Ptr)> const& callback, ///< called for each CR
+                        bool const keep            ///< if true, don't remove the CRs
+                       )
+{
+    typedef typename MaskedImageT::Image::Pixel ImagePixel;
+    typedef CRComponent<ImagePixel> Component;
+
+    CrParams p = makeCrParams<typename MaskedImageT::Mask>(policy);
+    setCrThresholds(p, psf);
+    int const bandHeight = policy.exists("streamBandHeight") ? policy.getInt("streamBandHeight") : 256;
+    if (bandHeight < 1) {
+        throw LSST_EXCEPT(pexExcept::InvalidParameterError,
+                          (boost::format("streamBandHeight must be positive; saw %d") % bandHeight).str());
+    }
+
+    geom::Box2I const frame = source.getBBox();
+    CrBackground const background(bkgd);
+    int const frameY0 = frame.getMinY();
+    int const nrow = frame.getHeight();
+    /*
+     * Cleaning a CR can read or write pixels up to margin rows away from it:  niteration rows of growth,
+     * the rows that the interpolation reads, and one for the check for adjacent saturated pixels.  The
+     * interpolation usually reads 2 rows, but if it falls back to interp::singlePixel (e.g. for a CR on a bad
+     * column) that reads further, and treats the ends of the window as the edges of the frame
+     */
+    int const margin = p.niteration + interp::singlePixelMaxData + 2 + 1;
+    SigmaPlane const noSigma;           // we take the square roots as needed
+    CosmicRayStats stats;               // we don't report these
+
+    std::shared_ptr<MaskedImageT> window; // the rows that we're holding, [w0, w1) relative to frameY0
+    int w0 = 0, w1 = 0;
+    int next = 1;                       // the next row to search (relative to frameY0)
+
+    std::map<int, Component> open;      // CRs that have pixels in row next - 1, indexed by ID
+    int lastId = 0;                     // the last ID that we allocated
+    std::vector<detection::IdSpan> prevSpans; // the spans in row next - 1, labelled with their CR's ID
+    std::vector<Component> finished;    // complete CRs that we haven't yet cleaned
+    std::deque<CRPixel<ImagePixel> > corrected; // pixels whose preliminary corrections are still present
+    int nCrPixel = 0;                   // number of CR pixels found so far
+    int nCrPixelCleaned = 0;            // number of CR pixels in CRs that we've cleaned
+    int seq = 0;                        // sequence number of the next CR pixel
+    /*
+     * Give up:  put back the pixels that we've changed but not cleaned, return the rows that we're holding,
+     * and complain
+     */
+    auto tooManyCRs = [&]() {
+        for (typename std::deque<CRPixel<ImagePixel> >::const_iterator crp = corrected.begin();
+             crp != corrected.end(); ++crp) {
+            window->at(crp->col - window->getX0(), crp->row - window->getY0()).image() = crp->val;
+        }
+        if (w1 > w0) {
+            source.writeRows(MaskedImageT(*window, geom::Box2I(geom::Point2I(frame.getMinX(), frameY0 + w0),
+                                                               geom::Extent2I(frame.getWidth(), w1 - w0)),
+                                          image::PARENT, false));
+        }
+
+        throw LSST_EXCEPT(TooManyCrPixelsError,
+                          (boost::format("Too many CR pixels (max %d)") % p.nCrPixelMax).str());
+    };
+
+    while (w0 < nrow) {
+        /*
+         * Read another band of rows
+         */
+        if (w1 < nrow) {
+            int const n = std::min(bandHeight, nrow - w1);
+            std::shared_ptr<MaskedImageT> band = source.readRows(frameY0 + w1, n);
+            if (!band || band->getBBox(image::PARENT) !=
+                geom::Box2I(geom::Point2I(frame.getMinX(), frameY0 + w1), geom::Extent2I(frame.getWidth(), n))) {
+                throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
+                                  (boost::format("Expected rows %d..%d from the CosmicRayRowSource") %
+                                   (frameY0 + w1) % (frameY0 + w1 + n - 1)).str());
+            }
+            window = copyRows(window, *band, frameY0 + w0, frameY0 + w1 + n);
+            w1 += n;
+        }
+        bool const allRead = (w1 == nrow);
+        /*
+         * Search all the rows whose neighbours we have, assembling their pixels into CRs
+         */
+        for (int const end = allRead ? nrow - 1 : w1 - 1; next < end; ++next) {
+            std::vector<CRPixel<ImagePixel> > rowPixels; // the CR pixels in this row
+            AppendCRPixel<ImagePixel> append(rowPixels, seq, window->getX0(), window->getY0(),
+                                             p.nCrPixelMax - nCrPixel);
+            if (!scanRowForCRs(*window, next - w0, p.minSigma, p.thresH, p.thresV, p.thresD, background,
+                               p.cond3Fac, p.badMask, p.interpBit, NULL, append)) {
+                corrected.insert(corrected.end(), rowPixels.begin(), rowPixels.end());
+                tooManyCRs();
+            }
+            nCrPixel += rowPixels.size();
+            corrected.insert(corrected.end(), rowPixels.begin(), rowPixels.end());
+            //
+            // Run-length encode the pixels into spans, and see which CRs in the previous row they touch
+            //
+            std::vector<detection::IdSpan> spans;
+            for (std::size_t i = 0; i != rowPixels.size(); ++i) {
+                if (i > 0 && rowPixels[i].col == rowPixels[i - 1].col + 1) {
+                    ++spans.back().x1;
+                } else {
+                    spans.push_back(detection::IdSpan(-1, rowPixels[i].row, rowPixels[i].col, rowPixels[i].col));
+                }
+            }
+
+            for (std::vector<detection::IdSpan>::iterator sp = spans.begin(); sp != spans.end(); ++sp) {
+                for (std::vector<detection::IdSpan>::const_iterator sp2 = prevSpans.begin();
+                     sp2 != prevSpans.end(); ++sp2) {
+                    if (sp2->x0 > sp->x1 + 1) {
+                        break;
+                    } else if (sp2->x1 < sp->x0 - 1 || sp2->id == sp->id) {
+                        continue;
+                    }
+
+                    if (sp->id < 0) {   // the first CR that this span touches
+                        sp->id = sp2->id;
+                    } else {            // this span joins two CRs; merge sp2's into sp's
+                        int const oldId = sp2->id;
+                        Component &cr = open.find(sp->id)->second;
+                        Component &old = open.find(oldId)->second;
+
+                        cr.spans.insert(cr.spans.end(), old.spans.begin(), old.spans.end());
+                        cr.pixels.insert(cr.pixels.end(), old.pixels.begin(), old.pixels.end());
+                        cr.minY = std::min(cr.minY, old.minY);
+                        open.erase(oldId);
+
+                        for (std::vector<detection::IdSpan>::iterator sp3 = prevSpans.begin();
+                             sp3 != prevSpans.end(); ++sp3) {
+                            if (sp3->id == oldId) {
+                                sp3->id = sp->id;
+                            }
+                        }
+                        for (std::vector<detection::IdSpan>::iterator sp3 = spans.begin(); sp3 != sp; ++sp3) {
+                            if (sp3->id == oldId) {
+                                sp3->id = sp->id;
+                            }
+                        }
+                    }
+                }
+
+                if (sp->id < 0) {       // a new CR
+                    sp->id = ++lastId;
+                    open.insert(std::make_pair(sp->id, Component(sp->y)));
+                }
+            }
+            //
+            // Add this row's spans and pixels to their CRs
+            //
+            std::size_t i = 0;          // index into rowPixels
+            for (std::vector<detection::IdSpan>::const_iterator sp = spans.begin(); sp != spans.end(); ++sp) {
+                Component &cr = open.find(sp->id)->second;
+                cr.spans.push_back(*sp);
+                cr.maxY = sp->y;
+                for (; i != rowPixels.size() && rowPixels[i].col <= sp->x1; ++i) {
+                    cr.pixels.push_back(rowPixels[i]);
+                }
+            }
+            //
+            // CRs with no pixels in this row are complete
+            //
+            for (typename std::map<int, Component>::iterator cr = open.begin(); cr != open.end(); ) {
+                if (cr->second.maxY < frameY0 + next) {
+                    finished.push_back(std::move(cr->second));
+                    open.erase(cr++);
+                } else {
+                    ++cr;
+                }
+            }
+            prevSpans.swap(spans);
+        }
+        if (allRead) {                  // there are no more rows, so all the CRs are complete
+            for (typename std::map<int, Component>::iterator cr = open.begin(); cr != open.end(); ++cr) {
+                finished.push_back(std::move(cr->second));
+            }
+            open.clear();
+            prevSpans.clear();
+        }
+        /*
+         * We won't look at rows below settled again, so we can restore their initial values
+         */
+        int const settled = allRead ? nrow : next - 1;
+        while (!corrected.empty() && corrected.front().row - frameY0 < settled) {
+            CRPixel<ImagePixel> const &crp = corrected.front();
+            window->at(crp.col - window->getX0(), crp.row - window->getY0()).image() = crp.val;
+            corrected.pop_front();
+        }
+        /*
+         * Clean the CRs that are far enough from the rows that the search is still changing
+         */
+        std::vector<detection::Footprint::Ptr> CRs;
+        std::vector<CRPixel<ImagePixel> > crpixels;
+        for (typename std::vector<Component>::iterator cr = finished.begin(); cr != finished.end(); ) {
+            if (!allRead && cr->maxY - frameY0 + margin > settled) {
+                ++cr;
+                continue;
+            }
+
+            std::sort(cr->spans.begin(), cr->spans.end(),
+                      [](detection::IdSpan const& a, detection::IdSpan const& b) {
+                          return (a.y < b.y) || (a.y == b.y && a.x0 < b.x0);
+                      });
+            detection::Footprint::Ptr fp(new detection::Footprint(cr->spans.size()));
+            for (std::vector<detection::IdSpan>::const_iterator sp = cr->spans.begin();
+                 sp != cr->spans.end(); ++sp) {
+                fp->addSpan(sp->y, sp->x0, sp->x1);
+            }
+            CRs.push_back(fp);
+            crpixels.insert(crpixels.end(), cr->pixels.begin(), cr->pixels.end());
+
+            cr = finished.erase(cr);
+        }
+
+        if (!CRs.empty()) {
+            int const nCrPixelBatch = crpixels.size();
+            crpixels.push_back(CRPixel<ImagePixel>(0, -1, 0, seq++, -1)); // a dummy, as cleanCRs expects
+
+            if (!cleanCRs(*window, frame, CRs, crpixels, seq, background, p, p.nCrPixelMax - nCrPixelCleaned,
+                          keep, noSigma, stats)) {
+                tooManyCRs();
+            }
+            nCrPixelCleaned += nCrPixelBatch;
+
+            for (std::vector<detection::Footprint::Ptr>::const_iterator cr = CRs.begin();
+                 cr != CRs.end(); ++cr) {
+                callback(*cr);
+            }
+        }
+        /*
+         * Return the rows that no-one needs any more
+         */
+        int keepFrom = allRead ? nrow : next - margin; // the first row that we need to keep
+        for (typename std::map<int, Component>::const_iterator cr = open.begin(); cr != open.end(); ++cr) {
+            keepFrom = std::min(keepFrom, cr->second.minY - frameY0 - margin);
+        }
+        for (typename std::vector<Component>::const_iterator cr = finished.begin();
+             cr != finished.end(); ++cr) {
+            keepFrom = std::min(keepFrom, cr->minY - frameY0 - margin);
+        }
+
+        if (keepFrom > w0) {
+            source.writeRows(MaskedImageT(*window, geom::Box2I(geom::Point2I(frame.getMinX(), frameY0 + w0),
+                                                               geom::Extent2I(frame.getWidth(), keepFrom - w0)),
+                                          image::PARENT, false));
+            w0 = keepFrom;
+        }
+    }
+}
 
 /*****************************************************************************/
 namespace {
@@ -794,120 +1897,144 @@ bool condition_3(ImageT *estimate,        // estimate of true value of pixel
 /************************************************************************************************************/
 /*
  * Interpolate over a CR's pixels
+ *
+ * We work a Span at a time, reading the pixels that we need directly from the five rows centred on the Span
  */
 template <typename MaskedImageT>
-class RemoveCR : public detection::FootprintFunctor<MaskedImageT> {
+class RemoveCR {
 public:
-    RemoveCR(MaskedImageT const& mimage,
-             double const bkgd,
-             typename MaskedImageT::Mask::Pixel badMask,
+    typedef typename MaskedImageT::Image::Pixel ImagePixel;
+    typedef typename MaskedImageT::Mask::Pixel MaskPixel;
+
+    RemoveCR(MaskedImageT & mimage,
+             geom::Box2I const& frame,  // bounding box of the whole frame; mimage may be only part of it
+             std::vector<detection::Footprint::Ptr> const& CRs, // all the CRs that we're removing
+             CrBackground const& bkgd,
+             MaskPixel crBit,
+             MaskPixel badMask,
              bool const debias,
-             lsst::afw::math::Random& rand
-            ) : detection::FootprintFunctor<MaskedImageT>(mimage),
+             detail::PixelRandom const& rand, // noise for the interpolated pixels
+             SigmaPlane const& sigma    // mimage's standard deviation; may be empty
+            ) : _mimage(mimage),
+                _CRs(CRs),
                 _bkgd(bkgd),
-                _ncol(mimage.getWidth()),
-                _nrow(mimage.getHeight()),
+                _frame(frame),
+                _crBit(crBit),
                 _badMask(badMask),
                 _debias(debias),
-                _rand(rand) {}
+                _rand(rand),
+                _sigma(sigma),
+                _badPixels(),
+                _nFallback(0) {}
+
+    // Interpolate over all of cr's pixels, in the order that they appear in its Spans
+    void apply(detection::Footprint const& cr) {
+        for (detection::Footprint::SpanList::const_iterator sp = cr.getSpans().begin();
+             sp != cr.getSpans().end(); ++sp) {
+            removeSpan((*sp)->getY(), (*sp)->getX0(), (*sp)->getX1());
+        }
+    }
 
-    // method called for each pixel by apply()
-    void operator()(typename MaskedImageT::xy_locator loc, // locator pointing at the pixel
-                    int x,                                 // column-position of pixel
-                    int y                                  // row-position of pixel
-                   ) {
-        typedef typename MaskedImageT::Image::Pixel MImagePixel;
-        MImagePixel min = std::numeric_limits<MImagePixel>::max();
-        int ngood = 0;          // number of good values on min
+    // Return the number of pixels that had no good estimate from their neighbours
+    int getNFallback() const { return _nFallback; }
+private:
+    // The PixelRandom streams that we use, so the fallback and the debiasing get independent values
+    enum { FALLBACK_STREAM = 0, DEBIAS_STREAM = 1 };
 
-        MImagePixel const minval = _bkgd - 2*sqrt(loc.variance()); // min. acceptable pixel value after interp
-/*
- * W-E row
- */
-        if (x - 2 >= 0 && x + 2 < _ncol) {
-            if ((loc.mask(-2, 0) | _badMask) || (loc.mask(-1, 0) | _badMask) ||
-                (loc.mask( 1, 0) | _badMask) || (loc.mask( 2, 0) | _badMask)) {
-                ;                       // estimate is contaminated
-            } else {
-                MImagePixel const v_m2 = loc.image(-2, 0);
-                MImagePixel const v_m1 = loc.image(-1, 0);
-                MImagePixel const v_p1 = loc.image( 1, 0);
-                MImagePixel const v_p2 = loc.image( 2, 0);
+    void removeSpan(int const y, int const x0, int const x1);
+    /*
+     * Include the linear-predictive estimate along the line through pixel ix of the Span's row in
+     * direction (dx, dy) if none of the pixels it uses are bad
+     */
+    void consider(int const ix, int const dx, int const dy, double const c1, double const c2,
+                  ImagePixel const minval, ImagePixel &min, int &ngood) const {
+        if ((_mask[2 - 2*dy][ix - 2*dx] | _mask[2 - dy][ix - dx] |
+             _mask[2 + dy][ix + dx] | _mask[2 + 2*dy][ix + 2*dx]) & _badMask) {
+            return;                     // estimate is contaminated
+        }
+        ImagePixel const v_m2 = _image[2 - 2*dy][ix - 2*dx];
+        ImagePixel const v_m1 = _image[2 - dy][ix - dx];
+        ImagePixel const v_p1 = _image[2 + dy][ix + dx];
+        ImagePixel const v_p2 = _image[2 + 2*dy][ix + 2*dx];
 
-                MImagePixel const tmp =
-                    interp::lpc_1_c1*(v_m1 + v_p1) + interp::lpc_1_c2*(v_m2 + v_p2);
+        ImagePixel const tmp = c1*(v_m1 + v_p1) + c2*(v_m2 + v_p2);
 
-                if (tmp > minval && tmp < min) {
-                    min = tmp;
-                    ngood++;
-                }
-            }
+        if (tmp > minval && tmp < min) {
+            min = tmp;
+            ngood++;
         }
-/*
- * N-S column
- */
-        if (y - 2 >= 0 && y + 2 < _nrow) {
-            if ((loc.mask(0, -2) | _badMask) || (loc.mask(0, -1) | _badMask) ||
-                (loc.mask(0,  1) | _badMask) || (loc.mask(0,  2) | _badMask)) {
-                ;                       /* estimate is contaminated */
-            } else {
-                MImagePixel const v_m2 = loc.image(0, -2);
-                MImagePixel const v_m1 = loc.image(0, -1);
-                MImagePixel const v_p1 = loc.image(0,  1);
-                MImagePixel const v_p2 = loc.image(0,  2);
-
-                MImagePixel const tmp =
-                    interp::lpc_1_c1*(v_m1 + v_p1) + interp::lpc_1_c2*(v_m2 + v_p2);
+    }
 
-                if (tmp > minval && tmp < min) {
-                    min = tmp;
-                    ngood++;
+    /*
+     * Return the bad pixels for interp::singlePixel, i.e. those in _badMask or in any of the CRs (which may
+     * not be in the mask yet).  We only build the index the first time that we need it
+     */
+    interp::BadPixelRuns const& getBadPixels() {
+        if (!_badPixels) {
+            _badPixels.reset(new interp::BadPixelRuns(*_mimage.getMask(), _badMask | _crBit));
+            for (std::vector<detection::Footprint::Ptr>::const_iterator cr = _CRs.begin();
+                 cr != _CRs.end(); ++cr) {
+                for (detection::Footprint::SpanList::const_iterator sp = (*cr)->getSpans().begin();
+                     sp != (*cr)->getSpans().end(); ++sp) {
+                    _badPixels->add((*sp)->getY(), (*sp)->getX0(), (*sp)->getX1());
                 }
             }
         }
-/*
- * SW--NE diagonal
- */
-        if (x - 2 >= 0 && x + 2 < _ncol && y - 2 >= 0 && y + 2 < _nrow) {
-            if ((loc.mask(-2, -2) | _badMask) || (loc.mask(-1, -1) | _badMask) ||
-                (loc.mask( 1,  1) | _badMask) || (loc.mask( 2,  2) | _badMask)) {
-                ;                       /* estimate is contaminated */
-            } else {
-                MImagePixel const v_m2 = loc.image(-2, -2);
-                MImagePixel const v_m1 = loc.image(-1, -1);
-                MImagePixel const v_p1 = loc.image( 1,  1);
-                MImagePixel const v_p2 = loc.image( 2,  2);
+        return *_badPixels;
+    }
 
-                MImagePixel const tmp =
-                    interp::lpc_1s2_c1*(v_m1 + v_p1) + interp::lpc_1s2_c2*(v_m2 + v_p2);
+    MaskedImageT & _mimage;
+    std::vector<detection::Footprint::Ptr> const& _CRs;
+    CrBackground const& _bkgd;
+    geom::Box2I _frame;
+    MaskPixel _crBit;
+    MaskPixel _badMask;
+    bool _debias;
+    detail::PixelRandom const& _rand;
+    SigmaPlane const& _sigma;
+    std::unique_ptr<interp::BadPixelRuns> _badPixels; // the bad pixels, for interp::singlePixel
+    int _nFallback;                     // number of pixels with no good estimate from their neighbours
+    // rows y - 2, ..., y + 2 of the Span that we're working on (only row y is set if we're near the edge)
+    typename MaskedImageT::Image::x_iterator _image[5];
+    typename MaskedImageT::Mask::x_iterator _mask[5];
+};
 
-                if (tmp > minval && tmp < min) {
-                    min = tmp;
-                    ngood++;
-                }
-            }
+template <typename MaskedImageT>
+void RemoveCR<MaskedImageT>::removeSpan(int const y, // row of Span (in the parent frame)
+                                        int const x0, // first column of Span (in the parent frame)
+                                        int const x1  // last column of Span (in the parent frame)
+                                       ) {
+    int const iy = y - _mimage.getY0();
+    // can we look 2 pixels to the N-S?
+    bool const okY = (y - 2 >= _frame.getMinY() && y + 2 <= _frame.getMaxY());
+    for (int dy = -2; dy <= 2; ++dy) {
+        if (dy == 0 || okY) {
+            _image[2 + dy] = _mimage.getImage()->row_begin(iy + dy);
+            _mask[2 + dy] = _mimage.getMask()->row_begin(iy + dy);
         }
-/*
- * SE--NW diagonal
- */
-        if (x - 2 >= 0 && x + 2 < _ncol && y - 2 >= 0 && y + 2 < _nrow) {
-            if ((loc.mask( 2, -2) | _badMask) || (loc.mask( 1, -1) | _badMask) ||
-                (loc.mask(-1,  1) | _badMask) || (loc.mask(-2,  2) | _badMask)) {
-                ;                       /* estimate is contaminated */
-            } else {
-                MImagePixel const v_m2 = loc.image( 2, -2);
-                MImagePixel const v_m1 = loc.image( 1, -1);
-                MImagePixel const v_p1 = loc.image(-1,  1);
-                MImagePixel const v_p2 = loc.image(-2,  2);
+    }
+    typename MaskedImageT::Variance::x_iterator const variance = _mimage.getVariance()->row_begin(iy);
 
-                MImagePixel const tmp =
-                    interp::lpc_1s2_c1*(v_m1 + v_p1) + interp::lpc_1s2_c2*(v_m2 + v_p2);
+    for (int x = x0; x <= x1; ++x) {
+        int const ix = x - _mimage.getX0();
+        ImagePixel min = std::numeric_limits<ImagePixel>::max();
+        int ngood = 0;          // number of good values on min
+        // can we look 2 pixels to the W-E?
+        bool const okX = (x - 2 >= _frame.getMinX() && x + 2 <= _frame.getMaxX());
 
-                if (tmp > minval && tmp < min) {
-                    min = tmp;
-                    ngood++;
-                }
-            }
+        double const sigma = _sigma.get(ix, iy, variance[ix]); // the pixel's standard deviation
+        double const bkgd = _bkgd.get(x, y);
+        ImagePixel const minval = bkgd - 2*sigma; // min. acceptable pixel value after interp
+
+        if (okX) {                      // W-E row
+            consider(ix, 1, 0, interp::lpc_1_c1, interp::lpc_1_c2, minval, min, ngood);
+        }
+        if (okY) {                      // N-S column
+            consider(ix, 0, 1, interp::lpc_1_c1, interp::lpc_1_c2, minval, min, ngood);
+        }
+        if (okX && okY) {               // SW--NE and SE--NW diagonals
+            consider(ix, 1, 1, interp::lpc_1s2_c1, interp::lpc_1s2_c2, minval, min, ngood);
+            consider(ix, -1, 1, interp::lpc_1s2_c1, interp::lpc_1s2_c2, minval, min, ngood);
         }
 /*
  * Have we altogether failed to find an acceptable value? If so interpolate
@@ -917,19 +2044,21 @@ public:
  * both directions fail, use the background value.
  */
         if (ngood == 0) {
-            std::pair<bool, MImagePixel const> val_h =
-                interp::singlePixel(x, y, this->getImage(), true,  minval);
-            std::pair<bool, MImagePixel const> val_v =
-                interp::singlePixel(x, y, this->getImage(), false, minval);
+            CR_STATS(++_nFallback;)
+            interp::BadPixelRuns const& badPixels = getBadPixels();
+            std::pair<bool, ImagePixel const> val_h =
+                interp::singlePixel(x, y, _mimage, badPixels, true,  minval);
+            std::pair<bool, ImagePixel const> val_v =
+                interp::singlePixel(x, y, _mimage, badPixels, false, minval);
 
             if (!val_h.first) {
                 if (!val_v.first) {    // Still no good value. Guess wildly
-                    min = _bkgd + sqrt(loc.variance())*_rand.gaussian();
+                    min = bkgd + sigma*_rand.gaussian(x, y, FALLBACK_STREAM);
                 } else {
                     min = val_v.second;
                 }
             } else {
-                if (val_v.first) {
+                if (!val_v.first) {
                     min = val_h.second;
                 } else {
                     min = (val_v.second + val_h.second)/2;
@@ -949,18 +2078,12 @@ public:
         }
 
         if (_debias && ngood > 1) {
-            min -= interp::min2GaussianBias*sqrt(loc.variance())*_rand.gaussian();
+            min -= interp::min2GaussianBias*sigma*_rand.gaussian(x, y, DEBIAS_STREAM);
         }
 
-        loc.image() = min;
+        _image[2][ix] = min;
     }
-private:
-    double _bkgd;
-    int _ncol, _nrow;
-    typename MaskedImageT::Mask::Pixel _badMask;
-    bool _debias;
-    lsst::afw::math::Random& _rand;
-};
+}
 
 /************************************************************************************************************/
 /*
@@ -968,16 +2091,20 @@ private:
  */
 template<typename ImageT, typename MaskT>
 void removeCR(image::MaskedImage<ImageT, MaskT> & mi,  // image to search
+              geom::Box2I const & frame, // bounding box of the whole frame; mi may be only part of it
               std::vector<detection::Footprint::Ptr> & CRs, // list of cosmic rays
-              double const bkgd, // non-subtracted background
-              MaskT const , // Bit value used to label CRs
+              CrBackground const &bkgd, // non-subtracted background
+              MaskT const crBit, // Bit value used to label CRs
               MaskT const saturBit, // Bit value used to label saturated pixels
               MaskT const badMask, // Bit mask for bad pixels
               bool const debias, // statistically debias values?
-              bool const grow   // Grow CRs?
+              bool const grow,  // Grow CRs?
+              SigmaPlane const &sigma, // mi's standard deviation; may be empty
+              detail::PixelRandom const &rand, // noise for the interpolated pixels
+              CosmicRayStats &stats     // statistics to update
              )
 {
-    lsst::afw::math::Random rand;    // a random number generator
+    CR_STATS(StageTimer timer(stats.removeTime);)
     /*
      * replace the values of cosmic-ray contaminated pixels with 1-dim 2nd-order weighted means Cosmic-ray
      * contaminated pixels have already been given a mask value, crBit
@@ -989,7 +2116,8 @@ void removeCR(image::MaskedImage<ImageT, MaskT> & mi,  // image to search
      */
 
     // a functor to remove a CR
-    RemoveCR<image::MaskedImage<ImageT, MaskT> > removeCR(mi, bkgd, badMask, debias, rand); 
+    RemoveCR<image::MaskedImage<ImageT, MaskT> > removeCR(mi, frame, CRs, bkgd, crBit, badMask, debias, rand,
+                                                                  sigma);
 
     for (std::vector<detection::Footprint::Ptr>::reverse_iterator fiter = CRs.rbegin();
          fiter != CRs.rend(); ++fiter) {
@@ -1018,7 +2146,25 @@ void removeCR(image::MaskedImage<ImageT, MaskT> & mi,  // image to search
  */
         removeCR.apply(*cr);
     }
+    CR_STATS(stats.nFallbackInterpolation += removeCR.getNFallback();)
+}
 }
+
+/************************************************************************************************************/
+
+void CosmicRayStats::setMetadata(lsst::daf::base::PropertySet &metadata, std::string const& prefix) const {
+    metadata.set(prefix + "scanTime", scanTime);
+    metadata.set(prefix + "mergeTime", mergeTime);
+    metadata.set(prefix + "condition1Time", condition1Time);
+    metadata.set(prefix + "growTime", growTime);
+    metadata.set(prefix + "removeTime", removeTime);
+    metadata.set(prefix + "totalTime", totalTime);
+    metadata.set(prefix + "nCandidatePixel", nCandidatePixel);
+    metadata.set(prefix + "nSpan", nSpan);
+    metadata.set(prefix + "nCrBeforeCondition1", nCrBeforeCondition1);
+    metadata.set(prefix + "nCrAfterCondition1", nCrAfterCondition1);
+    metadata.set(prefix + "nGrownPerIteration", nGrownPerIteration);
+    metadata.set(prefix + "nFallbackInterpolation", nFallbackInterpolation);
 }
 
 /************************************************************************************************************/
@@ -1033,7 +2179,50 @@ void removeCR(image::MaskedImage<ImageT, MaskT> & mi,  // image to search
                    double const bkgd,                           \
                    lsst::pex::policy::Policy const& policy,     \
                    bool const keep                              \
-                  )
+                  ); \
+    template \
+    std::vector<detection::Footprint::Ptr> \
+    findCosmicRays(lsst::afw::image::MaskedImage<TYPE> &image,  \
+                   detection::Psf const &psf,                   \
+                   double const bkgd,                           \
+                   lsst::pex::policy::Policy const& policy,     \
+                   bool const keep,                             \
+                   CosmicRayStats &stats                        \
+                  ); \
+    template \
+    std::vector<detection::Footprint::Ptr> \
+    findCosmicRays(lsst::afw::image::MaskedImage<TYPE> &image,  \
+                   detection::Psf const &psf,                   \
+                   math::BoundedField const &bkgd,              \
+                   lsst::pex::policy::Policy const& policy,     \
+                   bool const keep                              \
+                  ); \
+    template \
+    std::vector<detection::Footprint::Ptr> \
+    findCosmicRays(lsst::afw::image::MaskedImage<TYPE> &image,  \
+                   image::Image<float> const &sigma,            \
+                   detection::Psf const &psf,                   \
+                   double const bkgd,                           \
+                   lsst::pex::policy::Policy const& policy,     \
+                   bool const keep                              \
+                  ); \
+    template \
+    void \
+    findCosmicRaysStreaming(CosmicRayRowSource<lsst::afw::image::MaskedImage<TYPE> > &source, \
+                            detection::Psf const &psf,                   \
+                            double const bkgd,                           \
+                            lsst::pex::policy::Policy const& policy,     \
+                            std::function<void (detection::Footprint::Ptr)> const& callback, \
+                            bool const keep                              \
+                           ); \
+    template \
+    std::vector<CosmicRayBatchResult> \
+    findCosmicRaysBatch(std::vector<std::shared_ptr<lsst::afw::image::MaskedImage<TYPE> > > const& images, \
+                        std::vector<std::shared_ptr<detection::Psf const> > const& psfs, \
+                        std::vector<double> const& bkgds, \
+                        lsst::pex::policy::Policy const& policy,     \
+                        bool const keep                              \
+                       )
 
 INSTANTIATE(float);
 INSTANTIATE(double);                    // Why do we need double images?
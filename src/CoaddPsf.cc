@@ -26,9 +26,11 @@
  * Represent a PSF as for a Coadd based on the James Jee stacking
  * algorithm which was extracted from Stackfit.
  */
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <iostream>
+#include <iterator>
 #include <numeric>
 #include "boost/iterator/iterator_adaptor.hpp"
 #include "boost/iterator/transform_iterator.hpp"
@@ -139,6 +141,185 @@ afw::geom::Point2D computeAveragePosition(
 
 } // anonymous
 
+/*
+ * A uniform grid over the coadd, listing the inputs that may contain the points in each cell.
+ *
+ * Each input's bounding box (clipped to its validPolygon's) is mapped into coadd pixel coordinates by
+ * transforming points along its boundary, and padded by a bound on how far the edges curve between them
+ * (measured from the points themselves) and on how far the inverse transforms disagree; it's listed in each
+ * cell that the result overlaps.  Inputs that can't be mapped (e.g. that have no Wcs, or whose transform
+ * into the coadd is too far from affine over the distance between the points to bound the curvature) are
+ * candidates everywhere.  The grid is only used to choose the candidates, which are then tested exactly
+ * as ExposureCatalog::subsetContaining does, so the results are unchanged.
+ */
+class CoaddPsf::Index {
+public:
+    Index(afw::table::ExposureCatalog const & catalog, afw::image::Wcs const & coaddWcs);
+
+    /// Return the indices (in increasing order) of the inputs that may contain ccdXY
+    std::vector<int> getCandidates(afw::geom::Point2D const & ccdXY) const;
+
+private:
+    static int const nSample = 16;      // number of chords to transform along each edge of a bbox
+    static double const maxCurvature;   // largest deviation from a chord, relative to its length, we accept
+
+    // Return the bbox, in coadd pixel coordinates, of record's valid region (empty if we can't tell)
+    static afw::geom::Box2D mapRecord(afw::table::ExposureRecord const & record,
+                                      afw::image::Wcs const & coaddWcs);
+
+    afw::geom::Box2D _bbox;             // bbox of the grid, in coadd pixel coordinates
+    int _nx, _ny;                       // number of cells in x and y
+    std::vector<std::vector<int> > _cells; // the inputs that overlap each cell, in increasing order
+    std::vector<int> _everywhere;       // the inputs that we couldn't map, in increasing order
+};
+
+double const CoaddPsf::Index::maxCurvature = 0.05;
+
+afw::geom::Box2D CoaddPsf::Index::mapRecord(
+    afw::table::ExposureRecord const & record,
+    afw::image::Wcs const & coaddWcs
+) {
+    if (!record.getWcs()) {
+        return afw::geom::Box2D();
+    }
+    afw::geom::Box2D region(record.getBBox());
+    if (record.getValidPolygon()) {
+        region.clip(record.getValidPolygon()->getBBox());
+    }
+    if (region.isEmpty()) {
+        return afw::geom::Box2D();
+    }
+
+    afw::image::Wcs const & wcs = *record.getWcs();
+    afw::geom::Box2D result;
+    double maxDeviation = 0;            // furthest that a side strays from the chords between our points
+    double maxRoundTrip = 0;            // largest error in mapping a point to the coadd and back
+    double maxScale = 0;                // largest number of coadd pixels per input pixel
+    try {
+        afw::geom::Point2D const min = region.getMin(), max = region.getMax();
+        afw::geom::Point2D const corners[] = {
+            min, afw::geom::Point2D(max.getX(), min.getY()), max, afw::geom::Point2D(min.getX(), max.getY())
+        };
+        for (int i = 0; i != 4; ++i) {
+            afw::geom::Point2D const start = corners[i];
+            afw::geom::Extent2D const side = corners[(i + 1)%4] - start;
+            double const step = side.computeNorm()/(2*nSample); // distance between the points, input pixels
+            //
+            // Map 2*nSample + 1 points evenly spaced along the side into the coadd.  ExposureRecord::contains
+            // maps the other way, using the inverse transforms, so see how well they agree
+            //
+            afw::geom::Point2D points[2*nSample + 1];
+            for (int j = 0; j <= 2*nSample; ++j) {
+                afw::geom::Point2D const xy = start + side*(0.5*j/nSample);
+                afw::geom::Point2D const p = coaddWcs.skyToPixel(*wcs.pixelToSky(xy));
+                if (!std::isfinite(p.getX()) || !std::isfinite(p.getY())) {
+                    return afw::geom::Box2D();
+                }
+                maxRoundTrip = std::max(maxRoundTrip,
+                                        (wcs.skyToPixel(*coaddWcs.pixelToSky(p)) - xy).computeNorm());
+                points[j] = p;
+                result.include(p);
+            }
+            //
+            // How far each odd point lies from the midpoint of the chord joining its neighbours is (to
+            // leading order) an eighth of the side's second derivative times the chord's length squared,
+            // which bounds how far the side strays from the chord.  If that's not small compared with the
+            // chord, the transform is too far from affine on this scale for us to trust the estimate
+            //
+            for (int j = 1; j < 2*nSample; j += 2) {
+                afw::geom::Extent2D const chord = points[j + 1] - points[j - 1];
+                double const deviation = (points[j] - (points[j - 1] + chord*0.5)).computeNorm();
+                if (!(deviation <= maxCurvature*chord.computeNorm())) {
+                    return afw::geom::Box2D();
+                }
+                maxDeviation = std::max(maxDeviation, deviation);
+                maxScale = std::max(maxScale, chord.computeNorm()/(2*step));
+            }
+        }
+    } catch (pex::exceptions::Exception &) {
+        return afw::geom::Box2D();
+    }
+    //
+    // Allow (generously) for the sides curving between the points, and for the disagreement between the
+    // forward and inverse transforms (converted to coadd pixels), plus a pixel for rounding
+    //
+    result.grow(1.0 + 2*(maxDeviation + maxScale*maxRoundTrip));
+
+    return result;
+}
+
+CoaddPsf::Index::Index(
+    afw::table::ExposureCatalog const & catalog,
+    afw::image::Wcs const & coaddWcs
+) : _bbox(), _nx(0), _ny(0), _cells(), _everywhere()
+{
+    int const n = catalog.size();
+    std::vector<afw::geom::Box2D> boxes;
+    boxes.reserve(n);
+    for (int i = 0; i != n; ++i) {
+        boxes.push_back(mapRecord(catalog[i], coaddWcs));
+        if (boxes.back().isEmpty()) {
+            _everywhere.push_back(i);
+        } else {
+            _bbox.include(boxes.back());
+        }
+    }
+    if (_bbox.isEmpty()) {
+        return;
+    }
+
+    _nx = _ny = std::min(256, std::max(1, static_cast<int>(std::ceil(std::sqrt(double(n))))));
+    _cells.resize(_nx*_ny);
+    double const cellWidth = _bbox.getWidth()/_nx, cellHeight = _bbox.getHeight()/_ny;
+    for (int i = 0; i != n; ++i) {
+        afw::geom::Box2D const & box = boxes[i];
+        if (box.isEmpty()) {
+            continue;
+        }
+        int const ix0 = std::max(0, static_cast<int>((box.getMinX() - _bbox.getMinX())/cellWidth));
+        int const ix1 = std::min(_nx - 1, static_cast<int>((box.getMaxX() - _bbox.getMinX())/cellWidth));
+        int const iy0 = std::max(0, static_cast<int>((box.getMinY() - _bbox.getMinY())/cellHeight));
+        int const iy1 = std::min(_ny - 1, static_cast<int>((box.getMaxY() - _bbox.getMinY())/cellHeight));
+        for (int iy = iy0; iy <= iy1; ++iy) {
+            for (int ix = ix0; ix <= ix1; ++ix) {
+                _cells[iy*_nx + ix].push_back(i);
+            }
+        }
+    }
+}
+
+std::vector<int> CoaddPsf::Index::getCandidates(afw::geom::Point2D const & ccdXY) const {
+    if (_cells.empty() || !_bbox.contains(ccdXY)) {
+        return _everywhere;
+    }
+    double const fx = (ccdXY.getX() - _bbox.getMinX())/_bbox.getWidth(); // position within the grid
+    double const fy = (ccdXY.getY() - _bbox.getMinY())/_bbox.getHeight();
+    int const ix = std::min(_nx - 1, static_cast<int>(fx*_nx));
+    int const iy = std::min(_ny - 1, static_cast<int>(fy*_ny));
+    std::vector<int> const & cell = _cells[iy*_nx + ix];
+
+    std::vector<int> candidates;
+    candidates.reserve(cell.size() + _everywhere.size());
+    std::merge(cell.begin(), cell.end(), _everywhere.begin(), _everywhere.end(),
+               std::back_inserter(candidates));
+    return candidates;
+}
+
+afw::table::ExposureCatalog CoaddPsf::subsetContaining(afw::geom::Point2D const & ccdXY) const {
+    afw::table::ExposureCatalog result(_catalog.getTable());
+    std::vector<int> const candidates = _index->getCandidates(ccdXY);
+    if (candidates.empty()) {
+        return result;
+    }
+    PTR(afw::coord::Coord) coord = _coaddWcs->pixelToSky(ccdXY);
+    for (std::vector<int>::const_iterator i = candidates.begin(); i != candidates.end(); ++i) {
+        if (_catalog[*i].contains(*coord, true)) {
+            result.push_back(_catalog.get(*i));
+        }
+    }
+    return result;
+}
+
 CoaddPsf::CoaddPsf(
     afw::table::ExposureCatalog const & catalog,
     afw::image::Wcs const & coaddWcs,
@@ -171,6 +352,7 @@ CoaddPsf::CoaddPsf(
          _catalog.push_back(record);
     }
     _averagePosition = computeAveragePosition(_catalog, *_coaddWcs, _weightKey);
+    _index = std::make_shared<Index>(_catalog, *_coaddWcs);
 }
 
 PTR(afw::detection::Psf) CoaddPsf::clone() const {
@@ -225,7 +407,7 @@ afw::geom::Box2I CoaddPsf::doComputeBBox(
     afw::geom::Point2D const & ccdXY,
     afw::image::Color const & color
 ) const {
-    afw::table::ExposureCatalog subcat = _catalog.subsetContaining(ccdXY, *_coaddWcs, true);
+    afw::table::ExposureCatalog subcat = subsetContaining(ccdXY);
     if (subcat.empty()) {
         throw LSST_EXCEPT(
             pex::exceptions::InvalidParameterError,
@@ -250,7 +432,7 @@ PTR(afw::detection::Psf::Image) CoaddPsf::doComputeKernelImage(
     afw::image::Color const & color
 ) const {
     // Get the subset of expoures which contain our coordinate within their validPolygons.
-    afw::table::ExposureCatalog subcat = _catalog.subsetContaining(ccdXY, *_coaddWcs, true);
+    afw::table::ExposureCatalog subcat = subsetContaining(ccdXY);
     if (subcat.empty()) {
         throw LSST_EXCEPT(
             pex::exceptions::InvalidParameterError,
@@ -460,7 +642,9 @@ CoaddPsf::CoaddPsf(
     _catalog(catalog), _coaddWcs(coaddWcs), _weightKey(_catalog.getSchema()["weight"]),
     _averagePosition(averagePosition), _warpingKernelName(warpingKernelName),
     _warpingControl(new afw::math::WarpingControl(warpingKernelName, "", cacheSize))
-{}
+{
+    _index = std::make_shared<Index>(_catalog, *_coaddWcs);
+}
 
 }}} // namespace lsst::meas::algorithms
 
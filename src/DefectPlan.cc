@@ -0,0 +1,311 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "lsst/afw/table/io/CatalogVector.h"
+#include "lsst/afw/table/io/OutputArchive.h"
+#include "lsst/afw/table/io/InputArchive.h"
+#include "lsst/afw/table/aggregates.h"
+#include "lsst/meas/algorithms/DefectPlan.h"
+#include "lsst/meas/algorithms/detail/InterpKernel.h"
+
+namespace lsst { namespace meas { namespace algorithms {
+
+// The public constructor, which classifies the defects, lives in Interp.cc alongside the classification code
+
+DefectPlan::DefectPlan(
+    afw::geom::Box2I const & bbox,
+    std::vector<Segment> const & segments,
+    std::vector<Run> const & rowRuns,
+    std::vector<Run> const & columnRuns
+) :
+    _bbox(bbox), _segments(segments), _rowRuns(rowRuns), _columnRuns(columnRuns)
+{}
+
+// ---------- Persistence -----------------------------------------------------------------------------------
+
+// For persistence of DefectPlan, we have four catalogs: the first has just one record, and contains the
+// bounding box.  The second has one record for each segment, and the third and fourth one for each run of
+// rows and of columns.  The segments' interpolants are looked up again when they're read, so the archive
+// doesn't depend on the order of the interpolation tables in Interp.cc.
+
+namespace {
+
+namespace tbl = afw::table;
+
+// Singleton class that manages the first persistence catalog's schema and keys
+class DefectPlanPersistenceKeys1 {
+public:
+    tbl::Schema schema;
+    tbl::PointKey<int> bboxMin;
+    tbl::PointKey<int> bboxMax;
+
+    static DefectPlanPersistenceKeys1 const & get() {
+        static DefectPlanPersistenceKeys1 const instance;
+        return instance;
+    }
+
+    // No copying
+    DefectPlanPersistenceKeys1 (const DefectPlanPersistenceKeys1&) = delete;
+    DefectPlanPersistenceKeys1& operator=(const DefectPlanPersistenceKeys1&) = delete;
+
+    // No moving
+    DefectPlanPersistenceKeys1 (DefectPlanPersistenceKeys1&&) = delete;
+    DefectPlanPersistenceKeys1& operator=(DefectPlanPersistenceKeys1&&) = delete;
+
+private:
+    DefectPlanPersistenceKeys1() :
+        schema(),
+        bboxMin(tbl::PointKey<int>::addFields(
+            schema, "bbox_min", "lower-left corner of bounding box", "pixel")),
+        bboxMax(tbl::PointKey<int>::addFields(
+            schema, "bbox_max", "upper-right corner of bounding box", "pixel"))
+    {
+        schema.getCitizen().markPersistent();
+    }
+};
+
+// Singleton class that manages the segments' schema and keys
+class DefectPlanPersistenceKeys2 {
+public:
+    tbl::Schema schema;
+    tbl::Key<int> x0;
+    tbl::Key<int> x1;
+    tbl::Key<int> badX0;
+    tbl::Key<int> badX1;
+    tbl::Key<int> pos;
+    tbl::Key<int> type;
+    tbl::Key<int> fallbackX0;
+    tbl::Key<int> fallbackX1;
+    tbl::Key<tbl::Flag> interpolate;
+
+    static DefectPlanPersistenceKeys2 const & get() {
+        static DefectPlanPersistenceKeys2 const instance;
+        return instance;
+    }
+
+    // No copying
+    DefectPlanPersistenceKeys2 (const DefectPlanPersistenceKeys2&) = delete;
+    DefectPlanPersistenceKeys2& operator=(const DefectPlanPersistenceKeys2&) = delete;
+
+    // No moving
+    DefectPlanPersistenceKeys2 (DefectPlanPersistenceKeys2&&) = delete;
+    DefectPlanPersistenceKeys2& operator=(DefectPlanPersistenceKeys2&&) = delete;
+
+private:
+    DefectPlanPersistenceKeys2() :
+        schema(),
+        x0(schema.addField<int>("x0", "first pixel of the defect", "pixel")),
+        x1(schema.addField<int>("x1", "last pixel of the defect", "pixel")),
+        badX0(schema.addField<int>("badX0", "first pixel to interpolate", "pixel")),
+        badX1(schema.addField<int>("badX1", "last pixel to interpolate", "pixel")),
+        pos(schema.addField<int>("pos", "position of the defect on the chip (Defect::DefectPosition)")),
+        type(schema.addField<int>("type", "type of the defect")),
+        fallbackX0(schema.addField<int>("fallbackX0", "first pixel to set to the fallback value", "pixel")),
+        fallbackX1(schema.addField<int>("fallbackX1", "last pixel to set to the fallback value", "pixel")),
+        interpolate(schema.addField<tbl::Flag>("interpolate", "are there any pixels to interpolate?"))
+    {
+        schema.getCitizen().markPersistent();
+    }
+};
+
+// Singleton class that manages the runs' schema and keys
+class DefectPlanPersistenceKeys3 {
+public:
+    tbl::Schema schema;
+    tbl::Key<int> y0;
+    tbl::Key<int> y1;
+    tbl::Key<int> begin;
+    tbl::Key<int> end;
+
+    static DefectPlanPersistenceKeys3 const & get() {
+        static DefectPlanPersistenceKeys3 const instance;
+        return instance;
+    }
+
+    // No copying
+    DefectPlanPersistenceKeys3 (const DefectPlanPersistenceKeys3&) = delete;
+    DefectPlanPersistenceKeys3& operator=(const DefectPlanPersistenceKeys3&) = delete;
+
+    // No moving
+    DefectPlanPersistenceKeys3 (DefectPlanPersistenceKeys3&&) = delete;
+    DefectPlanPersistenceKeys3& operator=(DefectPlanPersistenceKeys3&&) = delete;
+
+private:
+    DefectPlanPersistenceKeys3() :
+        schema(),
+        y0(schema.addField<int>("y0", "first row (or column) of the run", "pixel")),
+        y1(schema.addField<int>("y1", "one past the last row (or column) of the run", "pixel")),
+        begin(schema.addField<int>("begin", "index of the run's first segment")),
+        end(schema.addField<int>("end", "one past the index of the run's last segment"))
+    {
+        schema.getCitizen().markPersistent();
+    }
+};
+
+/*
+ * Read and check the runs in a catalog, whose rows (or columns) are [0, nrow) and whose segments are
+ * those with indices [0, nSegment); the runs must be in order, and mustn't overlap
+ */
+std::vector<DefectPlan::Run> readRuns(tbl::BaseCatalog const & catalog, int nrow, int nSegment) {
+    DefectPlanPersistenceKeys3 const & keys = DefectPlanPersistenceKeys3::get();
+    LSST_ARCHIVE_ASSERT(catalog.getSchema() == keys.schema);
+
+    std::vector<DefectPlan::Run> runs;
+    runs.reserve(catalog.size());
+    int prevY1 = 0;                     // end of the previous run
+    for (tbl::BaseCatalog::const_iterator i = catalog.begin(); i != catalog.end(); ++i) {
+        DefectPlan::Run const run = {i->get(keys.y0), i->get(keys.y1), i->get(keys.begin), i->get(keys.end)};
+        LSST_ARCHIVE_ASSERT(prevY1 <= run.y0 && run.y0 < run.y1 && run.y1 <= nrow);
+        prevY1 = run.y1;
+        LSST_ARCHIVE_ASSERT(0 <= run.begin && run.begin <= run.end && run.end <= nSegment);
+        runs.push_back(run);
+    }
+
+    return runs;
+}
+
+/*
+ * Check that the segments [run.begin, run.end) lie within rows (or columns) of length ncol, along with
+ * the neighbours that they're interpolated from, and that they have interpolants if they need them
+ */
+void checkSegments(std::vector<DefectPlan::Segment> const & segments,
+                   std::vector<DefectPlan::Run> const & runs,
+                   int ncol
+                  ) {
+    for (std::vector<DefectPlan::Run>::const_iterator run = runs.begin(); run != runs.end(); ++run) {
+        for (int i = run->begin; i != run->end; ++i) {
+            DefectPlan::Segment const & segment = segments[i];
+            LSST_ARCHIVE_ASSERT(0 <= segment.x0 && segment.x0 <= segment.x1 && segment.x1 < ncol);
+            LSST_ARCHIVE_ASSERT(segment.x0 <= segment.badX0 && segment.badX1 <= segment.x1);
+            LSST_ARCHIVE_ASSERT(segment.fallbackX0 > segment.fallbackX1 ||
+                                (segment.x0 <= segment.fallbackX0 && segment.fallbackX1 <= segment.x1));
+            LSST_ARCHIVE_ASSERT(!segment.interpolate ||
+                                detail::isValidDefect(ncol, segment.badX0, segment.badX1, segment.pos,
+                                                      segment.pattern));
+        }
+    }
+}
+
+} // anonymous
+
+class DefectPlan::Factory : public tbl::io::PersistableFactory {
+public:
+
+    virtual PTR(tbl::io::Persistable)
+    read(InputArchive const & archive, CatalogVector const & catalogs) const {
+        DefectPlanPersistenceKeys1 const & keys1 = DefectPlanPersistenceKeys1::get();
+        DefectPlanPersistenceKeys2 const & keys2 = DefectPlanPersistenceKeys2::get();
+        LSST_ARCHIVE_ASSERT(catalogs.size() == 4u);
+        LSST_ARCHIVE_ASSERT(catalogs[0].getSchema() == keys1.schema);
+        LSST_ARCHIVE_ASSERT(catalogs[0].size() == 1u);
+        LSST_ARCHIVE_ASSERT(catalogs[1].getSchema() == keys2.schema);
+        tbl::BaseRecord const & record1 = catalogs[0].front();
+        afw::geom::Box2I const bbox(record1.get(keys1.bboxMin), record1.get(keys1.bboxMax));
+
+        std::vector<Segment> segments;
+        segments.reserve(catalogs[1].size());
+        for (tbl::BaseCatalog::const_iterator i = catalogs[1].begin(); i != catalogs[1].end(); ++i) {
+            Segment segment;
+            segment.x0 = i->get(keys2.x0);
+            segment.x1 = i->get(keys2.x1);
+            segment.badX0 = i->get(keys2.badX0);
+            segment.badX1 = i->get(keys2.badX1);
+            int const pos = i->get(keys2.pos);
+            LSST_ARCHIVE_ASSERT(Defect::LEFT <= pos && pos <= Defect::RIGHT);
+            segment.pos = static_cast<Defect::DefectPosition>(pos);
+            segment.type = i->get(keys2.type);
+            segment.fallbackX0 = i->get(keys2.fallbackX0);
+            segment.fallbackX1 = i->get(keys2.fallbackX1);
+            segment.interpolate = i->get(keys2.interpolate);
+            segment.pattern = segment.interpolate ? detail::findInterpPattern(segment.pos, segment.type) : -1;
+            segments.push_back(segment);
+        }
+
+        int const nSegment = segments.size();
+        std::vector<Run> const rowRuns = readRuns(catalogs[2], bbox.getHeight(), nSegment);
+        std::vector<Run> const columnRuns = readRuns(catalogs[3], bbox.getWidth(), nSegment);
+        checkSegments(segments, rowRuns, bbox.getWidth());
+        checkSegments(segments, columnRuns, bbox.getHeight());
+
+        return PTR(DefectPlan)(new DefectPlan(bbox, segments, rowRuns, columnRuns));
+    }
+
+    Factory(std::string const & name) : tbl::io::PersistableFactory(name) {}
+
+};
+
+namespace {
+
+std::string getDefectPlanPersistenceName() { return "DefectPlan"; }
+
+DefectPlan::Factory registration(getDefectPlanPersistenceName());
+
+/*
+ * Append the runs to a new catalog, and save it
+ */
+void writeRuns(afw::table::io::OutputArchiveHandle & handle, std::vector<DefectPlan::Run> const & runs) {
+    DefectPlanPersistenceKeys3 const & keys = DefectPlanPersistenceKeys3::get();
+    tbl::BaseCatalog cat = handle.makeCatalog(keys.schema);
+    for (std::vector<DefectPlan::Run>::const_iterator i = runs.begin(); i != runs.end(); ++i) {
+        PTR(tbl::BaseRecord) record = cat.addNew();
+        record->set(keys.y0, i->y0);
+        record->set(keys.y1, i->y1);
+        record->set(keys.begin, i->begin);
+        record->set(keys.end, i->end);
+    }
+    handle.saveCatalog(cat);
+}
+
+} // anonymous
+
+std::string DefectPlan::getPersistenceName() const { return getDefectPlanPersistenceName(); }
+
+std::string DefectPlan::getPythonModule() const { return "lsst.meas.algorithms"; }
+
+void DefectPlan::write(OutputArchiveHandle & handle) const {
+    DefectPlanPersistenceKeys1 const & keys1 = DefectPlanPersistenceKeys1::get();
+    DefectPlanPersistenceKeys2 const & keys2 = DefectPlanPersistenceKeys2::get();
+    tbl::BaseCatalog cat1 = handle.makeCatalog(keys1.schema);
+    PTR(tbl::BaseRecord) record1 = cat1.addNew();
+    record1->set(keys1.bboxMin, _bbox.getMin());
+    record1->set(keys1.bboxMax, _bbox.getMax());
+    handle.saveCatalog(cat1);
+    tbl::BaseCatalog cat2 = handle.makeCatalog(keys2.schema);
+    for (std::vector<Segment>::const_iterator i = _segments.begin(); i != _segments.end(); ++i) {
+        PTR(tbl::BaseRecord) record2 = cat2.addNew();
+        record2->set(keys2.x0, i->x0);
+        record2->set(keys2.x1, i->x1);
+        record2->set(keys2.badX0, i->badX0);
+        record2->set(keys2.badX1, i->badX1);
+        record2->set(keys2.pos, static_cast<int>(i->pos));
+        record2->set(keys2.type, static_cast<int>(i->type));
+        record2->set(keys2.fallbackX0, i->fallbackX0);
+        record2->set(keys2.fallbackX1, i->fallbackX1);
+        record2->set(keys2.interpolate, i->interpolate);
+    }
+    handle.saveCatalog(cat2);
+    writeRuns(handle, _rowRuns);
+    writeRuns(handle, _columnRuns);
+}
+
+}}} // namespace lsst::meas::algorithms
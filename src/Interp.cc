@@ -32,15 +32,26 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <string>
 #include <typeinfo>
 #include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
 #include "boost/format.hpp"
+#include "Eigen/Core"
+#include "Eigen/LU"
 
 #include "lsst/afw/geom.h"
 #include "lsst/pex/exceptions.h"
 #include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/detection/Psf.h"
 #include "lsst/meas/algorithms/Interp.h"
+#include "lsst/meas/algorithms/DefectPlan.h"
+#include "lsst/meas/algorithms/detail/InterpKernel.h"
+#include "lsst/meas/algorithms/detail/Parallel.h"
 
 namespace lsst {
 namespace meas {
@@ -52,18 +63,96 @@ namespace geom = lsst::afw::geom;
 typedef std::vector<Defect::Ptr>::const_iterator DefectCIter;
 
 /************************************************************************************************************/
+/*
+ * Classify a 1-D defect, the pixels [x0, x1] of a row of length ncol.  No other defect may touch it, but
+ * there may be one that ends at x0 - 2 (badLeft) or starts at x1 + 2 (badRight), in which case the pixel
+ * beyond the good one next to the defect can't be used.
+ *
+ * See the comment above the interpolation tables for a description of how to interpret DefectType
+ */
+static void classify_run(int const x0,              // first bad pixel
+                         int const x1,              // last bad pixel
+                         int const ncol,            // number of columns in image
+                         bool const badLeft,        // is x0 - 2 bad?
+                         bool const badRight,       // is x1 + 2 bad?
+                         Defect::DefectPosition &pos, // the defect's position
+                         unsigned int &type           // and type
+                        ) {
+    int const nbad = x1 - x0 + 1;
+    assert(nbad >= 1);
+
+    if (x0 == 0) {
+        if (nbad >= Defect::WIDE_DEFECT) {
+            pos = Defect::WIDE_LEFT; type = 03;
+        } else {
+            pos = Defect::LEFT; type = 03 << nbad;
+        }
+    } else if (x0 == 1) {       /* only second column is usable */
+        if (nbad >= Defect::WIDE_DEFECT) {
+            pos = Defect::WIDE_NEAR_LEFT; type = (01 << 2) | 03;
+        } else {
+            pos = Defect::NEAR_LEFT; type = (01 << (nbad + 2)) | 03;
+        }
+    } else if (x1 == ncol - 2) { /* use only penultimate column */
+        if (nbad >= Defect::WIDE_DEFECT) {
+            pos = Defect::WIDE_NEAR_RIGHT; type = (03 << 2) | 02;
+        } else {
+            pos = Defect::NEAR_RIGHT; type = (03 << (nbad + 2)) | 02;
+        }
+    } else if (x1 == ncol - 1) {
+        if (nbad >= Defect::WIDE_DEFECT) {
+            pos = Defect::WIDE_RIGHT; type = 03;
+        } else {
+            pos = Defect::RIGHT; type = 03 << nbad;
+        }
+    } else if (nbad >= Defect::WIDE_DEFECT) {
+        pos = Defect::WIDE; type = (03 << 2) | 03;
+    } else {
+        pos = Defect::MIDDLE; type = (03 << (nbad + 2)) | 03;
+    }
+/*
+ * look for bad columns in regions that we'll get `good' values from.
+ */
+    int nshift = 0;             // number of bits to shift to get to left edge of defect pattern
+    switch (pos) {
+      case Defect::WIDE:                // no bits
+      case Defect::WIDE_NEAR_LEFT:      //       are used to encode
+      case Defect::WIDE_NEAR_RIGHT:     //            the bad section of data
+        nshift = 0;
+        break;
+      default:
+        nshift = nbad;
+        break;
+    }
+
+    if (badLeft) {
+        type &= ~(02 << (nshift + 2));
+    }
+
+    if (badRight) {
+        if (pos == Defect::LEFT || pos == Defect::NEAR_LEFT) {
+            type &= ~(02 << nshift);
+        } else {
+            type &= ~01;
+        }
+    }
+}
+
 /*
  * Classify an vector of Defect::Ptr for the given row, returning a vector of 1-D
- * Defects (i.e. y0 == y1).  In general we can merge in saturated pixels at
+ * Defects (i.e. each is a single run of columns).  In general we can merge in saturated pixels at
  * this step, although we don't currently do so.
  *
- * See comment above do_defects for a description of how to interpret DefectType
+ * If the same defects touch the nrow rows starting at y the classification holds for all of them, so the
+ * returned Defects span those rows and may be reused for each of them.
+ *
+ * See the comment above the interpolation tables for a description of how to interpret DefectType
  */
 static std::vector<Defect::Ptr>
 classify_defects(std::vector<Defect::Ptr> const & badList, // list of bad things
-                 int const y,           // the row to process
+                 int const y,           // the (first) row to process
                  int const ncol,        // number of columns in image
-                 int = 0                // number of rows in image
+                 int const nrow = 1     // number of rows, starting at y, that the classification is for
                 ) {
 
     std::vector<Defect::Ptr> badList1D;
@@ -102,7 +191,7 @@ classify_defects(std::vector<Defect::Ptr> const & badList, // list of bad things
             new Defect(
                 geom::BoxI(
                     geom::Point2I(x0, y),
-                    geom::Extent2I(nbad, 1)
+                    geom::Extent2I(nbad, nrow)
                 )
             )
         );
@@ -118,76 +207,12 @@ classify_defects(std::vector<Defect::Ptr> const & badList, // list of bad things
     for (DefectCIter begin = badList1D.begin(), end = badList1D.end(), bri = begin; bri != end; ++bri) {
         Defect::Ptr defect = *bri;
 
-        int const nbad = defect->getX1() - defect->getX0() + 1;
-        assert(nbad >= 1);
-
-        if (defect->getX0() == 0) {
-            if (nbad >= Defect::WIDE_DEFECT) {
-                defect->classify(Defect::WIDE_LEFT, 03);
-            } else {
-                defect->classify(Defect::LEFT, 03 << nbad);
-            }
-        } else if (defect->getX0() == 1) {       /* only second column is usable */
-            if (nbad >= Defect::WIDE_DEFECT) {
-                defect->classify(Defect::WIDE_NEAR_LEFT, (01 << 2) | 03);
-            } else {
-                defect->classify(Defect::NEAR_LEFT, (01 << (nbad + 2)) | 03);
-            }
-        } else if (defect->getX1() == ncol - 2) { /* use only penultimate column */
-            if (nbad >= Defect::WIDE_DEFECT) {
-                defect->classify(Defect::WIDE_NEAR_RIGHT, (03 << 2) | 02);
-            } else {
-                defect->classify(Defect::NEAR_RIGHT, (03 << (nbad + 2)) | 02);
-            }
-        } else if (defect->getX1() == ncol - 1) {
-            if (nbad >= Defect::WIDE_DEFECT) {
-                defect->classify(Defect::WIDE_RIGHT, 03);
-            } else {
-                defect->classify(Defect::RIGHT, 03 << nbad);
-            }
-        } else if (nbad >= Defect::WIDE_DEFECT) {
-            defect->classify(Defect::WIDE, (03 << 2) | 03);
-        } else {
-            defect->classify(Defect::MIDDLE, (03 << (nbad + 2)) | 03);
-        }
-/*
- * look for bad columns in regions that we'll get `good' values from.
- *
- * We know that no two Defects are adjacent.
- */
-        int nshift = 0;             // number of bits to shift to get to left edge of defect pattern
-        switch (defect->getPos()) {
-          case Defect::WIDE:                // no bits
-          case Defect::WIDE_NEAR_LEFT:      //       are used to encode
-          case Defect::WIDE_NEAR_RIGHT:     //            the bad section of data
-            nshift = 0;
-            break;
-          default:
-            nshift = nbad;
-            break;
-        }
-
-        if (bri != begin) {
-            Defect::Ptr const defect_m = *(bri - 1);
-            assert(defect_m->getX1() < defect->getX0());
-
-            if (defect_m->getX1() == defect->getX0() - 2) {
-                defect->classify(defect->getPos(), (defect->getType() & ~(02 << (nshift + 2))));
-            }
-        }
-
-        if (bri + 1 != end) {
-            Defect::Ptr const defect_p = *(bri + 1);
-
-            if (defect->getX1() == defect_p->getX0() - 2) {
-                Defect::DefectPosition defectPos = defect->getPos();
-                if (defectPos == Defect::LEFT || defectPos == Defect::NEAR_LEFT) {
-                    defect->classify(defect->getPos(), (defect->getType() & ~(02 << nshift)));
-                } else {
-                    defect->classify(defectPos, (defect->getType() & ~01));
-                }
-            }
-        }
+        Defect::DefectPosition pos;
+        unsigned int type;
+        classify_run(defect->getX0(), defect->getX1(), ncol,
+                     bri != begin && (*(bri - 1))->getX1() == defect->getX0() - 2,
+                     bri + 1 != end && (*(bri + 1))->getX0() == defect->getX1() + 2, pos, type);
+        defect->classify(pos, type);
     }
 
     return badList1D;
@@ -209,1819 +234,1425 @@ classify_defects(std::vector<Defect::Ptr> const & badList, // list of bad things
  * The LEFT ones are actually a bit tricky as they'd have leading 0s, so they are inverted ("....##" is
  * written as 110000 not 000011).
  */
-template<typename ImageT>
-static void do_defects(std::vector<Defect::Ptr> const & badList, // list of bad things
-                       int const y,                              // Row that we should fix
-                       ImageT& data,                             // data to fix
-                       typename ImageT::Pixel min,               // minimum acceptable value
-                       double fallbackValue,                     // Value to fallback to if all else fails
-                       bool useFallbackValueAtEdge,              // use fallbackValue at edge of chip?
-                       int nUseInterp                            // no. of pixels to interpolate towards edge
-                      )
-{
-    typedef typename ImageT::Pixel ImagePixel;
-    ImagePixel out1_2, out1_1, out2_1, out2_2; // == out[badX1-2], ..., out[bad_x2+2]
-    ImagePixel val;                         // unpack a pixel value
-    //
-    // Get pointer to this row of data
-    //
-    int const ncol = data.getWidth();
-    typename ImageT::x_iterator out = data.row_begin(y);
-
-    for (DefectCIter ptr = badList.begin(), end = badList.end(); ptr != end; ++ptr) {
-        Defect::Ptr const defect = *ptr;
-
-        if (y < defect->getY0() || y > defect->getY1()) {
-            continue;
-        }
-
-        int badX0 = defect->getX0();
-        int badX1 = defect->getX1();
+namespace {
+/*
+ * One step in interpolating over a defect: set a range of its pixels to a linear combination of the
+ * neighbouring pixels out1_2, out1_1, out2_1, and out2_2 (i.e. out[badX0 - 2], out[badX0 - 1],
+ * out[badX1 + 1], and out[badX1 + 2]).  Neighbours with a zero coefficient aren't used, and needn't be
+ * good or even exist
+ */
+struct Step {
+    enum Clip {                         // What to do with values below the minimum acceptable value
+        CLIP_NONE,                      // nothing
+        CLIP_LEFT,                      // use out1_1
+        CLIP_RIGHT,                     // use out2_1
+        CLIP_MEAN,                      // use the mean of out1_1 and out2_1
+        CLIP_ZERO                       // use 0 if the value's negative, whatever the minimum
+    };
+    enum Anchor { X0, X1 };             // Is an offset relative to badX0 or badX1?
+
+    double coeff[4];                    // coefficients of out1_2, out1_1, out2_1, out2_2
+    Clip clip;                          // how to clip the value
+    Anchor beginAnchor;                 // the first pixel to set is beginAnchor + beginOffset
+    int beginOffset;
+    Anchor endAnchor;                   // and the last is endAnchor + endOffset - 1
+    int endOffset;
+};
+/*
+ * The steps needed to interpolate over each type of defect, using LPC coefficients.  The comments give the
+ * defect's position and type (in octal), and the pattern of good (#), bad (.), and unknown (?) pixels that
+ * the type describes.
+ */
+constexpr Step interpSteps[] = {
+    // LEFT 02: .#?, <noise^2> = 0
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 04: ..#?, <noise^2> = 0
+    {{0, 0, 1.000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 06: .##, <noise^2> = 0
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 010: ...#?, <noise^2> = 0
+    {{0, 0, 1.000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.000, 0}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 014: ..##, <noise^2> = 0
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 020: ....#?, <noise^2> = 0
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 030: ...##, <noise^2> = 0
+    {{0, 0, 0.6968, 0.3032}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 040: .....#?, <noise^2> = 0
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 060: ....##, <noise^2> = 0
+    {{0, 0, 0.5370, 0.4630}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 0.6968, 0.3032}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 0100: ......#?, <noise^2> = 0
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 0140: .....##, <noise^2> = 0
+    {{0, 0, 0.5041, 0.4959}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 0.5370, 0.4630}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 0.6968, 0.3032}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 0200: .......#?, <noise^2> = 0
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -3, Step::X1, -2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 0300: ......##, <noise^2> = 0
+    {{0, 0, 0.5003, 0.4997}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 0.5041, 0.4959}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 0.5370, 0.4630}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 0.6968, 0.3032}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 0400: ........#?, <noise^2> = 0
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 3, Step::X0, 4},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -3, Step::X1, -2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 0600: .......##, <noise^2> = 0
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 0.5003, 0.4997}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 0.5041, 0.4959}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 0.5370, 0.4630}, Step::CLIP_RIGHT, Step::X1, -3, Step::X1, -2},
+    {{0, 0, 0.6968, 0.3032}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 01000: .........#?, <noise^2> = 0
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 3, Step::X0, 4},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -4, Step::X1, -3},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -3, Step::X1, -2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 01400: ........##, <noise^2> = 0
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 0.5003, 0.4997}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 0.5041, 0.4959}, Step::CLIP_RIGHT, Step::X0, 3, Step::X0, 4},
+    {{0, 0, 0.5370, 0.4630}, Step::CLIP_RIGHT, Step::X1, -3, Step::X1, -2},
+    {{0, 0, 0.6968, 0.3032}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 02000: ..........#?, <noise^2> = 0
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 3, Step::X0, 4},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 4, Step::X0, 5},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -4, Step::X1, -3},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -3, Step::X1, -2},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 03000: .........##, <noise^2> = 0
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 0.5003, 0.4997}, Step::CLIP_RIGHT, Step::X0, 3, Step::X0, 4},
+    {{0, 0, 0.5041, 0.4959}, Step::CLIP_RIGHT, Step::X1, -4, Step::X1, -3},
+    {{0, 0, 0.5370, 0.4630}, Step::CLIP_RIGHT, Step::X1, -3, Step::X1, -2},
+    {{0, 0, 0.6968, 0.3032}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // LEFT 06000: ..........##, <noise^2> = 0
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 0, Step::X0, 1},
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 1, Step::X0, 2},
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 2, Step::X0, 3},
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 3, Step::X0, 4},
+    {{0, 0, 0.5003, 0.4997}, Step::CLIP_RIGHT, Step::X0, 4, Step::X0, 5},
+    {{0, 0, 0.5041, 0.4959}, Step::CLIP_RIGHT, Step::X1, -4, Step::X1, -3},
+    {{0, 0, 0.5370, 0.4630}, Step::CLIP_RIGHT, Step::X1, -3, Step::X1, -2},
+    {{0, 0, 0.6968, 0.3032}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // WIDE_LEFT 02: ?#., <noise^2> = 0
+    {{0, 0, 1.0000, 0}, Step::CLIP_RIGHT, Step::X0, 0, Step::X1, 1},
+    // WIDE_LEFT 03: ?##, <noise^2> = 0
+    {{0, 0, 0.5000, 0.5000}, Step::CLIP_RIGHT, Step::X0, 0, Step::X1, -5},
+    {{0, 0, 0.5003, 0.4997}, Step::CLIP_RIGHT, Step::X1, -5, Step::X1, -4},
+    {{0, 0, 0.5041, 0.4959}, Step::CLIP_RIGHT, Step::X1, -4, Step::X1, -3},
+    {{0, 0, 0.5370, 0.4630}, Step::CLIP_RIGHT, Step::X1, -3, Step::X1, -2},
+    {{0, 0, 0.6968, 0.3032}, Step::CLIP_RIGHT, Step::X1, -2, Step::X1, -1},
+    {{0, 0, 1.0933, -0.0933}, Step::CLIP_RIGHT, Step::X1, -1, Step::X1, 0},
+    {{0, 0, 1.4288, -0.4288}, Step::CLIP_RIGHT, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 012: #.#., <noise^2> = 0, sigma = 1
+    {{0, 0.5000, 0.5000, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 013: #.##, <noise^2> = 0
+    {{0, 0.4875, 0.8959, -0.3834}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 022: #..#., <noise^2> = 0, sigma = 1
+    {{0, 0.7297, 0.2703, 0}, Step::CLIP_ZERO, Step::X0, 0, Step::X0, 1},
+    {{0, 0.2703, 0.7297, 0}, Step::CLIP_ZERO, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 023: #..##, <noise^2> = 0
+    {{0, 0.7538, 0.5680, -0.3218}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.3095, 1.2132, -0.5227}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 032: ##.#., <noise^2> = 0
+    {{-0.3834, 0.8959, 0.4875, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 033: ##.##, <noise^2> = 0
+    {{-0.2737, 0.7737, 0.7737, -0.2737}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 042: #...#., <noise^2> = 0, sigma = 1
+    {{0, 0.8430, 0.1570, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.5000, 0.5000, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1570, 0.8430, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 043: #...##, <noise^2> = 0
+    {{0, 0.8525, 0.2390, -0.0915}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.5356, 0.8057, -0.3413}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.2120, 1.3150, -0.5270}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 062: ##..#., <noise^2> = 0
+    {{-0.5227, 1.2132, 0.3095, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.3218, 0.5680, 0.7538, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 063: ##..##, <noise^2> = 0
+    {{-0.4793, 1.1904, 0.5212, -0.2323}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2323, 0.5212, 1.1904, -0.4793}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0102: #....#., <noise^2> = 0, sigma = 1
+    {{0, 0.8810, 0.1190, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6315, 0.3685, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.3685, 0.6315, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1190, 0.8810, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0103: #....##, <noise^2> = 0
+    {{0, 0.8779, 0.0945, 0.0276}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6327, 0.3779, -0.0106}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.4006, 0.8914, -0.2920}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1757, 1.3403, -0.5160}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0142: ##...#., <noise^2> = 0
+    {{-0.5270, 1.3150, 0.2120, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.3413, 0.8057, 0.5356, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{-0.0915, 0.2390, 0.8525, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0143: ##...##, <noise^2> = 0
+    {{-0.5230, 1.3163, 0.2536, -0.0469}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.3144, 0.8144, 0.8144, -0.3144}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{-0.0469, 0.2536, 1.3163, -0.5230}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0202: #.....#., <noise^2> = 0, sigma = 1
+    {{0, 0.8885, 0.1115, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6748, 0.3252, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5000, 0.5000, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3252, 0.6748, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1115, 0.8885, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0203: #.....##, <noise^2> = 0
+    {{0, 0.8824, 0.0626, 0.0549}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6601, 0.2068, 0.1331}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.4938, 0.4498, 0.0564}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3551, 0.9157, -0.2708}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1682, 1.3447, -0.5129}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0302: ##....#., <noise^2> = 0
+    {{-0.5160, 1.3403, 0.1757, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2920, 0.8914, 0.4006, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{-0.0106, 0.3779, 0.6327, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0276, 0.0945, 0.8779, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0303: ##....##, <noise^2> = 0
+    {{-0.5197, 1.3370, 0.1231, 0.0596}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2924, 0.8910, 0.3940, 0.0074}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0074, 0.3940, 0.8910, -0.2924}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0596, 0.1231, 1.3370, -0.5197}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0402: #......#., <noise^2> = 0, sigma = 1
+    {{0, 0.8893, 0.1107, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6830, 0.3170, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5435, 0.4565, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.4565, 0.5435, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3170, 0.6830, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1107, 0.8893, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0403: #......##, <noise^2> = 0
+    {{0, 0.8829, 0.0588, 0.0583}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6649, 0.1716, 0.1635}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5212, 0.2765, 0.2024}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.4477, 0.4730, 0.0793}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3465, 0.9201, -0.2666}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1673, 1.3452, -0.5125}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0602: ##.....#., <noise^2> = 0
+    {{-0.5129, 1.3447, 0.1682, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2708, 0.9157, 0.3551, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0564, 0.4498, 0.4938, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1331, 0.2068, 0.6601, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0549, 0.0626, 0.8824, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 0603: ##.....##, <noise^2> = 0
+    {{-0.5179, 1.3397, 0.0928, 0.0854}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2796, 0.9069, 0.2231, 0.1495}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0533, 0.4467, 0.4467, 0.0533}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1495, 0.2231, 0.9069, -0.2796}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0854, 0.0928, 1.3397, -0.5179}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 01002: #.......#., <noise^2> = 0, sigma = 1
+    {{0, 0.8894, 0.1106, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6839, 0.3161, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5517, 0.4483, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.5000, 0.5000, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4483, 0.5517, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3161, 0.6839, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1106, 0.8894, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 01003: #.......##, <noise^2> = 0
+    {{0, 0.8829, 0.0585, 0.0585}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6654, 0.1676, 0.1670}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5260, 0.2411, 0.2329}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.4751, 0.2995, 0.2254}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4390, 0.4773, 0.0836}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3456, 0.9205, -0.2661}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1673, 1.3452, -0.5125}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 01402: ##......#., <noise^2> = 0
+    {{-0.5125, 1.3452, 0.1673, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2666, 0.9201, 0.3465, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0793, 0.4730, 0.4477, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2024, 0.2765, 0.5212, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1635, 0.1716, 0.6649, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0583, 0.0588, 0.8829, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 01403: ##......##, <noise^2> = 0
+    {{-0.5177, 1.3400, 0.0891, 0.0886}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2771, 0.9095, 0.1878, 0.1797}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0677, 0.4614, 0.2725, 0.1984}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.1984, 0.2725, 0.4614, 0.0677}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1797, 0.1878, 0.9095, -0.2771}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0886, 0.0891, 1.3400, -0.5177}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 02002: #........#., <noise^2> = 0, sigma = 1
+    {{0, 0.8894, 0.1106, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6839, 0.3161, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5526, 0.4474, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.5082, 0.4918, 0}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.4918, 0.5082, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4474, 0.5526, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3161, 0.6839, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1106, 0.8894, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 02003: #........##, <noise^2> = 0
+    {{0, 0.8829, 0.0585, 0.0585}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6654, 0.1673, 0.1673}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5265, 0.2370, 0.2365}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.4799, 0.2641, 0.2560}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.4664, 0.3038, 0.2298}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4381, 0.4778, 0.0841}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3455, 0.9206, -0.2661}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1673, 1.3452, -0.5125}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 03002: ##.......#., <noise^2> = 0
+    {{-0.5125, 1.3452, 0.1673, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2661, 0.9205, 0.3456, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0836, 0.4773, 0.4390, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2254, 0.2995, 0.4751, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2329, 0.2411, 0.5260, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1670, 0.1676, 0.6654, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0585, 0.0585, 0.8829, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 03003: ##.......##, <noise^2> = 0
+    {{-0.5177, 1.3400, 0.0889, 0.0888}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2768, 0.9098, 0.1838, 0.1832}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0703, 0.4639, 0.2370, 0.2288}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2130, 0.2870, 0.2870, 0.2130}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2288, 0.2370, 0.4639, 0.0703}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1832, 0.1838, 0.9098, -0.2768}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0888, 0.0889, 1.3400, -0.5177}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 04002: #.........#., <noise^2> = 0
+    {{0, 0.8894, 0.1106, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6839, 0.3161, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5527, 0.4473, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.5091, 0.4909, 0}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.5000, 0.5000, 0}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0, 0.4909, 0.5091, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4473, 0.5527, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3161, 0.6839, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1106, 0.8894, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 04003: #.........##, <noise^2> = 0
+    {{0, 0.8829, 0.0585, 0.0585}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6654, 0.1673, 0.1673}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5265, 0.2368, 0.2367}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.4804, 0.2601, 0.2595}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.4712, 0.2685, 0.2603}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0, 0.4654, 0.3043, 0.2302}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4380, 0.4778, 0.0842}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3455, 0.9206, -0.2661}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1673, 1.3452, -0.5125}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 06002: ##........#., <noise^2> = 0
+    {{-0.5125, 1.3452, 0.1673, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2661, 0.9206, 0.3455, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0841, 0.4778, 0.4381, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2298, 0.3038, 0.4664, 0}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0.2560, 0.2641, 0.4799, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2365, 0.2370, 0.5265, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1673, 0.1673, 0.6654, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0585, 0.0585, 0.8829, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 06003: ##........##, <noise^2> = 0
+    {{-0.5177, 1.3400, 0.0888, 0.0888}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2768, 0.9098, 0.1835, 0.1835}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0705, 0.4642, 0.2329, 0.2324}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2155, 0.2896, 0.2515, 0.2434}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0.2434, 0.2515, 0.2896, 0.2155}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2324, 0.2329, 0.4642, 0.0705}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1835, 0.1835, 0.9098, -0.2768}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0888, 0.0888, 1.3400, -0.5177}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 010002: #..........#., <noise^2> = 0, sigma = 1
+    {{0, 0.8894, 0.1106, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6839, 0.3161, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5527, 0.4473, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.5092, 0.4908, 0}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.5009, 0.4991, 0}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0, 0.4991, 0.5009, 0}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0, 0.4908, 0.5092, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4473, 0.5527, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3161, 0.6839, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1106, 0.8894, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 010003: #..........##, <noise^2> = 0
+    {{0, 0.8829, 0.0585, 0.0585}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6654, 0.1673, 0.1673}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5265, 0.2367, 0.2367}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.4804, 0.2598, 0.2598}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.4717, 0.2644, 0.2639}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0, 0.4703, 0.2690, 0.2608}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0, 0.4654, 0.3043, 0.2303}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4380, 0.4778, 0.0842}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3455, 0.9206, -0.2661}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1673, 1.3452, -0.5125}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 014002: ##.........#., <noise^2> = 0
+    {{-0.5125, 1.3452, 0.1673, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2661, 0.9206, 0.3455, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0842, 0.4778, 0.4380, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2302, 0.3043, 0.4654, 0}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0.2603, 0.2685, 0.4712, 0}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0.2595, 0.2601, 0.4804, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2367, 0.2368, 0.5265, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1673, 0.1673, 0.6654, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0585, 0.0585, 0.8829, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 014003: ##.........##, <noise^2> = 0
+    {{-0.5177, 1.3400, 0.0888, 0.0888}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2768, 0.9098, 0.1835, 0.1835}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0705, 0.4642, 0.2326, 0.2326}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2158, 0.2899, 0.2474, 0.2469}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0.2459, 0.2541, 0.2541, 0.2459}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0.2469, 0.2474, 0.2899, 0.2158}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2326, 0.2326, 0.4642, 0.0705}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1835, 0.1835, 0.9098, -0.2768}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0888, 0.0888, 1.3400, -0.5177}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 020003: #...........##, <noise^2> = 0
+    {{0, 0.8829, 0.0585, 0.0585}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6654, 0.1673, 0.1673}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5265, 0.2367, 0.2367}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.4804, 0.2598, 0.2598}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.4718, 0.2641, 0.2641}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0, 0.4708, 0.2649, 0.2644}, Step::CLIP_MEAN, Step::X1, -5, Step::X1, -4},
+    {{0, 0.4702, 0.2690, 0.2608}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0, 0.4654, 0.3044, 0.2303}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4380, 0.4778, 0.0842}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3455, 0.9206, -0.2661}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1673, 1.3452, -0.5125}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 030002: ##..........#., <noise^2> = 0
+    {{-0.5125, 1.3452, 0.1673, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2661, 0.9206, 0.3455, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0842, 0.4778, 0.4380, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2303, 0.3043, 0.4654, 0}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0.2608, 0.2690, 0.4703, 0}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0.2639, 0.2644, 0.4717, 0}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0.2598, 0.2598, 0.4804, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2367, 0.2367, 0.5265, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1673, 0.1673, 0.6654, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0585, 0.0585, 0.8829, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 030003: ##..........##, <noise^2> = 0
+    {{-0.5177, 1.3400, 0.0888, 0.0888}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2768, 0.9098, 0.1835, 0.1835}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0705, 0.4642, 0.2326, 0.2326}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2158, 0.2899, 0.2472, 0.2471}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0.2462, 0.2544, 0.2500, 0.2495}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0.2495, 0.2500, 0.2544, 0.2462}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0.2471, 0.2472, 0.2899, 0.2158}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2326, 0.2326, 0.4642, 0.0705}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1835, 0.1835, 0.9098, -0.2768}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0888, 0.0888, 1.3400, -0.5177}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 040003: #............##, <noise^2> = 0
+    {{0, 0.8829, 0.0585, 0.0585}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6654, 0.1673, 0.1673}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5265, 0.2367, 0.2367}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.4804, 0.2598, 0.2598}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.4718, 0.2641, 0.2641}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0, 0.4708, 0.2646, 0.2646}, Step::CLIP_MEAN, Step::X0, 5, Step::X0, 6},
+    {{0, 0.4707, 0.2649, 0.2644}, Step::CLIP_MEAN, Step::X1, -5, Step::X1, -4},
+    {{0, 0.4702, 0.2690, 0.2608}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0, 0.4654, 0.3044, 0.2303}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4380, 0.4778, 0.0842}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3455, 0.9206, -0.2661}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1673, 1.3452, -0.5125}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // MIDDLE 060002: ##...........#., <noise^2> = 0
+    {{-0.5125, 1.3452, 0.1673, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2661, 0.9206, 0.3455, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0842, 0.4778, 0.4380, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2303, 0.3044, 0.4654, 0}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0.2608, 0.2690, 0.4702, 0}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0.2644, 0.2649, 0.4708, 0}, Step::CLIP_MEAN, Step::X1, -5, Step::X1, -4},
+    {{0.2641, 0.2641, 0.4718, 0}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0.2598, 0.2598, 0.4804, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2367, 0.2367, 0.5265, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1673, 0.1673, 0.6654, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0585, 0.0585, 0.8829, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // WIDE 06: #?#., <noise^2> = 0
+    {{0, 0.8894, 0.1106, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6839, 0.3161, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5527, 0.4473, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.5092, 0.4908, 0}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.5010, 0.4990, 0}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0, 0.5001, 0.4999, 0}, Step::CLIP_MEAN, Step::X0, 5, Step::X0, 6},
+    {{0, 0.5000, 0.5000, 0}, Step::CLIP_NONE, Step::X0, 6, Step::X1, -5},
+    {{0, 0.4999, 0.5001, 0}, Step::CLIP_MEAN, Step::X1, -5, Step::X1, -4},
+    {{0, 0.4990, 0.5010, 0}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0, 0.4908, 0.5092, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4473, 0.5527, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3161, 0.6839, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1106, 0.8894, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // WIDE 07: #?##, <noise^2> = 0
+    {{0, 0.8829, 0.0585, 0.0585}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{0, 0.6654, 0.1673, 0.1673}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0, 0.5265, 0.2367, 0.2367}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0, 0.4804, 0.2598, 0.2598}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0, 0.4718, 0.2641, 0.2641}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0, 0.4708, 0.2646, 0.2646}, Step::CLIP_MEAN, Step::X0, 5, Step::X0, 6},
+    {{0, 0.4707, 0.2646, 0.2646}, Step::CLIP_NONE, Step::X0, 6, Step::X1, -5},
+    {{0, 0.4707, 0.2649, 0.2644}, Step::CLIP_MEAN, Step::X1, -5, Step::X1, -4},
+    {{0, 0.4702, 0.2690, 0.2608}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0, 0.4654, 0.3044, 0.2303}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0, 0.4380, 0.4778, 0.0842}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0, 0.3455, 0.9206, -0.2661}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0, 0.1673, 1.3452, -0.5125}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // WIDE 016: ##?#., <noise^2> = 0
+    {{-0.5125, 1.3452, 0.1673, 0}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2661, 0.9206, 0.3455, 0}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0842, 0.4778, 0.4380, 0}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2303, 0.3044, 0.4654, 0}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0.2608, 0.2690, 0.4702, 0}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0.2644, 0.2649, 0.4707, 0}, Step::CLIP_MEAN, Step::X0, 5, Step::X0, 6},
+    {{0.2646, 0.2646, 0.4707, 0}, Step::CLIP_MEAN, Step::X0, 6, Step::X1, -5},
+    {{0.2646, 0.2646, 0.4708, 0}, Step::CLIP_MEAN, Step::X1, -5, Step::X1, -4},
+    {{0.2641, 0.2641, 0.4718, 0}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0.2598, 0.2598, 0.4804, 0}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2367, 0.2367, 0.5265, 0}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1673, 0.1673, 0.6654, 0}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0585, 0.0585, 0.8829, 0}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // WIDE 017: ##?##, S/N = infty
+    {{-0.5177, 1.3400, 0.0888, 0.0888}, Step::CLIP_MEAN, Step::X0, 0, Step::X0, 1},
+    {{-0.2768, 0.9098, 0.1835, 0.1835}, Step::CLIP_MEAN, Step::X0, 1, Step::X0, 2},
+    {{0.0705, 0.4642, 0.2326, 0.2326}, Step::CLIP_MEAN, Step::X0, 2, Step::X0, 3},
+    {{0.2158, 0.2899, 0.2472, 0.2472}, Step::CLIP_MEAN, Step::X0, 3, Step::X0, 4},
+    {{0.2462, 0.2544, 0.2497, 0.2497}, Step::CLIP_MEAN, Step::X0, 4, Step::X0, 5},
+    {{0.2497, 0.2503, 0.2500, 0.2500}, Step::CLIP_MEAN, Step::X0, 5, Step::X0, 6},
+    {{0.2500, 0.2500, 0.2500, 0.2500}, Step::CLIP_MEAN, Step::X0, 6, Step::X1, -5},
+    {{0.2500, 0.2500, 0.2503, 0.2497}, Step::CLIP_MEAN, Step::X1, -5, Step::X1, -4},
+    {{0.2497, 0.2497, 0.2544, 0.2462}, Step::CLIP_MEAN, Step::X1, -4, Step::X1, -3},
+    {{0.2472, 0.2472, 0.2899, 0.2158}, Step::CLIP_MEAN, Step::X1, -3, Step::X1, -2},
+    {{0.2326, 0.2326, 0.4642, 0.0705}, Step::CLIP_MEAN, Step::X1, -2, Step::X1, -1},
+    {{0.1835, 0.1835, 0.9098, -0.2768}, Step::CLIP_MEAN, Step::X1, -1, Step::X1, 0},
+    {{0.0888, 0.0888, 1.3400, -0.5177}, Step::CLIP_MEAN, Step::X1, 0, Step::X1, 1},
+    // WIDE_RIGHT 03: ##?, S/N = infty
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X0, 1, Step::X0, 2},
+    {{0.3032, 0.6968, 0, 0}, Step::CLIP_LEFT, Step::X0, 2, Step::X0, 3},
+    {{0.4630, 0.5370, 0, 0}, Step::CLIP_LEFT, Step::X0, 3, Step::X0, 4},
+    {{0.4959, 0.5041, 0, 0}, Step::CLIP_LEFT, Step::X0, 4, Step::X0, 5},
+    {{0.4997, 0.5003, 0, 0}, Step::CLIP_LEFT, Step::X0, 5, Step::X0, 6},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X0, 6, Step::X1, 1},
+    // RIGHT 06: ##., <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+    // RIGHT 014: ##.., <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+    // RIGHT 030: ##..., <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X1, -1, Step::X1, 0},
+    {{0.3032, 0.6968, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+    // RIGHT 060: ##...., <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X0, 1, Step::X0, 2},
+    {{0.3032, 0.6968, 0, 0}, Step::CLIP_LEFT, Step::X1, -1, Step::X1, 0},
+    {{0.4630, 0.5370, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+    // RIGHT 0140: ##....., <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X0, 1, Step::X0, 2},
+    {{0.3032, 0.6968, 0, 0}, Step::CLIP_LEFT, Step::X1, -2, Step::X1, -1},
+    {{0.4630, 0.5370, 0, 0}, Step::CLIP_LEFT, Step::X1, -1, Step::X1, 0},
+    {{0.4959, 0.5041, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+    // RIGHT 0300: ##......, <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X0, 1, Step::X0, 2},
+    {{0.3032, 0.6968, 0, 0}, Step::CLIP_LEFT, Step::X0, 2, Step::X0, 3},
+    {{0.4630, 0.5370, 0, 0}, Step::CLIP_LEFT, Step::X1, -2, Step::X1, -1},
+    {{0.4959, 0.5041, 0, 0}, Step::CLIP_LEFT, Step::X1, -1, Step::X1, 0},
+    {{0.4997, 0.5003, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+    // RIGHT 0600: ##......., <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X0, 1, Step::X0, 2},
+    {{0.3032, 0.6968, 0, 0}, Step::CLIP_LEFT, Step::X0, 2, Step::X0, 3},
+    {{0.4630, 0.5370, 0, 0}, Step::CLIP_LEFT, Step::X1, -3, Step::X1, -2},
+    {{0.4959, 0.5041, 0, 0}, Step::CLIP_LEFT, Step::X1, -2, Step::X1, -1},
+    {{0.4997, 0.5003, 0, 0}, Step::CLIP_LEFT, Step::X1, -1, Step::X1, 0},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+    // RIGHT 01400: ##........, <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X0, 1, Step::X0, 2},
+    {{0.3032, 0.6968, 0, 0}, Step::CLIP_LEFT, Step::X0, 2, Step::X0, 3},
+    {{0.4630, 0.5370, 0, 0}, Step::CLIP_LEFT, Step::X0, 3, Step::X0, 4},
+    {{0.4959, 0.5041, 0, 0}, Step::CLIP_LEFT, Step::X1, -3, Step::X1, -2},
+    {{0.4997, 0.5003, 0, 0}, Step::CLIP_LEFT, Step::X1, -2, Step::X1, -1},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, -1, Step::X1, 0},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+    // RIGHT 03000: ##........., <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X0, 1, Step::X0, 2},
+    {{0.3032, 0.6968, 0, 0}, Step::CLIP_LEFT, Step::X0, 2, Step::X0, 3},
+    {{0.4630, 0.5370, 0, 0}, Step::CLIP_LEFT, Step::X0, 3, Step::X0, 4},
+    {{0.4959, 0.5041, 0, 0}, Step::CLIP_LEFT, Step::X1, -4, Step::X1, -3},
+    {{0.4997, 0.5003, 0, 0}, Step::CLIP_LEFT, Step::X1, -3, Step::X1, -2},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, -2, Step::X1, -1},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, -1, Step::X1, 0},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+    // RIGHT 06000: ##.........., <noise^2> = 0
+    {{-0.4288, 1.4288, 0, 0}, Step::CLIP_LEFT, Step::X0, 0, Step::X0, 1},
+    {{-0.0933, 1.0933, 0, 0}, Step::CLIP_LEFT, Step::X0, 1, Step::X0, 2},
+    {{0.3032, 0.6968, 0, 0}, Step::CLIP_LEFT, Step::X0, 2, Step::X0, 3},
+    {{0.4630, 0.5370, 0, 0}, Step::CLIP_LEFT, Step::X0, 3, Step::X0, 4},
+    {{0.4959, 0.5041, 0, 0}, Step::CLIP_LEFT, Step::X0, 4, Step::X0, 5},
+    {{0.4997, 0.5003, 0, 0}, Step::CLIP_LEFT, Step::X1, -4, Step::X1, -3},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, -3, Step::X1, -2},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, -2, Step::X1, -1},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, -1, Step::X1, 0},
+    {{0.5000, 0.5000, 0, 0}, Step::CLIP_LEFT, Step::X1, 0, Step::X1, 1},
+};
+
+struct InterpPattern {
+    Defect::DefectPosition pos;         // the defect's position
+    unsigned int type;                  // and type
+    int begin, end;                     // the steps are interpSteps[begin, end)
+};
+/*
+ * The defects that we know how to interpolate over, sorted by position and type
+ */
+constexpr InterpPattern interpPatterns[] = {
+    {Defect::LEFT, 02, 0, 1},
+    {Defect::LEFT, 04, 1, 3},
+    {Defect::LEFT, 06, 3, 4},
+    {Defect::LEFT, 010, 4, 7},
+    {Defect::LEFT, 014, 7, 9},
+    {Defect::LEFT, 020, 9, 13},
+    {Defect::LEFT, 030, 13, 16},
+    {Defect::LEFT, 040, 16, 21},
+    {Defect::LEFT, 060, 21, 25},
+    {Defect::LEFT, 0100, 25, 31},
+    {Defect::LEFT, 0140, 31, 36},
+    {Defect::LEFT, 0200, 36, 43},
+    {Defect::LEFT, 0300, 43, 49},
+    {Defect::LEFT, 0400, 49, 57},
+    {Defect::LEFT, 0600, 57, 64},
+    {Defect::LEFT, 01000, 64, 73},
+    {Defect::LEFT, 01400, 73, 81},
+    {Defect::LEFT, 02000, 81, 91},
+    {Defect::LEFT, 03000, 91, 100},
+    {Defect::LEFT, 06000, 100, 110},
+    {Defect::WIDE_LEFT, 02, 110, 111},
+    {Defect::WIDE_LEFT, 03, 111, 118},
+    {Defect::MIDDLE, 012, 118, 119},
+    {Defect::MIDDLE, 013, 119, 120},
+    {Defect::MIDDLE, 022, 120, 122},
+    {Defect::MIDDLE, 023, 122, 124},
+    {Defect::MIDDLE, 032, 124, 125},
+    {Defect::MIDDLE, 033, 125, 126},
+    {Defect::MIDDLE, 042, 126, 129},
+    {Defect::MIDDLE, 043, 129, 132},
+    {Defect::MIDDLE, 062, 132, 134},
+    {Defect::MIDDLE, 063, 134, 136},
+    {Defect::MIDDLE, 0102, 136, 140},
+    {Defect::MIDDLE, 0103, 140, 144},
+    {Defect::MIDDLE, 0142, 144, 147},
+    {Defect::MIDDLE, 0143, 147, 150},
+    {Defect::MIDDLE, 0202, 150, 155},
+    {Defect::MIDDLE, 0203, 155, 160},
+    {Defect::MIDDLE, 0302, 160, 164},
+    {Defect::MIDDLE, 0303, 164, 168},
+    {Defect::MIDDLE, 0402, 168, 174},
+    {Defect::MIDDLE, 0403, 174, 180},
+    {Defect::MIDDLE, 0602, 180, 185},
+    {Defect::MIDDLE, 0603, 185, 190},
+    {Defect::MIDDLE, 01002, 190, 197},
+    {Defect::MIDDLE, 01003, 197, 204},
+    {Defect::MIDDLE, 01402, 204, 210},
+    {Defect::MIDDLE, 01403, 210, 216},
+    {Defect::MIDDLE, 02002, 216, 224},
+    {Defect::MIDDLE, 02003, 224, 232},
+    {Defect::MIDDLE, 03002, 232, 239},
+    {Defect::MIDDLE, 03003, 239, 246},
+    {Defect::MIDDLE, 04002, 246, 255},
+    {Defect::MIDDLE, 04003, 255, 264},
+    {Defect::MIDDLE, 06002, 264, 272},
+    {Defect::MIDDLE, 06003, 272, 280},
+    {Defect::MIDDLE, 010002, 280, 290},
+    {Defect::MIDDLE, 010003, 290, 300},
+    {Defect::MIDDLE, 014002, 300, 309},
+    {Defect::MIDDLE, 014003, 309, 318},
+    {Defect::MIDDLE, 020003, 318, 329},
+    {Defect::MIDDLE, 030002, 329, 339},
+    {Defect::MIDDLE, 030003, 339, 349},
+    {Defect::MIDDLE, 040003, 349, 361},
+    {Defect::MIDDLE, 060002, 361, 372},
+    {Defect::WIDE, 06, 372, 385},
+    {Defect::WIDE, 07, 385, 398},
+    {Defect::WIDE, 016, 398, 411},
+    {Defect::WIDE, 017, 411, 424},
+    {Defect::WIDE_RIGHT, 03, 424, 431},
+    {Defect::RIGHT, 06, 431, 432},
+    {Defect::RIGHT, 014, 432, 434},
+    {Defect::RIGHT, 030, 434, 437},
+    {Defect::RIGHT, 060, 437, 441},
+    {Defect::RIGHT, 0140, 441, 446},
+    {Defect::RIGHT, 0300, 446, 452},
+    {Defect::RIGHT, 0600, 452, 459},
+    {Defect::RIGHT, 01400, 459, 467},
+    {Defect::RIGHT, 03000, 467, 476},
+    {Defect::RIGHT, 06000, 476, 486},
+};
+
+constexpr int nInterpPattern = sizeof(interpPatterns)/sizeof(interpPatterns[0]);
+
+constexpr bool comparePatterns(InterpPattern const& a, InterpPattern const& b) {
+    return a.pos < b.pos || (a.pos == b.pos && a.type < b.type);
+}
 
-        Defect::DefectPosition defectPos = defect->getPos();
-        unsigned int defectType = defect->getType();
+// Check that interpPatterns is sorted, and that its steps tile interpSteps
+constexpr bool checkPatterns(int i) {
+    return (i == nInterpPattern - 1) ?
+        interpPatterns[i].end == sizeof(interpSteps)/sizeof(interpSteps[0]) :
+        (comparePatterns(interpPatterns[i], interpPatterns[i + 1]) &&
+         interpPatterns[i].begin < interpPatterns[i].end &&
+         interpPatterns[i].end == interpPatterns[i + 1].begin &&
+         checkPatterns(i + 1));
+}
+static_assert(interpPatterns[0].begin == 0 && checkPatterns(0), "Inconsistent interpolation tables");
 
-        int nbad = badX1 - badX0 + 1;
+/*
+ * The tables are expanded at compile time into a function for each pattern:  the coefficients, the
+ * clipping, and the ranges of pixels set are all constants, so each pattern gets the same straight-line
+ * code as the hand-written switch that the tables replace.
+ *
+ * The terms are summed in order starting with the first one used, so as to give the same results as the
+ * switch, and unused (maybe NaN) neighbours are never touched.
+ */
+constexpr int firstTerm(int s, int k = 0) {
+    return (interpSteps[s].coeff[k] != 0) ? k : firstTerm(s, k + 1);
+}
 
-        if (nbad > nUseInterp && useFallbackValueAtEdge) {
-            switch (defectPos) {
-              case Defect::LEFT:
-              case Defect::WIDE_LEFT:
-                assert(badX0 == 0);
+template <int S, int K, bool Used = (K < 4 && interpSteps[S].coeff[K] != 0)>
+struct AddTerms {                       // Add the terms K..3 of step S to sum
+    template <typename TapsT>
+    static double apply(double sum, TapsT const& taps) {
+        return AddTerms<S, K + 1>::apply(sum + interpSteps[S].coeff[K]*taps[K], taps);
+    }
+};
 
-                if (badX1 == ncol - 1) { // also RIGHT --- spans the entire image
-                    for (int i = 0; i != ncol; ++i) {
-                        out[i] = fallbackValue;
-                    }
-                    continue;
-                }
+template <int S, int K>
+struct AddTerms<S, K, false> {
+    template <typename TapsT>
+    static double apply(double sum, TapsT const& taps) {
+        return AddTerms<S, K + 1>::apply(sum, taps);
+    }
+};
 
-                for (; badX0 <= badX1 - nUseInterp; ++badX0) {
-                    out[badX0] = fallbackValue;
-                }
+template <int S>
+struct AddTerms<S, 4, false> {
+    template <typename TapsT>
+    static double apply(double sum, TapsT const&) {
+        return sum;
+    }
+};
 
-                if (defectPos == Defect::LEFT) {
-                    defectType >>= nbad;    // we just want the last 2 bits
-                    switch (defectType) {
-                      case 01: defectType = 02; break;
-                      case 03: defectType = 03; break;
-                      default:
-                        throw std::runtime_error(str(boost::format("Impossible value of defectType: 0%o") %
-                                                     defectType));
-                    }
-                }
-                nbad = badX1 - badX0 + 1;
-                defectType = (03 << (nbad + 2)) | defectType;
-                defectPos = (badX0 > 1) ? ((badX1 < ncol - 2) ? Defect::MIDDLE : Defect::NEAR_RIGHT) :
-                    Defect::NEAR_LEFT;
-                break;
-              case Defect::RIGHT:
-              case Defect::WIDE_RIGHT:
-                assert(badX1 == ncol - 1);
-                for (; badX1 >= badX0 + nUseInterp; --badX1) {
-                    out[badX1] = fallbackValue;
-                }
-                nbad = badX1 - badX0 + 1;
-                defectType = (03 << (nbad + 2)) | 03;
-                defectPos = (badX1 < ncol - 2) ? Defect::MIDDLE : Defect::NEAR_RIGHT;
-                break;
-              default:
-                break;
-            }
+/*
+ * Return the value that step S sets its pixels to, given the neighbours taps[0..3] (out1_2, out1_1, out2_1,
+ * and out2_2)
+ */
+template <int S, typename PixelT, typename TapsT>
+PixelT stepValue(TapsT const& taps, PixelT const min) {
+    constexpr int k = firstTerm(S);
+    PixelT val = AddTerms<S, k + 1>::apply(interpSteps[S].coeff[k]*taps[k], taps);
+
+    switch (interpSteps[S].clip) {
+      case Step::CLIP_NONE:
+        break;
+      case Step::CLIP_LEFT:
+        if (val < min) {
+            val = taps[1];
         }
+        break;
+      case Step::CLIP_RIGHT:
+        if (val < min) {
+            val = taps[2];
+        }
+        break;
+      case Step::CLIP_MEAN:
+        if (val < min) {
+            val = 0.5*(taps[1] + taps[2]);
+        }
+        break;
+      case Step::CLIP_ZERO:
+        if (val < 0) {
+            val = 0;
+        }
+        break;
+    }
 
-        switch (defectPos) {
-          case Defect::LEFT:
-            assert(badX0 >= 0 && badX1 + 2 < ncol);
-
-            out2_1 = out[badX1 + 1];
-            out2_2 = out[badX1 + 2];
+    return val;
+}
 
-            switch (defectType) {
-              case 02:              /* .#?, <noise^2> = 0 */
-                val = 1.0000*out2_1;
-                out[badX1] = (val < min) ? out2_1 : val;
+template <int S, int E>
+struct ApplySteps {                     // Apply the steps [S, E)
+    template <typename PixelT, typename IterT>
+    static void apply(IterT out, int const badX0, int const badX1, PixelT const taps[4], PixelT const min) {
+        PixelT const val = stepValue<S>(taps, min);
+
+        Step const& step = interpSteps[S];
+        int const begin = ((step.beginAnchor == Step::X0) ? badX0 : badX1) + step.beginOffset;
+        int const end = ((step.endAnchor == Step::X0) ? badX0 : badX1) + step.endOffset;
+        for (int j = begin; j < end; ++j) {
+            out[j] = val;
+        }
 
-                break;
-              case 06:              /* .##, <noise^2> = 0 */
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
+        ApplySteps<S + 1, E>::apply(out, badX0, badX1, taps, min);
+    }
+};
+
+template <int E>
+struct ApplySteps<E, E> {
+    template <typename PixelT, typename IterT>
+    static void apply(IterT, int const, int const, PixelT const *, PixelT const) {}
+};
+
+template <int P, typename PixelT, typename IterT>
+void interpolatePattern(IterT out, int const badX0, int const badX1,
+                        PixelT const out1_2, PixelT const out1_1, PixelT const out2_1, PixelT const out2_2,
+                        PixelT const min) {
+    PixelT const taps[4] = {out1_2, out1_1, out2_1, out2_2};
+    ApplySteps<interpPatterns[P].begin, interpPatterns[P].end>::apply(out, badX0, badX1, taps, min);
+}
 
-                break;
-              case 014:             /* ..##, <noise^2> = 0 */
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX0] = (val < min) ? out2_1 : val;
+/*
+ * The neighbours of column c of a block of adjacent columns that share a defect, which we're interpolating
+ * along the columns;  rows[k] are the image's rows badX0 - 2, badX0 - 1, badX1 + 1, and badX1 + 2, starting
+ * at the block's first column.  Neighbours that aren't loaded are -1, as in detail::interpolateDefect
+ */
+template <typename PixelT, typename IterT>
+struct BlockTaps {
+    PixelT operator[](int const k) const { return load[k] ? static_cast<PixelT>(rows[k][c]) : PixelT(-1); }
+
+    IterT rows[4];
+    bool load[4];
+    int c;
+};
+
+template <int S, int E>
+struct ApplyBlockSteps {                // Apply the steps [S, E) to all the columns of a block
+    template <typename PixelT, typename ImageT>
+    static void apply(ImageT &image, int const x0, int const ncol, int const badX0, int const badX1,
+                      BlockTaps<PixelT, typename ImageT::x_iterator> const &taps, PixelT const min) {
+        Step const& step = interpSteps[S];
+        int const begin = ((step.beginAnchor == Step::X0) ? badX0 : badX1) + step.beginOffset;
+        int const end = ((step.endAnchor == Step::X0) ? badX0 : badX1) + step.endOffset;
+        if (begin < end) {
+            typename ImageT::x_iterator out = image.row_begin(begin) + x0;
+            BlockTaps<PixelT, typename ImageT::x_iterator> column = taps;
+            for (column.c = 0; column.c != ncol; ++column.c) {
+                out[column.c] = stepValue<S>(column, min);
+            }
+            for (int j = begin + 1; j < end; ++j) {
+                std::copy(out, out + ncol, image.row_begin(j) + x0);
+            }
+        }
 
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
+        ApplyBlockSteps<S + 1, E>::apply(image, x0, ncol, badX0, badX1, taps, min);
+    }
+};
+
+template <int E>
+struct ApplyBlockSteps<E, E> {
+    template <typename PixelT, typename ImageT>
+    static void apply(ImageT &, int const, int const, int const, int const,
+                      BlockTaps<PixelT, typename ImageT::x_iterator> const &, PixelT const) {}
+};
+
+template <int P, typename PixelT, typename ImageT>
+void interpolateBlockPattern(ImageT &image, int const x0, int const ncol, int const badX0, int const badX1,
+                             BlockTaps<PixelT, typename ImageT::x_iterator> const &taps, PixelT const min) {
+    ApplyBlockSteps<interpPatterns[P].begin, interpPatterns[P].end>::apply(image, x0, ncol, badX0, badX1,
+                                                                          taps, min);
+}
 
-                break;
-              case 04:             /* ..#?, <noise^2> = 0 */
-                val = 1.000*out2_1;
-                out[badX0] = (val < min) ? out2_1 : val;
-                out[badX1] = (val < min) ? out2_1 : val;
+template <typename PixelT, typename IterT>
+using PatternKernel = void (*)(IterT, int, int, PixelT, PixelT, PixelT, PixelT, PixelT);
 
-                break;
-              case 030:             /* ...##, <noise^2> = 0 */
-                val = 0.6968*out2_1 + 0.3032*out2_2;
-                out[badX0] = (val < min) ? out2_1 : val;
+template <int... I> struct Indices {};
+template <int N, int... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+template <int... I> struct MakeIndices<0, I...> { typedef Indices<I...> type; };
 
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
+template <typename PixelT, typename IterT, int... I>
+PatternKernel<PixelT, IterT> const *getPatternKernels(Indices<I...>) {
+    static PatternKernel<PixelT, IterT> const kernels[] = { &interpolatePattern<I, PixelT, IterT>... };
+    return kernels;
+}
 
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
+template <typename PixelT, typename ImageT>
+using BlockPatternKernel = void (*)(ImageT &, int, int, int, int,
+                                    BlockTaps<PixelT, typename ImageT::x_iterator> const &, PixelT);
 
-                break;
-              case 010:             /* ...#?, <noise^2> = 0 */
-                val = 1.000*out2_1;
+template <typename PixelT, typename ImageT, int... I>
+BlockPatternKernel<PixelT, ImageT> const *getBlockPatternKernels(Indices<I...>) {
+    static BlockPatternKernel<PixelT, ImageT> const kernels[] = {
+        &interpolateBlockPattern<I, PixelT, ImageT>...
+    };
+    return kernels;
+}
 
-                out[badX0] = (val < min) ? out2_1 : val;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-                out[badX1] = (val < min) ? out2_1 : val;
+/*
+ * How to interpolate over the pixels [badX0, badX1] of a row of length ncol, given the defect's position:
+ * which of its neighbours out[badX0 - 2], out[badX0 - 1], out[badX1 + 1], and out[badX1 + 2] to load, or
+ * (for wide defects that reach the far side of the row) which pixel to set it to instead
+ */
+struct DefectTaps {
+    enum Action {
+        INTERPOLATE,                    // interpolate using the neighbours in load
+        FILL,                           // set the defect to out[fillFrom], or the fallback value if it's -1
+        NONE                            // leave the defect alone
+    };
 
-                break;
-              case 060:             /* ....##, <noise^2> = 0 */
-                val = 0.5370*out2_1 + 0.4630*out2_2;
-                out[badX0] = (val < min) ? out2_1 : val;
+    Action action;
+    bool load[4];                       // load out1_2, out1_1, out2_1, out2_2?
+    int fillFrom;
+};
 
-                val = 0.6968*out2_1 + 0.3032*out2_2;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
+/*
+ * Are all the pixels that taps reads or writes for the defect [badX0, badX1] within a row of length ncol?
+ */
+bool tapsInRow(DefectTaps const& taps, int const ncol, int const badX0, int const badX1) {
+    if (taps.action == DefectTaps::NONE) {
+        return true;
+    }
+    if (badX0 < 0 || badX1 >= ncol) {
+        return false;
+    }
+    return taps.action != DefectTaps::INTERPOLATE ||
+        ((!taps.load[0] || badX0 >= 2) && (!taps.load[1] || badX0 >= 1) &&
+         (!taps.load[2] || badX1 + 1 < ncol) && (!taps.load[3] || badX1 + 2 < ncol));
+}
 
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
+DefectTaps findDefectTaps(int const ncol, int const badX0, int const badX1,
+                          Defect::DefectPosition const pos) {
+    DefectTaps taps = {DefectTaps::INTERPOLATE, {true, true, true, true}, -1};
+
+    switch (pos) {
+      case Defect::LEFT:
+        taps.load[0] = taps.load[1] = false;
+        break;
+      case Defect::WIDE_LEFT:
+      case Defect::WIDE_NEAR_LEFT:
+        if (badX1 + 2 >= ncol) {        // left defect extends near right edge of data!
+            taps.action = DefectTaps::FILL; // there is no information
+            if (badX1 == ncol - 2) {    // one column remains
+                taps.fillFrom = ncol - 1;
+            }
+            break;
+        }
+        taps.load[1] = (pos == Defect::WIDE_NEAR_LEFT);
+        taps.load[0] = false;
+        break;
+      case Defect::RIGHT:
+        taps.load[2] = taps.load[3] = false;
+        break;
+      case Defect::WIDE_RIGHT:
+      case Defect::WIDE_NEAR_RIGHT:
+        if (badX0 < 2) {                // right defect extends near left edge of data!
+            taps.action = DefectTaps::FILL; // there is no information
+            if (badX0 == 1) {           // one column remains
+                taps.fillFrom = 0;
+            }
+            break;
+        }
+        taps.load[2] = (pos == Defect::WIDE_NEAR_RIGHT);
+        taps.load[3] = false;
+        break;
+      case Defect::MIDDLE:
+      case Defect::WIDE:
+        break;
+      case Defect::NEAR_LEFT:
+        taps.load[0] = false;
+        break;
+      case Defect::NEAR_RIGHT:
+        taps.load[3] = false;
+        break;
+      default:
+        taps.action = DefectTaps::NONE;
+        break;
+    }
 
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
+    return taps;
+}
+}
 
-                break;
-              case 020:             /* ....#?, <noise^2> = 0 */
-                val = 1.0000*out2_1;
+int detail::findInterpPattern(Defect::DefectPosition pos, unsigned int type) {
+    switch (pos) {                      // these share their neighbours' interpolants
+      case Defect::NEAR_LEFT:
+      case Defect::NEAR_RIGHT:
+        pos = Defect::MIDDLE;
+        break;
+      case Defect::WIDE_NEAR_LEFT:
+      case Defect::WIDE_NEAR_RIGHT:
+        pos = Defect::WIDE;
+        break;
+      default:
+        break;
+    }
 
-                out[badX0] = (val < min) ? out2_1 : val;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-                out[badX1] = (val < min) ? out2_1 : val;
+    InterpPattern const key = {pos, type, 0, 0};
+    InterpPattern const *end = interpPatterns + nInterpPattern;
+    InterpPattern const *pattern = std::lower_bound(interpPatterns, end, key, comparePatterns);
+    if (pattern == end || pattern->pos != pos || pattern->type != type) {
+        return -1;
+    }
 
-                break;
-              case 0140:            /* .....##, <noise^2> = 0 */
-                val = 0.5041*out2_1 + 0.4959*out2_2;
-                out[badX0] = (val < min) ? out2_1 : val;
+    return pattern - interpPatterns;
+}
 
-                val = 0.5370*out2_1 + 0.4630*out2_2;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
+bool detail::isValidDefect(int const ncol, int const badX0, int const badX1,
+                           Defect::DefectPosition const pos, int const pattern) {
+    if (pos < Defect::LEFT || pos > Defect::RIGHT || badX0 > badX1) {
+        return false;
+    }
+    DefectTaps const taps = findDefectTaps(ncol, badX0, badX1, pos);
+    if (!tapsInRow(taps, ncol, badX0, badX1)) {
+        return false;
+    }
+    return taps.action != DefectTaps::INTERPOLATE || (0 <= pattern && pattern < nInterpPattern);
+}
 
-                val = 0.6968*out2_1 + 0.3032*out2_2;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
+template <typename PixelT, typename IterT>
+void detail::interpolateDefect(IterT out, int const ncol, int const badX0, int const badX1,
+                               Defect::DefectPosition const pos, int const pattern,
+                               PixelT const min, double const fallbackValue) {
+    DefectTaps const defectTaps = findDefectTaps(ncol, badX0, badX1, pos);
+    assert(tapsInRow(defectTaps, ncol, badX0, badX1));
+    switch (defectTaps.action) {
+      case DefectTaps::NONE:
+        return;
+      case DefectTaps::FILL:
+        {
+            PixelT const val = (defectTaps.fillFrom < 0) ? PixelT(fallbackValue) :
+                                                           PixelT(out[defectTaps.fillFrom]);
+            for (int j = badX0; j <= badX1; ++j) {
+                out[j] = val;
+            }
+        }
+        return;
+      case DefectTaps::INTERPOLATE:
+        break;
+    }
 
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
+    if (pattern < 0) {
+        return;
+    }
+    PixelT out1_2 = -1, out1_1 = -1, out2_1 = -1, out2_2 = -1; // -1 if NOTUSED
+    if (defectTaps.load[0]) {
+        out1_2 = out[badX0 - 2];
+    }
+    if (defectTaps.load[1]) {
+        out1_1 = out[badX0 - 1];
+    }
+    if (defectTaps.load[2]) {
+        out2_1 = out[badX1 + 1];
+    }
+    if (defectTaps.load[3]) {
+        out2_2 = out[badX1 + 2];
+    }
 
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
+    PatternKernel<PixelT, IterT> const *kernels =
+        getPatternKernels<PixelT, IterT>(MakeIndices<nInterpPattern>::type());
+    kernels[pattern](out, badX0, badX1, out1_2, out1_1, out2_1, out2_2, min);
+}
 
-                break;
-              case 040:            /* .....#?, <noise^2> = 0 */
-                val = 1.0000*out2_1;
-                out[badX0] = (val < min) ? out2_1 : val;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-                out[badX1] = (val < min) ? out2_1 : val;
+namespace {
+/*
+ * Interpolate along the columns [x0, x0 + ncol) of image over their pixels [badX0, badX1], which all the
+ * columns share; the same as calling detail::interpolateDefect for each column (of length nrow), but each
+ * step reads and writes a contiguous range of pixels in a row
+ */
+template <typename PixelT, typename ImageT>
+void interpolateBlockDefect(ImageT &image, int const x0, int const ncol, int const nrow,
+                            int const badX0, int const badX1, Defect::DefectPosition const pos,
+                            int const pattern, PixelT const min, double const fallbackValue) {
+    DefectTaps const defectTaps = findDefectTaps(nrow, badX0, badX1, pos);
+    assert(tapsInRow(defectTaps, nrow, badX0, badX1));
+    switch (defectTaps.action) {
+      case DefectTaps::NONE:
+        return;
+      case DefectTaps::FILL:
+        for (int j = badX0; j <= badX1; ++j) {
+            typename ImageT::x_iterator out = image.row_begin(j) + x0;
+            if (defectTaps.fillFrom < 0) {
+                std::fill(out, out + ncol, PixelT(fallbackValue));
+            } else {
+                std::copy(image.row_begin(defectTaps.fillFrom) + x0,
+                          image.row_begin(defectTaps.fillFrom) + x0 + ncol, out);
+            }
+        }
+        return;
+      case DefectTaps::INTERPOLATE:
+        break;
+    }
 
-                break;
-              case 0300:            /* ......##, <noise^2> = 0 */
-                val = 0.5003*out2_1 + 0.4997*out2_2;
-                out[badX0] = (val < min) ? out2_1 : val;
+    if (pattern < 0) {
+        return;
+    }
+    int const rows[4] = {badX0 - 2, badX0 - 1, badX1 + 1, badX1 + 2};
+    BlockTaps<PixelT, typename ImageT::x_iterator> taps;
+    for (int k = 0; k != 4; ++k) {
+        taps.load[k] = defectTaps.load[k];
+        taps.rows[k] = taps.load[k] ? image.row_begin(rows[k]) + x0 : typename ImageT::x_iterator();
+    }
+    taps.c = 0;
 
-                val = 0.5041*out2_1 + 0.4959*out2_2;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
+    BlockPatternKernel<PixelT, ImageT> const *kernels =
+        getBlockPatternKernels<PixelT, ImageT>(MakeIndices<nInterpPattern>::type());
+    kernels[pattern](image, x0, ncol, badX0, badX1, taps, min);
+}
+}
 
-                val = 0.5370*out2_1 + 0.4630*out2_2;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
+namespace {
+typedef DefectPlan::Segment RowDefect;  // a 1-D defect that's been decoded, ready to be interpolated over
+}
 
-                val = 0.6968*out2_1 + 0.3032*out2_2;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
+/*
+ * Decode a classified 1-D defect, the pixels [badX0, badX1] in a row of length ncol.  If it touches the edge
+ * of the chip and useFallbackValueAtEdge is true, only the nUseInterp pixels furthest from the edge are
+ * interpolated; the rest are set to the fallback value.  The result doesn't depend on the row, or on which
+ * image plane is being interpolated
+ */
+static RowDefect decode_defect(int badX0,             // first bad pixel
+                               int badX1,             // last bad pixel
+                               Defect::DefectPosition defectPos, // the defect's position
+                               unsigned int defectType,          //            and type
+                               int const ncol,        // number of columns in the row
+                               bool useFallbackValueAtEdge, // use fallbackValue at edge of chip?
+                               int nUseInterp         // no. of pixels to interpolate towards edge
+                              )
+{
 
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
+    RowDefect decoded;
+    decoded.x0 = decoded.badX0 = badX0;
+    decoded.x1 = decoded.badX1 = badX1;
+    decoded.pos = defectPos;
+    decoded.type = defectType;
+    decoded.pattern = -1;
+    decoded.fallbackX0 = 0;
+    decoded.fallbackX1 = -1;
+    decoded.interpolate = true;
 
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
+    int nbad = badX1 - badX0 + 1;
 
-                break;
-              case 0100:            /* ......#?, <noise^2> = 0 */
-                val = 1.0000*out2_1;
+    if (nbad > nUseInterp && useFallbackValueAtEdge) {
+        switch (defectPos) {
+          case Defect::LEFT:
+          case Defect::WIDE_LEFT:
+            assert(badX0 == 0);
 
-                out[badX0] = (val < min) ? out2_1 : val;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-                out[badX1] = (val < min) ? out2_1 : val;
+            if (badX1 == ncol - 1) { // also RIGHT --- spans the entire image
+                decoded.fallbackX1 = ncol - 1;
+                decoded.interpolate = false;
+                return decoded;
+            }
 
-                break;
-              case 0600:            /* .......##, <noise^2> = 0 */
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0] = (val < min) ? out2_1 : val;
+            decoded.fallbackX0 = badX0;
+            badX0 = badX1 - nUseInterp + 1;
+            decoded.fallbackX1 = badX0 - 1;
+
+            if (defectPos == Defect::LEFT) {
+                defectType >>= nbad;    // we just want the last 2 bits
+                switch (defectType) {
+                  case 01: defectType = 02; break;
+                  case 03: defectType = 03; break;
+                  default:
+                    throw std::runtime_error(str(boost::format("Impossible value of defectType: 0%o") %
+                                                 defectType));
+                }
+            }
+            nbad = badX1 - badX0 + 1;
+            defectType = (03 << (nbad + 2)) | defectType;
+            defectPos = (badX0 > 1) ? ((badX1 < ncol - 2) ? Defect::MIDDLE : Defect::NEAR_RIGHT) :
+                Defect::NEAR_LEFT;
+            break;
+          case Defect::RIGHT:
+          case Defect::WIDE_RIGHT:
+            assert(badX1 == ncol - 1);
+            decoded.fallbackX0 = badX0 + nUseInterp;
+            decoded.fallbackX1 = badX1;
+            badX1 = badX0 + nUseInterp - 1;
+
+            nbad = badX1 - badX0 + 1;
+            defectType = (03 << (nbad + 2)) | 03;
+            defectPos = (badX1 < ncol - 2) ? Defect::MIDDLE : Defect::NEAR_RIGHT;
+            break;
+          default:
+            break;
+        }
+    }
 
-                val = 0.5003*out2_1 + 0.4997*out2_2;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
+    decoded.badX0 = badX0;
+    decoded.badX1 = badX1;
+    decoded.pos = defectPos;
+    decoded.type = defectType;
+    decoded.pattern = detail::findInterpPattern(defectPos, defectType);
 
-                val = 0.5041*out2_1 + 0.4959*out2_2;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
+    return decoded;
+}
 
-                val = 0.5370*out2_1 + 0.4630*out2_2;
-                out[badX1 - 3] = (val < min) ? out2_1 : val;
+/*
+ * Return which of the pixels badX0 - 2, badX0 - 1, badX1 + 1, and badX1 + 2 (bits 3, 2, 1, and 0) are good
+ * and may be used to interpolate over a wide defect in a row of length ncol, or 0 if the defect isn't wide
+ * or none may be used
+ */
+static int wide_neighbours(RowDefect const& defect, int const ncol)
+{
+    if (!defect.interpolate) {
+        return 0;
+    }
 
-                val = 0.6968*out2_1 + 0.3032*out2_2;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
+    int neighbours = 0;
+    switch (defect.pos) {
+      case Defect::WIDE:                // the type has the same bits; see classify_run
+      case Defect::WIDE_NEAR_LEFT:
+      case Defect::WIDE_NEAR_RIGHT:
+      case Defect::WIDE_LEFT:
+        neighbours = defect.type & 017;
+        break;
+      case Defect::WIDE_RIGHT:          // the type is always 03, for the two good pixels on the left
+        neighbours = 014;
+        break;
+      default:
+        return 0;
+    }
 
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
+    if (defect.badX0 < 2) {
+        neighbours &= ~010;
+    }
+    if (defect.badX0 < 1) {
+        neighbours &= ~04;
+    }
+    if (defect.badX1 + 1 >= ncol) {
+        neighbours &= ~02;
+    }
+    if (defect.badX1 + 2 >= ncol) {
+        neighbours &= ~01;
+    }
 
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
+    return neighbours;
+}
 
-                break;
-              case 0200:            /* .......#?, <noise^2> = 0 */
-                val = 1.0000*out2_1;
-                out[badX0] = (val < min) ? out2_1 : val;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
-                out[badX1 - 3] = (val < min) ? out2_1 : val;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-                out[badX1] = (val < min) ? out2_1 : val;
+namespace {
+/*
+ * Weights to interpolate over wide defects using the PSF: each pixel is predicted from the good neighbours
+ * badX0 - 2, badX0 - 1, badX1 + 1, and badX1 + 2 by ordinary kriging, with the covariance between pixels d
+ * apart taken to be the PSF's autocorrelation, exp(-d^2/(4 sigma^2)), plus a little white noise
+ * (interp::wideNugget).
+ *
+ * The weights only depend on the defect's width and which neighbours are good, so the system is solved once
+ * for each (width, neighbours) in the defects.  Add all the defects before interpolating; find is then safe
+ * to call from several threads
+ */
+class WideInterpolants {
+public:
+    explicit WideInterpolants(double sigma) : _sigma(sigma), _weights() {}
+
+    /// Compute the weights for defect, if it's wide and we don't already have them
+    void add(RowDefect const& defect, int const ncol) {
+        int const neighbours = wide_neighbours(defect, ncol);
+        if (neighbours == 0) {
+            return;
+        }
+        int const nbad = defect.badX1 - defect.badX0 + 1;
+        std::vector<double>& weights = _weights[std::make_pair(nbad, neighbours)];
+        if (weights.empty()) {
+            solve(nbad, neighbours, weights);
+        }
+    }
 
-                break;
-              case 01400:           /* ........##, <noise^2> = 0 */
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0] = (val < min) ? out2_1 : val;
+    /// Return the weights for defect (4 for each of its pixels), or NULL if it isn't one that we handle
+    double const* find(RowDefect const& defect, int const ncol) const {
+        int const neighbours = wide_neighbours(defect, ncol);
+        if (neighbours == 0) {
+            return NULL;
+        }
+        int const nbad = defect.badX1 - defect.badX0 + 1;
+        std::map<std::pair<int, int>, std::vector<double> >::const_iterator ptr =
+            _weights.find(std::make_pair(nbad, neighbours));
+        return (ptr == _weights.end()) ? NULL : &ptr->second[0];
+    }
+private:
+    void solve(int const nbad, int const neighbours, std::vector<double>& weights) const {
+        int const offsets[4] = {-2, -1, nbad, nbad + 1}; // neighbours' positions relative to badX0
+        std::vector<int> used;                           // indices into offsets of the good neighbours
+        for (int j = 0; j != 4; ++j) {
+            if (neighbours & (010 >> j)) {
+                used.push_back(j);
+            }
+        }
+        int const n = used.size();
+
+        Eigen::MatrixXd a(n + 1, n + 1); // the kriging system, with the constraint that the weights sum to 1
+        Eigen::MatrixXd b(n + 1, nbad);  // the right-hand side for each bad pixel
+        for (int i = 0; i != n; ++i) {
+            for (int j = 0; j != n; ++j) {
+                a(i, j) = covariance(offsets[used[i]] - offsets[used[j]]);
+                if (i == j) {
+                    a(i, j) += interp::wideNugget;
+                }
+            }
+            a(i, n) = a(n, i) = 1;
+            for (int x = 0; x != nbad; ++x) {
+                b(i, x) = covariance(offsets[used[i]] - x);
+            }
+        }
+        a(n, n) = 0;
+        b.row(n).setOnes();
 
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
+        Eigen::MatrixXd const w = Eigen::FullPivLU<Eigen::MatrixXd>(a).solve(b);
 
-                val = 0.5003*out2_1 + 0.4997*out2_2;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
+        weights.assign(4*nbad, 0.0);
+        for (int x = 0; x != nbad; ++x) {
+            for (int i = 0; i != n; ++i) {
+                weights[4*x + used[i]] = w(i, x);
+            }
+        }
+    }
 
-                val = 0.5041*out2_1 + 0.4959*out2_2;
-                out[badX0 + 3] = (val < min) ? out2_1 : val;
+    double covariance(int const d) const {
+        return std::exp(-d*d/(4*_sigma*_sigma));
+    }
 
-                val = 0.5370*out2_1 + 0.4630*out2_2;
-                out[badX1 - 3] = (val < min) ? out2_1 : val;
+    double _sigma;                      // the PSF's width
+    std::map<std::pair<int, int>, std::vector<double> > _weights; // weights for each (width, neighbours)
+};
+}
 
-                val = 0.6968*out2_1 + 0.3032*out2_2;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
+/*
+ * Interpolate over a decoded defect in a row of data, using wide's weights for wide defects if it isn't NULL
+ */
+template<typename ImageT>
+static void interpolate_defect(RowDefect const& defect,              // the decoded defect
+                               typename ImageT::x_iterator out,      // the row to fix
+                               int const ncol,                       // number of columns in the row
+                               typename ImageT::Pixel min,           // minimum acceptable value
+                               double fallbackValue,                 // Value to fallback to if all else fails
+                               WideInterpolants const* wide=NULL     // PSF-based weights for wide defects
+                              )
+{
+    for (int x = defect.fallbackX0; x <= defect.fallbackX1; ++x) {
+        out[x] = fallbackValue;
+    }
+    if (!defect.interpolate) {
+        return;
+    }
 
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
+    double const* weights = (wide == NULL) ? NULL : wide->find(defect, ncol);
+    if (weights != NULL) {
+        int const neighbours = wide_neighbours(defect, ncol);
+        // unused neighbours have zero weight, and needn't exist
+        double const out1_2 = (neighbours & 010) ? static_cast<double>(out[defect.badX0 - 2]) : 0.0;
+        double const out1_1 = (neighbours & 04) ? static_cast<double>(out[defect.badX0 - 1]) : 0.0;
+        double const out2_1 = (neighbours & 02) ? static_cast<double>(out[defect.badX1 + 1]) : 0.0;
+        double const out2_2 = (neighbours & 01) ? static_cast<double>(out[defect.badX1 + 2]) : 0.0;
+
+        for (int x = defect.badX0; x <= defect.badX1; ++x, weights += 4) {
+            out[x] = weights[0]*out1_2 + weights[1]*out1_1 + weights[2]*out2_1 + weights[3]*out2_2;
+        }
+        return;
+    }
 
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
+    detail::interpolateDefect<typename ImageT::Pixel>(out, ncol, defect.badX0, defect.badX1, defect.pos,
+                                                      defect.pattern, min, fallbackValue);
+}
 
-                break;
-              case 0400:           /* ........#?, <noise^2> = 0 */
-                val = 1.0000*out2_1;
-                out[badX0] = (val < min) ? out2_1 : val;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
-                out[badX0 + 3] = (val < min) ? out2_1 : val;
-                out[badX1 - 3] = (val < min) ? out2_1 : val;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-                out[badX1] = (val < min) ? out2_1 : val;
+/*
+ * Interpolate along the columns [x0, x0 + ncol) of image over a decoded defect that they all share (so "x"
+ * in the defect is the row), as interpolate_defect does for each column in turn
+ */
+template<typename ImageT>
+static void interpolate_block(RowDefect const& defect,              // the decoded defect
+                              ImageT &image,                        // the image to fix
+                              int const x0,                         // first column of the block
+                              int const ncol,                       // number of columns in the block
+                              int const nrow,                       // number of rows in the image
+                              typename ImageT::Pixel min,           // minimum acceptable value
+                              double fallbackValue,                 // Value to fallback to if all else fails
+                              WideInterpolants const* wide=NULL     // PSF-based weights for wide defects
+                             )
+{
+    typedef typename ImageT::x_iterator XIter;
 
-                break;
-              case 03000:           /* .........##, <noise^2> = 0 */
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0] = (val < min) ? out2_1 : val;
+    for (int y = defect.fallbackX0; y <= defect.fallbackX1; ++y) {
+        XIter const out = image.row_begin(y) + x0;
+        for (int c = 0; c != ncol; ++c) {
+            out[c] = fallbackValue;
+        }
+    }
+    if (!defect.interpolate) {
+        return;
+    }
 
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
+    double const* weights = (wide == NULL) ? NULL : wide->find(defect, nrow);
+    if (weights != NULL) {
+        int const neighbours = wide_neighbours(defect, nrow);
+        XIter const in1_2 = (neighbours & 010) ? image.row_begin(defect.badX0 - 2) + x0 : XIter();
+        XIter const in1_1 = (neighbours & 04) ? image.row_begin(defect.badX0 - 1) + x0 : XIter();
+        XIter const in2_1 = (neighbours & 02) ? image.row_begin(defect.badX1 + 1) + x0 : XIter();
+        XIter const in2_2 = (neighbours & 01) ? image.row_begin(defect.badX1 + 2) + x0 : XIter();
+
+        for (int y = defect.badX0; y <= defect.badX1; ++y, weights += 4) {
+            XIter const out = image.row_begin(y) + x0;
+            for (int c = 0; c != ncol; ++c) {
+                double const out1_2 = (neighbours & 010) ? static_cast<double>(in1_2[c]) : 0.0;
+                double const out1_1 = (neighbours & 04) ? static_cast<double>(in1_1[c]) : 0.0;
+                double const out2_1 = (neighbours & 02) ? static_cast<double>(in2_1[c]) : 0.0;
+                double const out2_2 = (neighbours & 01) ? static_cast<double>(in2_2[c]) : 0.0;
+                out[c] = weights[0]*out1_2 + weights[1]*out1_1 + weights[2]*out2_1 + weights[3]*out2_2;
+            }
+        }
+        return;
+    }
 
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
+    interpolateBlockDefect<typename ImageT::Pixel>(image, x0, ncol, nrow, defect.badX0, defect.badX1,
+                                                   defect.pos, defect.pattern, min, fallbackValue);
+}
 
-                val = 0.5003*out2_1 + 0.4997*out2_2;
-                out[badX0 + 3] = (val < min) ? out2_1 : val;
-
-                val = 0.5041*out2_1 + 0.4959*out2_2;
-                out[badX1 - 4] = (val < min) ? out2_1 : val;
-
-                val = 0.5370*out2_1 + 0.4630*out2_2;
-                out[badX1 - 3] = (val < min) ? out2_1 : val;
-
-                val = 0.6968*out2_1 + 0.3032*out2_2;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
-
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
-
-                break;
-              case 01000:           /* .........#?, <noise^2> = 0 */
-                val = 1.0000*out2_1;
-                out[badX0] = (val < min) ? out2_1 : val;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
-                out[badX0 + 3] = (val < min) ? out2_1 : val;
-                out[badX1 - 4] = (val < min) ? out2_1 : val;
-                out[badX1 - 3] = (val < min) ? out2_1 : val;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-                out[badX1] = (val < min) ? out2_1 : val;
-
-                break;
-              case 06000:           /* ..........##, <noise^2> = 0 */
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0] = (val < min) ? out2_1 : val;
-
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
-
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
-
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                out[badX0 + 3] = (val < min) ? out2_1 : val;
-
-                val = 0.5003*out2_1 + 0.4997*out2_2;
-                out[badX0 + 4] = (val < min) ? out2_1 : val;
-
-                val = 0.5041*out2_1 + 0.4959*out2_2;
-                out[badX1 - 4] = (val < min) ? out2_1 : val;
-
-                val = 0.5370*out2_1 + 0.4630*out2_2;
-                out[badX1 - 3] = (val < min) ? out2_1 : val;
-
-                val = 0.6968*out2_1 + 0.3032*out2_2;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
-
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
-
-                break;
-              case 02000:           /* ..........#?, <noise^2> = 0 */
-                val = 1.0000*out2_1;
-
-                out[badX0] = (val < min) ? out2_1 : val;
-                out[badX0 + 1] = (val < min) ? out2_1 : val;
-                out[badX0 + 2] = (val < min) ? out2_1 : val;
-                out[badX0 + 3] = (val < min) ? out2_1 : val;
-                out[badX0 + 4] = (val < min) ? out2_1 : val;
-                out[badX1 - 4] = (val < min) ? out2_1 : val;
-                out[badX1 - 3] = (val < min) ? out2_1 : val;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-                out[badX1] = (val < min) ? out2_1 : val;
-
-                break;
-              default:
-                //shFatal("Unsupported defect type: LEFT 0%o", defectType);
-                break;                  /* NOTREACHED */
-            }
-            break;
-          case Defect::WIDE_LEFT:
-            assert(badX0 >= 0);
-            if (badX1 + 2 >= ncol) {    /* left defect extends near
-                                           right edge of data! */
-                if (badX1 == ncol - 2) {        /* one column remains */
-                    val = out[ncol - 1];
-                } else {
-                    val = fallbackValue; /* there is no information */
-                }
-                for (int j = badX0; j <= badX1; j++) {
-                    out[j] = val;
-                }
-                break;
-            }
-            out2_1 = out[badX1 + 1];
-            out2_2 = out[badX1 + 2];
-
-            switch (defectType) {
-              case 02:            /* ?#., <noise^2> = 0 */
-                val = 1.0000*out2_1;
-                val = (val < min) ? out2_1 : val;
-
-                for (int j = badX0; j <= badX1; j++) {
-                    out[j] = val;
-                }
-                break;
-              case 03:            /* ?##, <noise^2> = 0 */
-                val = 0.5000*out2_1 + 0.5000*out2_2;
-                if (val < min) {
-                    val = out2_1;
-                }
-
-                for (int j = badX0; j < badX1 - 5; j++) {
-                    out[j] = val;
-                }
-
-                val = 0.5003*out2_1 + 0.4997*out2_2;
-                out[badX1 - 5] = (val < min) ? out2_1 : val;
-
-                val = 0.5041*out2_1 + 0.4959*out2_2;
-                out[badX1 - 4] = (val < min) ? out2_1 : val;
-
-                val = 0.5370*out2_1 + 0.4630*out2_2;
-                out[badX1 - 3] = (val < min) ? out2_1 : val;
-
-                val = 0.6968*out2_1 + 0.3032*out2_2;
-                out[badX1 - 2] = (val < min) ? out2_1 : val;
-
-                val = 1.0933*out2_1 - 0.0933*out2_2;
-                out[badX1 - 1] = (val < min) ? out2_1 : val;
-
-                val = 1.4288*out2_1 - 0.4288*out2_2;
-                out[badX1] = (val < min) ? out2_1 : val;
-
-                break;
-              default:
-                //shFatal("Unsupported defect type: WIDE_LEFT 0%o",defect[i].type);
-                break;                  /* NOTREACHED */
-            }
-
-            break;
-          case Defect::RIGHT:
-            assert(badX0 >= 2 && badX1 < ncol);
-
-            out1_2 = out[badX0 - 2];
-            out1_1 = out[badX0 - 1];
-
-            switch (defectType) {
-              case 06:              /* ##., <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              case 014:             /* ##.., <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              case 030:             /* ##..., <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX1 - 1] = (val < min) ? out1_1 : val;
-
-                val = 0.3032*out1_2 + 0.6968*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              case 060:             /* ##...., <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX0 + 1] = (val < min) ? out1_1 : val;
-
-                val = 0.3032*out1_2 + 0.6968*out1_1;
-                out[badX1 - 1] = (val < min) ? out1_1 : val;
-
-                val = 0.4630*out1_2 + 0.5370*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              case 0140:            /* ##....., <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX0 + 1] = (val < min) ? out1_1 : val;
-
-                val = 0.3032*out1_2 + 0.6968*out1_1;
-                out[badX1 - 2] = (val < min) ? out1_1 : val;
-
-                val = 0.4630*out1_2 + 0.5370*out1_1;
-                out[badX1 - 1] = (val < min) ? out1_1 : val;
-
-                val = 0.4959*out1_2 + 0.5041*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              case 0300:            /* ##......, <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX0 + 1] = (val < min) ? out1_1 : val;
-
-                val = 0.3032*out1_2 + 0.6968*out1_1;
-                out[badX0 + 2] = (val < min) ? out1_1 : val;
-
-                val = 0.4630*out1_2 + 0.5370*out1_1;
-                out[badX1 - 2] = (val < min) ? out1_1 : val;
-
-                val = 0.4959*out1_2 + 0.5041*out1_1;
-                out[badX1 - 1] = (val < min) ? out1_1 : val;
-
-                val = 0.4997*out1_2 + 0.5003*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              case 0600:            /* ##......., <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX0 + 1] = (val < min) ? out1_1 : val;
-
-                val = 0.3032*out1_2 + 0.6968*out1_1;
-                out[badX0 + 2] = (val < min) ? out1_1 : val;
-
-                val = 0.4630*out1_2 + 0.5370*out1_1;
-                out[badX1 - 3] = (val < min) ? out1_1 : val;
-
-                val = 0.4959*out1_2 + 0.5041*out1_1;
-                out[badX1 - 2] = (val < min) ? out1_1 : val;
-
-                val = 0.4997*out1_2 + 0.5003*out1_1;
-                out[badX1 - 1] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              case 01400:           /* ##........, <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX0 + 1] = (val < min) ? out1_1 : val;
-
-                val = 0.3032*out1_2 + 0.6968*out1_1;
-                out[badX0 + 2] = (val < min) ? out1_1 : val;
-
-                val = 0.4630*out1_2 + 0.5370*out1_1;
-                out[badX0 + 3] = (val < min) ? out1_1 : val;
-
-                val = 0.4959*out1_2 + 0.5041*out1_1;
-                out[badX1 - 3] = (val < min) ? out1_1 : val;
-
-                val = 0.4997*out1_2 + 0.5003*out1_1;
-                out[badX1 - 2] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1 - 1] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              case 03000:           /* ##........., <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX0 + 1] = (val < min) ? out1_1 : val;
-
-                val = 0.3032*out1_2 + 0.6968*out1_1;
-                out[badX0 + 2] = (val < min) ? out1_1 : val;
-
-                val = 0.4630*out1_2 + 0.5370*out1_1;
-                out[badX0 + 3] = (val < min) ? out1_1 : val;
-
-                val = 0.4959*out1_2 + 0.5041*out1_1;
-                out[badX1 - 4] = (val < min) ? out1_1 : val;
-
-                val = 0.4997*out1_2 + 0.5003*out1_1;
-                out[badX1 - 3] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1 - 2] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1 - 1] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              case 06000:           /* ##.........., <noise^2> = 0 */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX0 + 1] = (val < min) ? out1_1 : val;
-
-                val = 0.3032*out1_2 + 0.6968*out1_1;
-                out[badX0 + 2] = (val < min) ? out1_1 : val;
-
-                val = 0.4630*out1_2 + 0.5370*out1_1;
-                out[badX0 + 3] = (val < min) ? out1_1 : val;
-
-                val = 0.4959*out1_2 + 0.5041*out1_1;
-                out[badX0 + 4] = (val < min) ? out1_1 : val;
-
-                val = 0.4997*out1_2 + 0.5003*out1_1;
-                out[badX1 - 4] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1 - 3] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1 - 2] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1 - 1] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                out[badX1] = (val < min) ? out1_1 : val;
-
-                break;
-              default:
-                //shFatal("Unsupported defect type: RIGHT 0%o",defect[i].type);
-                break;                  /* NOTREACHED */
-            }
-            break;
-          case Defect::WIDE_RIGHT:
-            assert(badX1 < ncol);
-
-            if (badX0 < 2) {            /* right defect extends near
-                                           left edge of data! */
-                if (badX0 == 1) {               /* one column remains */
-                    val = out[0];
-                } else {
-                    val = fallbackValue; /* there is no information */
-                }
-                for (int j = badX0; j <= badX1; j++) {
-                    out[j] = val;
-                }
-                break;
-            }
-
-            out1_2 = out[badX0 - 2];
-            out1_1 = out[badX0 - 1];
-
-            switch (defectType) {
-              case 03:                  /* ##?, S/N = infty */
-                val = -0.4288*out1_2 + 1.4288*out1_1;
-                out[badX0] = (val < min) ? out1_1 : val;
-
-                val = -0.0933*out1_2 + 1.0933*out1_1;
-                out[badX0 + 1] = (val < min) ? out1_1 : val;
-
-                val = 0.3032*out1_2 + 0.6968*out1_1;
-                out[badX0 + 2] = (val < min) ? out1_1 : val;
-
-                val = 0.4630*out1_2 + 0.5370*out1_1;
-                out[badX0 + 3] = (val < min) ? out1_1 : val;
-
-                val = 0.4959*out1_2 + 0.5041*out1_1;
-                out[badX0 + 4] = (val < min) ? out1_1 : val;
-
-                val = 0.4997*out1_2 + 0.5003*out1_1;
-                out[badX0 + 5] = (val < min) ? out1_1 : val;
-
-                val = 0.5000*out1_2 + 0.5000*out1_1;
-                val = (val < min) ? out1_1 : val;
-
-                for (int j = badX0 + 6; j <= badX1; j++) {
-                    out[j] = val;
-                }
-                break;
-              default:
-                //shFatal("Unsupported defect type: WIDE_RIGHT 0%o",defect[i].type);
-                break;                  /* NOTREACHED */
-            }
-            break;
-          case Defect::MIDDLE:
-          case Defect::NEAR_LEFT:
-          case Defect::NEAR_RIGHT:
-            if (defectPos == Defect::MIDDLE) {
-                assert(badX0 >= 2 && badX1 + 2 < ncol);
-                out1_2 = out[badX0 - 2];
-                out2_2 = out[badX1 + 2];
-            } else if (defectPos == Defect::NEAR_LEFT) {
-                assert(badX0 >= 1 && badX1 + 2 < ncol);
-                out1_2 = -1;            /* NOTUSED */
-                out2_2 = out[badX1 + 2];
-            } else if (defectPos == Defect::NEAR_RIGHT) {
-                assert(badX0 >= 2 && badX1 + 1 < ncol);
-                out1_2 = out[badX0 - 2];
-                out2_2 = -1;            /* NOTUSED */
-            } else {
-                //shFatal("Unknown defect classification %d (%s:%d)",defectPos, __FILE__,__LINE__);
-                out1_2 = out2_2 = -1;   /* NOTUSED */
-            }
-            out1_1 = out[badX0 - 1];
-            out2_1 = out[badX1 + 1];
-
-            switch (defectType) {
-              case 012:             /* #.#., <noise^2> = 0, sigma = 1 */
-                val = 0.5000*out1_1 + 0.5000*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1): val;
-
-                break;
-              case 013:         /* #.##, <noise^2> = 0 */
-                val = 0.4875*out1_1 + 0.8959*out2_1 - 0.3834*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 022:             /* #..#., <noise^2> = 0, sigma = 1 */
-                val = 0.7297*out1_1 + 0.2703*out2_1;
-                out[badX0] = (val < 0) ? 0 : val;
-
-                val = 0.2703*out1_1 + 0.7297*out2_1;
-                out[badX1] = (val < 0) ? 0 : val;
-
-                break;
-              case 023:         /* #..##, <noise^2> = 0 */
-                val = 0.7538*out1_1 + 0.5680*out2_1 - 0.3218*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3095*out1_1 + 1.2132*out2_1 - 0.5227*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 032:         /* ##.#., <noise^2> = 0 */
-                val = -0.3834*out1_2 + 0.8959*out1_1 + 0.4875*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 033:         /* ##.##, <noise^2> = 0 */
-                /* These coefficients are also available as
-                   interp::interp_1_c1 and interp::interp_1_c2 */
-                val = -0.2737*out1_2 + 0.7737*out1_1 + 0.7737*out2_1 - 0.2737*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 042:                 /* #...#., <noise^2> = 0, sigma = 1 */
-                val = 0.8430*out1_1 + 0.1570*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5000*out1_1 + 0.5000*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.1570*out1_1 + 0.8430*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                break;
-              case 043:             /* #...##, <noise^2> = 0 */
-                val = 0.8525*out1_1 + 0.2390*out2_1 - 0.0915*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5356*out1_1 + 0.8057*out2_1 - 0.3413*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2120*out1_1 + 1.3150*out2_1 - 0.5270*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 062:         /* ##..#., <noise^2> = 0 */
-                val = -0.5227*out1_2 + 1.2132*out1_1 + 0.3095*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.3218*out1_2 + 0.5680*out1_1 + 0.7538*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 063:         /* ##..##, <noise^2> = 0 */
-                val = -0.4793*out1_2 + 1.1904*out1_1 + 0.5212*out2_1 - 0.2323*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2323*out1_2 + 0.5212*out1_1 + 1.1904*out2_1 - 0.4793*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 0102:            /* #....#., <noise^2> = 0, sigma = 1 */
-                val = 0.8810*out1_1 + 0.1190*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.6315*out1_1 + 0.3685*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.3685*out1_1 + 0.6315*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.1190*out1_1 + 0.8810*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                break;
-              case 0103:            /* #....##, <noise^2> = 0 */
-                val = 0.8779*out1_1 + 0.0945*out2_1 + 0.0276*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6327*out1_1 + 0.3779*out2_1 - 0.0106*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4006*out1_1 + 0.8914*out2_1 - 0.2920*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1757*out1_1 + 1.3403*out2_1 - 0.5160*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 0142:                /* ##...#., <noise^2> = 0 */
-                val = -0.5270*out1_2 + 1.3150*out1_1 + 0.2120*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.3413*out1_2 + 0.8057*out1_1 + 0.5356*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.0915*out1_2 + 0.2390*out1_1 + 0.8525*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 0143:                /* ##...##, <noise^2> = 0 */
-                val = -0.5230*out1_2 + 1.3163*out1_1 + 0.2536*out2_1 - 0.0469*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.3144*out1_2 + 0.8144*out1_1 + 0.8144*out2_1 - 0.3144*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.0469*out1_2 + 0.2536*out1_1 + 1.3163*out2_1 - 0.5230*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 0202:            /* #.....#., <noise^2> = 0, sigma = 1 */
-                val = 0.8885*out1_1 + 0.1115*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.6748*out1_1 + 0.3252*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5000*out1_1 + 0.5000*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.3252*out1_1 + 0.6748*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.1115*out1_1 + 0.8885*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                break;
-              case 0203:            /* #.....##, <noise^2> = 0 */
-                val = 0.8824*out1_1 + 0.0626*out2_1 + 0.0549*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6601*out1_1 + 0.2068*out2_1 + 0.1331*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4938*out1_1 + 0.4498*out2_1 + 0.0564*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3551*out1_1 + 0.9157*out2_1 - 0.2708*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1682*out1_1 + 1.3447*out2_1 - 0.5129*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 0302:                /* ##....#., <noise^2> = 0 */
-                val = -0.5160*out1_2 + 1.3403*out1_1 + 0.1757*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2920*out1_2 + 0.8914*out1_1 + 0.4006*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.0106*out1_2 + 0.3779*out1_1 + 0.6327*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0276*out1_2 + 0.0945*out1_1 + 0.8779*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 0303:                /* ##....##, <noise^2> = 0 */
-                val = -0.5197*out1_2 + 1.3370*out1_1 + 0.1231*out2_1 + 0.0596*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2924*out1_2 + 0.8910*out1_1 + 0.3940*out2_1 + 0.0074*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0074*out1_2 + 0.3940*out1_1 + 0.8910*out2_1 - 0.2924*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0596*out1_2 + 0.1231*out1_1 + 1.3370*out2_1 - 0.5197*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 0402:            /* #......#., <noise^2> = 0, sigma = 1 */
-                val = 0.8893*out1_1 + 0.1107*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.6830*out1_1 + 0.3170*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5435*out1_1 + 0.4565*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.4565*out1_1 + 0.5435*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.3170*out1_1 + 0.6830*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.1107*out1_1 + 0.8893*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                break;
-              case 0403:            /* #......##, <noise^2> = 0 */
-                val = 0.8829*out1_1 + 0.0588*out2_1 + 0.0583*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6649*out1_1 + 0.1716*out2_1 + 0.1635*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5212*out1_1 + 0.2765*out2_1 + 0.2024*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4477*out1_1 + 0.4730*out2_1 + 0.0793*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3465*out1_1 + 0.9201*out2_1 - 0.2666*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 0602:                /* ##.....#., <noise^2> = 0 */
-                val = -0.5129*out1_2 + 1.3447*out1_1 + 0.1682*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2708*out1_2 + 0.9157*out1_1 + 0.3551*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0564*out1_2 + 0.4498*out1_1 + 0.4938*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1331*out1_2 + 0.2068*out1_1 + 0.6601*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0549*out1_2 + 0.0626*out1_1 + 0.8824*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 0603:                /* ##.....##, <noise^2> = 0 */
-                val = -0.5179*out1_2 + 1.3397*out1_1 + 0.0928*out2_1 + 0.0854*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2796*out1_2 + 0.9069*out1_1 + 0.2231*out2_1 + 0.1495*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0533*out1_2 + 0.4467*out1_1 + 0.4467*out2_1 + 0.0533*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1495*out1_2 + 0.2231*out1_1 + 0.9069*out2_1 - 0.2796*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0854*out1_2 + 0.0928*out1_1 + 1.3397*out2_1 - 0.5179*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 01002:               /* #.......#., <noise^2> = 0, sigma = 1 */
-                val = 0.8894*out1_1 + 0.1106*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.6839*out1_1 + 0.3161*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5517*out1_1 + 0.4483*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5000*out1_1 + 0.5000*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.4483*out1_1 + 0.5517*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.3161*out1_1 + 0.6839*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.1106*out1_1 + 0.8894*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                break;
-              case 01003:           /* #.......##, <noise^2> = 0 */
-                val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6654*out1_1 + 0.1676*out2_1 + 0.1670*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5260*out1_1 + 0.2411*out2_1 + 0.2329*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4751*out1_1 + 0.2995*out2_1 + 0.2254*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4390*out1_1 + 0.4773*out2_1 + 0.0836*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3456*out1_1 + 0.9205*out2_1 - 0.2661*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 01402:           /* ##......#., <noise^2> = 0 */
-                val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2666*out1_2 + 0.9201*out1_1 + 0.3465*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0793*out1_2 + 0.4730*out1_1 + 0.4477*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2024*out1_2 + 0.2765*out1_1 + 0.5212*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1635*out1_2 + 0.1716*out1_1 + 0.6649*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0583*out1_2 + 0.0588*out1_1 + 0.8829*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 01403:               /* ##......##, <noise^2> = 0 */
-                val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0891*out2_1 + 0.0886*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2771*out1_2 + 0.9095*out1_1 + 0.1878*out2_1 + 0.1797*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0677*out1_2 + 0.4614*out1_1 + 0.2725*out2_1 + 0.1984*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1984*out1_2 + 0.2725*out1_1 + 0.4614*out2_1 + 0.0677*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1797*out1_2 + 0.1878*out1_1 + 0.9095*out2_1 - 0.2771*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0886*out1_2 + 0.0891*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 02002:           /* #........#., <noise^2> = 0, sigma = 1 */
-                val = 0.8894*out1_1 + 0.1106*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.6839*out1_1 + 0.3161*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5526*out1_1 + 0.4474*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5082*out1_1 + 0.4918*out2_1;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.4918*out1_1 + 0.5082*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.4474*out1_1 + 0.5526*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.3161*out1_1 + 0.6839*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.1106*out1_1 + 0.8894*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                break;
-              case 02003:           /* #........##, <noise^2> = 0 */
-                val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5265*out1_1 + 0.2370*out2_1 + 0.2365*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4799*out1_1 + 0.2641*out2_1 + 0.2560*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4664*out1_1 + 0.3038*out2_1 + 0.2298*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4381*out1_1 + 0.4778*out2_1 + 0.0841*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 03002:           /* ##.......#., <noise^2> = 0 */
-                val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2661*out1_2 + 0.9205*out1_1 + 0.3456*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0836*out1_2 + 0.4773*out1_1 + 0.4390*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2254*out1_2 + 0.2995*out1_1 + 0.4751*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2329*out1_2 + 0.2411*out1_1 + 0.5260*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1670*out1_2 + 0.1676*out1_1 + 0.6654*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 03003:               /* ##.......##, <noise^2> = 0 */
-                val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0889*out2_1 + 0.0888*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1838*out2_1 + 0.1832*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0703*out1_2 + 0.4639*out1_1 + 0.2370*out2_1 + 0.2288*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2130*out1_2 + 0.2870*out1_1 + 0.2870*out2_1 + 0.2130*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2288*out1_2 + 0.2370*out1_1 + 0.4639*out2_1 + 0.0703*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1832*out1_2 + 0.1838*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0888*out1_2 + 0.0889*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 04002:           /* #.........#., <noise^2> = 0 */
-                val = 0.8894*out1_1 + 0.1106*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6839*out1_1 + 0.3161*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5527*out1_1 + 0.4473*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5091*out1_1 + 0.4909*out2_1;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5000*out1_1 + 0.5000*out2_1;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4909*out1_1 + 0.5091*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4473*out1_1 + 0.5527*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3161*out1_1 + 0.6839*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1106*out1_1 + 0.8894*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 04003:           /* #.........##, <noise^2> = 0 */
-                val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5265*out1_1 + 0.2368*out2_1 + 0.2367*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4804*out1_1 + 0.2601*out2_1 + 0.2595*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4712*out1_1 + 0.2685*out2_1 + 0.2603*out2_2;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4654*out1_1 + 0.3043*out2_1 + 0.2302*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 06002:           /* ##........#., <noise^2> = 0 */
-                val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0841*out1_2 + 0.4778*out1_1 + 0.4381*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2298*out1_2 + 0.3038*out1_1 + 0.4664*out2_1;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2560*out1_2 + 0.2641*out1_1 + 0.4799*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2365*out1_2 + 0.2370*out1_1 + 0.5265*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 06003:               /* ##........##, <noise^2> = 0 */
-                val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0888*out2_1 + 0.0888*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1835*out2_1 + 0.1835*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0705*out1_2 + 0.4642*out1_1 + 0.2329*out2_1 + 0.2324*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2155*out1_2 + 0.2896*out1_1 + 0.2515*out2_1 + 0.2434*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2434*out1_2 + 0.2515*out1_1 + 0.2896*out2_1 + 0.2155*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2324*out1_2 + 0.2329*out1_1 + 0.4642*out2_1 + 0.0705*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1835*out1_2 + 0.1835*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0888*out1_2 + 0.0888*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 010002:          /* #..........#., <noise^2> = 0, sigma = 1 */
-                val = 0.8894*out1_1 + 0.1106*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.6839*out1_1 + 0.3161*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5527*out1_1 + 0.4473*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5092*out1_1 + 0.4908*out2_1;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.5009*out1_1 + 0.4991*out2_1;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.4991*out1_1 + 0.5009*out2_1;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.4908*out1_1 + 0.5092*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.4473*out1_1 + 0.5527*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.3161*out1_1 + 0.6839*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                val = 0.1106*out1_1 + 0.8894*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
-
-                break;
-              case 010003:          /* #..........##, <noise^2> = 0 */
-                val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5265*out1_1 + 0.2367*out2_1 + 0.2367*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4804*out1_1 + 0.2598*out2_1 + 0.2598*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4717*out1_1 + 0.2644*out2_1 + 0.2639*out2_2;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4703*out1_1 + 0.2690*out2_1 + 0.2608*out2_2;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4654*out1_1 + 0.3043*out2_1 + 0.2303*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 014002:          /* ##.........#., <noise^2> = 0 */
-                val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0842*out1_2 + 0.4778*out1_1 + 0.4380*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2302*out1_2 + 0.3043*out1_1 + 0.4654*out2_1;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2603*out1_2 + 0.2685*out1_1 + 0.4712*out2_1;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2595*out1_2 + 0.2601*out1_1 + 0.4804*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2367*out1_2 + 0.2368*out1_1 + 0.5265*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 014003:          /* ##.........##, <noise^2> = 0 */
-                val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0888*out2_1 + 0.0888*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1835*out2_1 + 0.1835*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0705*out1_2 + 0.4642*out1_1 + 0.2326*out2_1 + 0.2326*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2158*out1_2 + 0.2899*out1_1 + 0.2474*out2_1 + 0.2469*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2459*out1_2 + 0.2541*out1_1 + 0.2541*out2_1 + 0.2459*out2_2;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2469*out1_2 + 0.2474*out1_1 + 0.2899*out2_1 + 0.2158*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2326*out1_2 + 0.2326*out1_1 + 0.4642*out2_1 + 0.0705*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1835*out1_2 + 0.1835*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0888*out1_2 + 0.0888*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 020003:          /* #...........##, <noise^2> = 0 */
-                val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5265*out1_1 + 0.2367*out2_1 + 0.2367*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4804*out1_1 + 0.2598*out2_1 + 0.2598*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4718*out1_1 + 0.2641*out2_1 + 0.2641*out2_2;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4708*out1_1 + 0.2649*out2_1 + 0.2644*out2_2;
-                out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4702*out1_1 + 0.2690*out2_1 + 0.2608*out2_2;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4654*out1_1 + 0.3044*out2_1 + 0.2303*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 030002:          /* ##..........#., <noise^2> = 0 */
-                val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0842*out1_2 + 0.4778*out1_1 + 0.4380*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2303*out1_2 + 0.3043*out1_1 + 0.4654*out2_1;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2608*out1_2 + 0.2690*out1_1 + 0.4703*out2_1;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2639*out1_2 + 0.2644*out1_1 + 0.4717*out2_1;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2598*out1_2 + 0.2598*out1_1 + 0.4804*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2367*out1_2 + 0.2367*out1_1 + 0.5265*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 030003:          /* ##..........##, <noise^2> = 0 */
-                val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0888*out2_1 + 0.0888*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1835*out2_1 + 0.1835*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0705*out1_2 + 0.4642*out1_1 + 0.2326*out2_1 + 0.2326*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2158*out1_2 + 0.2899*out1_1 + 0.2472*out2_1 + 0.2471*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2462*out1_2 + 0.2544*out1_1 + 0.2500*out2_1 + 0.2495*out2_2;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2495*out1_2 + 0.2500*out1_1 + 0.2544*out2_1 + 0.2462*out2_2;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2471*out1_2 + 0.2472*out1_1 + 0.2899*out2_1 + 0.2158*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2326*out1_2 + 0.2326*out1_1 + 0.4642*out2_1 + 0.0705*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1835*out1_2 + 0.1835*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0888*out1_2 + 0.0888*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 040003:          /* #............##, <noise^2> = 0 */
-                val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5265*out1_1 + 0.2367*out2_1 + 0.2367*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4804*out1_1 + 0.2598*out2_1 + 0.2598*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4718*out1_1 + 0.2641*out2_1 + 0.2641*out2_2;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4708*out1_1 + 0.2646*out2_1 + 0.2646*out2_2;
-                out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4707*out1_1 + 0.2649*out2_1 + 0.2644*out2_2;
-                out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4702*out1_1 + 0.2690*out2_1 + 0.2608*out2_2;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4654*out1_1 + 0.3044*out2_1 + 0.2303*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 060002:          /* ##...........#., <noise^2> = 0 */
-                val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0842*out1_2 + 0.4778*out1_1 + 0.4380*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2303*out1_2 + 0.3044*out1_1 + 0.4654*out2_1;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2608*out1_2 + 0.2690*out1_1 + 0.4702*out2_1;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2644*out1_2 + 0.2649*out1_1 + 0.4708*out2_1;
-                out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2641*out1_2 + 0.2641*out1_1 + 0.4718*out2_1;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2598*out1_2 + 0.2598*out1_1 + 0.4804*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2367*out1_2 + 0.2367*out1_1 + 0.5265*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              default:
-                //shFatal("Unsupported defect type: MIDDLE 0%o",defect[i].type);
-                break;                  /* NOTREACHED */
-            }
-            break;
-          case Defect::WIDE:
-          case Defect::WIDE_NEAR_LEFT:
-          case Defect::WIDE_NEAR_RIGHT:
-            if (defectPos == Defect::WIDE_NEAR_LEFT) {
-                assert(badX0 >= 1);
-
-                if (badX1 + 2 >= ncol) {        /* left defect extends near
-                                                   right edge of data! */
-                    if (badX1 == ncol - 2) {    /* one column remains */
-                        val = out[ncol - 1];
-                    } else {
-                        val = fallbackValue;            /* there is no information */
-                    }
-                    for (int j = badX0; j <= badX1; j++) {
-                        out[j] = val;
-                    }
-                    break;
-                }
-                out1_2 = -1;            /* NOTUSED */
-                out2_2 = out[badX1 + 2];
-            } else if (defectPos == Defect::WIDE) {
-                assert(badX0 >= 2 && badX1 + 2 < ncol);
-                out1_2 = out[badX0 - 2];
-                out2_2 = out[badX1 + 2];
-            } else if (defectPos == Defect::WIDE_NEAR_RIGHT) {
-                assert(badX1 + 1 < ncol);
-
-                if (badX0 < 2) {                /* right defect extends near
-                                                   left edge of data! */
-                    if (badX0 == 1) {   /* one column remains */
-                        val = out[0];
-                    } else {
-                        val = fallbackValue;    /* there is no information */
-                    }
-                    for (int j = badX0; j <= badX1; j++) {
-                        out[j] = val;
-                    }
-                    break;
-                }
-                out1_2 = out[badX0 - 2];
-                out2_2 = -1;            /* NOTUSED */
-            } else {
-                //shFatal("Unknown defect classification %d (%s:%d)",defectPos, __FILE__,__LINE__);
-                out1_2 = out2_2 = -1;   /* NOTUSED */
-            }
-
-            out1_1 = out[badX0 - 1];
-            out2_1 = out[badX1 + 1];
-
-            switch (defectType) {
-
-              case 06:                  /* #?#., <noise^2> = 0 */
-                val = 0.8894*out1_1 + 0.1106*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6839*out1_1 + 0.3161*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5527*out1_1 + 0.4473*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5092*out1_1 + 0.4908*out2_1;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5010*out1_1 + 0.4990*out2_1;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5001*out1_1 + 0.4999*out2_1;
-                out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5000*out1_1 + 0.5000*out2_1;
-
-                for (int j = badX0 + 6; j < badX1 - 5; j++) {
-                    out[j] = val;
-                }
-
-                val = 0.4999*out1_1 + 0.5001*out2_1;
-                out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4990*out1_1 + 0.5010*out2_1;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4908*out1_1 + 0.5092*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4473*out1_1 + 0.5527*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3161*out1_1 + 0.6839*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1106*out1_1 + 0.8894*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 07:           /* #?##, <noise^2> = 0 */
-                val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.5265*out1_1 + 0.2367*out2_1 + 0.2367*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4804*out1_1 + 0.2598*out2_1 + 0.2598*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4718*out1_1 + 0.2641*out2_1 + 0.2641*out2_2;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4708*out1_1 + 0.2646*out2_1 + 0.2646*out2_2;
-                out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4707*out[badX0 - 1] + 0.2646*out[badX1 + 1] + 0.2646*out[badX1 + 2];
-
-                for (int j = badX0 + 6; j < badX1 - 5; j++) {
-                    out[j] = val;
-                }
-
-                val = 0.4707*out1_1 + 0.2649*out2_1 + 0.2644*out2_2;
-                out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4702*out1_1 + 0.2690*out2_1 + 0.2608*out2_2;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4654*out1_1 + 0.3044*out2_1 + 0.2303*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 016:         /* ##?#., <noise^2> = 0 */
-                val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0842*out1_2 + 0.4778*out1_1 + 0.4380*out2_1;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2303*out1_2 + 0.3044*out1_1 + 0.4654*out2_1;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2608*out1_2 + 0.2690*out1_1 + 0.4702*out2_1;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2644*out1_2 + 0.2649*out1_1 + 0.4707*out2_1;
-                out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2646*out1_2 + 0.2646*out1_1 + 0.4707*out2_1;
-                val = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                for (int j = badX0 + 6; j < badX1 - 5; j++) {
-                    out[j] = val;
-                }
-
-                val = 0.2646*out1_2 + 0.2646*out1_1 + 0.4708*out2_1;
-                out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2641*out1_2 + 0.2641*out1_1 + 0.4718*out2_1;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2598*out1_2 + 0.2598*out1_1 + 0.4804*out2_1;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2367*out1_2 + 0.2367*out1_1 + 0.5265*out2_1;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              case 017:                 /* ##?##, S/N = infty */
-                val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0888*out2_1 + 0.0888*out2_2;
-                out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1835*out2_1 + 0.1835*out2_2;
-                out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0705*out1_2 + 0.4642*out1_1 + 0.2326*out2_1 + 0.2326*out2_2;
-                out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2158*out1_2 + 0.2899*out1_1 + 0.2472*out2_1 + 0.2472*out2_2;
-                out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2462*out1_2 + 0.2544*out1_1 + 0.2497*out2_1 + 0.2497*out2_2;
-                out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2497*out1_2 + 0.2503*out1_1 + 0.2500*out2_1 + 0.2500*out2_2;
-                out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2500*out1_2 + 0.2500*out1_1 + 0.2500*out2_1 + 0.2500*out2_2;
-                val = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                for (int j = badX0 + 6; j < badX1 - 5; j++) {
-                    out[j] = val;
-                }
-
-                val = 0.2500*out1_2 + 0.2500*out1_1 + 0.2503*out2_1 + 0.2497*out2_2;
-                out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2497*out1_2 + 0.2497*out1_1 + 0.2544*out2_1 + 0.2462*out2_2;
-                out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2472*out1_2 + 0.2472*out1_1 + 0.2899*out2_1 + 0.2158*out2_2;
-                out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.2326*out1_2 + 0.2326*out1_1 + 0.4642*out2_1 + 0.0705*out2_2;
-                out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.1835*out1_2 + 0.1835*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
-                out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                val = 0.0888*out1_2 + 0.0888*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
-                out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
-
-                break;
-              default:
-                //shFatal("Unsupported defect type: WIDE 0%o",defect[i].type);
-                break;                  /* NOTREACHED */
-            }
-            break;
-        }
-    }
-}
-
-template<typename MaskT>
+/*
+ * Interpolate over the defects in a given row of data
+ */
+template<typename ImageT>
 static void do_defects(std::vector<Defect::Ptr> const & badList, // list of bad things
                        int const y,                              // Row that we should fix
-                       MaskT& mask,                              // mask to set
-                       typename MaskT::Pixel const interpBit,    // bit to set for bad pixels
+                       ImageT& data,                             // data to fix
+                       typename ImageT::Pixel min,               // minimum acceptable value
+                       double fallbackValue,                     // Value to fallback to if all else fails
                        bool useFallbackValueAtEdge,              // use fallbackValue at edge of chip?
                        int nUseInterp                            // no. of pixels to interpolate towards edge
                       )
 {
-    typename MaskT::x_iterator mask_row = mask.row_begin(y); // pointer to this row of mask
+    int const ncol = data.getWidth();
+    typename ImageT::x_iterator out = data.row_begin(y);
 
     for (DefectCIter ptr = badList.begin(), end = badList.end(); ptr != end; ++ptr) {
         Defect::Ptr const defect = *ptr;
@@ -2030,10 +1661,41 @@ static void do_defects(std::vector<Defect::Ptr> const & badList, // list of bad
             continue;
         }
 
-        int const badX0 = defect->getX0();
-        int const badX1 = defect->getX1();
+        interpolate_defect<ImageT>(decode_defect(defect->getX0(), defect->getX1(), defect->getPos(),
+                                                 defect->getType(), ncol, useFallbackValueAtEdge, nUseInterp),
+                                   out, ncol, min, fallbackValue);
+    }
+}
+
+/*
+ * Interpolate over the decoded defects in a row of a MaskedImage, patching the image and variance and
+ * setting interpBit in the mask for each defect in turn
+ */
+typedef std::vector<RowDefect>::const_iterator RowDefectCIter;
+
+template<typename MaskedImageT>
+static void do_masked_defects(RowDefectCIter const begin, // the decoded defects in this row
+                              RowDefectCIter const end,   //  are [begin, end)
+                              int const ncol,                         // number of columns in the row
+                              typename MaskedImageT::Image::x_iterator image_row,       // the row's image,
+                              typename MaskedImageT::Mask::x_iterator mask_row,         //       mask,
+                              typename MaskedImageT::Variance::x_iterator variance_row, //   and variance
+                              typename MaskedImageT::Mask::Pixel const interpBit, // bit to set for bad pixels
+                              double fallbackValue,                   // Value to fallback to
+                              WideInterpolants const* wide=NULL       // PSF-based weights for wide defects
+                             )
+{
+    typedef typename MaskedImageT::Image ImageT;
+    typedef typename MaskedImageT::Variance VarianceT;
+    // the variance's minimum is the image's, so don't use the variance's own limits
+    typename ImageT::Pixel const imageMin = -std::numeric_limits<typename ImageT::Pixel>::max();
+    typename VarianceT::Pixel const varianceMin = -std::numeric_limits<typename ImageT::Pixel>::max();
+
+    for (RowDefectCIter ptr = begin; ptr != end; ++ptr) {
+        interpolate_defect<ImageT>(*ptr, image_row, ncol, imageMin, fallbackValue, wide);
+        interpolate_defect<VarianceT>(*ptr, variance_row, ncol, varianceMin, fallbackValue, wide);
 
-        for (int c = badX0; c <= badX1; ++c) {
+        for (int c = ptr->x0; c <= ptr->x1; ++c) {
             mask_row[c] |= interpBit;
         }
     }
@@ -2048,31 +1710,169 @@ namespace {
             return a->getX0() < b->getX0();
         }
     };
+
+    struct RowBlock {
+        int y0, y1;                     // the block is rows [y0, y1)
+        int run;                        // index into the plan's runs
+    };
 }
 
-/*!
- * @brief Process a set of known bad pixels in an image
+/*
+ * Plan the interpolation over defects (sorted by x0, and already clipped to the row length) in an image with
+ * the given number of rows and columns, appending the decoded 1-D defects to segments and the runs of rows
+ * that share them to runs.
+ *
+ * The set of defects that touch a row only changes at rows where a defect starts or stops, so sweep up the
+ * image keeping track of that set, and classify it once for each run of rows that share it
  */
-template<typename MaskedImageT>
-void interpolateOverDefects(MaskedImageT& mimage, ///< Image to patch
-                            lsst::afw::detection::Psf const &, ///< the Image's PSF
-                            std::vector<Defect::Ptr> &_badList, ///< List of Defects to patch
-                            double fallbackValue,                ///< Value to fallback to if all else fails
-                            bool useFallbackValueAtEdge ///< Use the fallback value at the image's edge?
-                           ) {
+static void plan_rows(std::vector<Defect::Ptr> const& badList, // defects to interpolate over
+                      int const width,                         // number of columns
+                      int const height,                        // number of rows
+                      bool const useFallbackValueAtEdge,       // use fallbackValue at edge of chip?
+                      int const nUseInterp,                    // no. of pixels to interpolate towards edge
+                      std::vector<DefectPlan::Segment> &segments, // the decoded 1-D defects
+                      std::vector<DefectPlan::Run> &runs          // the runs of rows
+                     )
+{
+    std::vector<std::pair<int, int> > events; // (row, i): badList[i] starts (i >= 0) or stops (i < 0) at row
+    events.reserve(2*badList.size());
+    for (int i = 0, n = badList.size(); i != n; ++i) {
+        if (badList[i]->getY1() < badList[i]->getY0()) { // empty; it never touches a row
+            continue;
+        }
+        events.push_back(std::make_pair(badList[i]->getY0(), i));
+        events.push_back(std::make_pair(badList[i]->getY1() + 1, ~i));
+    }
+    std::sort(events.begin(), events.end());
+
+    std::set<int> active;                   // indices into badList, so iterating preserves the sort by x0
+    std::vector<Defect::Ptr> activeList;
+    std::vector<std::pair<int, int> >::const_iterator event = events.begin();
+    for (int y = 0; y < height; ) {
+        for (; event != events.end() && event->first <= y; ++event) {
+            if (event->second >= 0) {
+                active.insert(event->second);
+            } else {
+                active.erase(~event->second);
+            }
+        }
+        int const yEnd = (event == events.end()) ? height : std::min(event->first, height);
+
+        if (active.empty()) {
+            y = yEnd;
+            continue;
+        }
+
+        activeList.clear();
+        for (std::set<int>::const_iterator ptr = active.begin(), end = active.end(); ptr != end; ++ptr) {
+            activeList.push_back(badList[*ptr]);
+        }
+        std::vector<Defect::Ptr> const badList1D = classify_defects(activeList, y, width, yEnd - y);
+        DefectPlan::Run const run = {y, yEnd, static_cast<int>(segments.size()), 0};
+        for (DefectCIter ptr = badList1D.begin(), end = badList1D.end(); ptr != end; ++ptr) {
+            segments.push_back(decode_defect((*ptr)->getX0(), (*ptr)->getX1(), (*ptr)->getPos(),
+                                             (*ptr)->getType(), width, useFallbackValueAtEdge, nUseInterp));
+        }
+        runs.push_back(run);
+        runs.back().end = segments.size();
+
+        y = yEnd;
+    }
+}
+
 /*
- * Allow for image's origin
+ * Add to the defects that we'll interpolate along rows (sorted by x0, and already clipped to the row length)
+ * the parts of those that we'll interpolate along columns (transposed) that lie within 2 pixels of them in
+ * the same rows, so that classify_defects treats those pixels as bad rather than using their unpatched
+ * values.
+ *
+ * The added parts are interpolated along rows too, but they're patched again along columns afterwards
  */
-    int const width = mimage.getWidth();
-    int const height = mimage.getHeight();
+static void add_crossing_defects(std::vector<Defect::Ptr> const& badColList, // transposed column defects
+                                 int const width,                          // number of columns
+                                 std::vector<Defect::Ptr> &badList         // the row defects
+                                )
+{
+    int maxWidth = 0;                   // the widest row defect
+    for (DefectCIter ptr = badList.begin(), end = badList.end(); ptr != end; ++ptr) {
+        maxWidth = std::max(maxWidth, (*ptr)->getX1() - (*ptr)->getX0() + 1);
+    }
+
+    std::vector<Defect::Ptr> crossing;
+    for (DefectCIter ptr = badColList.begin(), end = badColList.end(); ptr != end; ++ptr) {
+        int const x0 = std::max(0, (*ptr)->getY0()), x1 = std::min(width - 1, (*ptr)->getY1());
+        int const y0 = (*ptr)->getX0(), y1 = (*ptr)->getX1();
+        if (x0 > x1) {
+            continue;
+        }
+        //
+        // A row defect that reads a pixel in [x0, x1] ends at or after x0 - 2, so it starts after
+        // x0 - 2 - maxWidth
+        //
+        DefectCIter row = std::lower_bound(badList.begin(), badList.end(), x0 - 1 - maxWidth,
+                                           [](Defect::Ptr const& defect, int x) {
+                                               return defect->getX0() < x;
+                                           });
+        for (; row != badList.end() && (*row)->getX0() <= x1 + 2; ++row) {
+            int const rowY0 = std::max(y0, (*row)->getY0()), rowY1 = std::min(y1, (*row)->getY1());
+            if ((*row)->getX1() + 2 < x0 || rowY0 > rowY1) {
+                continue;
+            }
+            crossing.push_back(Defect::Ptr(new Defect(geom::BoxI(geom::PointI(x0, rowY0),
+                                                                 geom::PointI(x1, rowY1)))));
+        }
+    }
+
+    badList.insert(badList.end(), crossing.begin(), crossing.end());
+}
+
+/*
+ * Split runs of rows into blocks of at most blockRows rows
+ */
+static std::vector<RowBlock> split_runs(std::vector<DefectPlan::Run> const& runs, // the runs of rows
+                                        int const blockRows                       // maximum rows in a block
+                                       )
+{
+    std::vector<RowBlock> blocks;
+    for (int i = 0, n = runs.size(); i != n; ++i) {
+        for (int y = runs[i].y0; y < runs[i].y1; y += blockRows) {
+            RowBlock const block = {y, std::min(y + blockRows, runs[i].y1), i};
+            blocks.push_back(block);
+        }
+    }
+
+    return blocks;
+}
+
+DefectPlan::DefectPlan(geom::Box2I const & bbox,
+                       std::vector<Defect::Ptr> const & _badList,
+                       bool useFallbackValueAtEdge,
+                       InterpDirection direction
+                      ) : _bbox(bbox), _segments(), _rowRuns(), _columnRuns()
+{
+/*
+ * Allow for image's origin, and transpose the defects that we'll interpolate along columns
+ */
+    int const width = bbox.getWidth();
+    int const height = bbox.getHeight();
 
-    std::vector<Defect::Ptr> badList;
+    std::vector<Defect::Ptr> badList;   // defects to interpolate along rows
+    std::vector<Defect::Ptr> badColList; // transposed defects to interpolate along columns
     badList.reserve(_badList.size());
-    for (std::vector<Defect::Ptr>::iterator ptr = _badList.begin(), end = _badList.end(); ptr != end; ++ptr) {
+    for (DefectCIter ptr = _badList.begin(), end = _badList.end(); ptr != end; ++ptr) {
         geom::BoxI bbox = (*ptr)->getBBox();
-        bbox.shift(geom::ExtentI(-mimage.getX0(), -mimage.getY0())); //allow for image's origin
+        bbox.shift(geom::ExtentI(-_bbox.getMinX(), -_bbox.getMinY())); //allow for image's origin
+
+        bool const alongColumns = (direction == INTERP_COLUMNS) ||
+            (direction == INTERP_AUTO && bbox.getWidth() > bbox.getHeight());
+        int const rowLength = alongColumns ? height : width;
+        if (alongColumns) {
+            bbox = geom::BoxI(geom::PointI(bbox.getMinY(), bbox.getMinX()),
+                              geom::PointI(bbox.getMaxY(), bbox.getMaxX()));
+        }
+
 		geom::PointI min = bbox.getMin(), max = bbox.getMax();
-		if(min.getX() >= width){
+		if(min.getX() >= rowLength){
             continue;
         } else if (min.getX() < 0) {
             if (max.getX() < 0) {
@@ -2084,153 +1884,454 @@ void interpolateOverDefects(MaskedImageT& mimage, ///< Image to patch
 
         if (max.getX() < 0) {
             continue;
-        } else if (max.getX() >= width) {
-            max.setX(width - 1);
+        } else if (max.getX() >= rowLength) {
+            max.setX(rowLength - 1);
         }
 
         bbox = geom::BoxI(min, max);
         Defect::Ptr ndefect(new Defect(bbox));
         ndefect->classify((*ptr)->getPos(), (*ptr)->getType());
-        badList.push_back(ndefect);
+        (alongColumns ? badColList : badList).push_back(ndefect);
     }
 
     sort(badList.begin(), badList.end(), Sort_ByX0<Defect>());
-/*
- * Go through the frame looking at each pixel (except the edge ones which we ignore)
- */
-    typename MaskedImageT::Mask::Pixel const interpBit =
-        mimage.getMask()->getPlaneBitMask("INTRP"); // interp'd pixels
+    sort(badColList.begin(), badColList.end(), Sort_ByX0<Defect>());
+    if (!badList.empty() && !badColList.empty()) { // the rows mustn't use the column defects' pixels
+        add_crossing_defects(badColList, width, badList);
+        sort(badList.begin(), badList.end(), Sort_ByX0<Defect>());
+    }
 
     constexpr int nUseInterp = 6;                       // no. of pixels to interpolate towards edge
     static_assert(nUseInterp < Defect::WIDE_DEFECT, "make sure that we can handle these defects using"
             "the full interpolation not edge code");
 
-    for (int y = 0; y != height; y++) {
-        std::vector<Defect::Ptr> badList1D = classify_defects(badList, y, width);
-
-        do_defects(badList1D, y, *mimage.getImage(),
-                   -std::numeric_limits<typename MaskedImageT::Image::Pixel>::max(),
-                   fallbackValue, useFallbackValueAtEdge, nUseInterp);
+    plan_rows(badList, width, height, useFallbackValueAtEdge, nUseInterp, _segments, _rowRuns);
+    plan_rows(badColList, height, width, useFallbackValueAtEdge, nUseInterp, _segments, _columnRuns);
+}
 
-        do_defects(badList1D, y, *mimage.getMask(), interpBit, useFallbackValueAtEdge, nUseInterp);
+/*!
+ * @brief Process a set of known bad pixels in an image
+ */
+template<typename MaskedImageT>
+void interpolateOverDefects(MaskedImageT& mimage, ///< Image to patch
+                            lsst::afw::detection::Psf const &psf, ///< the Image's PSF
+                            std::vector<Defect::Ptr> &badList, ///< List of Defects to patch
+                            double fallbackValue,                ///< Value to fallback to if all else fails
+                            bool useFallbackValueAtEdge, ///< Use the fallback value at the image's edge?
+                            int nThread,                 ///< Number of threads to use
+                            InterpDirection direction,   ///< Direction to interpolate in
+                            bool usePsf                  ///< Use the PSF to interpolate over wide defects?
+                           ) {
+    DefectPlan const plan(mimage.getBBox(image::PARENT), badList, useFallbackValueAtEdge, direction);
+    interpolateOverDefects(mimage, plan, fallbackValue, nThread, usePsf ? &psf : NULL);
+}
 
-        do_defects(badList1D, y, *mimage.getVariance(),
-                   -std::numeric_limits<typename MaskedImageT::Image::Pixel>::max(),
-                   fallbackValue, useFallbackValueAtEdge, nUseInterp);
+/*!
+ * @brief Process the bad pixels in a DefectPlan
+ */
+template<typename MaskedImageT>
+void interpolateOverDefects(MaskedImageT& mimage,   ///< Image to patch
+                            DefectPlan const &plan, ///< the classified defects
+                            double fallbackValue,   ///< Value to fallback to if all else fails
+                            int nThread,            ///< Number of threads to use
+                            lsst::afw::detection::Psf const *psf ///< PSF for wide defects, or NULL
+                           ) {
+    geom::Box2I const bbox = mimage.getBBox(image::PARENT);
+    if (bbox != plan.getBBox()) {
+        throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
+                          (boost::format("Image's bounding box (%d,%d)--(%d,%d) isn't the DefectPlan's "
+                                         "(%d,%d)--(%d,%d)") %
+                           bbox.getMinX() % bbox.getMinY() % bbox.getMaxX() % bbox.getMaxY() %
+                           plan.getBBox().getMinX() % plan.getBBox().getMinY() %
+                           plan.getBBox().getMaxX() % plan.getBBox().getMaxY()).str());
     }
-}
 
-/*****************************************************************************/
-/**
- *
- * Return a boolean status (true: interpolation is OK) and the interpolated value for a pixel,
- * ignoring pixels given by badmask
- *
- * Interpolation can either be vertical or horizontal
- *
- * @note: This is a pretty expensive routine, so use only after suitable thought.
+    int const width = mimage.getWidth();
+    int const height = mimage.getHeight();
+    std::vector<DefectPlan::Segment> const& segments = plan.getSegments();
+
+    typename MaskedImageT::Mask::Pixel const interpBit =
+        mimage.getMask()->getPlaneBitMask("INTRP"); // interp'd pixels
+
+    std::vector<DefectPlan::Run> const& rowRuns = plan.getRowRuns();
+    std::vector<DefectPlan::Run> const& columnRuns = plan.getColumnRuns();
+/*
+ * Solve for the PSF-based weights for all the wide defects now, so that the threads only read them
  */
-template <typename MaskedImageT>
-std::pair<bool, typename MaskedImageT::Image::Pixel> interp::singlePixel(
-        int,                            ///< x: column coordinate of the pixel in question
-        int,                            ///< y: row coordinate of the pixel in question
-        MaskedImageT const&,            ///< image: in this image
-        bool,                           ///< horizontal: interpolate horizontally?
-        double                          ///< minval: minimum acceptable value
-                                                                  )
-{
-#if defined(SDSS)
-    BADCOLUMN defect;                    /* describe a bad column */
-    PIX *data;                           /* temp array to interpolate in */
-    int i;
-    int i0, i1;                          /* data corresponds to range of
-                                           {row,col} == [i0,i1] */
-    int ndata;                           /* dimension of data */
-    static int ndatamax = 40;            /* largest allowable defect. XXX */
-    int nrow, ncol;                      /* == reg->n{row,col} */
-    PIX *val;                            /* pointer to pixel (rowc, colc) */
-    int z1, z2;                          /* range of bad {row,columns} */
-
-    shAssert(badmask != NULL && badmask->type == shTypeGetFromName("OBJMASK"));
-    shAssert(reg != NULL && reg->type == TYPE_PIX);
-    nrow = reg->nrow;
-    ncol = reg->ncol;
-
-    if (horizontal) {
-        for (z1 = colc - 1; z1 >= 0; z1--) {
-            if (!phPixIntersectMask(badmask, z1, rowc)) {
-                break;
+    std::unique_ptr<WideInterpolants> wide;
+    if (psf != NULL) {
+        wide.reset(new WideInterpolants(psf->computeShape().getDeterminantRadius()));
+        for (int pass = 0; pass != 2; ++pass) {
+            std::vector<DefectPlan::Run> const& runs = (pass == 0) ? rowRuns : columnRuns;
+            int const ncol = (pass == 0) ? width : height;
+            for (std::vector<DefectPlan::Run>::const_iterator run = runs.begin(); run != runs.end(); ++run) {
+                for (int i = run->begin; i != run->end; ++i) {
+                    wide->add(segments[i], ncol);
+                }
             }
         }
-        z1++;
+    }
+/*
+ * Each row only reads and writes its own pixels, so the blocks may be processed in any order
+ */
+    std::vector<RowBlock> const rows = split_runs(rowRuns,
+                                                  (nThread > 1) ? std::max(1, height/(4*nThread)) : height);
+    detail::parallelFor(rows.size(), nThread, [&](int b) {
+        RowBlock const& block = rows[b];
+        RowDefectCIter const begin = segments.begin() + rowRuns[block.run].begin;
+        RowDefectCIter const end = segments.begin() + rowRuns[block.run].end;
+
+        for (int y = block.y0; y != block.y1; ++y) {
+            do_masked_defects<MaskedImageT>(begin, end, width,
+                                            mimage.getImage()->row_begin(y), mimage.getMask()->row_begin(y),
+                                            mimage.getVariance()->row_begin(y), interpBit, fallbackValue,
+                                            wide.get());
+        }
+    });
 
-        for (z2 = colc + 1; z2 < ncol; z2++) {
-            if (!phPixIntersectMask(badmask, z2, rowc)) {
-                break;
+    if (columnRuns.empty()) {
+        return;
+    }
+/*
+ * The columns are interpolated in the same way, but all the columns in a block share the same defects, so
+ * rather than going down each column in turn we apply each step of the interpolation to the whole block,
+ * reading and writing a contiguous range of pixels in each row.  Each block only reads and writes its own
+ * columns
+ */
+    typedef typename MaskedImageT::Image ImageT;
+    typedef typename MaskedImageT::Variance VarianceT;
+    // the variance's minimum is the image's, so don't use the variance's own limits (as do_masked_defects)
+    typename ImageT::Pixel const imageMin = -std::numeric_limits<typename ImageT::Pixel>::max();
+    typename VarianceT::Pixel const varianceMin = -std::numeric_limits<typename ImageT::Pixel>::max();
+
+    std::vector<RowBlock> const cols = split_runs(columnRuns,
+                                                  (nThread > 1) ? std::max(1, width/(4*nThread)) : width);
+    detail::parallelFor(cols.size(), nThread, [&](int b) {
+        RowBlock const& block = cols[b];
+        RowDefectCIter const begin = segments.begin() + columnRuns[block.run].begin;
+        RowDefectCIter const end = segments.begin() + columnRuns[block.run].end;
+        int const x0 = block.y0, ncol = block.y1 - block.y0;
+
+        for (RowDefectCIter ptr = begin; ptr != end; ++ptr) {
+            interpolate_block(*ptr, *mimage.getImage(), x0, ncol, height, imageMin, fallbackValue,
+                              wide.get());
+            interpolate_block(*ptr, *mimage.getVariance(), x0, ncol, height, varianceMin, fallbackValue,
+                              wide.get());
+
+            for (int y = ptr->x0; y <= ptr->x1; ++y) {
+                typename MaskedImageT::Mask::x_iterator const mask_row = mimage.getMask()->row_begin(y) + x0;
+                for (int c = 0; c != ncol; ++c) {
+                    mask_row[c] |= interpBit;
+                }
             }
         }
-        z2--;
+    });
+}
 
-        i0 = (z1 > 2) ? z1 - 2 : 0;       /* origin of available required data */
-        i1 = (z2 < ncol - 2) ? z2 + 2 : ncol - 1; /* end of "      "   "    "  */
+/*!
+ * @brief Interpolate along rows over the pixels with any of planeBits set in the mask
+ *
+ * Each row's runs of bad pixels are found and classified directly from the mask, with no Defects; a run
+ * that's the same as the previous row's (e.g. in a bad column) reuses its classification
+ */
+template<typename MaskedImageT>
+void interpolateOverMaskPlane(MaskedImageT& mimage, ///< Image to patch
+                              typename MaskedImageT::Mask::Pixel const planeBits, ///< bits to patch
+                              double fallbackValue,         ///< Value to fallback to if all else fails
+                              bool useFallbackValueAtEdge,  ///< Use the fallback value at the image's edge?
+                              int nThread                   ///< Number of threads to use
+                             ) {
+    int const width = mimage.getWidth();
+    int const height = mimage.getHeight();
 
-        if (i0 < 2 || i1 >= ncol - 2) {    /* interpolation will fail */
-            return(-1);                    /* failure */
-        }
+    typename MaskedImageT::Mask::Pixel const interpBit =
+        mimage.getMask()->getPlaneBitMask("INTRP"); // interp'd pixels
 
-        ndata = (i1 - i0 + 1);
-        if (ndata > ndatamax) {
-            return(-1);                    /* failure */
-        }
+    constexpr int nUseInterp = 6;                       // no. of pixels to interpolate towards edge
+/*
+ * Each row is classified from, and only writes, its own pixels, so the blocks may be processed in any order
+ */
+    int const nBlock = (nThread > 1) ? std::min(height, 4*nThread) : 1;
+    detail::parallelFor(nBlock, nThread, [&](int b) {
+        std::vector<std::pair<int, int> > runs, prevRuns; // first and last pixels of this and the last
+                                                          // row's runs of bad pixels
+        std::vector<RowDefect> decoded;                   // the decoded runs in prevRuns
+
+        for (int y = b*height/nBlock, yEnd = (b + 1)*height/nBlock; y != yEnd; ++y) {
+            typename MaskedImageT::Mask::x_iterator mask_row = mimage.getMask()->row_begin(y);
+
+            runs.clear();
+            for (int x = 0; x < width; ++x) {
+                if (mask_row[x] & planeBits) {
+                    int const x0 = x;
+                    while (x + 1 < width && (mask_row[x + 1] & planeBits)) {
+                        ++x;
+                    }
+                    runs.push_back(std::make_pair(x0, x));
+                }
+            }
+            if (runs.empty()) {
+                continue;
+            }
 
-        data = alloca(ndata*sizeof(PIX));
-        for (i = i0; i <= i1; i++) {
-            data[i - i0] = reg->ROWS[rowc][i];
-        }
-        val = &data[colc - i0];
-    } else {
-        for (z1 = rowc - 1; z1 >= 0; z1--) {
-            if (!phPixIntersectMask(badmask, colc, z1)) {
-                break;
+            if (runs != prevRuns) {
+                decoded.clear();
+                for (int i = 0, n = runs.size(); i != n; ++i) {
+                    Defect::DefectPosition pos;
+                    unsigned int type;
+                    classify_run(runs[i].first, runs[i].second, width,
+                                 i > 0 && runs[i - 1].second == runs[i].first - 2,
+                                 i + 1 < n && runs[i + 1].first == runs[i].second + 2, pos, type);
+                    decoded.push_back(decode_defect(runs[i].first, runs[i].second, pos, type, width,
+                                                    useFallbackValueAtEdge, nUseInterp));
+                }
+                prevRuns.swap(runs);
             }
+
+            do_masked_defects<MaskedImageT>(decoded.begin(), decoded.end(), width,
+                                            mimage.getImage()->row_begin(y), mask_row,
+                                            mimage.getVariance()->row_begin(y), interpBit, fallbackValue);
         }
-        z1++;
+    });
+}
 
-        for (z2 = rowc + 1; z2 < nrow; z2++) {
-            if (!phPixIntersectMask(badmask, colc, z2)) {
-                break;
+/*****************************************************************************/
+
+namespace {
+typedef interp::BadPixelRuns::Run Run;
+
+/*
+ * Mark [a, b] as bad in a row's (or column's) list of runs, merging it with any runs that it touches
+ */
+void insertRun(std::vector<Run> &runs, int a, int b) {
+    // the first run that ends at or after a - 1 (the runs are disjoint, so their ends are sorted too)
+    std::vector<Run>::iterator lo = std::lower_bound(runs.begin(), runs.end(), a - 1,
+                                                     [](Run const& r, int v) { return r.second < v; });
+    std::vector<Run>::iterator hi = lo;
+    for (; hi != runs.end() && hi->first <= b + 1; ++hi) {
+        a = std::min(a, hi->first);
+        b = std::max(b, hi->second);
+    }
+    runs.insert(runs.erase(lo, hi), Run(a, b));
+}
+}
+
+/**
+ * Find the runs of pixels in mask with any of the bits in badMask set
+ */
+interp::BadPixelRuns::BadPixelRuns(image::Mask<image::MaskPixel> const& mask, ///< the mask to index
+                                   image::MaskPixel const badMask ///< bits that identify bad pixels
+                                  ) :
+    _x0(mask.getX0()), _y0(mask.getY0()), _rows(mask.getHeight()), _cols(mask.getWidth())
+{
+    int const width = mask.getWidth();
+    int const height = mask.getHeight();
+
+    std::vector<int> colStart(width, -1); // first row of the current run in each column, or -1
+    for (int y = 0; y != height; ++y) {
+        image::Mask<image::MaskPixel>::x_iterator ptr = mask.row_begin(y);
+        int rowStart = -1;              // first column of the current run in this row, or -1
+        for (int x = 0; x != width; ++x) {
+            if (ptr[x] & badMask) {
+                if (rowStart < 0) {
+                    rowStart = x;
+                }
+                if (colStart[x] < 0) {
+                    colStart[x] = y;
+                }
+            } else {
+                if (rowStart >= 0) {
+                    _rows[y].push_back(Run(rowStart, x - 1));
+                    rowStart = -1;
+                }
+                if (colStart[x] >= 0) {
+                    _cols[x].push_back(Run(colStart[x], y - 1));
+                    colStart[x] = -1;
+                }
             }
         }
-        z2--;
+        if (rowStart >= 0) {
+            _rows[y].push_back(Run(rowStart, width - 1));
+        }
+    }
+    for (int x = 0; x != width; ++x) {
+        if (colStart[x] >= 0) {
+            _cols[x].push_back(Run(colStart[x], height - 1));
+        }
+    }
+}
+
+/**
+ * Mark the pixels [x0, x1] in row y as bad (e.g. because they're part of a CR that isn't in the mask yet)
+ *
+ * Pixels outside the mask used to build the BadPixelRuns are ignored
+ */
+void interp::BadPixelRuns::add(int y, int x0, int x1) {
+    y -= _y0;
+    x0 = std::max(x0 - _x0, 0);
+    x1 = std::min(x1 - _x0, static_cast<int>(_cols.size()) - 1);
+    if (y < 0 || y >= static_cast<int>(_rows.size()) || x0 > x1) {
+        return;
+    }
 
-        i0 = (z1 > 2) ? z1 - 2 : 0;       /* origin of available required data */
-        i1 = (z2 < nrow - 2) ? z2 + 2 : nrow - 1; /* end of "      "   "    "  */
+    insertRun(_rows[y], x0, x1);
+    for (int x = x0; x <= x1; ++x) {
+        insertRun(_cols[x], y, y);
+    }
+}
 
-        if (i0 < 2 || i1 >= ncol - 2) {    /* interpolation will fail */
-            return(-1);                    /* failure */
+/**
+ * Return the first and last pixels of the defect that includes (x, y), along its row (or its column if
+ * horizontal is false).  The pixel (x, y) is taken to be bad whether or not it's marked as such.
+ */
+interp::BadPixelRuns::Run interp::BadPixelRuns::getDefect(int x, int y, bool horizontal) const {
+    int const c = horizontal ? x - _x0 : y - _y0; // position along the row or column
+    int const origin = horizontal ? _x0 : _y0;
+    std::vector<Run> const& runs = horizontal ? _rows[y - _y0] : _cols[x - _x0];
+
+    Run defect(c, c);
+    // the first run that starts after c;  only it and its predecessor can touch c
+    std::vector<Run>::const_iterator next = std::upper_bound(runs.begin(), runs.end(), c,
+                                                             [](int v, Run const& r) { return v < r.first; });
+    if (next != runs.end() && next->first == c + 1) {
+        defect.second = next->second;
+    }
+    if (next != runs.begin()) {
+        Run const& prev = *(next - 1);
+        if (prev.second >= c - 1) {
+            defect.first = prev.first;
+            defect.second = std::max(defect.second, prev.second);
         }
+    }
 
-        ndata = (i1 - i0 + 1);
-        if (ndata > ndatamax) {
-            return(-1);                    /* failure */
-        }
+    return Run(defect.first + origin, defect.second + origin);
+}
 
-        data = alloca(ndata*sizeof(PIX));
-        for (i = i0; i <= i1; i++) {
-            data[i - i0] = reg->ROWS[i][colc];
-        }
-        val = &data[rowc - i0];
+/**
+ * Return the runs of bad pixels in the row (or column, if horizontal is false) through (x, y) that overlap
+ * [i0, i1];  i0 and i1 are columns (rows) in the parent frame, as are the returned runs
+ */
+std::vector<interp::BadPixelRuns::Run>
+interp::BadPixelRuns::getRuns(int x, int y, bool horizontal, int i0, int i1) const {
+    int const origin = horizontal ? _x0 : _y0;
+    std::vector<Run> const& runs = horizontal ? _rows[y - _y0] : _cols[x - _x0];
+
+    std::vector<Run> overlapping;
+    for (std::vector<Run>::const_iterator run = std::lower_bound(runs.begin(), runs.end(), i0 - origin,
+                                                    [](Run const& r, int v) { return r.second < v; });
+         run != runs.end() && run->first <= i1 - origin; ++run) {
+        overlapping.push_back(Run(run->first + origin, run->second + origin));
     }
 
-    defect.x1 = z1 - i0;
-    defect.x2 = z2 - i0;
-    classify_defects(&defect, 1, ndata);
-    do_defect(&defect, 1, data, ndata, minval);
+    return overlapping;
+}
 
-    return(*val);
-#endif
+/**
+ *
+ * Return a boolean status (true: interpolation is OK) and the interpolated value for a pixel,
+ * ignoring BAD, CR, INTRP, SAT, and NO_DATA pixels
+ *
+ * Interpolation can either be vertical or horizontal
+ *
+ * @note: This has to index the whole of image's mask, so it's a pretty expensive routine;  if you're
+ * going to call it more than once, build an interp::BadPixelRuns and use the other overload.
+ */
+template <typename MaskedImageT>
+std::pair<bool, typename MaskedImageT::Image::Pixel> interp::singlePixel(
+        int x,                          ///< column coordinate of the pixel in question
+        int y,                          ///< row coordinate of the pixel in question
+        MaskedImageT const& image,      ///< in this image
+        bool horizontal,                ///< interpolate horizontally?
+        double minval                   ///< minimum acceptable value
+                                                                  )
+{
+    typedef typename MaskedImageT::Mask MaskT;
+    BadPixelRuns const badPixels(*image.getMask(),
+                                 MaskT::getPlaneBitMask("BAD") | MaskT::getPlaneBitMask("CR") |
+                                 MaskT::getPlaneBitMask("INTRP") | MaskT::getPlaneBitMask("SAT") |
+                                 MaskT::getPlaneBitMask("NO_DATA"));
+
+    return singlePixel(x, y, image, badPixels, horizontal, minval);
+}
+
+/**
+ *
+ * Return a boolean status (true: interpolation is OK) and the interpolated value for a pixel,
+ * ignoring the pixels in badPixels;  the pixel (x, y) itself is taken to be bad
+ *
+ * Interpolation can either be vertical or horizontal, and fails if the defect containing the pixel comes
+ * too close to the edge of the image or is too wide.
+ */
+template <typename MaskedImageT>
+std::pair<bool, typename MaskedImageT::Image::Pixel> interp::singlePixel(
+        int x,                          ///< column coordinate of the pixel in question (parent frame)
+        int y,                          ///< row coordinate of the pixel in question (parent frame)
+        MaskedImageT const& image,      ///< in this image
+        BadPixelRuns const& badPixels,  ///< the bad pixels in image
+        bool horizontal,                ///< interpolate horizontally?
+        double minval                   ///< minimum acceptable value
+                                                                  )
+{
+    typedef typename MaskedImageT::Image::Pixel ImagePixel;
+    std::pair<bool, ImagePixel> const failure(false, std::numeric_limits<ImagePixel>::min());
+    int const ndatamax = singlePixelMaxData; // largest allowable defect. XXX
+    int const nUseInterp = 6;           // no. of pixels to interpolate towards edge
+    /*
+     * Work along the row (or column) through the pixel, in the image's coordinates
+     */
+    int const origin = horizontal ? image.getX0() : image.getY0(); // parent coordinate of start of line
+    int const n = horizontal ? image.getWidth() : image.getHeight(); // length of line
+    int const c = (horizontal ? x : y) - origin; // position of pixel on line
+
+    BadPixelRuns::Run const defect = badPixels.getDefect(x, y, horizontal);
+    int const z1 = defect.first - origin; // range of bad pixels
+    int const z2 = defect.second - origin;
+
+    int const i0 = (z1 > 2) ? z1 - 2 : 0; // origin of available required data
+    int const i1 = (z2 < n - 2) ? z2 + 2 : n - 1; // end of "      "   "    "
+
+    if (i0 < 2 || i1 >= n - 2) {        // interpolation will fail
+        return failure;
+    }
+
+    int const ndata = i1 - i0 + 1;      // dimension of data
+    if (ndata > ndatamax) {
+        return failure;
+    }
+    /*
+     * Copy the pixels into a temporary one-row image and interpolate over the defect, treating any other
+     * bad pixels in the data as defects too
+     */
+    image::Image<ImagePixel> data(geom::Extent2I(ndata, 1));
+    typename image::Image<ImagePixel>::x_iterator out = data.row_begin(0);
+    for (int i = i0; i <= i1; ++i) {
+        out[i - i0] = horizontal ? (*image.getImage())(i, y - image.getY0()) :
+                                   (*image.getImage())(x - image.getX0(), i);
+    }
+
+    std::vector<Defect::Ptr> badList;   // in order of increasing x0
+    std::vector<BadPixelRuns::Run> const runs = badPixels.getRuns(x, y, horizontal, i0 + origin, i1 + origin);
+    for (std::vector<BadPixelRuns::Run>::const_iterator run = runs.begin(); run != runs.end(); ++run) {
+        int const r0 = std::max(run->first - origin, i0) - i0;
+        int const r1 = std::min(run->second - origin, i1) - i0;
+        if (r1 < z1 - i0) {
+            badList.push_back(Defect::Ptr(new Defect(geom::BoxI(geom::Point2I(r0, 0), geom::Point2I(r1, 0)))));
+        }
+    }
+    badList.push_back(Defect::Ptr(new Defect(geom::BoxI(geom::Point2I(z1 - i0, 0),
+                                                        geom::Point2I(z2 - i0, 0)))));
+    for (std::vector<BadPixelRuns::Run>::const_iterator run = runs.begin(); run != runs.end(); ++run) {
+        int const r0 = std::max(run->first - origin, i0) - i0;
+        int const r1 = std::min(run->second - origin, i1) - i0;
+        if (r0 > z2 - i0) {
+            badList.push_back(Defect::Ptr(new Defect(geom::BoxI(geom::Point2I(r0, 0), geom::Point2I(r1, 0)))));
+        }
+    }
 
-    return std::make_pair(false, std::numeric_limits<typename MaskedImageT::Image::Pixel>::min());
+    std::vector<Defect::Ptr> const badList1D = classify_defects(badList, 0, ndata);
+    do_defects(badList1D, 0, data, static_cast<ImagePixel>(minval), 0.0, false, nUseInterp);
+
+    return std::make_pair(true, out[c - i0]);
 }
 
 /************************************************************************************************************/
@@ -2241,27 +2342,56 @@ std::pair<bool, typename MaskedImageT::Image::Pixel> interp::singlePixel(
 
 typedef float ImagePixel;
 
+template
+void detail::interpolateDefect(image::Image<ImagePixel>::x_iterator, int, int, int, Defect::DefectPosition,
+                               int, ImagePixel, double);
+
 template
 void interpolateOverDefects(image::MaskedImage<ImagePixel, image::MaskPixel> &image,
-                            lsst::afw::detection::Psf const &, std::vector<Defect::Ptr> &badList, double, bool
-                           );
+                            lsst::afw::detection::Psf const &, std::vector<Defect::Ptr> &badList,
+                            double, bool, int, InterpDirection, bool);
+template
+void interpolateOverDefects(image::MaskedImage<ImagePixel, image::MaskPixel> &image, DefectPlan const &,
+                            double, int, lsst::afw::detection::Psf const *);
+template
+void interpolateOverMaskPlane(image::MaskedImage<ImagePixel, image::MaskPixel> &image, image::MaskPixel,
+                              double, bool, int);
+template
+std::pair<bool, ImagePixel> interp::singlePixel(int x, int y,
+                                                image::MaskedImage<ImagePixel, image::MaskPixel> const& image,
+                                                bool horizontal, double minval);
 template
 std::pair<bool, ImagePixel> interp::singlePixel(int x, int y,
                                                 image::MaskedImage<ImagePixel, image::MaskPixel> const& image,
+                                                interp::BadPixelRuns const& badPixels,
                                                 bool horizontal, double minval);
 //
 // Why do we need double images?
 //
 #if 1
 template
+void detail::interpolateDefect(image::Image<double>::x_iterator, int, int, int, Defect::DefectPosition,
+                               int, double, double);
+template
 void interpolateOverDefects(image::MaskedImage<double, image::MaskPixel> &image,
-                            lsst::afw::detection::Psf const &, std::vector<Defect::Ptr> &badList, double, bool
-                           );
+                            lsst::afw::detection::Psf const &, std::vector<Defect::Ptr> &badList,
+                            double, bool, int, InterpDirection, bool);
+template
+void interpolateOverDefects(image::MaskedImage<double, image::MaskPixel> &image, DefectPlan const &,
+                            double, int, lsst::afw::detection::Psf const *);
+template
+void interpolateOverMaskPlane(image::MaskedImage<double, image::MaskPixel> &image, image::MaskPixel,
+                              double, bool, int);
 
 template
 std::pair<bool, double> interp::singlePixel(int x, int y,
                                             image::MaskedImage<double, image::MaskPixel> const& image,
                                             bool horizontal, double minval);
+template
+std::pair<bool, double> interp::singlePixel(int x, int y,
+                                            image::MaskedImage<double, image::MaskPixel> const& image,
+                                            interp::BadPixelRuns const& badPixels,
+                                            bool horizontal, double minval);
 
 #endif
 // \endcond
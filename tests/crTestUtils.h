@@ -0,0 +1,142 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_TESTS_crTestUtils_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_TESTS_crTestUtils_h_INCLUDED
+
+#include <cmath>
+#include <random>
+#include <string>
+
+#include "lsst/pex/policy/Policy.h"
+#include "lsst/afw/geom/Box.h"
+#include "lsst/afw/geom/Extent.h"
+#include "lsst/afw/image/MaskedImage.h"
+
+namespace test {
+namespace cr {
+
+/// A sky of level pedestal with Gaussian noise of standard deviation sigma, and a variance to match
+///
+/// If sigma is 0 the sky is flat, and rng isn't used
+template <typename PixelT>
+lsst::afw::image::MaskedImage<PixelT> makeSky(lsst::afw::geom::Extent2I const& size, std::mt19937 &rng,
+                                              double pedestal=100.0, double sigma=10.0) {
+    lsst::afw::image::MaskedImage<PixelT> mi(size);
+    *mi.getImage() = pedestal;
+    *mi.getMask() = 0;
+    *mi.getVariance() = sigma*sigma;
+
+    if (sigma > 0) {
+        std::normal_distribution<double> noise(pedestal, sigma);
+        for (int y = 0; y != mi.getHeight(); ++y) {
+            for (int x = 0; x != mi.getWidth(); ++x) {
+                (*mi.getImage())(x, y) = noise(rng);
+            }
+        }
+    }
+
+    return mi;
+}
+
+/// Add nCr CRs to an image
+///
+/// Each CR is a streak of 1--10 pixels rising a row every 3 columns, starting at a pixel chosen uniformly
+/// within bbox (in the image's local coordinates), with each pixel's amplitude drawn from
+/// |N(crAmplitude, crAmplitudeSigma)|.  The CRs are free to overlap, and bbox must leave room for them
+/// to the right of and above its corners
+template <typename PixelT>
+void addCrs(lsst::afw::image::MaskedImage<PixelT> &mi, std::mt19937 &rng, int nCr,
+            lsst::afw::geom::Box2I const& bbox,
+            double crAmplitude=800.0, double crAmplitudeSigma=200.0) {
+    std::uniform_int_distribution<int> xpos(bbox.getMinX(), bbox.getMaxX());
+    std::uniform_int_distribution<int> ypos(bbox.getMinY(), bbox.getMaxY());
+    std::uniform_int_distribution<int> length(1, 10);
+    std::normal_distribution<double> amplitude(crAmplitude, crAmplitudeSigma);
+    for (int i = 0; i != nCr; ++i) {
+        int const x = xpos(rng), y = ypos(rng);
+        int const len = length(rng);
+        for (int k = 0; k != len; ++k) {
+            (*mi.getImage())(x + k, y + k/3) += std::fabs(amplitude(rng));
+        }
+    }
+}
+
+/// Noisy sky (see makeSky) with nCr CRs (see addCrs) kept at least 3 pixels away from the left, right, and
+/// bottom edges, but only 1 pixel from the top
+template <typename PixelT>
+lsst::afw::image::MaskedImage<PixelT> makeCrImage(lsst::afw::geom::Extent2I const& size, unsigned int seed,
+                                                  int nCr, double pedestal=100.0,
+                                                  double crAmplitude=800.0) {
+    std::mt19937 rng(seed);
+    lsst::afw::image::MaskedImage<PixelT> mi = makeSky<PixelT>(size, rng, pedestal);
+    addCrs(mi, rng, nCr,
+           lsst::afw::geom::Box2I(lsst::afw::geom::Point2I(3, 3), size - lsst::afw::geom::Extent2I(15, 7)),
+           crAmplitude);
+
+    return mi;
+}
+
+/// The policy that the CR tests run findCosmicRays with
+inline lsst::pex::policy::Policy makeCrPolicy() {
+    lsst::pex::policy::Policy policy;
+    policy.set("nCrPixelMax", 100000);
+    policy.set("minSigma", 6.0);
+    policy.set("min_DN", 150.0);
+    policy.set("cond3_fac", 2.5);
+    policy.set("cond3_fac2", 0.6);
+    policy.set("niteration", 3);
+
+    return policy;
+}
+
+/// The policy that the CR tests run findCosmicRays with, with some entries added or replaced
+///
+/// e.g. makeCrPolicy("min_DN", 300.0, "nThreads", 4)
+template <typename T, typename... Rest>
+lsst::pex::policy::Policy makeCrPolicy(std::string const& name, T const& value, Rest const&... rest) {
+    lsst::pex::policy::Policy policy = makeCrPolicy(rest...);
+    policy.set(name, value);
+
+    return policy;
+}
+
+/// Return the number of pixels whose value or mask differ between two images
+template <typename PixelT>
+int countDifferences(lsst::afw::image::MaskedImage<PixelT> const& mi,
+                     lsst::afw::image::MaskedImage<PixelT> const& expected) {
+    int nDiff = 0;
+    for (int y = 0; y != mi.getHeight(); ++y) {
+        for (int x = 0; x != mi.getWidth(); ++x) {
+            if ((*mi.getImage())(x, y) != (*expected.getImage())(x, y) ||
+                (*mi.getMask())(x, y) != (*expected.getMask())(x, y)) {
+                ++nDiff;
+            }
+        }
+    }
+    return nDiff;
+}
+
+}} // namespace test::cr
+
+#endif
@@ -25,6 +25,7 @@ from __future__ import absolute_import, division, print_function
 from builtins import range
 import unittest
 
+import lsst.daf.base as dafBase
 import lsst.afw.geom as afwGeom
 import lsst.afw.math as afwMath
 import lsst.afw.table as afwTable
@@ -72,6 +73,39 @@ def makeBiaxialGaussianPsf(sizex, sizey, sigma1, sigma2, theta):
     kernel = afwMath.AnalyticKernel(sizex, sizey, afwMath.GaussianFunction2D(sigma1, sigma2, theta))
     return measAlg.KernelPsf(kernel)
 
+
+def makeDistortedWcs(crval, crpix, cdelt, distortion):
+    """Return a TAN-SIP Wcs with a quadratic distortion, displacing pixels r pixels from crpix by
+    about distortion*r**2 pixels.
+
+    The inverse (AP, BP) terms only undo the distortion to first order, so the forward and inverse
+    transforms disagree slightly.
+    """
+    md = dafBase.PropertyList()
+    md.set("RADESYS", "ICRS")
+    md.set("EQUINOX", 2000.0)
+    md.set("CTYPE1", "RA---TAN-SIP")
+    md.set("CTYPE2", "DEC--TAN-SIP")
+    md.set("CUNIT1", "deg")
+    md.set("CUNIT2", "deg")
+    md.set("CRVAL1", crval.getLongitude().asDegrees())
+    md.set("CRVAL2", crval.getLatitude().asDegrees())
+    md.set("CRPIX1", crpix.getX() + 1)  # FITS pixels are 1-indexed
+    md.set("CRPIX2", crpix.getY() + 1)
+    md.set("CD1_1", cdelt)
+    md.set("CD1_2", 0.0)
+    md.set("CD2_1", 0.0)
+    md.set("CD2_2", cdelt)
+    for name in ("A", "B", "AP", "BP"):
+        md.set("%s_ORDER" % name, 2)
+    for name, sign in (("A", 1), ("AP", -1)):
+        md.set("%s_2_0" % name, sign*distortion)
+        md.set("%s_1_1" % name, sign*0.5*distortion)
+    for name, sign in (("B", 1), ("BP", -1)):
+        md.set("%s_0_2" % name, sign*distortion)
+        md.set("%s_1_1" % name, -sign*0.5*distortion)
+    return afwImage.makeWcs(md)
+
 # This is a mock method for coadding the moments of the component Psfs at a point
 # Check that the coaddpsf passed in is really using the correct components and weighting them properly
 # The components in this case are all single gaussians, and we will just add the moments
@@ -424,6 +458,43 @@ class CoaddPsfTest(lsst.utils.tests.TestCase):
             self.assertAlmostEqual(m1, m1coadd, delta=0.01)
             self.assertAlmostEqual(m2, m2coadd, delta=0.01)
 
+    def testManyInputs(self):
+        """Check that the inputs found at a point are those that contain it, with many scattered inputs,
+        some of them with distorted Wcss."""
+        for i in range(60):
+            record = self.mycatalog.getTable().makeRecord()
+            record.setPsf(measAlg.DoubleGaussianPsf(41, 41, 1.0 + 0.05*i, 1.00, 0.0))
+            crpix = afwGeom.PointD(1000 - 97.0*(i % 8), 1000 - 131.0*(i//8))
+            if i % 4 == 1:
+                wcs = makeDistortedWcs(self.crval, crpix, self.cd11, 2e-5*(1 + i % 3))
+            else:
+                wcs = afwImage.makeWcs(self.crval, crpix, self.cd11, self.cd12, self.cd21, self.cd22)
+            record.setWcs(wcs)
+            record['weight'] = 1.0 + 0.1*i
+            record['id'] = i
+            bbox = afwGeom.Box2I(afwGeom.Point2I(0, 0), afwGeom.Extent2I(200 + 10*i, 300))
+            record.setBBox(bbox)
+            if i % 3 == 0:
+                validPolygon = Polygon(afwGeom.Box2D(afwGeom.Point2D(20, 20), afwGeom.Extent2D(150, 100)))
+            else:
+                validPolygon = Polygon(afwGeom.Box2D(bbox))
+            record.setValidPolygon(validPolygon)
+            self.mycatalog.append(record)
+
+        mypsf = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+
+        nFound = 0
+        for x in range(-60, 1800, 23):
+            for y in range(-60, 1300, 29):
+                position = afwGeom.Point2D(x + 0.25, y + 0.5)
+                expected = [r.getId() for r in self.mycatalog.subsetContaining(position, self.wcsref, True)]
+                self.assertEqual([r.getId() for r in mypsf.subsetContaining(position)], expected)
+                if len(expected) == 0:
+                    with self.assertRaises(pexExceptions.InvalidParameterError):
+                        mypsf.computeBBox(position)
+                nFound += len(expected)
+        self.assertGreater(nFound, 0)
+
     def testGoodPix(self):
         """Demonstrate that we can goodPix information in the CoaddPsf."""
         bboxSize = afwGeom.Extent2I(2000, 2000)
@@ -22,11 +22,14 @@
 # see <https://www.lsstcorp.org/LegalNotices/>.
 #
 from __future__ import absolute_import, division, print_function
+from builtins import range
 import math
 import os
 import sys
 import unittest
 
+import numpy as np
+
 import lsst.afw.image as afwImage
 import lsst.afw.math as afwMath
 import lsst.afw.geom as afwGeom
@@ -159,6 +162,12 @@ class CosmicRayTestCase(lsst.utils.tests.TestCase):
 
         if self.nCR is not None:
             self.assertEqual(len(crs), self.nCR)
+        #
+        # The CR pixels should have been replaced by values consistent with the sky
+        #
+        isCr = (self.mi.getMask().getArray() & self.mi.getMask().getPlaneBitMask("CR")) != 0
+        sigma = stats.getValue(afwMath.STDEVCLIP)
+        self.assertLess(abs(np.median(self.mi.getImage().getArray()[isCr]) - background), 3*sigma)
 
 
 class CosmicRayNullTestCase(unittest.TestCase):
@@ -182,6 +191,85 @@ class CosmicRayNullTestCase(unittest.TestCase):
         self.assertEqual(len(crs), 0, "Found %d CRs in empty image" % len(crs))
 
 
+class CosmicRayThreadTestCase(lsst.utils.tests.TestCase):
+    """A test case that multithreaded Cosmic Ray detection gives the same answer as the serial code."""
+
+    def setUp(self):
+        self.FWHM = 5                   # pixels
+        self.psf = algorithms.DoubleGaussianPsf(29, 29, self.FWHM/(2*math.sqrt(2*math.log(2))))
+        self.mi = makeCrImage(400, 600, nCR=1000, seed=1)
+
+    def tearDown(self):
+        del self.psf
+        del self.mi
+
+    def findCRs(self, nThreads):
+        """Run findCosmicRays on a copy of self.mi, returning the copy and the CRs' spans"""
+        mi = self.mi.Factory(self.mi, True)
+        crConfig = algorithms.FindCosmicRaysConfig()
+        crConfig.nThreads = nThreads
+        crs = algorithms.findCosmicRays(mi, self.psf, 100.0, pexConfig.makePolicy(crConfig))
+
+        return mi, [[(s.getY(), s.getX0(), s.getX1()) for s in cr.getSpans()] for cr in crs]
+
+    def testThreads(self):
+        mi1, crs1 = self.findCRs(1)
+        self.assertGreater(len(crs1), 0)
+        for nThreads in (2, 3, 8):
+            mi, crs = self.findCRs(nThreads)
+            self.assertEqual(crs, crs1)
+            self.assertMaskedImagesEqual(mi, mi1)
+
+
+class CosmicRayInterpolationTestCase(lsst.utils.tests.TestCase):
+    """A test case that the pixels under Cosmic Rays are replaced by values consistent with the sky."""
+
+    def setUp(self):
+        self.FWHM = 5                   # pixels
+        self.psf = algorithms.DoubleGaussianPsf(29, 29, self.FWHM/(2*math.sqrt(2*math.log(2))))
+        self.bkgd, self.sigma = 100.0, 10.0
+        self.mi = makeCrImage(400, 600, nCR=300, seed=2, bkgd=self.bkgd, sigma=self.sigma)
+        #
+        # Add a sloping sky, so replacing the CRs with values drawn from the background level would be wrong
+        #
+        ima = self.mi.getImage().getArray()
+        self.sky = self.bkgd + 0.2*np.arange(ima.shape[1])[np.newaxis, :]*np.ones_like(ima)
+        ima += self.sky - self.bkgd
+
+    def tearDown(self):
+        del self.psf
+        del self.mi
+
+    def testInterpolation(self):
+        crConfig = algorithms.FindCosmicRaysConfig()
+        crs = algorithms.findCosmicRays(self.mi, self.psf, self.bkgd, pexConfig.makePolicy(crConfig))
+        self.assertGreater(len(crs), 0)
+
+        isCr = (self.mi.getMask().getArray() & self.mi.getMask().getPlaneBitMask("CR")) != 0
+        resid = (self.mi.getImage().getArray()[isCr] - self.sky[isCr])/self.sigma
+        # The estimate is the smallest of the directional estimates, so it's biased a little low
+        self.assertLess(abs(np.median(resid)), 3)
+        self.assertGreater(np.mean(np.abs(resid) < 3), 0.7)
+
+
+def makeCrImage(width, height, nCR, seed, bkgd=100.0, sigma=10.0):
+    """Return a MaskedImageF of noise with nCR straight cosmic ray tracks added"""
+    mi = afwImage.MaskedImageF(width, height)
+    rand = np.random.RandomState(seed)
+    ima = mi.getImage().getArray()
+    ima[:] = rand.normal(bkgd, sigma, ima.shape)
+    mi.getVariance().set(sigma**2)
+
+    for x0, y0, length, direction in zip(rand.randint(2, width - 2, nCR), rand.randint(2, height - 2, nCR),
+                                         rand.randint(1, 12, nCR), rand.randint(0, 4, nCR)):
+        dx, dy = [(1, 0), (0, 1), (1, 1), (1, -1)][direction]
+        for i in range(length):
+            x, y = x0 + i*dx, y0 + i*dy
+            if 0 <= x < width and 0 <= y < height:
+                ima[y, x] += rand.normal(500, 200)
+
+    return mi
+
 #-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
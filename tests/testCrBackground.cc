@@ -0,0 +1,167 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+/*
+ * Check findCosmicRays with a background that varies over the image
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CrBackground
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/math/BoundedField.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+#include "crTestUtils.h"
+
+namespace {
+
+namespace afwDet = lsst::afw::detection;
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace afwMath = lsst::afw::math;
+namespace algorithms = lsst::meas::algorithms;
+
+typedef afwImage::MaskedImage<float> MaskedImageF;
+
+int const WIDTH = 300, HEIGHT = 200;
+int const AMP_WIDTH = WIDTH/2;          // the image is made of two amplifiers, side by side
+afwGeom::Point2I const XY0(1000, 2000); // the image's origin in its parent
+
+/*
+ * A background with one level to the left of column x (in the parent frame), and another to its right
+ */
+class AmpBackground : public afwMath::BoundedField {
+public:
+    AmpBackground(afwGeom::Box2I const& bbox, int x, double left, double right) :
+        afwMath::BoundedField(bbox), _x(x), _left(left), _right(right) {}
+
+    virtual double evaluate(afwGeom::Point2D const& position) const {
+        return (position.getX() < _x) ? _left : _right;
+    }
+
+    virtual PTR(afwMath::BoundedField) operator*(double const scale) const {
+        return std::make_shared<AmpBackground>(getBBox(), _x, scale*_left, scale*_right);
+    }
+private:
+    int _x;
+    double _left, _right;
+};
+
+/*
+ * Noisy sky with a sprinkling of CRs.  The right-hand amplifier is a copy of the left-hand one, but with
+ * pedestal added;  the columns on either side of the join are BAD
+ */
+MaskedImageF makeImage(double pedestal) {
+    std::mt19937 rng(1);
+    MaskedImageF amp = test::cr::makeSky<float>(afwGeom::Extent2I(AMP_WIDTH, HEIGHT), rng);
+    test::cr::addCrs(amp, rng, 40, afwGeom::Box2I(afwGeom::Point2I(5, 5),
+                                                  afwGeom::Point2I(AMP_WIDTH - 30, HEIGHT - 10)));
+
+    MaskedImageF mi(afwGeom::Extent2I(WIDTH, HEIGHT));
+    mi.setXY0(XY0);
+    *mi.getMask() = 0;
+    *mi.getVariance() = 100;
+    for (int y = 0; y != HEIGHT; ++y) {
+        for (int x = 0; x != AMP_WIDTH; ++x) {
+            float const value = std::round(16*(*amp.getImage())(x, y))/16; // so adding pedestal is exact
+            (*mi.getImage())(x, y) = value;
+            (*mi.getImage())(x + AMP_WIDTH, y) = value + pedestal;
+        }
+        (*mi.getMask())(AMP_WIDTH - 1, y) = MaskedImageF::Mask::getPlaneBitMask("BAD");
+        (*mi.getMask())(AMP_WIDTH, y) = MaskedImageF::Mask::getPlaneBitMask("BAD");
+    }
+
+    return mi;
+}
+
+} // anonymous namespace
+
+/*
+ * A constant background gives exactly the same results as passing it as a number
+ */
+BOOST_AUTO_TEST_CASE(CrBackgroundConstant) {
+    algorithms::DoubleGaussianPsf const psf(15, 15, 2.0);
+    MaskedImageF const in = makeImage(0.0);
+    AmpBackground const bkgd(in.getBBox(afwImage::PARENT), 0, 100.0, 100.0);
+
+    for (int keep = 0; keep != 2; ++keep) {
+        MaskedImageF expected(in, true);
+        std::vector<PTR(afwDet::Footprint)> const expectedCrs =
+            algorithms::findCosmicRays(expected, psf, 100.0, test::cr::makeCrPolicy(), keep);
+        BOOST_REQUIRE(!expectedCrs.empty());
+
+        MaskedImageF mi(in, true);
+        std::vector<PTR(afwDet::Footprint)> const crs =
+            algorithms::findCosmicRays(mi, psf, bkgd, test::cr::makeCrPolicy(), keep);
+
+        BOOST_REQUIRE_EQUAL(crs.size(), expectedCrs.size());
+        for (std::size_t i = 0; i != crs.size(); ++i) {
+            BOOST_CHECK_EQUAL(crs[i]->getNpix(), expectedCrs[i]->getNpix());
+        }
+        BOOST_CHECK_EQUAL(test::cr::countDifferences(mi, expected), 0);
+    }
+}
+
+/*
+ * Amplifiers with different pedestals:  given the right background, we find the same CRs (and leave the
+ * same pixel values) as we do when processing each amplifier on its own
+ */
+BOOST_AUTO_TEST_CASE(CrBackgroundAmplifiers) {
+    algorithms::DoubleGaussianPsf const psf(15, 15, 2.0);
+    double const pedestal = 1000;
+    MaskedImageF const in = makeImage(pedestal);
+    lsst::pex::policy::Policy const policy = test::cr::makeCrPolicy();
+
+    MaskedImageF mi(in, true);
+    AmpBackground const bkgd(in.getBBox(afwImage::PARENT), XY0.getX() + AMP_WIDTH, 100.0, 100.0 + pedestal);
+    std::vector<PTR(afwDet::Footprint)> const crs = algorithms::findCosmicRays(mi, psf, bkgd, policy);
+
+    MaskedImageF expected(in, true);
+    std::size_t nExpected = 0;          // number of CRs found in the amplifiers
+    for (int amp = 0; amp != 2; ++amp) {
+        afwGeom::Box2I const bbox(afwGeom::Point2I(XY0.getX() + amp*AMP_WIDTH, XY0.getY()),
+                                  afwGeom::Extent2I(AMP_WIDTH, HEIGHT));
+        MaskedImageF ampImage(expected, bbox, afwImage::PARENT, false);
+        nExpected += algorithms::findCosmicRays(ampImage, psf, 100.0 + amp*pedestal, policy).size();
+    }
+    BOOST_CHECK(nExpected > 20);
+    BOOST_CHECK_EQUAL(crs.size(), nExpected);
+    BOOST_CHECK_EQUAL(test::cr::countDifferences(mi, expected), 0);
+    //
+    // Check that the test means something:  the left-hand amplifier's background is wrong for the right
+    //
+    MaskedImageF scalar(in, true);
+    algorithms::findCosmicRays(scalar, psf, 100.0, policy);
+    BOOST_CHECK(test::cr::countDifferences(scalar, expected) > 0);
+}
@@ -0,0 +1,156 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Check findCosmicRaysBatch against findCosmicRays on each image in turn
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CrBatch
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <vector>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+#include "crTestUtils.h"
+
+namespace {
+
+namespace afwDet = lsst::afw::detection;
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+int const nCrPixelMax = 2000;           // more CR pixels than this are too many
+
+/*
+ * Noisy sky with nCr CRs
+ */
+template <typename PixelT>
+afwImage::MaskedImage<PixelT> makeImage(unsigned int seed, int nCr) {
+    return test::cr::makeCrImage<PixelT>(afwGeom::Extent2I(200, 150), seed, nCr);
+}
+
+template <typename PixelT>
+void checkBatch(bool keep) {
+    typedef afwImage::MaskedImage<PixelT> MaskedImageT;
+    lsst::pex::policy::Policy const policy =
+        test::cr::makeCrPolicy("nCrPixelMax", nCrPixelMax, "nThreads", 4);
+    //
+    // The first three images share a Psf;  image 4 has too many CRs
+    //
+    int const nImage = 7;
+    int const tooMany = 4;
+    PTR(afwDet::Psf const) shared = std::make_shared<algorithms::DoubleGaussianPsf>(15, 15, 2.0);
+
+    std::vector<PTR(MaskedImageT)> images;
+    std::vector<PTR(afwDet::Psf const)> psfs;
+    std::vector<double> bkgds;
+    std::vector<MaskedImageT> originals;
+    for (int i = 0; i != nImage; ++i) {
+        originals.push_back(makeImage<PixelT>(i + 1, (i == tooMany) ? 2000 : 50));
+        images.push_back(std::make_shared<MaskedImageT>(originals.back(), true));
+        psfs.push_back((i < 3) ? shared :
+                       std::make_shared<algorithms::DoubleGaussianPsf>(15, 15, 1.5 + 0.1*i));
+        bkgds.push_back(100.0);
+    }
+
+    std::vector<algorithms::CosmicRayBatchResult> const results =
+        algorithms::findCosmicRaysBatch(images, psfs, bkgds, policy, keep);
+    BOOST_REQUIRE_EQUAL(results.size(), static_cast<std::size_t>(nImage));
+
+    for (int i = 0; i != nImage; ++i) {
+        MaskedImageT expected(originals[i], true);
+        if (i == tooMany) {
+            BOOST_CHECK_THROW(algorithms::findCosmicRays(expected, *psfs[i], bkgds[i], policy, keep),
+                              algorithms::TooManyCrPixelsError);
+            BOOST_CHECK_EQUAL(results[i].status, algorithms::CosmicRayBatchResult::TOO_MANY_CRS);
+            BOOST_CHECK(!results[i].message.empty());
+            BOOST_CHECK(results[i].crs.empty());
+        } else {
+            std::vector<PTR(afwDet::Footprint)> const crs =
+                algorithms::findCosmicRays(expected, *psfs[i], bkgds[i], policy, keep);
+            BOOST_REQUIRE_EQUAL(results[i].status, algorithms::CosmicRayBatchResult::OK);
+            BOOST_CHECK(!crs.empty());
+            BOOST_REQUIRE_EQUAL(results[i].crs.size(), crs.size());
+            BOOST_CHECK_EQUAL(results[i].stats.nCrAfterCondition1, static_cast<int>(crs.size()));
+            for (std::size_t j = 0; j != crs.size(); ++j) {
+                afwDet::Footprint::SpanList const& spans = results[i].crs[j]->getSpans();
+                afwDet::Footprint::SpanList const& expectedSpans = crs[j]->getSpans();
+                BOOST_REQUIRE_EQUAL(spans.size(), expectedSpans.size());
+                for (std::size_t k = 0; k != spans.size(); ++k) {
+                    BOOST_CHECK_EQUAL(spans[k]->getY(), expectedSpans[k]->getY());
+                    BOOST_CHECK_EQUAL(spans[k]->getX0(), expectedSpans[k]->getX0());
+                    BOOST_CHECK_EQUAL(spans[k]->getX1(), expectedSpans[k]->getX1());
+                }
+            }
+        }
+        BOOST_CHECK_EQUAL(test::cr::countDifferences(*images[i], expected), 0);
+    }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(CrBatchFloat) {
+    checkBatch<float>(false);
+    checkBatch<float>(true);
+}
+
+BOOST_AUTO_TEST_CASE(CrBatchDouble) {
+    checkBatch<double>(false);
+    checkBatch<double>(true);
+}
+
+BOOST_AUTO_TEST_CASE(CrBatchErrors) {
+    typedef afwImage::MaskedImage<float> MaskedImageF;
+    lsst::pex::policy::Policy const policy =
+        test::cr::makeCrPolicy("nCrPixelMax", nCrPixelMax, "nThreads", 4);
+
+    std::vector<PTR(MaskedImageF)> images;
+    images.push_back(std::make_shared<MaskedImageF>(makeImage<float>(1, 50), true));
+    images.push_back(std::make_shared<MaskedImageF>(makeImage<float>(2, 50), true));
+    std::vector<PTR(afwDet::Psf const)> psfs;
+    psfs.push_back(std::make_shared<algorithms::DoubleGaussianPsf>(15, 15, 2.0));
+    std::vector<double> bkgds(2, 100.0);
+
+    BOOST_CHECK_THROW(algorithms::findCosmicRaysBatch(images, psfs, bkgds, policy),
+                      lsst::pex::exceptions::LengthError);
+    //
+    // A missing Psf only affects its own image
+    //
+    psfs.push_back(PTR(afwDet::Psf const)());
+    std::vector<algorithms::CosmicRayBatchResult> const results =
+        algorithms::findCosmicRaysBatch(images, psfs, bkgds, policy);
+    BOOST_CHECK_EQUAL(results[0].status, algorithms::CosmicRayBatchResult::OK);
+    BOOST_CHECK(!results[0].crs.empty());
+    BOOST_CHECK_EQUAL(results[1].status, algorithms::CosmicRayBatchResult::FAILED);
+    BOOST_CHECK(results[1].crs.empty());
+}
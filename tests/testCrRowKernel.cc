@@ -0,0 +1,231 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CrRowKernel
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "lsst/meas/algorithms/detail/CrRowKernel.h"
+
+namespace {
+
+using lsst::meas::algorithms::detail::CrRows;
+using lsst::meas::algorithms::detail::CrTestParams;
+
+std::uint16_t const BAD = 01;
+std::uint16_t const INTRP = 04;
+
+/*
+ * Three rows of noisy sky with a sprinkling of bright pixels, masked pixels, and oddities
+ */
+template <typename ImagePixelT>
+struct TestRows {
+    TestRows(int ncol, unsigned int seed) : image(3*ncol), variance(3*ncol), mask(3*ncol), sigma(ncol) {
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> noise(100.0, 10.0);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        for (int i = 0; i != 3*ncol; ++i) {
+            image[i] = noise(rng);
+            variance[i] = 100.0*(0.5 + uniform(rng));
+            double const u = uniform(rng);
+            if (u < 0.15) {
+                image[i] += 1000*uniform(rng);      // a CR (or a star)
+            } else if (u < 0.17) {
+                image[i] = -image[i];               // negative pixels are never CRs
+            } else if (u < 0.18) {
+                image[i] = std::numeric_limits<ImagePixelT>::quiet_NaN();
+            } else if (u < 0.19) {
+                variance[i] = 0.0;
+            }
+            mask[i] = (uniform(rng) < 0.02) ? BAD : ((uniform(rng) < 0.02) ? INTRP : 0);
+        }
+        for (int k = 0; k != 3; ++k) {
+            rows.image[k] = &image[k*ncol];
+            rows.variance[k] = &variance[k*ncol];
+            rows.mask[k] = &mask[k*ncol];
+        }
+        rows.sigma = NULL;
+        rows.bkgd = NULL;
+        for (int i = 0; i != ncol; ++i) { // make the middle row's variances exact squares of floats
+            sigma[i] = std::round(64*std::sqrt(variance[ncol + i]))/64;
+            variance[ncol + i] = sigma[i]*sigma[i];
+        }
+    }
+
+    std::vector<ImagePixelT> image;
+    std::vector<float> variance;
+    std::vector<std::uint16_t> mask;
+    std::vector<float> sigma;           // sqrt(variance) of the middle row
+    CrRows<ImagePixelT, float, std::uint16_t> rows;
+};
+
+/*
+ * Check that the scalar and vectorised kernels agree, and return the candidates
+ */
+template <typename ImagePixelT>
+std::vector<std::uint8_t> checkAgree(TestRows<ImagePixelT> const &data, int ncol,
+                                     CrTestParams const &params) {
+    int const nbyte = (ncol - 2 + 7)/8;
+    std::vector<std::uint8_t> scalar(nbyte), vector(nbyte);
+    lsst::meas::algorithms::detail::findCrCandidatesScalar(data.rows, 1, ncol - 1, params, BAD, INTRP,
+                                                           &scalar[0]);
+    lsst::meas::algorithms::detail::findCrCandidates(data.rows, 1, ncol - 1, params, BAD, INTRP, &vector[0]);
+    BOOST_CHECK_EQUAL_COLLECTIONS(scalar.begin(), scalar.end(), vector.begin(), vector.end());
+
+    return scalar;
+}
+
+template <typename ImagePixelT>
+void checkKernel(CrTestParams const &params) {
+    for (int ncol = 3; ncol != 80; ++ncol) {
+        TestRows<ImagePixelT> data(ncol, ncol);
+        int const nbyte = (ncol - 2 + 7)/8;
+
+        std::vector<std::uint8_t> scalar(nbyte), vector(nbyte);
+        lsst::meas::algorithms::detail::findCrCandidatesScalar(data.rows, 1, ncol - 1, params, BAD, INTRP,
+                                                               &scalar[0]);
+        lsst::meas::algorithms::detail::findCrCandidates(data.rows, 1, ncol - 1, params, BAD, INTRP,
+                                                         &vector[0]);
+        BOOST_CHECK_EQUAL_COLLECTIONS(scalar.begin(), scalar.end(), vector.begin(), vector.end());
+        //
+        // and check that the bitmask agrees with the per-pixel test
+        //
+        for (int i = 1; i < ncol - 1; ++i) {
+            bool const bit = (scalar[(i - 1)/8] >> ((i - 1)%8)) & 1;
+            BOOST_CHECK_EQUAL(bit, lsst::meas::algorithms::detail::isCrCandidate(data.rows, i, params,
+                                                                                 BAD, INTRP));
+        }
+        //
+        // Supplying the standard deviations mustn't change anything
+        //
+        data.rows.sigma = &data.sigma[0];
+        std::vector<std::uint8_t> withSigma(nbyte);
+        lsst::meas::algorithms::detail::findCrCandidates(data.rows, 1, ncol - 1, params, BAD, INTRP,
+                                                         &withSigma[0]);
+        BOOST_CHECK_EQUAL_COLLECTIONS(scalar.begin(), scalar.end(), withSigma.begin(), withSigma.end());
+        //
+        // Nor must supplying the background under the row, if it's params.bkgd;  a varying background
+        // must give the same results from both versions of the test
+        //
+        std::vector<double> bkgd(ncol, params.bkgd);
+        data.rows.bkgd = &bkgd[0];
+        std::vector<std::uint8_t> const withBkgd = checkAgree(data, ncol, params);
+        BOOST_CHECK_EQUAL_COLLECTIONS(scalar.begin(), scalar.end(), withBkgd.begin(), withBkgd.end());
+
+        for (int i = 0; i != ncol; ++i) {
+            bkgd[i] = params.bkgd + 300*std::sin(0.3*i);
+        }
+        checkAgree(data, ncol, params);
+        //
+        // Skipping condition #3 can only add candidates
+        //
+        CrTestParams noCondition3 = params;
+        noCondition3.skipCondition3 = true;
+        std::vector<std::uint8_t> const superset = checkAgree(data, ncol, noCondition3);
+        for (int i = 0; i != nbyte; ++i) {
+            BOOST_CHECK_EQUAL(scalar[i] & ~superset[i], 0);
+        }
+    }
+}
+
+/*
+ * Check the kernel on sky that is mostly clean, so that most groups of pixels are rejected early,
+ * with a few pixels set to within a rounding error of condition #2's threshold and runs of BAD pixels
+ */
+void checkSparseKernel(CrTestParams const &params) {
+    int const ncol = 203;
+    for (unsigned int seed = 1; seed != 20; ++seed) {
+        TestRows<float> data(ncol, seed);
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> noise(100.0, 10.0);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (int i = 0; i != 3*ncol; ++i) {
+            data.image[i] = noise(rng);
+            data.mask[i] = 0;
+        }
+        for (int i = ncol + 1; i < 2*ncol - 1; ++i) {
+            double const u = uniform(rng);
+            if (u < 0.03) {                 // on the edge of condition #2, using the mean to the W and E
+                double const thres = params.minSigma*std::sqrt(static_cast<double>(data.variance[i]));
+                float const mean = (data.image[i - 1] + data.image[i + 1])/2;
+                int const ulps = static_cast<int>(uniform(rng)*5) - 2;
+                float value = mean + thres;
+                for (int k = 0; k < ulps; ++k) {
+                    value = std::nextafter(value, std::numeric_limits<float>::max());
+                }
+                for (int k = 0; k > ulps; --k) {
+                    value = std::nextafter(value, -std::numeric_limits<float>::max());
+                }
+                data.image[i] = value;
+            } else if (u < 0.04) {
+                data.image[i] += 1000*uniform(rng);
+            }
+        }
+        int const badStart = 8 + seed%16;   // a run of BAD pixels covering a few whole groups of 8
+        for (int i = badStart; i != badStart + 40; ++i) {
+            data.mask[ncol + i] = BAD;
+        }
+
+        int const nbyte = (ncol - 2 + 7)/8;
+        std::vector<std::uint8_t> scalar(nbyte), vector(nbyte);
+        lsst::meas::algorithms::detail::findCrCandidatesScalar(data.rows, 1, ncol - 1, params, BAD, INTRP,
+                                                               &scalar[0]);
+        lsst::meas::algorithms::detail::findCrCandidates(data.rows, 1, ncol - 1, params, BAD, INTRP,
+                                                         &vector[0]);
+        BOOST_CHECK_EQUAL_COLLECTIONS(scalar.begin(), scalar.end(), vector.begin(), vector.end());
+    }
+}
+
+CrTestParams makeParams(double minSigma, double cond3Fac) {
+    CrTestParams params = {minSigma, 0.3, 0.25, 0.15, 100.0, cond3Fac, false};
+    return params;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(CrRowKernelFloat) {
+    checkKernel<float>(makeParams(6.0, 2.5));
+    checkKernel<float>(makeParams(3.0, 0.0)); // as used when growing CRs
+    checkKernel<float>(makeParams(-500.0, 2.5)); // an absolute threshold
+}
+
+BOOST_AUTO_TEST_CASE(CrRowKernelSparse) {
+    checkSparseKernel(makeParams(6.0, 2.5));
+    checkSparseKernel(makeParams(3.0, 0.0));
+}
+
+BOOST_AUTO_TEST_CASE(CrRowKernelDouble) {
+    checkKernel<double>(makeParams(6.0, 2.5));
+    checkKernel<double>(makeParams(-500.0, 2.5));
+}
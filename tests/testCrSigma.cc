@@ -0,0 +1,137 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ * Check that passing findCosmicRays the standard deviation of the pixels doesn't change what it does
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CrSigma
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+#include "crTestUtils.h"
+
+namespace {
+
+namespace afwDet = lsst::afw::detection;
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+/*
+ * Noisy sky with a sprinkling of CRs;  the variance varies from column to column, but its square root
+ * is exactly representable as a float
+ */
+template <typename PixelT>
+afwImage::MaskedImage<PixelT> makeImage() {
+    std::mt19937 rng(1);
+    afwImage::MaskedImage<PixelT> mi = test::cr::makeSky<PixelT>(afwGeom::Extent2I(300, 200), rng, 0.0, 1.0);
+    for (int y = 0; y != mi.getHeight(); ++y) {
+        for (int x = 0; x != mi.getWidth(); ++x) {
+            double const sigma = 8 + x%5;
+            (*mi.getImage())(x, y) = 100 + sigma*(*mi.getImage())(x, y);
+            (*mi.getVariance())(x, y) = sigma*sigma;
+        }
+    }
+    test::cr::addCrs(mi, rng, 100, afwGeom::Box2I(afwGeom::Point2I(3, 3), afwGeom::Point2I(180, 180)));
+
+    return mi;
+}
+
+template <typename PixelT>
+void checkSame(std::vector<PTR(afwDet::Footprint)> const& crs, afwImage::MaskedImage<PixelT> const& mi,
+               std::vector<PTR(afwDet::Footprint)> const& expectedCrs,
+               afwImage::MaskedImage<PixelT> const& expected) {
+    BOOST_REQUIRE_EQUAL(crs.size(), expectedCrs.size());
+    for (std::size_t i = 0; i != crs.size(); ++i) {
+        afwDet::Footprint::SpanList const& spans = crs[i]->getSpans();
+        afwDet::Footprint::SpanList const& expectedSpans = expectedCrs[i]->getSpans();
+        BOOST_REQUIRE_EQUAL(spans.size(), expectedSpans.size());
+        for (std::size_t j = 0; j != spans.size(); ++j) {
+            BOOST_CHECK_EQUAL(spans[j]->getY(), expectedSpans[j]->getY());
+            BOOST_CHECK_EQUAL(spans[j]->getX0(), expectedSpans[j]->getX0());
+            BOOST_CHECK_EQUAL(spans[j]->getX1(), expectedSpans[j]->getX1());
+        }
+    }
+    BOOST_CHECK_EQUAL(test::cr::countDifferences(mi, expected), 0);
+}
+
+template <typename PixelT>
+void checkSigma(bool keep) {
+    algorithms::DoubleGaussianPsf const psf(15, 15, 2.0);
+    afwImage::MaskedImage<PixelT> const in = makeImage<PixelT>();
+    lsst::pex::policy::Policy const policy = test::cr::makeCrPolicy();
+
+    afwImage::MaskedImage<PixelT> expected(in, true);
+    std::vector<PTR(afwDet::Footprint)> const expectedCrs =
+        algorithms::findCosmicRays(expected, psf, 100.0, policy, keep);
+    BOOST_REQUIRE(!expectedCrs.empty());
+    //
+    // Use the caller's plane
+    //
+    afwImage::Image<float> sigma(in.getDimensions());
+    for (int y = 0; y != in.getHeight(); ++y) {
+        for (int x = 0; x != in.getWidth(); ++x) {
+            sigma(x, y) = std::sqrt((*in.getVariance())(x, y));
+        }
+    }
+    afwImage::MaskedImage<PixelT> mi(in, true);
+    std::vector<PTR(afwDet::Footprint)> const crs =
+        algorithms::findCosmicRays(mi, sigma, psf, 100.0, policy, keep);
+    checkSame(crs, mi, expectedCrs, expected);
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(CrSigmaFloat) {
+    checkSigma<float>(false);
+    checkSigma<float>(true);
+}
+
+BOOST_AUTO_TEST_CASE(CrSigmaDouble) {
+    checkSigma<double>(false);
+    checkSigma<double>(true);
+}
+
+BOOST_AUTO_TEST_CASE(CrSigmaSize) {
+    algorithms::DoubleGaussianPsf const psf(15, 15, 2.0);
+    afwImage::MaskedImage<float> mi = makeImage<float>();
+    afwImage::Image<float> const sigma(afwGeom::Extent2I(mi.getWidth(), mi.getHeight() - 1));
+
+    BOOST_CHECK_THROW(algorithms::findCosmicRays(mi, sigma, psf, 100.0, test::cr::makeCrPolicy()),
+                      lsst::pex::exceptions::LengthError);
+}
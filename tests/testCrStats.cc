@@ -0,0 +1,127 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ * Check the statistics that findCosmicRays reports
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CrStats
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <vector>
+
+#include "lsst/daf/base/PropertySet.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+#include "crTestUtils.h"
+
+namespace {
+
+namespace afwDet = lsst::afw::detection;
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+typedef afwImage::MaskedImage<float> MaskedImageF;
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(CrStats) {
+    algorithms::DoubleGaussianPsf const psf(15, 15, 2.0);
+    lsst::pex::policy::Policy const policy = test::cr::makeCrPolicy("min_DN", 300.0);
+    //
+    // Noisy sky with a sprinkling of CRs, some of them too faint to pass condition #1
+    //
+    MaskedImageF const in = test::cr::makeCrImage<float>(afwGeom::Extent2I(300, 300), 1, 150, 100.0, 400.0);
+
+    MaskedImageF expected(in, true);
+    std::vector<PTR(afwDet::Footprint)> const expectedCrs = algorithms::findCosmicRays(expected, psf, 100.0,
+                                                                                        policy);
+    BOOST_REQUIRE(!expectedCrs.empty());
+
+    MaskedImageF mi(in, true);
+    algorithms::CosmicRayStats stats;
+    std::vector<PTR(afwDet::Footprint)> const crs = algorithms::findCosmicRays(mi, psf, 100.0, policy, false,
+                                                                                stats);
+    //
+    // Asking for the statistics doesn't change the results
+    //
+    BOOST_REQUIRE_EQUAL(crs.size(), expectedCrs.size());
+    int nPixel = 0;                     // number of pixels in the CRs
+    for (std::size_t i = 0; i != crs.size(); ++i) {
+        BOOST_CHECK_EQUAL(crs[i]->getNpix(), expectedCrs[i]->getNpix());
+        nPixel += crs[i]->getNpix();
+    }
+    for (int y = 0; y != mi.getHeight(); ++y) {
+        for (int x = 0; x != mi.getWidth(); ++x) {
+            BOOST_REQUIRE_EQUAL((*mi.getImage())(x, y), (*expected.getImage())(x, y));
+        }
+    }
+    //
+    // The counts are consistent with each other, and with the CRs that we found
+    //
+    BOOST_CHECK_EQUAL(stats.nCrAfterCondition1, static_cast<int>(crs.size()));
+    BOOST_CHECK_GT(stats.nCrBeforeCondition1, stats.nCrAfterCondition1); // some CRs were too faint
+    BOOST_CHECK_GE(stats.nSpan, stats.nCrBeforeCondition1);
+    BOOST_CHECK_GE(stats.nCandidatePixel, stats.nSpan);
+    BOOST_REQUIRE_EQUAL(stats.nGrownPerIteration.size(), 3u);
+    int nGrown = 0;
+    for (int i = 0; i != 3; ++i) {
+        nGrown += stats.nGrownPerIteration[i];
+    }
+    BOOST_CHECK_GT(nGrown, 0);
+    BOOST_CHECK_LE(nPixel, stats.nCandidatePixel + nGrown); // less any pixels in the faint CRs
+    BOOST_CHECK_GE(stats.nFallbackInterpolation, 0);
+
+    BOOST_CHECK_GT(stats.totalTime, 0.0);
+    BOOST_CHECK_GT(stats.scanTime, 0.0);
+    BOOST_CHECK_LE(stats.scanTime + stats.mergeTime + stats.condition1Time + stats.growTime + stats.removeTime,
+                   stats.totalTime);
+    //
+    // Calling again accumulates the statistics
+    //
+    MaskedImageF mi2(in, true);
+    algorithms::CosmicRayStats stats2 = stats;
+    algorithms::findCosmicRays(mi2, psf, 100.0, policy, false, stats2);
+    BOOST_CHECK_EQUAL(stats2.nCrAfterCondition1, 2*stats.nCrAfterCondition1);
+    BOOST_CHECK_EQUAL(stats2.nGrownPerIteration[0], 2*stats.nGrownPerIteration[0]);
+    //
+    // And they can be written to a PropertySet
+    //
+    lsst::daf::base::PropertySet metadata;
+    stats.setMetadata(metadata);
+    BOOST_CHECK_EQUAL(metadata.get<int>("cr.nSpan"), stats.nSpan);
+    BOOST_CHECK_EQUAL(metadata.get<double>("cr.totalTime"), stats.totalTime);
+    BOOST_CHECK(metadata.getArray<int>("cr.nGrownPerIteration") == stats.nGrownPerIteration);
+
+    stats.setMetadata(metadata, "findCosmicRays.");
+    BOOST_CHECK(metadata.exists("findCosmicRays.nFallbackInterpolation"));
+}
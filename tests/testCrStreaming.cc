@@ -0,0 +1,225 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CrStreaming
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+#include "lsst/meas/algorithms/Interp.h"
+
+#include "crTestUtils.h"
+
+namespace {
+
+namespace afwDet = lsst::afw::detection;
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+typedef afwImage::MaskedImage<float> MaskedImageF;
+
+int const maxCrHeight = 9;              // the tallest CR made by makeImage
+
+/*
+ * A flat sky with a sprinkling of short vertical and horizontal CRs, none of them touching
+ */
+MaskedImageF makeImage(int width, int height) {
+    std::mt19937 rng;                   // unused; the sky is flat
+    MaskedImageF mi = test::cr::makeSky<float>(afwGeom::Extent2I(width, height), rng, 100.0, 0.0);
+    *mi.getVariance() = 100;
+
+    for (int i = 0; i != 60; ++i) {
+        int const x = 5 + (37*i)%(width - 15);
+        int const y = 5 + (97*i)%(height - 15);
+        for (int k = 0; k != 1 + i%maxCrHeight; ++k) {
+            (*mi.getImage())(x + ((i%2 == 1) ? k : 0), y + ((i%2 == 0) ? k : 0)) += 3000;
+        }
+    }
+
+    return mi;
+}
+
+/*
+ * A CosmicRayRowSource that reads from and writes to MaskedImages in memory, checking that it's used
+ * as advertised
+ */
+class MemoryRowSource : public algorithms::CosmicRayRowSource<MaskedImageF> {
+public:
+    explicit MemoryRowSource(MaskedImageF const& in) :
+        _in(in, true), _out(in, true), _nextRead(in.getY0()), _nextWrite(in.getY0()), _maxHeld(0) {}
+
+    virtual afwGeom::Box2I getBBox() const { return _in.getBBox(afwImage::PARENT); }
+
+    virtual PTR(MaskedImageF) readRows(int y0, int nrow) {
+        BOOST_CHECK_EQUAL(y0, _nextRead);
+        _nextRead += nrow;
+        _maxHeld = std::max(_maxHeld, _nextRead - _nextWrite);
+
+        afwGeom::Box2I const bbox(afwGeom::Point2I(_in.getX0(), y0), afwGeom::Extent2I(_in.getWidth(), nrow));
+        return std::make_shared<MaskedImageF>(_in, bbox, afwImage::PARENT, true);
+    }
+
+    virtual void writeRows(MaskedImageF const& rows) {
+        BOOST_CHECK_EQUAL(rows.getY0(), _nextWrite);
+        _nextWrite += rows.getHeight();
+
+        MaskedImageF dest(_out, rows.getBBox(afwImage::PARENT), afwImage::PARENT, false);
+        dest <<= rows;
+    }
+
+    MaskedImageF const& getOutput() const { return _out; }
+    int getNextWrite() const { return _nextWrite; }
+    int getMaxHeld() const { return _maxHeld; }
+private:
+    MaskedImageF _in, _out;
+    int _nextRead, _nextWrite;
+    int _maxHeld;                       // the most rows that have been read but not written
+};
+
+typedef std::set<std::vector<int> > FootprintSet;
+
+FootprintSet asSet(std::vector<PTR(afwDet::Footprint)> const& crs) {
+    FootprintSet out;
+    for (std::vector<PTR(afwDet::Footprint)>::const_iterator cr = crs.begin(); cr != crs.end(); ++cr) {
+        std::vector<int> spans;
+        for (afwDet::Footprint::SpanList::const_iterator sp = (*cr)->getSpans().begin();
+             sp != (*cr)->getSpans().end(); ++sp) {
+            spans.push_back((*sp)->getY());
+            spans.push_back((*sp)->getX0());
+            spans.push_back((*sp)->getX1());
+        }
+        out.insert(spans);
+    }
+    return out;
+}
+
+void checkStreaming(int bandHeight, bool keep) {
+    int const width = 200, height = 500;
+    MaskedImageF const mi = makeImage(width, height);
+    algorithms::DoubleGaussianPsf const psf(15, 15, 2.0);
+    lsst::pex::policy::Policy const policy = test::cr::makeCrPolicy("streamBandHeight", bandHeight);
+
+    MaskedImageF ref(mi, true);
+    std::vector<PTR(afwDet::Footprint)> const expected = algorithms::findCosmicRays(ref, psf, 100, policy, keep);
+    BOOST_REQUIRE(!expected.empty());
+
+    MemoryRowSource source(mi);
+    std::vector<PTR(afwDet::Footprint)> crs;
+    algorithms::findCosmicRaysStreaming<MaskedImageF>(source, psf, 100, policy,
+                                                      [&crs](PTR(afwDet::Footprint) cr) { crs.push_back(cr); },
+                                                      keep);
+    BOOST_CHECK_EQUAL(source.getNextWrite(), height);
+    BOOST_CHECK(asSet(crs) == asSet(expected));
+    //
+    // We only need to hold the rows within reach of the CRs that we're working on
+    //
+    int const margin = policy.getInt("niteration") + algorithms::interp::singlePixelMaxData + 3;
+    BOOST_CHECK_LE(source.getMaxHeld(), std::min(height, bandHeight + 2*margin + maxCrHeight + 2));
+    //
+    // The CRs are isolated and on a flat background, so how far they grow doesn't depend on the order
+    // in which they were removed;  nor does the noise added to the interpolated pixels, which depends
+    // only on their positions
+    //
+    MaskedImageF const& out = source.getOutput();
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            BOOST_CHECK_EQUAL((*out.getMask())(x, y), (*ref.getMask())(x, y));
+            BOOST_CHECK_EQUAL((*out.getImage())(x, y), (keep ? *mi.getImage() : *ref.getImage())(x, y));
+        }
+    }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(CrStreaming) {
+    int const bandHeights[] = {1, 7, 64, 1000};
+    for (int i = 0; i != 4; ++i) {
+        checkStreaming(bandHeights[i], false);
+        checkStreaming(bandHeights[i], true);
+    }
+}
+
+/*
+ * A CR on a short segment of a bad column, in a bad row, can only be interpolated along the column by
+ * interp::singlePixel, which reads the whole segment; streaming must hold enough rows for it to succeed
+ */
+BOOST_AUTO_TEST_CASE(CrStreamingBadColumn) {
+    int const width = 200, height = 500;
+    int const crX = 99, crY = 215;      // the CR
+    int const badY0 = 200, badY1 = 229; // the bad column segment; short enough for singlePixel
+
+    std::mt19937 rng;                   // unused; the sky is flat
+    MaskedImageF mi = test::cr::makeSky<float>(afwGeom::Extent2I(width, height), rng, 100.0, 0.0);
+    *mi.getVariance() = 100;
+    afwImage::MaskPixel const badBit = MaskedImageF::Mask::getPlaneBitMask("BAD");
+    for (int y = badY0; y <= badY1; ++y) { // every direction through the CR has a bad pixel...
+        for (int x = crX - 1; x <= crX + 1; ++x) {
+            (*mi.getMask())(x, y) = badBit;
+        }
+    }
+    for (int x = 40; x <= 160; ++x) {   // ... and the bad run along the row is too long to interpolate over
+        (*mi.getMask())(x, crY) = badBit;
+    }
+    (*mi.getMask())(crX, crY) = 0;
+    (*mi.getImage())(crX, crY) += 3000;
+
+    algorithms::DoubleGaussianPsf const psf(15, 15, 2.0);
+    for (int bandHeight = 1; bandHeight <= 64; bandHeight *= 64) {
+        lsst::pex::policy::Policy const policy = test::cr::makeCrPolicy("streamBandHeight", bandHeight);
+
+        MaskedImageF ref(mi, true);
+        std::vector<PTR(afwDet::Footprint)> const expected =
+            algorithms::findCosmicRays(ref, psf, 100, policy);
+        BOOST_REQUIRE_EQUAL(expected.size(), 1u);
+        BOOST_REQUIRE_CLOSE((*ref.getImage())(crX, crY), 100.0f, 1e-3); // interpolated, not a random value
+
+        MemoryRowSource source(mi);
+        std::vector<PTR(afwDet::Footprint)> crs;
+        algorithms::findCosmicRaysStreaming<MaskedImageF>(source, psf, 100, policy,
+                                                          [&crs](PTR(afwDet::Footprint) cr) {
+                                                              crs.push_back(cr);
+                                                          });
+        BOOST_CHECK(asSet(crs) == asSet(expected));
+
+        MaskedImageF const& out = source.getOutput();
+        for (int y = 0; y != height; ++y) {
+            for (int x = 0; x != width; ++x) {
+                BOOST_REQUIRE_EQUAL((*out.getMask())(x, y), (*ref.getMask())(x, y));
+                BOOST_REQUIRE_EQUAL((*out.getImage())(x, y), (*ref.getImage())(x, y));
+            }
+        }
+    }
+}
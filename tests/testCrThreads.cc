@@ -0,0 +1,131 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Check that findCosmicRays may be called on different images from many threads at once
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CrThreads
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <thread>
+#include <vector>
+
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+#include "crTestUtils.h"
+
+namespace {
+
+namespace afwDet = lsst::afw::detection;
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+int const nImage = 4;                   // number of different images
+int const nThread = 16;                 // number of threads to run at once
+int const nCall = 4;                    // number of calls made by each thread
+
+/*
+ * The result of running findCosmicRays on an image
+ */
+template <typename PixelT>
+struct Result {
+    Result(afwImage::MaskedImage<PixelT> const& in, bool keep) : image(in, true) {
+        algorithms::DoubleGaussianPsf const psf(15, 15, 2.0); // each call has its own PSF
+        crs = algorithms::findCosmicRays(image, psf, 100.0, test::cr::makeCrPolicy(), keep);
+    }
+
+    bool operator==(Result const& rhs) const {
+        if (crs.size() != rhs.crs.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i != crs.size(); ++i) {
+            afwDet::Footprint::SpanList const& spans = crs[i]->getSpans();
+            afwDet::Footprint::SpanList const& rhsSpans = rhs.crs[i]->getSpans();
+            if (spans.size() != rhsSpans.size()) {
+                return false;
+            }
+            for (std::size_t j = 0; j != spans.size(); ++j) {
+                if (spans[j]->getY() != rhsSpans[j]->getY() || spans[j]->getX0() != rhsSpans[j]->getX0() ||
+                    spans[j]->getX1() != rhsSpans[j]->getX1()) {
+                    return false;
+                }
+            }
+        }
+        return test::cr::countDifferences(image, rhs.image) == 0;
+    }
+
+    afwImage::MaskedImage<PixelT> image;
+    std::vector<PTR(afwDet::Footprint)> crs;
+};
+
+template <typename PixelT>
+void checkThreads(bool keep) {
+    std::vector<afwImage::MaskedImage<PixelT> > images;
+    std::vector<Result<PixelT> > expected;
+    for (int i = 0; i != nImage; ++i) {
+        images.push_back(test::cr::makeCrImage<PixelT>(afwGeom::Extent2I(256, 256), i + 1, 150));
+        expected.push_back(Result<PixelT>(images.back(), keep));
+        BOOST_REQUIRE(!expected.back().crs.empty());
+    }
+    //
+    // Each thread processes the images in a different order, so there are always several different images
+    // being processed at once
+    //
+    std::vector<int> nGood(nThread, 0); // number of calls in each thread that gave the expected results
+    std::vector<std::thread> threads;
+    for (int t = 0; t != nThread; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            for (int i = 0; i != nCall; ++i) {
+                int const which = (t + i)%nImage;
+                if (Result<PixelT>(images[which], keep) == expected[which]) {
+                    ++nGood[t];
+                }
+            }
+        }));
+    }
+    for (int t = 0; t != nThread; ++t) {
+        threads[t].join();
+        BOOST_CHECK_EQUAL(nGood[t], nCall);
+    }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(CrThreadsFloat) {
+    checkThreads<float>(false);
+    checkThreads<float>(true);
+}
+
+BOOST_AUTO_TEST_CASE(CrThreadsDouble) {
+    checkThreads<double>(false);
+    checkThreads<double>(true);
+}
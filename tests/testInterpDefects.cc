@@ -0,0 +1,615 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Test interpolateOverDefects
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE InterpDefects
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "lsst/afw/fits.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+#include "lsst/meas/algorithms/DefectPlan.h"
+#include "lsst/meas/algorithms/Interp.h"
+
+namespace {
+
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+typedef afwImage::MaskedImage<float> MaskedImageF;
+typedef std::vector<algorithms::Defect::Ptr> DefectList;
+
+PTR(MaskedImageF) makeImage(int width, int height, int seed) {
+    PTR(MaskedImageF) mi(new MaskedImageF(afwGeom::Extent2I(width, height)));
+    mi->setXY0(afwGeom::Point2I(-5, 7));
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(100, 10);
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            (*mi->getImage())(x, y) = noise(rng);
+            (*mi->getVariance())(x, y) = 100;
+        }
+    }
+    *mi->getMask() = 0;
+
+    return mi;
+}
+
+/*
+ * Noise smoothed by a Gaussian of width sigma, so that its autocorrelation is the one that the PSF-based
+ * interpolation over wide defects assumes, with standard deviation about rms about a mean of 100
+ */
+PTR(MaskedImageF) makeSmoothedImage(int width, int height, double sigma, double rms, int seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0, 1);
+    afwImage::Image<float> white(afwGeom::Extent2I(width, height));
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            white(x, y) = noise(rng);
+        }
+    }
+
+    int const r = static_cast<int>(4*sigma + 1);
+    std::vector<double> kernel(2*r + 1);
+    for (int i = -r; i <= r; ++i) {     // normalised so that the smoothed noise has variance 1
+        kernel[i + r] = std::exp(-i*i/(2*sigma*sigma))/std::sqrt(std::sqrt(M_PI)*sigma);
+    }
+    afwImage::Image<float> rows(white.getDimensions());
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            double sum = 0;
+            for (int i = std::max(-r, -x); i <= std::min(r, width - 1 - x); ++i) {
+                sum += kernel[i + r]*white(x + i, y);
+            }
+            rows(x, y) = sum;
+        }
+    }
+
+    PTR(MaskedImageF) mi(new MaskedImageF(afwGeom::Extent2I(width, height)));
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            double sum = 0;
+            for (int i = std::max(-r, -y); i <= std::min(r, height - 1 - y); ++i) {
+                sum += kernel[i + r]*rows(x, y + i);
+            }
+            (*mi->getImage())(x, y) = 100 + rms*sum;
+        }
+    }
+    *mi->getMask() = 0;
+    *mi->getVariance() = rms*rms;
+
+    return mi;
+}
+
+/*
+ * Overlapping defects of assorted sizes, some of which hang off the image (in parent coordinates)
+ */
+DefectList makeDefects(MaskedImageF const& mi, int ndefect, int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> xpos(-5, mi.getWidth() + 2), ypos(-10, mi.getHeight() + 2);
+    std::uniform_int_distribution<int> width(1, 4), height(1, 30);
+
+    DefectList defects;
+    for (int i = 0; i != ndefect; ++i) {
+        int const w = (i%10 == 0) ? 15*width(rng) : width(rng); // a few WIDE ones
+        afwGeom::Box2I const bbox(afwGeom::Point2I(xpos(rng) + mi.getX0(), ypos(rng) + mi.getY0()),
+                                  afwGeom::Extent2I(w, height(rng)));
+        defects.push_back(algorithms::Defect::Ptr(new algorithms::Defect(bbox)));
+    }
+
+    return defects;
+}
+
+/*
+ * Swap the x and y axes of an image, or of the defects in it
+ */
+PTR(MaskedImageF) transpose(MaskedImageF const& mi) {
+    PTR(MaskedImageF) transposed(new MaskedImageF(afwGeom::Extent2I(mi.getHeight(), mi.getWidth())));
+    transposed->setXY0(afwGeom::Point2I(mi.getY0(), mi.getX0()));
+    for (int y = 0; y != mi.getHeight(); ++y) {
+        for (int x = 0; x != mi.getWidth(); ++x) {
+            (*transposed->getImage())(y, x) = (*mi.getImage())(x, y);
+            (*transposed->getMask())(y, x) = (*mi.getMask())(x, y);
+            (*transposed->getVariance())(y, x) = (*mi.getVariance())(x, y);
+        }
+    }
+
+    return transposed;
+}
+
+DefectList transpose(DefectList const& defects) {
+    DefectList transposed;
+    for (DefectList::const_iterator ptr = defects.begin(); ptr != defects.end(); ++ptr) {
+        afwGeom::Box2I const bbox(afwGeom::Point2I((*ptr)->getY0(), (*ptr)->getX0()),
+                                  afwGeom::Point2I((*ptr)->getY1(), (*ptr)->getX1()));
+        transposed.push_back(algorithms::Defect::Ptr(new algorithms::Defect(bbox)));
+    }
+
+    return transposed;
+}
+
+void checkEqual(MaskedImageF const& mi, MaskedImageF const& ref) {
+    BOOST_REQUIRE_EQUAL(mi.getWidth(), ref.getWidth());
+    BOOST_REQUIRE_EQUAL(mi.getHeight(), ref.getHeight());
+    for (int y = 0; y != mi.getHeight(); ++y) {
+        for (int x = 0; x != mi.getWidth(); ++x) {
+            BOOST_REQUIRE_EQUAL((*mi.getImage())(x, y), (*ref.getImage())(x, y));
+            BOOST_REQUIRE_EQUAL((*mi.getMask())(x, y), (*ref.getMask())(x, y));
+            BOOST_REQUIRE_EQUAL((*mi.getVariance())(x, y), (*ref.getVariance())(x, y));
+        }
+    }
+}
+
+} // anonymous namespace
+
+/*
+ * The defects are classified once for each run of rows that they all touch; check that the result is
+ * the same as interpolating over the same pixels given as a separate defect for each row
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsByRow) {
+    int const width = 120, height = 100;
+    algorithms::DoubleGaussianPsf const psf(5, 5, 1.0);
+
+    for (int useFallbackValueAtEdge = 0; useFallbackValueAtEdge != 2; ++useFallbackValueAtEdge) {
+        PTR(MaskedImageF) mi = makeImage(width, height, 1);
+        PTR(MaskedImageF) ref(new MaskedImageF(*mi, true));
+
+        DefectList defects = makeDefects(*mi, 60, 2);
+        DefectList rows;
+        for (DefectList::const_iterator ptr = defects.begin(); ptr != defects.end(); ++ptr) {
+            for (int y = (*ptr)->getY0(); y <= (*ptr)->getY1(); ++y) {
+                afwGeom::Box2I const bbox(afwGeom::Point2I((*ptr)->getX0(), y),
+                                          afwGeom::Point2I((*ptr)->getX1(), y));
+                rows.push_back(algorithms::Defect::Ptr(new algorithms::Defect(bbox)));
+            }
+        }
+
+        algorithms::interpolateOverDefects(*mi, psf, defects, 10.0, useFallbackValueAtEdge);
+        algorithms::interpolateOverDefects(*ref, psf, rows, 10.0, useFallbackValueAtEdge);
+
+        afwImage::MaskPixel const interpBit = MaskedImageF::Mask::getPlaneBitMask("INTRP");
+        int nInterp = 0;
+        for (int y = 0; y != height; ++y) {
+            for (int x = 0; x != width; ++x) {
+                BOOST_REQUIRE_EQUAL((*mi->getImage())(x, y), (*ref->getImage())(x, y));
+                BOOST_REQUIRE_EQUAL((*mi->getMask())(x, y), (*ref->getMask())(x, y));
+                BOOST_REQUIRE_EQUAL((*mi->getVariance())(x, y), (*ref->getVariance())(x, y));
+                if ((*mi->getMask())(x, y) & interpBit) {
+                    ++nInterp;
+                }
+            }
+        }
+        BOOST_CHECK(nInterp > 0);
+    }
+}
+
+/*
+ * Defects that miss the image's rows entirely are ignored
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsOffImage) {
+    int const width = 50, height = 40;
+    algorithms::DoubleGaussianPsf const psf(5, 5, 1.0);
+
+    PTR(MaskedImageF) mi = makeImage(width, height, 3);
+    PTR(MaskedImageF) ref(new MaskedImageF(*mi, true));
+
+    DefectList defects;
+    int const x0 = mi->getX0() + 10, y0 = mi->getY0();
+    defects.push_back(algorithms::Defect::Ptr(new algorithms::Defect(
+        afwGeom::Box2I(afwGeom::Point2I(x0, y0 - 20), afwGeom::Extent2I(3, 20)))));
+    defects.push_back(algorithms::Defect::Ptr(new algorithms::Defect(
+        afwGeom::Box2I(afwGeom::Point2I(x0, y0 + height), afwGeom::Extent2I(3, 5)))));
+
+    algorithms::interpolateOverDefects(*mi, psf, defects);
+
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            BOOST_REQUIRE_EQUAL((*mi->getImage())(x, y), (*ref->getImage())(x, y));
+            BOOST_REQUIRE_EQUAL((*mi->getMask())(x, y), (*ref->getMask())(x, y));
+        }
+    }
+}
+
+/*
+ * The rows may be shared between threads, but the results mustn't depend on how many we use
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsThreads) {
+    int const width = 200, height = 300;
+    algorithms::DoubleGaussianPsf const psf(5, 5, 1.0);
+
+    PTR(MaskedImageF) ref = makeImage(width, height, 4);
+    PTR(MaskedImageF) const original(new MaskedImageF(*ref, true));
+
+    DefectList defects = makeDefects(*ref, 200, 5);
+    defects.push_back(algorithms::Defect::Ptr(new algorithms::Defect( // a bad column, so one run of rows
+        afwGeom::Box2I(afwGeom::Point2I(ref->getX0() + 50, ref->getY0()), afwGeom::Extent2I(2, height)))));
+
+    algorithms::interpolateOverDefects(*ref, psf, defects, 10.0, false, 1);
+
+    for (int nThread = 2; nThread <= 8; nThread *= 2) {
+        PTR(MaskedImageF) mi(new MaskedImageF(*original, true));
+        algorithms::interpolateOverDefects(*mi, psf, defects, 10.0, false, nThread);
+
+        for (int y = 0; y != height; ++y) {
+            for (int x = 0; x != width; ++x) {
+                BOOST_REQUIRE_EQUAL((*mi->getImage())(x, y), (*ref->getImage())(x, y));
+                BOOST_REQUIRE_EQUAL((*mi->getMask())(x, y), (*ref->getMask())(x, y));
+                BOOST_REQUIRE_EQUAL((*mi->getVariance())(x, y), (*ref->getVariance())(x, y));
+            }
+        }
+    }
+}
+
+/*
+ * Interpolating along columns is the same as interpolating along the rows of the transposed image
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsColumns) {
+    int const width = 150, height = 230;   // more than one tile of columns
+    algorithms::DoubleGaussianPsf const psf(5, 5, 1.0);
+
+    for (int useFallbackValueAtEdge = 0; useFallbackValueAtEdge != 2; ++useFallbackValueAtEdge) {
+        for (int nThread = 1; nThread <= 3; nThread += 2) {
+            PTR(MaskedImageF) mi = makeImage(width, height, 6);
+            DefectList defects = makeDefects(*mi, 100, 7);
+            PTR(MaskedImageF) ref = transpose(*mi);
+            DefectList refDefects = transpose(defects);
+
+            algorithms::interpolateOverDefects(*mi, psf, defects, 10.0, useFallbackValueAtEdge, nThread,
+                                               algorithms::INTERP_COLUMNS);
+            algorithms::interpolateOverDefects(*ref, psf, refDefects, 10.0, useFallbackValueAtEdge);
+
+            checkEqual(*transpose(*mi), *ref);
+        }
+    }
+}
+
+/*
+ * INTERP_AUTO interpolates along rows over defects that are at least as tall as they are wide, and then
+ * along columns over the rest.  If none of the latter is within 2 pixels of the former in the same row, that
+ * is the same as interpolating over them separately
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsAuto) {
+    int const width = 120, height = 100;
+    algorithms::DoubleGaussianPsf const psf(5, 5, 1.0);
+
+    PTR(MaskedImageF) mi = makeImage(width, height, 8);
+    PTR(MaskedImageF) ref(new MaskedImageF(*mi, true));
+
+    DefectList defects = makeDefects(*mi, 60, 9);
+    DefectList tall, wide;
+    for (DefectList::const_iterator ptr = defects.begin(); ptr != defects.end(); ++ptr) {
+        if ((*ptr)->getBBox().getHeight() >= (*ptr)->getBBox().getWidth()) {
+            tall.push_back(*ptr);
+        }
+    }
+    for (DefectList::const_iterator ptr = defects.begin(); ptr != defects.end(); ++ptr) {
+        if ((*ptr)->getBBox().getHeight() >= (*ptr)->getBBox().getWidth()) {
+            continue;
+        }
+        bool crosses = false;
+        for (DefectList::const_iterator row = tall.begin(); row != tall.end(); ++row) {
+            crosses = crosses ||
+                ((*row)->getX0() - 2 <= (*ptr)->getX1() && (*row)->getX1() + 2 >= (*ptr)->getX0() &&
+                 (*row)->getY0() <= (*ptr)->getY1() && (*row)->getY1() >= (*ptr)->getY0());
+        }
+        if (!crosses) {
+            wide.push_back(*ptr);
+        }
+    }
+    BOOST_REQUIRE(!tall.empty() && !wide.empty());
+    defects = tall;
+    defects.insert(defects.end(), wide.begin(), wide.end());
+
+    algorithms::interpolateOverDefects(*mi, psf, defects, 10.0, false, 1, algorithms::INTERP_AUTO);
+    algorithms::interpolateOverDefects(*ref, psf, tall, 10.0, false, 1, algorithms::INTERP_ROWS);
+    algorithms::interpolateOverDefects(*ref, psf, wide, 10.0, false, 1, algorithms::INTERP_COLUMNS);
+
+    checkEqual(*mi, *ref);
+}
+
+/*
+ * When INTERP_AUTO interpolates along rows over a bad column that crosses, touches, or comes within 2 pixels
+ * of a bleed trail, it doesn't use the trail's pixels (which aren't patched until we interpolate along
+ * columns)
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsAutoCrossing) {
+    int const width = 120, height = 100;
+    algorithms::DoubleGaussianPsf const psf(5, 5, 1.0);
+    float const garbage = 1e5;
+
+    PTR(MaskedImageF) mi = makeImage(width, height, 18);
+    int const x0 = mi->getX0(), y0 = mi->getY0();
+
+    DefectList defects;
+    defects.push_back(algorithms::Defect::Ptr(new algorithms::Defect( // a trail
+        afwGeom::Box2I(afwGeom::Point2I(x0 + 20, y0 + 40), afwGeom::Point2I(x0 + 99, y0 + 42)))));
+    int const columns[] = {18, 60, 100};    // ends 2 pixels short of the trail, crosses it, and touches it
+    for (int i = 0; i != 3; ++i) {
+        defects.push_back(algorithms::Defect::Ptr(new algorithms::Defect(
+            afwGeom::Box2I(afwGeom::Point2I(x0 + columns[i], y0), afwGeom::Extent2I(1 + i%2, height)))));
+    }
+    for (DefectList::const_iterator ptr = defects.begin(); ptr != defects.end(); ++ptr) {
+        for (int y = (*ptr)->getY0(); y <= (*ptr)->getY1(); ++y) {
+            for (int x = (*ptr)->getX0(); x <= (*ptr)->getX1(); ++x) {
+                (*mi->getImage())(x - x0, y - y0) = garbage;
+            }
+        }
+    }
+
+    algorithms::interpolateOverDefects(*mi, psf, defects, 10.0, false, 1, algorithms::INTERP_AUTO);
+
+    afwImage::MaskPixel const interpBit = MaskedImageF::Mask::getPlaneBitMask("INTRP");
+    for (DefectList::const_iterator ptr = defects.begin(); ptr != defects.end(); ++ptr) {
+        for (int y = (*ptr)->getY0(); y <= (*ptr)->getY1(); ++y) {
+            for (int x = (*ptr)->getX0(); x <= (*ptr)->getX1(); ++x) {
+                BOOST_REQUIRE((*mi->getMask())(x - x0, y - y0) & interpBit);
+            }
+        }
+    }
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            BOOST_REQUIRE_LT(std::fabs((*mi->getImage())(x, y) - 100), 100);
+        }
+    }
+}
+
+/*
+ * A DefectPlan gives the same results as the defects it was built from, before and after a round trip
+ * through a FITS file, and may only be used for images with its bounding box
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsPlan) {
+    int const width = 120, height = 100;
+    algorithms::DoubleGaussianPsf const psf(5, 5, 1.0);
+
+    for (int useFallbackValueAtEdge = 0; useFallbackValueAtEdge != 2; ++useFallbackValueAtEdge) {
+        PTR(MaskedImageF) ref = makeImage(width, height, 10);
+        PTR(MaskedImageF) const original(new MaskedImageF(*ref, true));
+
+        DefectList defects = makeDefects(*ref, 60, 11);
+        algorithms::DefectPlan const plan(ref->getBBox(afwImage::PARENT), defects, useFallbackValueAtEdge,
+                                          algorithms::INTERP_AUTO);
+        BOOST_CHECK(!plan.getRowRuns().empty() && !plan.getColumnRuns().empty());
+
+        algorithms::interpolateOverDefects(*ref, psf, defects, 10.0, useFallbackValueAtEdge, 1,
+                                           algorithms::INTERP_AUTO);
+
+        PTR(MaskedImageF) mi(new MaskedImageF(*original, true));
+        algorithms::interpolateOverDefects(*mi, plan, 10.0, 3);
+        checkEqual(*mi, *ref);
+
+        lsst::afw::fits::MemFileManager manager;
+        plan.writeFits(manager);
+        PTR(algorithms::DefectPlan) const readPlan = algorithms::DefectPlan::readFits(manager);
+        BOOST_CHECK(readPlan->getBBox() == plan.getBBox());
+        BOOST_CHECK_EQUAL(readPlan->getSegments().size(), plan.getSegments().size());
+
+        mi.reset(new MaskedImageF(*original, true));
+        algorithms::interpolateOverDefects(*mi, *readPlan, 10.0);
+        checkEqual(*mi, *ref);
+    }
+
+    PTR(MaskedImageF) mi = makeImage(width, height, 12);
+    afwGeom::Box2I const bbox(afwGeom::Point2I(0, 0), afwGeom::Extent2I(width, height)); // not mi's
+    algorithms::DefectPlan const plan(bbox, makeDefects(*mi, 10, 13));
+    BOOST_CHECK_THROW(algorithms::interpolateOverDefects(*mi, plan), lsst::pex::exceptions::LengthError);
+}
+
+/*
+ * Interpolating over a mask plane is the same as interpolating over a Defect for each run of its pixels
+ */
+BOOST_AUTO_TEST_CASE(InterpMaskPlane) {
+    int const width = 120, height = 100;
+    algorithms::DoubleGaussianPsf const psf(5, 5, 1.0);
+
+    PTR(MaskedImageF) const original = makeImage(width, height, 14);
+    afwImage::MaskPixel const badBit = MaskedImageF::Mask::getPlaneBitMask("BAD");
+    afwImage::MaskPixel const satBit = MaskedImageF::Mask::getPlaneBitMask("SAT");
+    afwImage::MaskPixel const edgeBit = MaskedImageF::Mask::getPlaneBitMask("EDGE");
+
+    std::mt19937 rng(15);
+    std::uniform_int_distribution<int> bits(0, 15);
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            int const r = bits(rng);
+            (*original->getMask())(x, y) = (r == 0) ? badBit : (r == 1) ? satBit : (r == 2) ? edgeBit : 0;
+        }
+    }
+    for (int y = 0; y != height; ++y) { // a bad column, a wide trail, and runs at both edges
+        (*original->getMask())(40, y) |= badBit;
+        for (int x = 60; x != 75; ++x) {
+            (*original->getMask())(x, y) |= (y > 30 && y < 50) ? satBit : 0;
+        }
+        for (int x = 0; x != 8; ++x) {
+            (*original->getMask())(x, y) |= (y%10 == 0) ? badBit : 0;
+            (*original->getMask())(width - 1 - x, y) |= (y%10 == 5) ? badBit : 0;
+        }
+    }
+
+    DefectList defects;
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            if ((*original->getMask())(x, y) & (badBit | satBit)) {
+                int const x0 = x;
+                while (x + 1 < width && ((*original->getMask())(x + 1, y) & (badBit | satBit))) {
+                    ++x;
+                }
+                afwGeom::Box2I const bbox(afwGeom::Point2I(x0 + original->getX0(), y + original->getY0()),
+                                          afwGeom::Point2I(x + original->getX0(), y + original->getY0()));
+                defects.push_back(algorithms::Defect::Ptr(new algorithms::Defect(bbox)));
+            }
+        }
+    }
+
+    for (int useFallbackValueAtEdge = 0; useFallbackValueAtEdge != 2; ++useFallbackValueAtEdge) {
+        PTR(MaskedImageF) ref(new MaskedImageF(*original, true));
+        algorithms::interpolateOverDefects(*ref, psf, defects, 10.0, useFallbackValueAtEdge);
+
+        for (int nThread = 1; nThread <= 3; nThread += 2) {
+            PTR(MaskedImageF) mi(new MaskedImageF(*original, true));
+            algorithms::interpolateOverMaskPlane(*mi, badBit | satBit, 10.0, useFallbackValueAtEdge, nThread);
+            checkEqual(*mi, *ref);
+        }
+    }
+}
+
+/*
+ * Interpolating over wide defects using the PSF preserves a constant background, leaves narrow defects
+ * alone, and doesn't depend on the number of threads
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsPsf) {
+    int const width = 120, height = 100;
+    algorithms::DoubleGaussianPsf const psf(11, 11, 1.5);
+
+    PTR(MaskedImageF) flat = makeImage(width, height, 16);
+    *flat->getImage() = 100;
+    DefectList wide;
+    int const x0 = flat->getX0(), y0 = flat->getY0();
+    for (int x = 1; x != 12; x += 5) { // wide defects in the middle, near and at the edges
+        wide.push_back(algorithms::Defect::Ptr(new algorithms::Defect(
+            afwGeom::Box2I(afwGeom::Point2I(x0 + 30 + x, y0 + 4*x), afwGeom::Extent2I(10 + x, 3)))));
+        wide.push_back(algorithms::Defect::Ptr(new algorithms::Defect(
+            afwGeom::Box2I(afwGeom::Point2I(x0 + x - 1, y0 + 50 + 4*x), afwGeom::Extent2I(12, 2)))));
+        wide.push_back(algorithms::Defect::Ptr(new algorithms::Defect(
+            afwGeom::Box2I(afwGeom::Point2I(x0 + width - 12 - x, y0 + 70 + 4*x), afwGeom::Extent2I(12, 2)))));
+    }
+    algorithms::interpolateOverDefects(*flat, psf, wide, 10.0, false, 1, algorithms::INTERP_ROWS, true);
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            BOOST_REQUIRE_CLOSE((*flat->getImage())(x, y), 100.0f, 1e-4);
+        }
+    }
+
+    PTR(MaskedImageF) const original = makeImage(width, height, 17);
+    DefectList narrow;                  // defects that are too far apart to merge into a wide one
+    for (int i = 0; i != 20; ++i) {
+        narrow.push_back(algorithms::Defect::Ptr(new algorithms::Defect(
+            afwGeom::Box2I(afwGeom::Point2I(x0 + 6*i, y0 + 5*i), afwGeom::Extent2I(1 + i%4, 20)))));
+    }
+    PTR(MaskedImageF) ref(new MaskedImageF(*original, true));
+    PTR(MaskedImageF) mi(new MaskedImageF(*original, true));
+    algorithms::interpolateOverDefects(*ref, psf, narrow, 10.0);
+    algorithms::interpolateOverDefects(*mi, psf, narrow, 10.0, false, 1, algorithms::INTERP_ROWS, true);
+    checkEqual(*mi, *ref);
+
+    ref.reset(new MaskedImageF(*original, true));
+    algorithms::interpolateOverDefects(*ref, psf, wide, 10.0, false, 1, algorithms::INTERP_AUTO, true);
+    algorithms::DefectPlan const plan(original->getBBox(afwImage::PARENT), wide, false,
+                                      algorithms::INTERP_AUTO);
+    mi.reset(new MaskedImageF(*original, true));
+    algorithms::interpolateOverDefects(*mi, plan, 10.0, 3, &psf);
+    checkEqual(*mi, *ref);
+}
+
+/*
+ * The PSF-based weights for a WIDE defect with all four neighbours, found by interpolating over images that
+ * are zero but for one of them, sum to 1 and are symmetric.  For the middle pixel the symmetry reduces the
+ * kriging system to one equation, a*p - (1/2 - a)*q = c(7) - c(6), for the weight a of each outer neighbour
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsPsfWeights) {
+    int const width = 40, height = 3;
+    int const badX0 = 15, nbad = algorithms::Defect::WIDE_DEFECT;
+    int const neighbours[4] = {badX0 - 2, badX0 - 1, badX0 + nbad, badX0 + nbad + 1};
+    algorithms::DoubleGaussianPsf const psf(11, 11, 1.5);
+
+    double weights[4][nbad];            // weights[i][x] is neighbour i's weight for pixel badX0 + x
+    for (int i = 0; i != 4; ++i) {
+        MaskedImageF mi(afwGeom::Extent2I(width, height));
+        *mi.getImage() = 0;
+        *mi.getMask() = 0;
+        *mi.getVariance() = 0;
+        (*mi.getImage())(neighbours[i], 1) = 1;
+
+        DefectList defects(1, algorithms::Defect::Ptr(new algorithms::Defect(
+            afwGeom::Box2I(afwGeom::Point2I(badX0, 1), afwGeom::Extent2I(nbad, 1)))));
+        algorithms::interpolateOverDefects(mi, psf, defects, 10.0, false, 1, algorithms::INTERP_ROWS, true);
+        for (int x = 0; x != nbad; ++x) {
+            weights[i][x] = (*mi.getImage())(badX0 + x, 1);
+        }
+    }
+
+    for (int x = 0; x != nbad; ++x) {
+        BOOST_CHECK_CLOSE(weights[0][x] + weights[1][x] + weights[2][x] + weights[3][x], 1.0, 1e-3);
+        for (int i = 0; i != 4; ++i) {
+            BOOST_CHECK_SMALL(weights[i][x] - weights[3 - i][nbad - 1 - x], 1e-6);
+        }
+    }
+
+    double const sigma = psf.computeShape().getDeterminantRadius();
+    double c[15];                       // the covariance between pixels d apart
+    for (int d = 0; d != 15; ++d) {
+        c[d] = std::exp(-d*d/(4*sigma*sigma)) + ((d == 0) ? algorithms::interp::wideNugget : 0.0);
+    }
+    double const p = c[0] + c[14] - c[1] - c[13];
+    double const q = c[0] + c[12] - c[1] - c[13];
+    double const a = (c[7] - c[6] + 0.5*q)/(p + q);
+    BOOST_CHECK_CLOSE(weights[0][nbad/2], a, 1e-3);
+    BOOST_CHECK_CLOSE(weights[1][nbad/2], 0.5 - a, 1e-3);
+}
+
+/*
+ * On noise smoothed by the PSF, which is what the PSF-based interpolation assumes, it does no worse over wide
+ * defects than the fixed LPC coefficients
+ */
+BOOST_AUTO_TEST_CASE(InterpDefectsPsfResiduals) {
+    int const width = 200, height = 100;
+    int const nbad = algorithms::Defect::WIDE_DEFECT;
+    algorithms::DoubleGaussianPsf const psf(11, 11, 1.5);
+
+    PTR(MaskedImageF) const original = makeSmoothedImage(width, height, 1.5, 10.0, 18);
+    DefectList defects;
+    for (int x = 10; x + nbad + 10 <= width; x += nbad + 6) {
+        defects.push_back(algorithms::Defect::Ptr(new algorithms::Defect(
+            afwGeom::Box2I(afwGeom::Point2I(x, 5), afwGeom::Extent2I(nbad, height - 10)))));
+    }
+
+    MaskedImageF usePsf(*original, true), lpc(*original, true);
+    algorithms::interpolateOverDefects(usePsf, psf, defects, 10.0, false, 1, algorithms::INTERP_ROWS, true);
+    algorithms::interpolateOverDefects(lpc, psf, defects, 10.0, false, 1, algorithms::INTERP_ROWS, false);
+
+    double psfResidual = 0, lpcResidual = 0; // sums of the squared residuals over the defects
+    for (DefectList::const_iterator ptr = defects.begin(); ptr != defects.end(); ++ptr) {
+        for (int y = (*ptr)->getY0(); y <= (*ptr)->getY1(); ++y) {
+            for (int x = (*ptr)->getX0(); x <= (*ptr)->getX1(); ++x) {
+                double const truth = (*original->getImage())(x, y);
+                psfResidual += std::pow((*usePsf.getImage())(x, y) - truth, 2);
+                lpcResidual += std::pow((*lpc.getImage())(x, y) - truth, 2);
+            }
+        }
+    }
+    BOOST_CHECK_GT(psfResidual, 0.0);
+    BOOST_CHECK_LE(psfResidual, lpcResidual);
+}
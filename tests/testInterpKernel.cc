@@ -0,0 +1,1952 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Test the tables of interpolants used by interpolateOverDefects against the switch that they replaced
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE InterpKernel
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "lsst/afw/image/Image.h"
+#include "lsst/meas/algorithms/Interp.h"
+#include "lsst/meas/algorithms/detail/InterpKernel.h"
+
+namespace {
+
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace algorithms = lsst::meas::algorithms;
+
+using algorithms::Defect;
+
+/*
+ * The hand-written interpolants that interpolateOverDefects used before they were replaced by tables
+ */
+template <typename PixelT, typename IterT>
+void interpolateBySwitch(IterT out, int const ncol, int const badX0, int const badX1,
+                         Defect::DefectPosition const defectPos, unsigned int const defectType,
+                         PixelT const min, double const fallbackValue) {
+    PixelT out1_2, out1_1, out2_1, out2_2; // == out[badX1-2], ..., out[bad_x2+2]
+    PixelT val;                         // unpack a pixel value
+
+    switch (defectPos) {
+      case Defect::LEFT:
+        assert(badX0 >= 0 && badX1 + 2 < ncol);
+
+        out2_1 = out[badX1 + 1];
+        out2_2 = out[badX1 + 2];
+
+        switch (defectType) {
+          case 02:              /* .#?, <noise^2> = 0 */
+            val = 1.0000*out2_1;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 06:              /* .##, <noise^2> = 0 */
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 014:             /* ..##, <noise^2> = 0 */
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX0] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 04:             /* ..#?, <noise^2> = 0 */
+            val = 1.000*out2_1;
+            out[badX0] = (val < min) ? out2_1 : val;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 030:             /* ...##, <noise^2> = 0 */
+            val = 0.6968*out2_1 + 0.3032*out2_2;
+            out[badX0] = (val < min) ? out2_1 : val;
+
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 010:             /* ...#?, <noise^2> = 0 */
+            val = 1.000*out2_1;
+
+            out[badX0] = (val < min) ? out2_1 : val;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 060:             /* ....##, <noise^2> = 0 */
+            val = 0.5370*out2_1 + 0.4630*out2_2;
+            out[badX0] = (val < min) ? out2_1 : val;
+
+            val = 0.6968*out2_1 + 0.3032*out2_2;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 020:             /* ....#?, <noise^2> = 0 */
+            val = 1.0000*out2_1;
+
+            out[badX0] = (val < min) ? out2_1 : val;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 0140:            /* .....##, <noise^2> = 0 */
+            val = 0.5041*out2_1 + 0.4959*out2_2;
+            out[badX0] = (val < min) ? out2_1 : val;
+
+            val = 0.5370*out2_1 + 0.4630*out2_2;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+            val = 0.6968*out2_1 + 0.3032*out2_2;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 040:            /* .....#?, <noise^2> = 0 */
+            val = 1.0000*out2_1;
+            out[badX0] = (val < min) ? out2_1 : val;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 0300:            /* ......##, <noise^2> = 0 */
+            val = 0.5003*out2_1 + 0.4997*out2_2;
+            out[badX0] = (val < min) ? out2_1 : val;
+
+            val = 0.5041*out2_1 + 0.4959*out2_2;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+            val = 0.5370*out2_1 + 0.4630*out2_2;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+
+            val = 0.6968*out2_1 + 0.3032*out2_2;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 0100:            /* ......#?, <noise^2> = 0 */
+            val = 1.0000*out2_1;
+
+            out[badX0] = (val < min) ? out2_1 : val;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 0600:            /* .......##, <noise^2> = 0 */
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0] = (val < min) ? out2_1 : val;
+
+            val = 0.5003*out2_1 + 0.4997*out2_2;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+            val = 0.5041*out2_1 + 0.4959*out2_2;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+
+            val = 0.5370*out2_1 + 0.4630*out2_2;
+            out[badX1 - 3] = (val < min) ? out2_1 : val;
+
+            val = 0.6968*out2_1 + 0.3032*out2_2;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 0200:            /* .......#?, <noise^2> = 0 */
+            val = 1.0000*out2_1;
+            out[badX0] = (val < min) ? out2_1 : val;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+            out[badX1 - 3] = (val < min) ? out2_1 : val;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 01400:           /* ........##, <noise^2> = 0 */
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0] = (val < min) ? out2_1 : val;
+
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+            val = 0.5003*out2_1 + 0.4997*out2_2;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+
+            val = 0.5041*out2_1 + 0.4959*out2_2;
+            out[badX0 + 3] = (val < min) ? out2_1 : val;
+
+            val = 0.5370*out2_1 + 0.4630*out2_2;
+            out[badX1 - 3] = (val < min) ? out2_1 : val;
+
+            val = 0.6968*out2_1 + 0.3032*out2_2;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 0400:           /* ........#?, <noise^2> = 0 */
+            val = 1.0000*out2_1;
+            out[badX0] = (val < min) ? out2_1 : val;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+            out[badX0 + 3] = (val < min) ? out2_1 : val;
+            out[badX1 - 3] = (val < min) ? out2_1 : val;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 03000:           /* .........##, <noise^2> = 0 */
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0] = (val < min) ? out2_1 : val;
+
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+
+            val = 0.5003*out2_1 + 0.4997*out2_2;
+            out[badX0 + 3] = (val < min) ? out2_1 : val;
+
+            val = 0.5041*out2_1 + 0.4959*out2_2;
+            out[badX1 - 4] = (val < min) ? out2_1 : val;
+
+            val = 0.5370*out2_1 + 0.4630*out2_2;
+            out[badX1 - 3] = (val < min) ? out2_1 : val;
+
+            val = 0.6968*out2_1 + 0.3032*out2_2;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 01000:           /* .........#?, <noise^2> = 0 */
+            val = 1.0000*out2_1;
+            out[badX0] = (val < min) ? out2_1 : val;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+            out[badX0 + 3] = (val < min) ? out2_1 : val;
+            out[badX1 - 4] = (val < min) ? out2_1 : val;
+            out[badX1 - 3] = (val < min) ? out2_1 : val;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 06000:           /* ..........##, <noise^2> = 0 */
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0] = (val < min) ? out2_1 : val;
+
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            out[badX0 + 3] = (val < min) ? out2_1 : val;
+
+            val = 0.5003*out2_1 + 0.4997*out2_2;
+            out[badX0 + 4] = (val < min) ? out2_1 : val;
+
+            val = 0.5041*out2_1 + 0.4959*out2_2;
+            out[badX1 - 4] = (val < min) ? out2_1 : val;
+
+            val = 0.5370*out2_1 + 0.4630*out2_2;
+            out[badX1 - 3] = (val < min) ? out2_1 : val;
+
+            val = 0.6968*out2_1 + 0.3032*out2_2;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          case 02000:           /* ..........#?, <noise^2> = 0 */
+            val = 1.0000*out2_1;
+
+            out[badX0] = (val < min) ? out2_1 : val;
+            out[badX0 + 1] = (val < min) ? out2_1 : val;
+            out[badX0 + 2] = (val < min) ? out2_1 : val;
+            out[badX0 + 3] = (val < min) ? out2_1 : val;
+            out[badX0 + 4] = (val < min) ? out2_1 : val;
+            out[badX1 - 4] = (val < min) ? out2_1 : val;
+            out[badX1 - 3] = (val < min) ? out2_1 : val;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          default:
+            //shFatal("Unsupported defect type: LEFT 0%o", defectType);
+            break;                  /* NOTREACHED */
+        }
+        break;
+      case Defect::WIDE_LEFT:
+        assert(badX0 >= 0);
+        if (badX1 + 2 >= ncol) {    /* left defect extends near
+                                       right edge of data! */
+            if (badX1 == ncol - 2) {        /* one column remains */
+                val = out[ncol - 1];
+            } else {
+                val = fallbackValue; /* there is no information */
+            }
+            for (int j = badX0; j <= badX1; j++) {
+                out[j] = val;
+            }
+            break;
+        }
+        out2_1 = out[badX1 + 1];
+        out2_2 = out[badX1 + 2];
+
+        switch (defectType) {
+          case 02:            /* ?#., <noise^2> = 0 */
+            val = 1.0000*out2_1;
+            val = (val < min) ? out2_1 : val;
+
+            for (int j = badX0; j <= badX1; j++) {
+                out[j] = val;
+            }
+            break;
+          case 03:            /* ?##, <noise^2> = 0 */
+            val = 0.5000*out2_1 + 0.5000*out2_2;
+            if (val < min) {
+                val = out2_1;
+            }
+
+            for (int j = badX0; j < badX1 - 5; j++) {
+                out[j] = val;
+            }
+
+            val = 0.5003*out2_1 + 0.4997*out2_2;
+            out[badX1 - 5] = (val < min) ? out2_1 : val;
+
+            val = 0.5041*out2_1 + 0.4959*out2_2;
+            out[badX1 - 4] = (val < min) ? out2_1 : val;
+
+            val = 0.5370*out2_1 + 0.4630*out2_2;
+            out[badX1 - 3] = (val < min) ? out2_1 : val;
+
+            val = 0.6968*out2_1 + 0.3032*out2_2;
+            out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+            val = 1.0933*out2_1 - 0.0933*out2_2;
+            out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+            val = 1.4288*out2_1 - 0.4288*out2_2;
+            out[badX1] = (val < min) ? out2_1 : val;
+
+            break;
+          default:
+            //shFatal("Unsupported defect type: WIDE_LEFT 0%o",defect[i].type);
+            break;                  /* NOTREACHED */
+        }
+
+        break;
+      case Defect::RIGHT:
+        assert(badX0 >= 2 && badX1 < ncol);
+
+        out1_2 = out[badX0 - 2];
+        out1_1 = out[badX0 - 1];
+
+        switch (defectType) {
+          case 06:              /* ##., <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          case 014:             /* ##.., <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          case 030:             /* ##..., <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX1 - 1] = (val < min) ? out1_1 : val;
+
+            val = 0.3032*out1_2 + 0.6968*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          case 060:             /* ##...., <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX0 + 1] = (val < min) ? out1_1 : val;
+
+            val = 0.3032*out1_2 + 0.6968*out1_1;
+            out[badX1 - 1] = (val < min) ? out1_1 : val;
+
+            val = 0.4630*out1_2 + 0.5370*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          case 0140:            /* ##....., <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX0 + 1] = (val < min) ? out1_1 : val;
+
+            val = 0.3032*out1_2 + 0.6968*out1_1;
+            out[badX1 - 2] = (val < min) ? out1_1 : val;
+
+            val = 0.4630*out1_2 + 0.5370*out1_1;
+            out[badX1 - 1] = (val < min) ? out1_1 : val;
+
+            val = 0.4959*out1_2 + 0.5041*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          case 0300:            /* ##......, <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX0 + 1] = (val < min) ? out1_1 : val;
+
+            val = 0.3032*out1_2 + 0.6968*out1_1;
+            out[badX0 + 2] = (val < min) ? out1_1 : val;
+
+            val = 0.4630*out1_2 + 0.5370*out1_1;
+            out[badX1 - 2] = (val < min) ? out1_1 : val;
+
+            val = 0.4959*out1_2 + 0.5041*out1_1;
+            out[badX1 - 1] = (val < min) ? out1_1 : val;
+
+            val = 0.4997*out1_2 + 0.5003*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          case 0600:            /* ##......., <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX0 + 1] = (val < min) ? out1_1 : val;
+
+            val = 0.3032*out1_2 + 0.6968*out1_1;
+            out[badX0 + 2] = (val < min) ? out1_1 : val;
+
+            val = 0.4630*out1_2 + 0.5370*out1_1;
+            out[badX1 - 3] = (val < min) ? out1_1 : val;
+
+            val = 0.4959*out1_2 + 0.5041*out1_1;
+            out[badX1 - 2] = (val < min) ? out1_1 : val;
+
+            val = 0.4997*out1_2 + 0.5003*out1_1;
+            out[badX1 - 1] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          case 01400:           /* ##........, <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX0 + 1] = (val < min) ? out1_1 : val;
+
+            val = 0.3032*out1_2 + 0.6968*out1_1;
+            out[badX0 + 2] = (val < min) ? out1_1 : val;
+
+            val = 0.4630*out1_2 + 0.5370*out1_1;
+            out[badX0 + 3] = (val < min) ? out1_1 : val;
+
+            val = 0.4959*out1_2 + 0.5041*out1_1;
+            out[badX1 - 3] = (val < min) ? out1_1 : val;
+
+            val = 0.4997*out1_2 + 0.5003*out1_1;
+            out[badX1 - 2] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1 - 1] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          case 03000:           /* ##........., <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX0 + 1] = (val < min) ? out1_1 : val;
+
+            val = 0.3032*out1_2 + 0.6968*out1_1;
+            out[badX0 + 2] = (val < min) ? out1_1 : val;
+
+            val = 0.4630*out1_2 + 0.5370*out1_1;
+            out[badX0 + 3] = (val < min) ? out1_1 : val;
+
+            val = 0.4959*out1_2 + 0.5041*out1_1;
+            out[badX1 - 4] = (val < min) ? out1_1 : val;
+
+            val = 0.4997*out1_2 + 0.5003*out1_1;
+            out[badX1 - 3] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1 - 2] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1 - 1] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          case 06000:           /* ##.........., <noise^2> = 0 */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX0 + 1] = (val < min) ? out1_1 : val;
+
+            val = 0.3032*out1_2 + 0.6968*out1_1;
+            out[badX0 + 2] = (val < min) ? out1_1 : val;
+
+            val = 0.4630*out1_2 + 0.5370*out1_1;
+            out[badX0 + 3] = (val < min) ? out1_1 : val;
+
+            val = 0.4959*out1_2 + 0.5041*out1_1;
+            out[badX0 + 4] = (val < min) ? out1_1 : val;
+
+            val = 0.4997*out1_2 + 0.5003*out1_1;
+            out[badX1 - 4] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1 - 3] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1 - 2] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1 - 1] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            out[badX1] = (val < min) ? out1_1 : val;
+
+            break;
+          default:
+            //shFatal("Unsupported defect type: RIGHT 0%o",defect[i].type);
+            break;                  /* NOTREACHED */
+        }
+        break;
+      case Defect::WIDE_RIGHT:
+        assert(badX1 < ncol);
+
+        if (badX0 < 2) {            /* right defect extends near
+                                       left edge of data! */
+            if (badX0 == 1) {               /* one column remains */
+                val = out[0];
+            } else {
+                val = fallbackValue; /* there is no information */
+            }
+            for (int j = badX0; j <= badX1; j++) {
+                out[j] = val;
+            }
+            break;
+        }
+
+        out1_2 = out[badX0 - 2];
+        out1_1 = out[badX0 - 1];
+
+        switch (defectType) {
+          case 03:                  /* ##?, S/N = infty */
+            val = -0.4288*out1_2 + 1.4288*out1_1;
+            out[badX0] = (val < min) ? out1_1 : val;
+
+            val = -0.0933*out1_2 + 1.0933*out1_1;
+            out[badX0 + 1] = (val < min) ? out1_1 : val;
+
+            val = 0.3032*out1_2 + 0.6968*out1_1;
+            out[badX0 + 2] = (val < min) ? out1_1 : val;
+
+            val = 0.4630*out1_2 + 0.5370*out1_1;
+            out[badX0 + 3] = (val < min) ? out1_1 : val;
+
+            val = 0.4959*out1_2 + 0.5041*out1_1;
+            out[badX0 + 4] = (val < min) ? out1_1 : val;
+
+            val = 0.4997*out1_2 + 0.5003*out1_1;
+            out[badX0 + 5] = (val < min) ? out1_1 : val;
+
+            val = 0.5000*out1_2 + 0.5000*out1_1;
+            val = (val < min) ? out1_1 : val;
+
+            for (int j = badX0 + 6; j <= badX1; j++) {
+                out[j] = val;
+            }
+            break;
+          default:
+            //shFatal("Unsupported defect type: WIDE_RIGHT 0%o",defect[i].type);
+            break;                  /* NOTREACHED */
+        }
+        break;
+      case Defect::MIDDLE:
+      case Defect::NEAR_LEFT:
+      case Defect::NEAR_RIGHT:
+        if (defectPos == Defect::MIDDLE) {
+            assert(badX0 >= 2 && badX1 + 2 < ncol);
+            out1_2 = out[badX0 - 2];
+            out2_2 = out[badX1 + 2];
+        } else if (defectPos == Defect::NEAR_LEFT) {
+            assert(badX0 >= 1 && badX1 + 2 < ncol);
+            out1_2 = -1;            /* NOTUSED */
+            out2_2 = out[badX1 + 2];
+        } else if (defectPos == Defect::NEAR_RIGHT) {
+            assert(badX0 >= 2 && badX1 + 1 < ncol);
+            out1_2 = out[badX0 - 2];
+            out2_2 = -1;            /* NOTUSED */
+        } else {
+            //shFatal("Unknown defect classification %d (%s:%d)",defectPos, __FILE__,__LINE__);
+            out1_2 = out2_2 = -1;   /* NOTUSED */
+        }
+        out1_1 = out[badX0 - 1];
+        out2_1 = out[badX1 + 1];
+
+        switch (defectType) {
+          case 012:             /* #.#., <noise^2> = 0, sigma = 1 */
+            val = 0.5000*out1_1 + 0.5000*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1): val;
+
+            break;
+          case 013:         /* #.##, <noise^2> = 0 */
+            val = 0.4875*out1_1 + 0.8959*out2_1 - 0.3834*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 022:             /* #..#., <noise^2> = 0, sigma = 1 */
+            val = 0.7297*out1_1 + 0.2703*out2_1;
+            out[badX0] = (val < 0) ? 0 : val;
+
+            val = 0.2703*out1_1 + 0.7297*out2_1;
+            out[badX1] = (val < 0) ? 0 : val;
+
+            break;
+          case 023:         /* #..##, <noise^2> = 0 */
+            val = 0.7538*out1_1 + 0.5680*out2_1 - 0.3218*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3095*out1_1 + 1.2132*out2_1 - 0.5227*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 032:         /* ##.#., <noise^2> = 0 */
+            val = -0.3834*out1_2 + 0.8959*out1_1 + 0.4875*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 033:         /* ##.##, <noise^2> = 0 */
+            /* These coefficients are also available as
+               interp::interp_1_c1 and interp::interp_1_c2 */
+            val = -0.2737*out1_2 + 0.7737*out1_1 + 0.7737*out2_1 - 0.2737*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 042:                 /* #...#., <noise^2> = 0, sigma = 1 */
+            val = 0.8430*out1_1 + 0.1570*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5000*out1_1 + 0.5000*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.1570*out1_1 + 0.8430*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            break;
+          case 043:             /* #...##, <noise^2> = 0 */
+            val = 0.8525*out1_1 + 0.2390*out2_1 - 0.0915*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5356*out1_1 + 0.8057*out2_1 - 0.3413*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2120*out1_1 + 1.3150*out2_1 - 0.5270*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 062:         /* ##..#., <noise^2> = 0 */
+            val = -0.5227*out1_2 + 1.2132*out1_1 + 0.3095*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.3218*out1_2 + 0.5680*out1_1 + 0.7538*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 063:         /* ##..##, <noise^2> = 0 */
+            val = -0.4793*out1_2 + 1.1904*out1_1 + 0.5212*out2_1 - 0.2323*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2323*out1_2 + 0.5212*out1_1 + 1.1904*out2_1 - 0.4793*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 0102:            /* #....#., <noise^2> = 0, sigma = 1 */
+            val = 0.8810*out1_1 + 0.1190*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.6315*out1_1 + 0.3685*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.3685*out1_1 + 0.6315*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.1190*out1_1 + 0.8810*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            break;
+          case 0103:            /* #....##, <noise^2> = 0 */
+            val = 0.8779*out1_1 + 0.0945*out2_1 + 0.0276*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6327*out1_1 + 0.3779*out2_1 - 0.0106*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4006*out1_1 + 0.8914*out2_1 - 0.2920*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1757*out1_1 + 1.3403*out2_1 - 0.5160*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 0142:                /* ##...#., <noise^2> = 0 */
+            val = -0.5270*out1_2 + 1.3150*out1_1 + 0.2120*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.3413*out1_2 + 0.8057*out1_1 + 0.5356*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.0915*out1_2 + 0.2390*out1_1 + 0.8525*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 0143:                /* ##...##, <noise^2> = 0 */
+            val = -0.5230*out1_2 + 1.3163*out1_1 + 0.2536*out2_1 - 0.0469*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.3144*out1_2 + 0.8144*out1_1 + 0.8144*out2_1 - 0.3144*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.0469*out1_2 + 0.2536*out1_1 + 1.3163*out2_1 - 0.5230*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 0202:            /* #.....#., <noise^2> = 0, sigma = 1 */
+            val = 0.8885*out1_1 + 0.1115*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.6748*out1_1 + 0.3252*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5000*out1_1 + 0.5000*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.3252*out1_1 + 0.6748*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.1115*out1_1 + 0.8885*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            break;
+          case 0203:            /* #.....##, <noise^2> = 0 */
+            val = 0.8824*out1_1 + 0.0626*out2_1 + 0.0549*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6601*out1_1 + 0.2068*out2_1 + 0.1331*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4938*out1_1 + 0.4498*out2_1 + 0.0564*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3551*out1_1 + 0.9157*out2_1 - 0.2708*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1682*out1_1 + 1.3447*out2_1 - 0.5129*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 0302:                /* ##....#., <noise^2> = 0 */
+            val = -0.5160*out1_2 + 1.3403*out1_1 + 0.1757*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2920*out1_2 + 0.8914*out1_1 + 0.4006*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.0106*out1_2 + 0.3779*out1_1 + 0.6327*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0276*out1_2 + 0.0945*out1_1 + 0.8779*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 0303:                /* ##....##, <noise^2> = 0 */
+            val = -0.5197*out1_2 + 1.3370*out1_1 + 0.1231*out2_1 + 0.0596*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2924*out1_2 + 0.8910*out1_1 + 0.3940*out2_1 + 0.0074*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0074*out1_2 + 0.3940*out1_1 + 0.8910*out2_1 - 0.2924*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0596*out1_2 + 0.1231*out1_1 + 1.3370*out2_1 - 0.5197*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 0402:            /* #......#., <noise^2> = 0, sigma = 1 */
+            val = 0.8893*out1_1 + 0.1107*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.6830*out1_1 + 0.3170*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5435*out1_1 + 0.4565*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.4565*out1_1 + 0.5435*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.3170*out1_1 + 0.6830*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.1107*out1_1 + 0.8893*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            break;
+          case 0403:            /* #......##, <noise^2> = 0 */
+            val = 0.8829*out1_1 + 0.0588*out2_1 + 0.0583*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6649*out1_1 + 0.1716*out2_1 + 0.1635*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5212*out1_1 + 0.2765*out2_1 + 0.2024*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4477*out1_1 + 0.4730*out2_1 + 0.0793*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3465*out1_1 + 0.9201*out2_1 - 0.2666*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 0602:                /* ##.....#., <noise^2> = 0 */
+            val = -0.5129*out1_2 + 1.3447*out1_1 + 0.1682*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2708*out1_2 + 0.9157*out1_1 + 0.3551*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0564*out1_2 + 0.4498*out1_1 + 0.4938*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1331*out1_2 + 0.2068*out1_1 + 0.6601*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0549*out1_2 + 0.0626*out1_1 + 0.8824*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 0603:                /* ##.....##, <noise^2> = 0 */
+            val = -0.5179*out1_2 + 1.3397*out1_1 + 0.0928*out2_1 + 0.0854*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2796*out1_2 + 0.9069*out1_1 + 0.2231*out2_1 + 0.1495*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0533*out1_2 + 0.4467*out1_1 + 0.4467*out2_1 + 0.0533*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1495*out1_2 + 0.2231*out1_1 + 0.9069*out2_1 - 0.2796*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0854*out1_2 + 0.0928*out1_1 + 1.3397*out2_1 - 0.5179*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 01002:               /* #.......#., <noise^2> = 0, sigma = 1 */
+            val = 0.8894*out1_1 + 0.1106*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.6839*out1_1 + 0.3161*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5517*out1_1 + 0.4483*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5000*out1_1 + 0.5000*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.4483*out1_1 + 0.5517*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.3161*out1_1 + 0.6839*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.1106*out1_1 + 0.8894*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            break;
+          case 01003:           /* #.......##, <noise^2> = 0 */
+            val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6654*out1_1 + 0.1676*out2_1 + 0.1670*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5260*out1_1 + 0.2411*out2_1 + 0.2329*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4751*out1_1 + 0.2995*out2_1 + 0.2254*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4390*out1_1 + 0.4773*out2_1 + 0.0836*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3456*out1_1 + 0.9205*out2_1 - 0.2661*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 01402:           /* ##......#., <noise^2> = 0 */
+            val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2666*out1_2 + 0.9201*out1_1 + 0.3465*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0793*out1_2 + 0.4730*out1_1 + 0.4477*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2024*out1_2 + 0.2765*out1_1 + 0.5212*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1635*out1_2 + 0.1716*out1_1 + 0.6649*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0583*out1_2 + 0.0588*out1_1 + 0.8829*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 01403:               /* ##......##, <noise^2> = 0 */
+            val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0891*out2_1 + 0.0886*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2771*out1_2 + 0.9095*out1_1 + 0.1878*out2_1 + 0.1797*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0677*out1_2 + 0.4614*out1_1 + 0.2725*out2_1 + 0.1984*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1984*out1_2 + 0.2725*out1_1 + 0.4614*out2_1 + 0.0677*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1797*out1_2 + 0.1878*out1_1 + 0.9095*out2_1 - 0.2771*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0886*out1_2 + 0.0891*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 02002:           /* #........#., <noise^2> = 0, sigma = 1 */
+            val = 0.8894*out1_1 + 0.1106*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.6839*out1_1 + 0.3161*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5526*out1_1 + 0.4474*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5082*out1_1 + 0.4918*out2_1;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.4918*out1_1 + 0.5082*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.4474*out1_1 + 0.5526*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.3161*out1_1 + 0.6839*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.1106*out1_1 + 0.8894*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            break;
+          case 02003:           /* #........##, <noise^2> = 0 */
+            val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5265*out1_1 + 0.2370*out2_1 + 0.2365*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4799*out1_1 + 0.2641*out2_1 + 0.2560*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4664*out1_1 + 0.3038*out2_1 + 0.2298*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4381*out1_1 + 0.4778*out2_1 + 0.0841*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 03002:           /* ##.......#., <noise^2> = 0 */
+            val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2661*out1_2 + 0.9205*out1_1 + 0.3456*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0836*out1_2 + 0.4773*out1_1 + 0.4390*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2254*out1_2 + 0.2995*out1_1 + 0.4751*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2329*out1_2 + 0.2411*out1_1 + 0.5260*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1670*out1_2 + 0.1676*out1_1 + 0.6654*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 03003:               /* ##.......##, <noise^2> = 0 */
+            val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0889*out2_1 + 0.0888*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1838*out2_1 + 0.1832*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0703*out1_2 + 0.4639*out1_1 + 0.2370*out2_1 + 0.2288*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2130*out1_2 + 0.2870*out1_1 + 0.2870*out2_1 + 0.2130*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2288*out1_2 + 0.2370*out1_1 + 0.4639*out2_1 + 0.0703*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1832*out1_2 + 0.1838*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0888*out1_2 + 0.0889*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 04002:           /* #.........#., <noise^2> = 0 */
+            val = 0.8894*out1_1 + 0.1106*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6839*out1_1 + 0.3161*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5527*out1_1 + 0.4473*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5091*out1_1 + 0.4909*out2_1;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5000*out1_1 + 0.5000*out2_1;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4909*out1_1 + 0.5091*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4473*out1_1 + 0.5527*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3161*out1_1 + 0.6839*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1106*out1_1 + 0.8894*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 04003:           /* #.........##, <noise^2> = 0 */
+            val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5265*out1_1 + 0.2368*out2_1 + 0.2367*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4804*out1_1 + 0.2601*out2_1 + 0.2595*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4712*out1_1 + 0.2685*out2_1 + 0.2603*out2_2;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4654*out1_1 + 0.3043*out2_1 + 0.2302*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 06002:           /* ##........#., <noise^2> = 0 */
+            val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0841*out1_2 + 0.4778*out1_1 + 0.4381*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2298*out1_2 + 0.3038*out1_1 + 0.4664*out2_1;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2560*out1_2 + 0.2641*out1_1 + 0.4799*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2365*out1_2 + 0.2370*out1_1 + 0.5265*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 06003:               /* ##........##, <noise^2> = 0 */
+            val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0888*out2_1 + 0.0888*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1835*out2_1 + 0.1835*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0705*out1_2 + 0.4642*out1_1 + 0.2329*out2_1 + 0.2324*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2155*out1_2 + 0.2896*out1_1 + 0.2515*out2_1 + 0.2434*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2434*out1_2 + 0.2515*out1_1 + 0.2896*out2_1 + 0.2155*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2324*out1_2 + 0.2329*out1_1 + 0.4642*out2_1 + 0.0705*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1835*out1_2 + 0.1835*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0888*out1_2 + 0.0888*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 010002:          /* #..........#., <noise^2> = 0, sigma = 1 */
+            val = 0.8894*out1_1 + 0.1106*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.6839*out1_1 + 0.3161*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5527*out1_1 + 0.4473*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5092*out1_1 + 0.4908*out2_1;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.5009*out1_1 + 0.4991*out2_1;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.4991*out1_1 + 0.5009*out2_1;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.4908*out1_1 + 0.5092*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.4473*out1_1 + 0.5527*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.3161*out1_1 + 0.6839*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            val = 0.1106*out1_1 + 0.8894*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1):  val;
+
+            break;
+          case 010003:          /* #..........##, <noise^2> = 0 */
+            val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5265*out1_1 + 0.2367*out2_1 + 0.2367*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4804*out1_1 + 0.2598*out2_1 + 0.2598*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4717*out1_1 + 0.2644*out2_1 + 0.2639*out2_2;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4703*out1_1 + 0.2690*out2_1 + 0.2608*out2_2;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4654*out1_1 + 0.3043*out2_1 + 0.2303*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 014002:          /* ##.........#., <noise^2> = 0 */
+            val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0842*out1_2 + 0.4778*out1_1 + 0.4380*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2302*out1_2 + 0.3043*out1_1 + 0.4654*out2_1;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2603*out1_2 + 0.2685*out1_1 + 0.4712*out2_1;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2595*out1_2 + 0.2601*out1_1 + 0.4804*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2367*out1_2 + 0.2368*out1_1 + 0.5265*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 014003:          /* ##.........##, <noise^2> = 0 */
+            val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0888*out2_1 + 0.0888*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1835*out2_1 + 0.1835*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0705*out1_2 + 0.4642*out1_1 + 0.2326*out2_1 + 0.2326*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2158*out1_2 + 0.2899*out1_1 + 0.2474*out2_1 + 0.2469*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2459*out1_2 + 0.2541*out1_1 + 0.2541*out2_1 + 0.2459*out2_2;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2469*out1_2 + 0.2474*out1_1 + 0.2899*out2_1 + 0.2158*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2326*out1_2 + 0.2326*out1_1 + 0.4642*out2_1 + 0.0705*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1835*out1_2 + 0.1835*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0888*out1_2 + 0.0888*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 020003:          /* #...........##, <noise^2> = 0 */
+            val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5265*out1_1 + 0.2367*out2_1 + 0.2367*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4804*out1_1 + 0.2598*out2_1 + 0.2598*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4718*out1_1 + 0.2641*out2_1 + 0.2641*out2_2;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4708*out1_1 + 0.2649*out2_1 + 0.2644*out2_2;
+            out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4702*out1_1 + 0.2690*out2_1 + 0.2608*out2_2;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4654*out1_1 + 0.3044*out2_1 + 0.2303*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 030002:          /* ##..........#., <noise^2> = 0 */
+            val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0842*out1_2 + 0.4778*out1_1 + 0.4380*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2303*out1_2 + 0.3043*out1_1 + 0.4654*out2_1;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2608*out1_2 + 0.2690*out1_1 + 0.4703*out2_1;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2639*out1_2 + 0.2644*out1_1 + 0.4717*out2_1;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2598*out1_2 + 0.2598*out1_1 + 0.4804*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2367*out1_2 + 0.2367*out1_1 + 0.5265*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 030003:          /* ##..........##, <noise^2> = 0 */
+            val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0888*out2_1 + 0.0888*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1835*out2_1 + 0.1835*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0705*out1_2 + 0.4642*out1_1 + 0.2326*out2_1 + 0.2326*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2158*out1_2 + 0.2899*out1_1 + 0.2472*out2_1 + 0.2471*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2462*out1_2 + 0.2544*out1_1 + 0.2500*out2_1 + 0.2495*out2_2;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2495*out1_2 + 0.2500*out1_1 + 0.2544*out2_1 + 0.2462*out2_2;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2471*out1_2 + 0.2472*out1_1 + 0.2899*out2_1 + 0.2158*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2326*out1_2 + 0.2326*out1_1 + 0.4642*out2_1 + 0.0705*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1835*out1_2 + 0.1835*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0888*out1_2 + 0.0888*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 040003:          /* #............##, <noise^2> = 0 */
+            val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5265*out1_1 + 0.2367*out2_1 + 0.2367*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4804*out1_1 + 0.2598*out2_1 + 0.2598*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4718*out1_1 + 0.2641*out2_1 + 0.2641*out2_2;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4708*out1_1 + 0.2646*out2_1 + 0.2646*out2_2;
+            out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4707*out1_1 + 0.2649*out2_1 + 0.2644*out2_2;
+            out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4702*out1_1 + 0.2690*out2_1 + 0.2608*out2_2;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4654*out1_1 + 0.3044*out2_1 + 0.2303*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 060002:          /* ##...........#., <noise^2> = 0 */
+            val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0842*out1_2 + 0.4778*out1_1 + 0.4380*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2303*out1_2 + 0.3044*out1_1 + 0.4654*out2_1;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2608*out1_2 + 0.2690*out1_1 + 0.4702*out2_1;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2644*out1_2 + 0.2649*out1_1 + 0.4708*out2_1;
+            out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2641*out1_2 + 0.2641*out1_1 + 0.4718*out2_1;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2598*out1_2 + 0.2598*out1_1 + 0.4804*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2367*out1_2 + 0.2367*out1_1 + 0.5265*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          default:
+            //shFatal("Unsupported defect type: MIDDLE 0%o",defect[i].type);
+            break;                  /* NOTREACHED */
+        }
+        break;
+      case Defect::WIDE:
+      case Defect::WIDE_NEAR_LEFT:
+      case Defect::WIDE_NEAR_RIGHT:
+        if (defectPos == Defect::WIDE_NEAR_LEFT) {
+            assert(badX0 >= 1);
+
+            if (badX1 + 2 >= ncol) {        /* left defect extends near
+                                               right edge of data! */
+                if (badX1 == ncol - 2) {    /* one column remains */
+                    val = out[ncol - 1];
+                } else {
+                    val = fallbackValue;            /* there is no information */
+                }
+                for (int j = badX0; j <= badX1; j++) {
+                    out[j] = val;
+                }
+                break;
+            }
+            out1_2 = -1;            /* NOTUSED */
+            out2_2 = out[badX1 + 2];
+        } else if (defectPos == Defect::WIDE) {
+            assert(badX0 >= 2 && badX1 + 2 < ncol);
+            out1_2 = out[badX0 - 2];
+            out2_2 = out[badX1 + 2];
+        } else if (defectPos == Defect::WIDE_NEAR_RIGHT) {
+            assert(badX1 + 1 < ncol);
+
+            if (badX0 < 2) {                /* right defect extends near
+                                               left edge of data! */
+                if (badX0 == 1) {   /* one column remains */
+                    val = out[0];
+                } else {
+                    val = fallbackValue;    /* there is no information */
+                }
+                for (int j = badX0; j <= badX1; j++) {
+                    out[j] = val;
+                }
+                break;
+            }
+            out1_2 = out[badX0 - 2];
+            out2_2 = -1;            /* NOTUSED */
+        } else {
+            //shFatal("Unknown defect classification %d (%s:%d)",defectPos, __FILE__,__LINE__);
+            out1_2 = out2_2 = -1;   /* NOTUSED */
+        }
+
+        out1_1 = out[badX0 - 1];
+        out2_1 = out[badX1 + 1];
+
+        switch (defectType) {
+
+          case 06:                  /* #?#., <noise^2> = 0 */
+            val = 0.8894*out1_1 + 0.1106*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6839*out1_1 + 0.3161*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5527*out1_1 + 0.4473*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5092*out1_1 + 0.4908*out2_1;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5010*out1_1 + 0.4990*out2_1;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5001*out1_1 + 0.4999*out2_1;
+            out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5000*out1_1 + 0.5000*out2_1;
+
+            for (int j = badX0 + 6; j < badX1 - 5; j++) {
+                out[j] = val;
+            }
+
+            val = 0.4999*out1_1 + 0.5001*out2_1;
+            out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4990*out1_1 + 0.5010*out2_1;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4908*out1_1 + 0.5092*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4473*out1_1 + 0.5527*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3161*out1_1 + 0.6839*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1106*out1_1 + 0.8894*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 07:           /* #?##, <noise^2> = 0 */
+            val = 0.8829*out1_1 + 0.0585*out2_1 + 0.0585*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.6654*out1_1 + 0.1673*out2_1 + 0.1673*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.5265*out1_1 + 0.2367*out2_1 + 0.2367*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4804*out1_1 + 0.2598*out2_1 + 0.2598*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4718*out1_1 + 0.2641*out2_1 + 0.2641*out2_2;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4708*out1_1 + 0.2646*out2_1 + 0.2646*out2_2;
+            out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4707*out[badX0 - 1] + 0.2646*out[badX1 + 1] + 0.2646*out[badX1 + 2];
+
+            for (int j = badX0 + 6; j < badX1 - 5; j++) {
+                out[j] = val;
+            }
+
+            val = 0.4707*out1_1 + 0.2649*out2_1 + 0.2644*out2_2;
+            out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4702*out1_1 + 0.2690*out2_1 + 0.2608*out2_2;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4654*out1_1 + 0.3044*out2_1 + 0.2303*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.4380*out1_1 + 0.4778*out2_1 + 0.0842*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.3455*out1_1 + 0.9206*out2_1 - 0.2661*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_1 + 1.3452*out2_1 - 0.5125*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 016:         /* ##?#., <noise^2> = 0 */
+            val = -0.5125*out1_2 + 1.3452*out1_1 + 0.1673*out2_1;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2661*out1_2 + 0.9206*out1_1 + 0.3455*out2_1;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0842*out1_2 + 0.4778*out1_1 + 0.4380*out2_1;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2303*out1_2 + 0.3044*out1_1 + 0.4654*out2_1;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2608*out1_2 + 0.2690*out1_1 + 0.4702*out2_1;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2644*out1_2 + 0.2649*out1_1 + 0.4707*out2_1;
+            out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2646*out1_2 + 0.2646*out1_1 + 0.4707*out2_1;
+            val = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            for (int j = badX0 + 6; j < badX1 - 5; j++) {
+                out[j] = val;
+            }
+
+            val = 0.2646*out1_2 + 0.2646*out1_1 + 0.4708*out2_1;
+            out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2641*out1_2 + 0.2641*out1_1 + 0.4718*out2_1;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2598*out1_2 + 0.2598*out1_1 + 0.4804*out2_1;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2367*out1_2 + 0.2367*out1_1 + 0.5265*out2_1;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1673*out1_2 + 0.1673*out1_1 + 0.6654*out2_1;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0585*out1_2 + 0.0585*out1_1 + 0.8829*out2_1;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          case 017:                 /* ##?##, S/N = infty */
+            val = -0.5177*out1_2 + 1.3400*out1_1 + 0.0888*out2_1 + 0.0888*out2_2;
+            out[badX0] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = -0.2768*out1_2 + 0.9098*out1_1 + 0.1835*out2_1 + 0.1835*out2_2;
+            out[badX0 + 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0705*out1_2 + 0.4642*out1_1 + 0.2326*out2_1 + 0.2326*out2_2;
+            out[badX0 + 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2158*out1_2 + 0.2899*out1_1 + 0.2472*out2_1 + 0.2472*out2_2;
+            out[badX0 + 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2462*out1_2 + 0.2544*out1_1 + 0.2497*out2_1 + 0.2497*out2_2;
+            out[badX0 + 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2497*out1_2 + 0.2503*out1_1 + 0.2500*out2_1 + 0.2500*out2_2;
+            out[badX0 + 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2500*out1_2 + 0.2500*out1_1 + 0.2500*out2_1 + 0.2500*out2_2;
+            val = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            for (int j = badX0 + 6; j < badX1 - 5; j++) {
+                out[j] = val;
+            }
+
+            val = 0.2500*out1_2 + 0.2500*out1_1 + 0.2503*out2_1 + 0.2497*out2_2;
+            out[badX1 - 5] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2497*out1_2 + 0.2497*out1_1 + 0.2544*out2_1 + 0.2462*out2_2;
+            out[badX1 - 4] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2472*out1_2 + 0.2472*out1_1 + 0.2899*out2_1 + 0.2158*out2_2;
+            out[badX1 - 3] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.2326*out1_2 + 0.2326*out1_1 + 0.4642*out2_1 + 0.0705*out2_2;
+            out[badX1 - 2] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.1835*out1_2 + 0.1835*out1_1 + 0.9098*out2_1 - 0.2768*out2_2;
+            out[badX1 - 1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            val = 0.0888*out1_2 + 0.0888*out1_1 + 1.3400*out2_1 - 0.5177*out2_2;
+            out[badX1] = (val < min) ? 0.5*(out1_1 + out2_1) : val;
+
+            break;
+          default:
+            //shFatal("Unsupported defect type: WIDE 0%o",defect[i].type);
+            break;                  /* NOTREACHED */
+        }
+        break;
+    }
+}
+
+/*
+ * The gaps to leave to the left and right of a defect at a given position, including those that take wide
+ * defects to the far side of the row
+ */
+std::vector<int> leftGaps(Defect::DefectPosition pos) {
+    switch (pos) {
+      case Defect::LEFT:
+      case Defect::WIDE_LEFT:
+        return std::vector<int>(1, 0);
+      case Defect::NEAR_LEFT:
+      case Defect::WIDE_NEAR_LEFT:
+        return std::vector<int>(1, 1);
+      case Defect::WIDE_RIGHT:
+      case Defect::WIDE_NEAR_RIGHT:
+        return std::vector<int>{0, 1, 2, 4};
+      default:
+        return std::vector<int>{2, 4};
+    }
+}
+
+std::vector<int> rightGaps(Defect::DefectPosition pos) {
+    switch (pos) {
+      case Defect::RIGHT:
+      case Defect::WIDE_RIGHT:
+        return std::vector<int>(1, 0);
+      case Defect::NEAR_RIGHT:
+      case Defect::WIDE_NEAR_RIGHT:
+        return std::vector<int>(1, 1);
+      case Defect::WIDE_LEFT:
+      case Defect::WIDE_NEAR_LEFT:
+        return std::vector<int>{0, 1, 2, 4};
+      default:
+        return std::vector<int>{2, 4};
+    }
+}
+
+template <typename PixelT>
+bool identical(PixelT a, PixelT b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+/*
+ * Interpolate over a defect of every width up to 20 pixels with both the tables and the switch, and check
+ * that the rows are identical.  The defect's type doesn't always make sense for its width, so the row
+ * is padded on both sides to catch any pixels that are set outside it.
+ */
+template <typename PixelT>
+int checkDefect(Defect::DefectPosition pos, unsigned int type, std::mt19937 & rng) {
+    int const pad = 25;
+    int const pattern = algorithms::detail::findInterpPattern(pos, type);
+    std::normal_distribution<PixelT> noise(100, 10);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::vector<int> const left = leftGaps(pos), right = rightGaps(pos);
+
+    int nCheck = 0;
+    for (int nbad = 1; nbad <= 20; ++nbad) {
+        for (std::vector<int>::const_iterator g0 = left.begin(); g0 != left.end(); ++g0) {
+            for (std::vector<int>::const_iterator g1 = right.begin(); g1 != right.end(); ++g1) {
+                int const ncol = *g0 + nbad + *g1;
+                int const badX0 = *g0, badX1 = badX0 + nbad - 1;
+
+                for (int trial = 0; trial != 4; ++trial) {
+                    afwImage::Image<PixelT> ref(afwGeom::Extent2I(ncol + 2*pad, 1));
+                    for (int x = 0; x != ref.getWidth(); ++x) {
+                        ref(x, 0) = noise(rng);
+                        if (trial == 1) {  // values around zero, to test clipping negative values
+                            ref(x, 0) -= 100;
+                        } else if (trial == 2 && uniform(rng) < 0.2) { // unknown pixels may be NaN
+                            ref(x, 0) = std::numeric_limits<PixelT>::quiet_NaN();
+                        }
+                    }
+                    afwImage::Image<PixelT> image(ref, true);
+                    // clip everything on the last trial
+                    PixelT const min = (trial == 3) ? 1000 : -std::numeric_limits<PixelT>::max();
+                    double const fallbackValue = 12345;
+
+                    interpolateBySwitch<PixelT>(ref.row_begin(0) + pad, ncol, badX0, badX1, pos, type,
+                                                min, fallbackValue);
+                    algorithms::detail::interpolateDefect<PixelT>(image.row_begin(0) + pad, ncol,
+                                                                  badX0, badX1, pos, pattern,
+                                                                  min, fallbackValue);
+                    for (int x = 0; x != ref.getWidth(); ++x) {
+                        if (!identical(image(x, 0), ref(x, 0))) {
+                            BOOST_FAIL("position " << pos << " type 0" << std::oct << type << std::dec <<
+                                       " pixels [" << badX0 << ", " << badX1 << "] of " << ncol <<
+                                       " trial " << trial << " x " << x - pad << ": " <<
+                                       image(x, 0) << " != " << ref(x, 0));
+                        }
+                    }
+                    ++nCheck;
+                }
+            }
+        }
+    }
+
+    return nCheck;
+}
+
+template <typename PixelT>
+void checkAllDefects() {
+    std::mt19937 rng(1);
+    int nPattern = 0;
+    for (int pos = Defect::LEFT; pos <= Defect::RIGHT; ++pos) {
+        for (unsigned int type = 0; type != 0100000; ++type) {
+            Defect::DefectPosition const defectPos = static_cast<Defect::DefectPosition>(pos);
+            //
+            // WIDE 07's fill reads out[badX1 + 2] rather than out2_2, so the switch reads off the end of
+            // the row for a WIDE_NEAR_RIGHT 07 defect (which classify_defects never produces);  the table
+            // uses out2_2 (i.e. -1) instead
+            //
+            if (defectPos == Defect::WIDE_NEAR_RIGHT && type == 07) {
+                ++nPattern;
+                continue;
+            }
+            if (algorithms::detail::findInterpPattern(defectPos, type) >= 0) {
+                ++nPattern;
+                checkDefect<PixelT>(defectPos, type, rng);
+            } else if (type%64 == 0) {  // the switch has no case for this type
+                checkDefect<PixelT>(defectPos, type, rng);
+            }
+        }
+    }
+    //
+    // The switch has 80 cases, but NEAR_LEFT and NEAR_RIGHT use MIDDLE's 43, and WIDE_NEAR_LEFT
+    // and WIDE_NEAR_RIGHT use WIDE's 4
+    //
+    BOOST_CHECK_EQUAL(nPattern, 80 + 2*43 + 2*4);
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(InterpKernelFloat) {
+    checkAllDefects<float>();
+}
+
+BOOST_AUTO_TEST_CASE(InterpKernelDouble) {
+    checkAllDefects<double>();
+}
+
+/*
+ * A defect is only valid if the neighbours implied by its position lie in the row, and it has an
+ * interpolant unless it's filled
+ */
+BOOST_AUTO_TEST_CASE(InterpKernelValidDefect) {
+    using algorithms::detail::isValidDefect;
+    int const pattern = algorithms::detail::findInterpPattern(Defect::MIDDLE, 0143); // ##...##
+    BOOST_REQUIRE(pattern >= 0);
+
+    BOOST_CHECK(isValidDefect(7, 2, 4, Defect::MIDDLE, pattern));
+    BOOST_CHECK(!isValidDefect(7, 1, 4, Defect::MIDDLE, pattern)); // out[badX0 - 2] is off the row
+    BOOST_CHECK(!isValidDefect(7, 2, 5, Defect::MIDDLE, pattern)); // out[badX1 + 2] is off the row
+    BOOST_CHECK(!isValidDefect(7, 2, 4, Defect::MIDDLE, -1));      // no interpolant
+    BOOST_CHECK(!isValidDefect(7, 4, 2, Defect::MIDDLE, pattern)); // empty
+
+    BOOST_CHECK(isValidDefect(6, 1, 3, Defect::NEAR_LEFT, pattern));
+    BOOST_CHECK(!isValidDefect(6, 0, 3, Defect::NEAR_LEFT, pattern));
+    BOOST_CHECK(isValidDefect(5, 0, 2, Defect::LEFT, pattern));
+    BOOST_CHECK(!isValidDefect(4, 0, 2, Defect::LEFT, pattern));
+    BOOST_CHECK(isValidDefect(5, 2, 4, Defect::RIGHT, pattern));
+    BOOST_CHECK(!isValidDefect(5, 2, 5, Defect::RIGHT, pattern));
+
+    BOOST_CHECK(isValidDefect(21, 0, 20, Defect::WIDE_LEFT, -1)); // filled, so needs no interpolant
+    BOOST_CHECK(isValidDefect(20, 1, 19, Defect::WIDE_RIGHT, -1));
+    BOOST_CHECK(!isValidDefect(30, 0, 20, Defect::WIDE_LEFT, -1));
+
+    BOOST_CHECK(!isValidDefect(7, 2, 4, static_cast<Defect::DefectPosition>(0), pattern));
+    BOOST_CHECK(!isValidDefect(7, 2, 4, static_cast<Defect::DefectPosition>(Defect::RIGHT + 1), pattern));
+}
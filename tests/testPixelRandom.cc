@@ -0,0 +1,79 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ * Check the counter-based random numbers used when removing CRs
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE PixelRandom
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <cmath>
+
+#include "lsst/meas/algorithms/detail/PixelRandom.h"
+
+using lsst::meas::algorithms::detail::PixelRandom;
+
+BOOST_AUTO_TEST_CASE(Reproducible) {
+    PixelRandom const rand(42);
+    PixelRandom const rand2(42);
+    PixelRandom const other(43);
+
+    double const value = rand.gaussian(10, -3, 1);
+    BOOST_CHECK_EQUAL(rand.gaussian(10, -3, 1), value);
+    BOOST_CHECK_EQUAL(rand2.gaussian(10, -3, 1), value);
+    BOOST_CHECK_NE(other.gaussian(10, -3, 1), value);
+    BOOST_CHECK_NE(rand.gaussian(10, -3, 0), value);
+    BOOST_CHECK_NE(rand.gaussian(-3, 10, 1), value);
+    BOOST_CHECK_NE(rand.gaussian(11, -3, 1), value);
+}
+
+BOOST_AUTO_TEST_CASE(Distribution) {
+    PixelRandom const rand;
+    int const n = 500;                  // size of the grid of pixels
+    double sum = 0, sum2 = 0;           // sum and sum of squares of the Gaussian deviates
+    double sumxy = 0;                   // sum of the products of horizontally-adjacent deviates
+    double usum = 0;                    // sum of the uniform deviates
+    for (int y = 0; y != n; ++y) {
+        for (int x = 0; x != n; ++x) {
+            double const g = rand.gaussian(x, y);
+            sum += g;
+            sum2 += g*g;
+            sumxy += g*rand.gaussian(x + 1, y);
+
+            double const u = rand.uniform(x, y, 1);
+            BOOST_REQUIRE(u > 0 && u < 1);
+            usum += u;
+        }
+    }
+    double const npix = n*n;
+    BOOST_CHECK_SMALL(sum/npix, 5/std::sqrt(npix)); // 5 sigma
+    BOOST_CHECK_CLOSE(sum2/npix, 1.0, 5*std::sqrt(2/npix)*100);
+    BOOST_CHECK_SMALL(sumxy/npix, 5/std::sqrt(npix));
+    BOOST_CHECK_SMALL(usum/npix - 0.5, 5*std::sqrt(1/(12*npix)));
+}
@@ -0,0 +1,180 @@
+// -*- LSST-C++ -*-
+
+/*
+ * LSST Data Management System
+ * Copyright 2008-2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Test interp::singlePixel and the index of bad pixels that it uses
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SinglePixel
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <random>
+#include <vector>
+
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/Interp.h"
+
+namespace {
+
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace interp = lsst::meas::algorithms::interp;
+
+typedef afwImage::MaskedImage<float> MaskedImageF;
+
+/*
+ * Find the defect containing (x, y) the slow way
+ */
+interp::BadPixelRuns::Run findDefect(afwImage::Mask<afwImage::MaskPixel> const& mask,
+                                     afwImage::MaskPixel badMask, int x, int y, bool horizontal) {
+    int const x0 = mask.getX0(), y0 = mask.getY0();
+    int const dx = horizontal ? 1 : 0, dy = horizontal ? 0 : 1;
+
+    int z1 = horizontal ? x : y, z2 = z1;
+    for (int i = 1; ; ++i) {
+        int const xx = x - i*dx - x0, yy = y - i*dy - y0;
+        if (xx < 0 || yy < 0 || !(mask(xx, yy) & badMask)) {
+            break;
+        }
+        --z1;
+    }
+    for (int i = 1; ; ++i) {
+        int const xx = x + i*dx - x0, yy = y + i*dy - y0;
+        if (xx >= mask.getWidth() || yy >= mask.getHeight() || !(mask(xx, yy) & badMask)) {
+            break;
+        }
+        ++z2;
+    }
+    return interp::BadPixelRuns::Run(z1, z2);
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(BadPixelRuns) {
+    int const width = 60, height = 50;
+    afwImage::Mask<afwImage::MaskPixel> mask(afwGeom::Extent2I(width, height));
+    mask.setXY0(afwGeom::Point2I(10, 20));
+    mask = 0;
+
+    afwImage::MaskPixel const bad = 0x1, other = 0x2;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> bit(0, 3);
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            int const b = bit(rng);
+            mask(x, y) = (b == 0) ? bad : ((b == 1) ? other : 0);
+        }
+    }
+
+    interp::BadPixelRuns runs(mask, bad);
+    //
+    // Add some more bad pixels, both to the index and the mask
+    //
+    std::uniform_int_distribution<int> xpos(0, width - 1), ypos(0, height - 1);
+    for (int i = 0; i != 50; ++i) {
+        int const y = ypos(rng);
+        int x0 = xpos(rng), x1 = xpos(rng);
+        if (x0 > x1) {
+            std::swap(x0, x1);
+        }
+        runs.add(y + mask.getY0(), x0 + mask.getX0(), x1 + mask.getX0());
+        for (int x = x0; x <= x1; ++x) {
+            mask(x, y) |= bad;
+        }
+    }
+    runs.add(mask.getY0() - 1, mask.getX0(), mask.getX0() + 3); // off the mask; ignored
+
+    for (int y = 0; y != height; ++y) {
+        for (int x = 0; x != width; ++x) {
+            for (int horizontal = 0; horizontal != 2; ++horizontal) {
+                interp::BadPixelRuns::Run const expected =
+                    findDefect(mask, bad, x + mask.getX0(), y + mask.getY0(), horizontal);
+                interp::BadPixelRuns::Run const defect =
+                    runs.getDefect(x + mask.getX0(), y + mask.getY0(), horizontal);
+                BOOST_REQUIRE_EQUAL(defect.first, expected.first);
+                BOOST_REQUIRE_EQUAL(defect.second, expected.second);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SinglePixel) {
+    int const width = 100, height = 80;
+    float const value = 100;
+    MaskedImageF mi(afwGeom::Extent2I(width, height));
+    mi.setXY0(afwGeom::Point2I(-5, 7));
+    *mi.getImage() = value;
+    *mi.getMask() = 0;
+    *mi.getVariance() = 1;
+
+    afwImage::MaskPixel const badBit = MaskedImageF::Mask::getPlaneBitMask("BAD");
+    afwImage::MaskPixel const crBit = MaskedImageF::Mask::getPlaneBitMask("CR");
+    /*
+     * Make defects of widths 1..40 at the start of rows (columns) 10, 11, ...;  they're contaminated
+     */
+    int const maxWidth = 40;
+    for (int w = 1; w <= maxWidth; ++w) {
+        for (int i = 0; i != w; ++i) {
+            (*mi.getImage())(10 + i, 10 + w) = 1000;
+            (*mi.getMask())(10 + i, 10 + w) = (i%2 == 0) ? badBit : crBit;
+        }
+    }
+    interp::BadPixelRuns const badPixels(*mi.getMask(), badBit | crBit);
+
+    for (int w = 1; w <= maxWidth; ++w) {
+        for (int i = 0; i != w; ++i) {
+            int const x = 10 + i + mi.getX0(), y = 10 + w + mi.getY0();
+            std::pair<bool, float> const val = interp::singlePixel(x, y, mi, badPixels, true, 0.0);
+            if (w + 4 > 40) {           // too wide
+                BOOST_CHECK(!val.first);
+            } else {
+                BOOST_REQUIRE(val.first);
+                BOOST_CHECK_CLOSE(val.second, value, 0.1); // percent
+            }
+
+            std::pair<bool, float> const slow = interp::singlePixel(x, y, mi, true, 0.0);
+            BOOST_CHECK_EQUAL(slow.first, val.first);
+            if (val.first) {
+                BOOST_CHECK_EQUAL(slow.second, val.second);
+            }
+        }
+    }
+    //
+    // A pixel that isn't marked bad is still interpolated over; check it vertically too
+    //
+    (*mi.getImage())(50, 4) = 1000;
+    std::pair<bool, float> const vert = interp::singlePixel(50 + mi.getX0(), 4 + mi.getY0(), mi, badPixels,
+                                                            false, 0.0);
+    BOOST_REQUIRE(vert.first);
+    BOOST_CHECK_CLOSE(vert.second, value, 0.1);
+    //
+    // We need two good pixels and a margin of two more between the defect and the edge
+    //
+    BOOST_CHECK(!interp::singlePixel(50 + mi.getX0(), 3 + mi.getY0(), mi, badPixels, false, 0.0).first);
+    BOOST_CHECK(!interp::singlePixel(3 + mi.getX0(), 50 + mi.getY0(), mi, badPixels, true, 0.0).first);
+    BOOST_CHECK(interp::singlePixel(4 + mi.getX0(), 50 + mi.getY0(), mi, badPixels, true, 0.0).first);
+}